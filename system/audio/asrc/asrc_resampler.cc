@@ -385,6 +385,26 @@ class SourceAudioHalAsrc::Resampler {
   }
 };
 
+//
+// Generic Resampler Filtering
+//
+
+// Dot product of the 2 * KERNEL_A input samples with the interpolated
+// coefficients, in Q31. The last coefficient of each phase is null, the
+// 32 taps form is used by the vectorized versions, and gives the same
+// result as the 31 taps scalar loop.
+
+[[maybe_unused]] static inline int64_t FilterGeneric(const int32_t* in,
+                                                     const int32_t* h,
+                                                     int16_t mu,
+                                                     const int16_t* d) {
+  int64_t s = 0;
+  for (int i = 0; i < 2 * ResamplerTables::KERNEL_A - 1; i++)
+    s += int64_t(in[i]) * (h[i] + ((mu * d[i] + (1 << 6)) >> 7));
+
+  return s;
+}
+
 //
 // ARM AArch 64 Neon Resampler Filtering
 //
@@ -443,6 +463,104 @@ inline int32_t SourceAudioHalAsrc::Resampler::Filter(const int32_t* x,
   return std::clamp(s, int64_t(pcm_min_), int64_t(pcm_max_));
 }
 
+//
+// x86 SSE4.1 / AVX2 Resampler Filtering
+//
+
+#elif defined(__x86_64__)
+
+#include <immintrin.h>
+
+// The `_mm_mul_epi32` instruction multiplies the even 32 bits lanes,
+// the odd lanes are moved down for the second half of the products.
+
+__attribute__((target("sse4.1"))) static inline __m128i mm_mul_odd_epi32(
+    __m128i a, __m128i b) {
+  return _mm_mul_epi32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+}
+
+__attribute__((target("avx2"))) static inline __m256i mm256_mul_odd_epi32(
+    __m256i a, __m256i b) {
+  return _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+}
+
+__attribute__((target("sse4.1"))) static int64_t FilterSse41(
+    const int32_t* x, const int32_t* h, int16_t _mu, const int16_t* d) {
+  __m128i sx = _mm_setzero_si128();
+
+  const __m128i mu = _mm_set1_epi32(_mu);
+  const __m128i rnd = _mm_set1_epi32(1 << 6);
+
+  for (int i = 0; i < 2 * ResamplerTables::KERNEL_A; i += 4) {
+    __m128i d4 = _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i*)(d + i)));
+    __m128i h4 = _mm_loadu_si128((const __m128i*)(h + i));
+    __m128i x4 = _mm_loadu_si128((const __m128i*)(x + i));
+
+    h4 = _mm_add_epi32(
+        h4, _mm_srai_epi32(_mm_add_epi32(_mm_mullo_epi32(d4, mu), rnd), 7));
+
+    sx = _mm_add_epi64(sx, _mm_mul_epi32(x4, h4));
+    sx = _mm_add_epi64(sx, mm_mul_odd_epi32(x4, h4));
+  }
+
+  sx = _mm_add_epi64(sx, _mm_unpackhi_epi64(sx, sx));
+  return _mm_cvtsi128_si64(sx);
+}
+
+__attribute__((target("avx2"))) static int64_t FilterAvx2(const int32_t* x,
+                                                          const int32_t* h,
+                                                          int16_t _mu,
+                                                          const int16_t* d) {
+  __m256i sx = _mm256_setzero_si256();
+
+  const __m256i mu = _mm256_set1_epi32(_mu);
+  const __m256i rnd = _mm256_set1_epi32(1 << 6);
+
+  for (int i = 0; i < 2 * ResamplerTables::KERNEL_A; i += 8) {
+    __m256i d8 =
+        _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(d + i)));
+    __m256i h8 = _mm256_loadu_si256((const __m256i*)(h + i));
+    __m256i x8 = _mm256_loadu_si256((const __m256i*)(x + i));
+
+    h8 = _mm256_add_epi32(
+        h8,
+        _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(d8, mu), rnd),
+                          7));
+
+    sx = _mm256_add_epi64(sx, _mm256_mul_epi32(x8, h8));
+    sx = _mm256_add_epi64(sx, mm256_mul_odd_epi32(x8, h8));
+  }
+
+  __m128i s2 = _mm_add_epi64(_mm256_castsi256_si128(sx),
+                             _mm256_extracti128_si256(sx, 1));
+  s2 = _mm_add_epi64(s2, _mm_unpackhi_epi64(s2, s2));
+  return _mm_cvtsi128_si64(s2);
+}
+
+// The implementation is selected once, from the features of the CPU.
+// The accumulation is done modulo 2^64 in all versions, whatever the order
+// of the additions, so the result is bit-exact with the generic filtering.
+
+using FilterFn = int64_t (*)(const int32_t*, const int32_t*, int16_t,
+                             const int16_t*);
+
+static FilterFn SelectFilter() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return FilterAvx2;
+  if (__builtin_cpu_supports("sse4.1")) return FilterSse41;
+  return FilterGeneric;
+}
+
+inline int32_t SourceAudioHalAsrc::Resampler::Filter(const int32_t* in,
+                                                     const int32_t* h,
+                                                     int16_t mu,
+                                                     const int16_t* d) {
+  static const FilterFn filter = SelectFilter();
+
+  int64_t s = (filter(in, h, mu, d) + (1 << 30)) >> 31;
+  return std::clamp(s, int64_t(pcm_min_), int64_t(pcm_max_));
+}
+
 //
 // Generic Resampler Filtering
 //
@@ -453,11 +571,7 @@ inline int32_t SourceAudioHalAsrc::Resampler::Filter(const int32_t* in,
                                                      const int32_t* h,
                                                      int16_t mu,
                                                      const int16_t* d) {
-  int64_t s = 0;
-  for (int i = 0; i < 2 * KERNEL_A - 1; i++)
-    s += int64_t(in[i]) * (h[i] + ((mu * d[i] + (1 << 6)) >> 7));
-
-  s = (s + (1 << 30)) >> 31;
+  int64_t s = (FilterGeneric(in, h, mu, d) + (1 << 30)) >> 31;
   return std::clamp(s, int64_t(pcm_min_), int64_t(pcm_max_));
 }
 
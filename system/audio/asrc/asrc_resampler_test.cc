@@ -16,8 +16,10 @@
 
 #include "asrc_resampler.cc"
 
+#include <chrono>
 #include <cstdio>
 #include <iostream>
+#include <random>
 
 namespace bluetooth::audio::asrc {
 
@@ -77,4 +79,88 @@ extern "C" void resample_i32(int channels, int bitdepth, double ratio,
   return;
 }
 
+// Check the vectorized filtering against the generic implementation,
+// on random input windows, for all the phases and a set of fractions.
+// Returns the number of mismatching results.
+
+extern "C" int check_filter_bitexact(int bitdepth) {
+  std::vector<std::pair<const char*, int64_t (*)(const int32_t*,
+                                                 const int32_t*, int16_t,
+                                                 const int16_t*)>>
+      filters;
+
+#if defined(__x86_64__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse4.1"))
+    filters.emplace_back("sse4.1", FilterSse41);
+  if (__builtin_cpu_supports("avx2")) filters.emplace_back("avx2", FilterAvx2);
+#endif
+
+  std::mt19937 gen(bitdepth);
+  std::uniform_int_distribution<int32_t> pcm(
+      -(int64_t(1) << (bitdepth - 1)), (int64_t(1) << (bitdepth - 1)) - 1);
+  std::uniform_int_distribution<int16_t> frac(0, 0x7fff);
+
+  const auto& tables = resampler_tables;
+  const int size = 2 * ResamplerTables::KERNEL_A;
+  int32_t x[size];
+  int errors = 0;
+
+  for (int phy = 0; phy < ResamplerTables::KERNEL_Q; phy++)
+    for (int n = 0; n < 16; n++) {
+      for (auto& v : x) v = pcm(gen);
+
+      int16_t mu = n == 0 ? 0 : n == 1 ? 0x7fff : frac(gen);
+      int64_t ref = FilterGeneric(x, tables.h[phy], mu, tables.d[phy]);
+
+      for (auto& [name, filter] : filters)
+        if (filter(x, tables.h[phy], mu, tables.d[phy]) != ref) {
+          fprintf(stderr, "%s: mismatch on phase %d, fraction %d\n", name,
+                  phy, mu);
+          errors++;
+        }
+    }
+
+  return errors;
+}
+
+// Resample `duration_ms` of a random mono stream, and returns
+// the throughput in number of output samples per second.
+
+extern "C" double resample_throughput(int bitdepth, double ratio,
+                                      int duration_ms) {
+  const size_t in_length = 48 * duration_ms;
+  const size_t out_length = size_t(in_length / ratio);
+
+  std::mt19937 gen(bitdepth);
+  std::uniform_int_distribution<int32_t> pcm(
+      -(int64_t(1) << (bitdepth - 1)), (int64_t(1) << (bitdepth - 1)) - 1);
+
+  SourceAudioHalAsrcTest asrc(1, bitdepth);
+  size_t in_count, out_count;
+
+  auto start = std::chrono::steady_clock::now();
+
+  if (bitdepth <= 16) {
+    std::vector<int16_t> in(in_length), out(out_length);
+    for (auto& v : in) v = pcm(gen);
+
+    start = std::chrono::steady_clock::now();
+    asrc.Resample<int16_t>(ratio, in.data(), in_length, &in_count, out.data(),
+                           out_length, &out_count);
+  } else {
+    std::vector<int32_t> in(in_length), out(out_length);
+    for (auto& v : in) v = pcm(gen);
+
+    start = std::chrono::steady_clock::now();
+    asrc.Resample<int32_t>(ratio, in.data(), in_length, &in_count, out.data(),
+                           out_length, &out_count);
+  }
+
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  return out_count / elapsed.count();
+}
+
 }  // namespace bluetooth::audio::asrc
@@ -19,7 +19,7 @@ import ctypes
 import numpy as np
 from scipy import signal
 from mobly import test_runner, base_test
-from mobly.asserts import assert_greater
+from mobly.asserts import assert_equal, assert_greater
 import sys
 import os
 
@@ -114,6 +114,38 @@ class SnrTest(base_test.BaseTestClass):
         assert_greater(mean_snr(cresampler_24, 48.0 / 44.1), 114)
 
 
+class FilterTest(base_test.BaseTestClass):
+
+    def test_16bit_bitexact(self):
+        assert_equal(lib.check_filter_bitexact(ctypes.c_int(16)), 0)
+
+    def test_24bit_bitexact(self):
+        assert_equal(lib.check_filter_bitexact(ctypes.c_int(24)), 0)
+
+    def test_32bit_bitexact(self):
+        assert_equal(lib.check_filter_bitexact(ctypes.c_int(32)), 0)
+
+
+class ThroughputBenchmark(base_test.BaseTestClass):
+
+    def throughput(self, bitdepth, ratio):
+        lib.resample_throughput.restype = ctypes.c_double
+        value = lib.resample_throughput(ctypes.c_int(bitdepth), ctypes.c_double(ratio), ctypes.c_int(10 * 1000))
+        self.record_data({
+            'Test Name': self.current_test_info.name,
+            'sponge_properties': {
+                'samples_per_second': value
+            },
+        })
+        return value
+
+    def test_16bit_throughput(self):
+        assert_greater(self.throughput(16, 44.1 / 48.0), FS)
+
+    def test_24bit_throughput(self):
+        assert_greater(self.throughput(24, 44.1 / 48.0), FS)
+
+
 if __name__ == '__main__':
     index = sys.argv.index('--')
     sys.argv = sys.argv[:1] + sys.argv[index + 1:]
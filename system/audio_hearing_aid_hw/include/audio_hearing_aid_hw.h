@@ -85,6 +85,7 @@ typedef enum {
   HEARING_AID_CTRL_GET_OUTPUT_AUDIO_CONFIG,
   HEARING_AID_CTRL_SET_OUTPUT_AUDIO_CONFIG,
   HEARING_AID_CTRL_CMD_OFFLOAD_START,
+  HEARING_AID_CTRL_GET_AUDIO_FIFO, /* ACK carries an audio FIFO memfd */
 } tHEARING_AID_CTRL_CMD;
 
 typedef enum {
@@ -35,12 +35,15 @@
 #include <system/audio.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cerrno>
+#include <cstring>
 #include <mutex>
 
 #include "osi/include/hash_map_utils.h"
 #include "osi/include/osi.h"
 #include "osi/include/socket_utils/sockets.h"
+#include "udrv/include/audio_fifo.h"
 
 /*****************************************************************************
  *  Constants & Macros
@@ -86,6 +89,7 @@ static const char* audio_ha_hw_dump_ctrl_event(tHEARING_AID_CTRL_CMD event) {
     CASE_RETURN_STR(HEARING_AID_CTRL_GET_OUTPUT_AUDIO_CONFIG)
     CASE_RETURN_STR(HEARING_AID_CTRL_SET_OUTPUT_AUDIO_CONFIG)
     CASE_RETURN_STR(HEARING_AID_CTRL_CMD_OFFLOAD_START)
+    CASE_RETURN_STR(HEARING_AID_CTRL_GET_AUDIO_FIFO)
     default:
       break;
   }
@@ -132,6 +136,7 @@ struct ha_stream_common {
   std::recursive_mutex* mutex;  // See note below on mutex acquisition order.
   int ctrl_fd;
   int audio_fd;
+  bluetooth::udrv::AudioFifo* audio_fifo;  // carries the audio data if set
   size_t buffer_sz;
   struct ha_config cfg;
   ha_state_t state;
@@ -805,6 +810,7 @@ static void ha_stream_common_init(struct ha_stream_common* common) {
 
   common->ctrl_fd = AUDIO_SKT_DISCONNECTED;
   common->audio_fd = AUDIO_SKT_DISCONNECTED;
+  common->audio_fifo = NULL;
   common->state = AUDIO_HA_STATE_STOPPED;
 
   /* manages max capacity of socket pipe */
@@ -814,10 +820,112 @@ static void ha_stream_common_init(struct ha_stream_common* common) {
 static void ha_stream_common_destroy(struct ha_stream_common* common) {
   FNLOG();
 
+  delete common->audio_fifo;
+  common->audio_fifo = NULL;
+
   delete common->mutex;
   common->mutex = NULL;
 }
 
+// Requests a shared memory FIFO for the audio data of stream |common|, the
+// audio socket keeps carrying the audio data if the stack declines.
+static void ha_open_audio_fifo(struct ha_stream_common* common) {
+  uint8_t cmd = HEARING_AID_CTRL_GET_AUDIO_FIFO;
+  ssize_t ret;
+
+  OSI_NO_INTR(ret = send(common->ctrl_fd, &cmd, 1, MSG_NOSIGNAL));
+  if (ret == -1) {
+    ERROR("cmd failed (%s): command=%s", strerror(errno),
+          audio_ha_hw_dump_ctrl_event(HEARING_AID_CTRL_GET_AUDIO_FIFO));
+    return;
+  }
+
+  /* wait for ack byte, the FIFO memory comes along on success */
+  char ack = HEARING_AID_CTRL_ACK_FAILURE;
+  char control[CMSG_SPACE(sizeof(int))] = {};
+  struct iovec iov = {.iov_base = &ack, .iov_len = 1};
+  struct msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  OSI_NO_INTR(ret = recvmsg(common->ctrl_fd, &msg, MSG_CMSG_CLOEXEC));
+  if (ret <= 0) {
+    ERROR("HEARING_AID COMMAND %s: no ACK",
+          audio_ha_hw_dump_ctrl_event(HEARING_AID_CTRL_GET_AUDIO_FIFO));
+    skt_disconnect(common->ctrl_fd);
+    common->ctrl_fd = AUDIO_SKT_DISCONNECTED;
+    return;
+  }
+
+  int fd = -1;
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  if (cmsg != NULL && cmsg->cmsg_level == SOL_SOCKET &&
+      cmsg->cmsg_type == SCM_RIGHTS) {
+    memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+  }
+
+  if (ack != HEARING_AID_CTRL_ACK_SUCCESS || fd < 0) {
+    INFO("audio FIFO not available (status %d)", ack);
+    if (fd >= 0) close(fd);
+    return;
+  }
+
+  common->audio_fifo = bluetooth::udrv::AudioFifo::Map(fd).release();
+  if (common->audio_fifo == NULL) {
+    /* The stack reads from the FIFO from now on: restart the audio path */
+    ERROR("failed to map the audio FIFO");
+    skt_disconnect(common->audio_fd);
+    common->audio_fd = AUDIO_SKT_DISCONNECTED;
+    return;
+  }
+
+  INFO("audio FIFO of %zu bytes", common->audio_fifo->GetCapacity());
+}
+
+static void ha_close_audio_fifo(struct ha_stream_common* common) {
+  if (common->audio_fifo == NULL) return;
+
+  INFO("audio FIFO overruns %" PRIu64 " (%" PRIu64 " bytes), underruns %" PRIu64
+       " (%" PRIu64 " bytes)",
+       common->audio_fifo->GetOverrunCount(),
+       common->audio_fifo->GetOverrunBytes(),
+       common->audio_fifo->GetUnderrunCount(),
+       common->audio_fifo->GetUnderrunBytes());
+
+  delete common->audio_fifo;
+  common->audio_fifo = NULL;
+}
+
+// Writes |len| bytes to the audio FIFO of stream |common|, waiting up to
+// SOCK_SEND_TIMEOUT_MS for the encoder to make room. |lock| is released while
+// waiting. On success, returns the number of octets written, otherwise -1.
+static int fifo_write(struct ha_stream_common* common,
+                      std::unique_lock<std::recursive_mutex>& lock,
+                      const void* p, size_t len) {
+  int ms_timeout = SOCK_SEND_TIMEOUT_MS;
+
+  ts_log("fifo_write", len, NULL);
+
+  /* The FIFO is released when the stream is suspended or stopped */
+  while (common->audio_fifo != NULL) {
+    len = std::min(len, common->audio_fifo->GetCapacity());
+    if (common->audio_fifo->GetWritableSize() >= len) {
+      return (int)common->audio_fifo->Write((const uint8_t*)p, len);
+    }
+    if (ms_timeout < WRITE_POLL_MS) {
+      WARN("write timeout exceeded, audio FIFO full");
+      return -1;
+    }
+    lock.unlock();
+    usleep(WRITE_POLL_MS * 1000);
+    lock.lock();
+    ms_timeout -= WRITE_POLL_MS;
+  }
+  return -1;
+}
+
 static int start_audio_datapath(struct ha_stream_common* common) {
   INFO("state %d", common->state);
 
@@ -867,6 +975,7 @@ static int stop_audio_datapath(struct ha_stream_common* common) {
   common->state = (ha_state_t)AUDIO_HA_STATE_STOPPED;
 
   /* disconnect audio path */
+  ha_close_audio_fifo(common);
   skt_disconnect(common->audio_fd);
   common->audio_fd = AUDIO_SKT_DISCONNECTED;
 
@@ -887,6 +996,7 @@ static int suspend_audio_datapath(struct ha_stream_common* common,
     common->state = AUDIO_HA_STATE_SUSPENDED;
 
   /* disconnect audio path */
+  ha_close_audio_fifo(common);
   skt_disconnect(common->audio_fd);
 
   common->audio_fd = AUDIO_SKT_DISCONNECTED;
@@ -921,6 +1031,7 @@ static ssize_t out_write(struct audio_stream_out* stream, const void* buffer,
     if (start_audio_datapath(&out->common) < 0) {
       goto finish;
     }
+    ha_open_audio_fifo(&out->common);
   } else if (out->common.state != AUDIO_HA_STATE_STARTED) {
     ERROR("stream not in stopped or standby");
     goto finish;
@@ -939,11 +1050,16 @@ static ssize_t out_write(struct audio_stream_out* stream, const void* buffer,
           out->common.audio_fd);
   }
 
-  lock.unlock();
-  sent = skt_write(out->common.audio_fd, buffer, write_bytes);
-  lock.lock();
+  if (out->common.audio_fifo != NULL) {
+    sent = fifo_write(&out->common, lock, buffer, write_bytes);
+  } else {
+    lock.unlock();
+    sent = skt_write(out->common.audio_fd, buffer, write_bytes);
+    lock.lock();
+  }
 
   if (sent == -1) {
+    ha_close_audio_fifo(&out->common);
     skt_disconnect(out->common.audio_fd);
     out->common.audio_fd = AUDIO_SKT_DISCONNECTED;
     if ((out->common.state != AUDIO_HA_STATE_SUSPENDED) &&
@@ -1019,6 +1019,9 @@ void bta_gattc_read(tBTA_GATTC_CLCB* p_clcb, const tBTA_GATTC_DATA* p_data) {
 
   /* read fail */
   if (status != GATT_SUCCESS) {
+    /* Retry later if it was sent on an additional EATT bearer */
+    if (bta_gattc_requeue_eatt_cmd(p_clcb, p_data)) return;
+
     /* Dequeue the data, if it was enqueued */
     if (p_clcb->p_q_cmd == p_data) p_clcb->p_q_cmd = NULL;
 
@@ -1090,6 +1093,9 @@ void bta_gattc_write(tBTA_GATTC_CLCB* p_clcb, const tBTA_GATTC_DATA* p_data) {
 
   /* write fail */
   if (status != GATT_SUCCESS) {
+    /* Retry later if it was sent on an additional EATT bearer */
+    if (bta_gattc_requeue_eatt_cmd(p_clcb, p_data)) return;
+
     /* Dequeue the data, if it was enqueued */
     if (p_clcb->p_q_cmd == p_data) p_clcb->p_q_cmd = NULL;
 
@@ -1262,6 +1268,8 @@ void bta_gattc_op_cmpl(tBTA_GATTC_CLCB* p_clcb, const tBTA_GATTC_DATA* p_data) {
       return;
   }
 
+  bta_gattc_select_eatt_cmd(p_clcb, op, p_data->op_cmpl.p_cmpl);
+
   if (p_clcb->p_q_cmd->hdr.event !=
           bta_gattc_opcode_to_int_evt[op - GATTC_OPTYPE_READ] &&
       (p_clcb->p_q_cmd->hdr.event != BTA_GATTC_API_READ_MULTI_EVT ||
@@ -1314,11 +1322,19 @@ void bta_gattc_op_cmpl(tBTA_GATTC_CLCB* p_clcb, const tBTA_GATTC_DATA* p_data) {
     }
   }
 
+  /* Commands still executing on EATT bearers are completed before any
+   * rediscovery */
+  bta_gattc_promote_eatt_cmd(p_clcb);
+
   // If receive DATABASE_OUT_OF_SYNC error code, bta_gattc should start service
   // discovery immediately
   if (bta_gattc_is_robust_caching_enabled() &&
       p_data->op_cmpl.status == GATT_DATABASE_OUT_OF_SYNC) {
     log::info("DATABASE_OUT_OF_SYNC, re-discover service");
+    if (p_clcb->p_q_cmd != NULL) {
+      p_clcb->auto_update = BTA_GATTC_DISC_WAITING;
+      return;
+    }
     p_clcb->auto_update = BTA_GATTC_REQ_WAITING;
     /* request read db hash first */
     p_clcb->p_srcb->srvc_hdl_db_hash = true;
@@ -1327,6 +1343,8 @@ void bta_gattc_op_cmpl(tBTA_GATTC_CLCB* p_clcb, const tBTA_GATTC_DATA* p_data) {
   }
 
   if (p_clcb->auto_update == BTA_GATTC_DISC_WAITING) {
+    if (p_clcb->p_q_cmd != NULL) return;
+
     p_clcb->auto_update = BTA_GATTC_REQ_WAITING;
 
     /* request read db hash first */
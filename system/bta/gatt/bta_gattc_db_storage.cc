@@ -22,9 +22,16 @@
 #include <base/strings/string_number_conversions.h>
 #include <bluetooth/log.h>
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <map>
+#include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "bta/gatt/bta_gattc_int.h"
@@ -32,6 +39,7 @@
 #include "os/log.h"
 #include "stack/include/gattdefs.h"
 #include "types/bluetooth/uuid.h"
+#include "types/raw_address.h"
 
 using namespace bluetooth;
 
@@ -40,40 +48,88 @@ using std::string;
 using std::vector;
 
 #ifdef TARGET_FLOSS
-#define GATT_CACHE_PREFIX "/var/lib/bluetooth/gatt/gatt_cache_"
-#define GATT_CACHE_VERSION 6
-
-#define GATT_HASH_MAX_SIZE 30
-#define GATT_HASH_PATH_PREFIX "/var/lib/bluetooth/gatt/gatt_hash_"
 #define GATT_HASH_PATH "/var/lib/bluetooth/gatt"
-#define GATT_HASH_FILE_PREFIX "gatt_hash_"
 #else
-#define GATT_CACHE_PREFIX "/data/misc/bluetooth/gatt_cache_"
+#define GATT_HASH_PATH "/data/misc/bluetooth"
+#endif
+#define GATT_CACHE_DB_FILE "gatt_db_cache"
+#define GATT_CACHE_DB_MAGIC 0x43544147 /* "GATC" */
 #define GATT_CACHE_VERSION 6
 
-#define GATT_HASH_MAX_SIZE 30
-#define GATT_HASH_PATH_PREFIX "/data/misc/bluetooth/gatt_hash_"
-#define GATT_HASH_PATH "/data/misc/bluetooth"
+/* Per device and per hash files of the previous cache format, imported into
+ * the cache file when it is created */
+#define GATT_CACHE_FILE_PREFIX "gatt_cache_"
 #define GATT_HASH_FILE_PREFIX "gatt_hash_"
-#endif
+
+#define GATT_HASH_MAX_SIZE 30
 
 // Default expired time is 7 days
 #define GATT_HASH_EXPIRED_TIME 604800
 
-static void bta_gattc_hash_remove_least_recently_used_if_possible();
-
-static void bta_gattc_generate_cache_file_name(char* buffer, size_t buffer_len,
-                                               const RawAddress& bda) {
-  snprintf(buffer, buffer_len, "%s%02x%02x%02x%02x%02x%02x", GATT_CACHE_PREFIX,
-           bda.address[0], bda.address[1], bda.address[2], bda.address[3],
-           bda.address[4], bda.address[5]);
-}
-
-static void bta_gattc_generate_hash_file_name(char* buffer, size_t buffer_len,
-                                              const Octet16& hash) {
-  snprintf(buffer, buffer_len, "%s%s", GATT_HASH_PATH_PREFIX,
-           base::HexEncode(hash.data(), 16).c_str());
-}
+/* The GATT cache is a single file holding the databases of all the servers,
+ * keyed by database hash, and the links from bonded server addresses to their
+ * database. Servers sharing the same database share the stored attributes.
+ *
+ *   tGATT_CACHE_DB_HEADER
+ *   tGATT_CACHE_DB_ENTRY[num_databases]
+ *   tGATT_CACHE_DB_LINK[num_links]
+ *   StoredAttribute[num_attr] of each database, at the entry offset
+ *
+ * The file is mapped in memory and only its index is parsed when opened. A
+ * database is deserialized from the mapping when it is loaded. The file is
+ * rewritten atomically when a database or a link is added or removed. */
+typedef struct {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t num_databases;
+  uint16_t num_links;
+  uint16_t reserved[3];
+} tGATT_CACHE_DB_HEADER;
+
+typedef struct {
+  Octet16 hash;
+  int64_t last_used;
+  uint32_t offset;
+  uint16_t num_attr;
+  uint16_t reserved;
+} tGATT_CACHE_DB_ENTRY;
+
+typedef struct {
+  RawAddress bda;
+  uint16_t database;
+} tGATT_CACHE_DB_LINK;
+
+static_assert(sizeof(tGATT_CACHE_DB_HEADER) == 16);
+static_assert(sizeof(tGATT_CACHE_DB_ENTRY) == 32);
+static_assert(sizeof(tGATT_CACHE_DB_LINK) == 8);
+static_assert(sizeof(StoredAttribute) == StoredAttribute::kSizeOnDisk);
+
+namespace {
+struct gatt_cache_database {
+  time_t last_used;
+  uint16_t num_attr;
+  /* offset of the attributes in the mapped file */
+  size_t offset;
+  /* serialized attributes not written to the file yet */
+  vector<uint8_t> pending;
+};
+
+struct gatt_cache_db {
+  bool opened = false;
+  const uint8_t* map = nullptr;
+  size_t map_size = 0;
+  std::map<Octet16, gatt_cache_database> databases;
+  std::unordered_map<RawAddress, Octet16> links;
+};
+}  // namespace
+
+static gatt_cache_db cache_db;
+
+/* Directory of the cache file and of the files of the previous cache format */
+static string cache_dir = GATT_HASH_PATH;
+
+static string cache_db_path() { return cache_dir + "/" GATT_CACHE_DB_FILE; }
+static string cache_db_tmp_path() { return cache_db_path() + ".tmp"; }
 
 static gatt::Database EMPTY_DB;
 
@@ -81,7 +137,7 @@ static gatt::Database EMPTY_DB;
  *
  * Function         bta_gattc_load_db
  *
- * Description      Load GATT database from storage.
+ * Description      Load GATT database from a file of the previous cache format.
  *
  * Parameter        fname: input file name
  *
@@ -134,6 +190,356 @@ done:
   return EMPTY_DB;
 }
 
+/*******************************************************************************
+ *
+ * Function         bta_gattc_cache_db_map
+ *
+ * Description      Map the GATT cache file in memory and parse its index. The
+ *                  previous mapping is kept if the file is invalid.
+ *
+ * Returns          true on success, false otherwise
+ *
+ ******************************************************************************/
+static bool bta_gattc_cache_db_map() {
+  const string path = cache_db_path();
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    log::error("can't open GATT cache file {} for reading, error: {}", path,
+               strerror(errno));
+    return false;
+  }
+
+  struct stat buf;
+  if (fstat(fd, &buf) == -1 ||
+      (size_t)buf.st_size < sizeof(tGATT_CACHE_DB_HEADER)) {
+    log::error("can't read GATT cache header: {}", path);
+    close(fd);
+    return false;
+  }
+
+  size_t map_size = buf.st_size;
+  void* map = mmap(nullptr, map_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    log::error("can't map GATT cache file {}, error: {}", path,
+               strerror(errno));
+    return false;
+  }
+
+  const uint8_t* p = (const uint8_t*)map;
+  tGATT_CACHE_DB_HEADER header;
+  memcpy(&header, p, sizeof(header));
+
+  size_t index_size = sizeof(header) +
+                      header.num_databases * sizeof(tGATT_CACHE_DB_ENTRY) +
+                      header.num_links * sizeof(tGATT_CACHE_DB_LINK);
+  if (header.magic != GATT_CACHE_DB_MAGIC ||
+      header.version != GATT_CACHE_VERSION || index_size > map_size) {
+    log::error("wrong GATT cache version: {}", path);
+    munmap(map, map_size);
+    return false;
+  }
+
+  std::map<Octet16, gatt_cache_database> databases;
+  std::unordered_map<RawAddress, Octet16> links;
+  vector<Octet16> hashes;
+  p += sizeof(header);
+
+  for (uint16_t i = 0; i < header.num_databases; i++) {
+    tGATT_CACHE_DB_ENTRY entry;
+    memcpy(&entry, p, sizeof(entry));
+    p += sizeof(entry);
+
+    if (entry.offset < index_size ||
+        entry.offset + entry.num_attr * StoredAttribute::kSizeOnDisk >
+            map_size) {
+      log::error("can't read GATT attributes: {}", path);
+      munmap(map, map_size);
+      return false;
+    }
+
+    databases[entry.hash] = {.last_used = (time_t)entry.last_used,
+                             .num_attr = entry.num_attr,
+                             .offset = entry.offset,
+                             .pending = {}};
+    hashes.push_back(entry.hash);
+  }
+
+  for (uint16_t i = 0; i < header.num_links; i++) {
+    tGATT_CACHE_DB_LINK link;
+    memcpy(&link, p, sizeof(link));
+    p += sizeof(link);
+
+    if (link.database >= hashes.size()) {
+      log::error("invalid GATT cache link: {}", path);
+      munmap(map, map_size);
+      return false;
+    }
+    links[link.bda] = hashes[link.database];
+  }
+
+  if (cache_db.map != nullptr) {
+    munmap((void*)cache_db.map, cache_db.map_size);
+  }
+  cache_db.map = (const uint8_t*)map;
+  cache_db.map_size = map_size;
+  cache_db.databases = std::move(databases);
+  cache_db.links = std::move(links);
+  return true;
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_gattc_cache_db_commit
+ *
+ * Description      Write the GATT cache file, and map the new file.
+ *
+ * Returns          true on success, false otherwise
+ *
+ ******************************************************************************/
+static bool bta_gattc_cache_db_commit() {
+  if (cache_db.databases.size() > UINT16_MAX ||
+      cache_db.links.size() > UINT16_MAX) {
+    log::error("too many GATT databases to store");
+    return false;
+  }
+
+  tGATT_CACHE_DB_HEADER header = {
+      .magic = GATT_CACHE_DB_MAGIC,
+      .version = GATT_CACHE_VERSION,
+      .num_databases = (uint16_t)cache_db.databases.size(),
+      .num_links = (uint16_t)cache_db.links.size(),
+      .reserved = {},
+  };
+  size_t entries_offset = sizeof(header);
+  size_t links_offset = entries_offset + header.num_databases *
+                                             sizeof(tGATT_CACHE_DB_ENTRY);
+
+  vector<uint8_t> bytes(links_offset +
+                        header.num_links * sizeof(tGATT_CACHE_DB_LINK));
+  memcpy(bytes.data(), &header, sizeof(header));
+
+  std::map<Octet16, uint16_t> database_index;
+  for (const auto& [hash, database] : cache_db.databases) {
+    tGATT_CACHE_DB_ENTRY entry = {
+        .hash = hash,
+        .last_used = (int64_t)database.last_used,
+        .offset = (uint32_t)bytes.size(),
+        .num_attr = database.num_attr,
+        .reserved = 0,
+    };
+    uint16_t index = database_index.size();
+    memcpy(bytes.data() + entries_offset + index * sizeof(entry), &entry,
+           sizeof(entry));
+    database_index[hash] = index;
+
+    const uint8_t* attr = database.pending.empty()
+                              ? cache_db.map + database.offset
+                              : database.pending.data();
+    bytes.insert(bytes.end(), attr,
+                 attr + database.num_attr * StoredAttribute::kSizeOnDisk);
+  }
+
+  uint16_t index = 0;
+  for (const auto& [bda, hash] : cache_db.links) {
+    tGATT_CACHE_DB_LINK link = {.bda = bda, .database = database_index[hash]};
+    memcpy(bytes.data() + links_offset + index++ * sizeof(link), &link,
+           sizeof(link));
+  }
+
+  const string path = cache_db_path();
+  const string tmp_path = cache_db_tmp_path();
+  FILE* fd = fopen(tmp_path.c_str(), "wb");
+  if (!fd) {
+    log::error("can't open GATT cache file for writing: {}", tmp_path);
+    return false;
+  }
+
+  if (fwrite(bytes.data(), sizeof(uint8_t), bytes.size(), fd) !=
+          bytes.size() ||
+      fflush(fd) != 0 || fsync(fileno(fd)) != 0) {
+    log::error("can't write GATT cache: {}", tmp_path);
+    fclose(fd);
+    unlink(tmp_path.c_str());
+    return false;
+  }
+  fclose(fd);
+
+  if (rename(tmp_path.c_str(), path.c_str()) == -1) {
+    log::error("rename {} to {}, errno={}", tmp_path, path, errno);
+    unlink(tmp_path.c_str());
+    return false;
+  }
+
+  return bta_gattc_cache_db_map();
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_gattc_cache_db_add
+ *
+ * Description      Add a GATT database to the cache, to be written by the next
+ *                  commit.
+ *
+ * Parameter        hash: 16-byte value
+ *                  database: gatt::Database instance.
+ *                  last_used: time the database was last stored.
+ *
+ * Returns          true on success, false otherwise
+ *
+ ******************************************************************************/
+static bool bta_gattc_cache_db_add(const Octet16& hash,
+                                   const gatt::Database& database,
+                                   time_t last_used) {
+  std::vector<StoredAttribute> attr = database.Serialize();
+  if (attr.size() > UINT16_MAX) {
+    log::error("too many GATT attributes to store: {}", attr.size());
+    return false;
+  }
+
+  std::vector<uint8_t> db_bytes;
+  db_bytes.reserve(attr.size() * StoredAttribute::kSizeOnDisk);
+  for (const auto& attribute : attr) {
+    StoredAttribute::SerializeStoredAttribute(attribute, db_bytes);
+  }
+
+  cache_db.databases[hash] = {.last_used = last_used,
+                              .num_attr = (uint16_t)attr.size(),
+                              .offset = 0,
+                              .pending = std::move(db_bytes)};
+  return true;
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_gattc_cache_db_import_legacy_files
+ *
+ * Description      Import the per device and per hash files of the previous
+ *                  cache format into the cache file, and remove them.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void bta_gattc_cache_db_import_legacy_files() {
+  std::unique_ptr<DIR, decltype(&closedir)> dirp(opendir(cache_dir.c_str()),
+                                                 &closedir);
+  if (dirp == nullptr) {
+    log::error("open dir error, dir={}", cache_dir);
+    return;
+  }
+
+  size_t cache_prefix_len = strlen(GATT_CACHE_FILE_PREFIX);
+  size_t hash_prefix_len = strlen(GATT_HASH_FILE_PREFIX);
+  vector<string> legacy_files;
+
+  dirent* dp;
+  while ((dp = readdir(dirp.get())) != nullptr) {
+    bool is_cache_file =
+        strncmp(dp->d_name, GATT_CACHE_FILE_PREFIX, cache_prefix_len) == 0;
+    bool is_hash_file =
+        strncmp(dp->d_name, GATT_HASH_FILE_PREFIX, hash_prefix_len) == 0;
+    if (!is_cache_file && !is_hash_file) {
+      continue;
+    }
+
+    string fname = cache_dir + "/" + dp->d_name;
+    legacy_files.push_back(fname);
+
+    gatt::Database database = bta_gattc_load_db(fname.c_str());
+    if (database.IsEmpty()) {
+      continue;
+    }
+
+    struct stat buf;
+    Octet16 hash = database.Hash();
+    if (!bta_gattc_cache_db_add(
+            hash, database,
+            stat(fname.c_str(), &buf) == 0 ? buf.st_mtime : time(NULL))) {
+      continue;
+    }
+
+    // cache files are named after the address of the server
+    std::vector<uint8_t> address;
+    if (is_cache_file &&
+        base::HexStringToBytes(dp->d_name + cache_prefix_len, &address) &&
+        address.size() == RawAddress::kLength) {
+      RawAddress bda;
+      std::copy(address.begin(), address.end(), bda.address);
+      cache_db.links[bda] = hash;
+    }
+  }
+
+  if (legacy_files.empty()) {
+    return;
+  }
+
+  log::info("importing {} GATT cache files", legacy_files.size());
+  if (!bta_gattc_cache_db_commit()) {
+    return;
+  }
+
+  for (const string& fname : legacy_files) {
+    unlink(fname.c_str());
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_gattc_cache_db_open
+ *
+ * Description      Map the GATT cache file on first use. The files of the
+ *                  previous cache format are imported if the cache file does
+ *                  not exist yet.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void bta_gattc_cache_db_open() {
+  if (cache_db.opened) {
+    return;
+  }
+  cache_db.opened = true;
+
+  if (access(cache_db_path().c_str(), F_OK) == -1) {
+    bta_gattc_cache_db_import_legacy_files();
+    return;
+  }
+
+  // An invalid cache file is replaced by the next commit
+  bta_gattc_cache_db_map();
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_gattc_cache_db_load
+ *
+ * Description      Deserialize a GATT database from the cache.
+ *
+ * Parameter        hash: 16-byte value
+ *
+ * Returns          non-empty GATT database on success, empty GATT database
+ *                  otherwise
+ *
+ ******************************************************************************/
+static gatt::Database bta_gattc_cache_db_load(const Octet16& hash) {
+  auto it = cache_db.databases.find(hash);
+  if (it == cache_db.databases.end() || it->second.num_attr == 0) {
+    return EMPTY_DB;
+  }
+
+  const gatt_cache_database& database = it->second;
+  const uint8_t* bytes = database.pending.empty()
+                             ? cache_db.map + database.offset
+                             : database.pending.data();
+  std::vector<StoredAttribute> attr(database.num_attr);
+  memcpy(attr.data(), bytes,
+         database.num_attr * StoredAttribute::kSizeOnDisk);
+
+  bool success = false;
+  gatt::Database result = gatt::Database::Deserialize(attr, &success);
+  return success ? result : EMPTY_DB;
+}
+
 /*******************************************************************************
  *
  * Function         bta_gattc_cache_load
@@ -147,9 +553,16 @@ done:
  *
  ******************************************************************************/
 gatt::Database bta_gattc_cache_load(const RawAddress& server_bda) {
-  char fname[255] = {0};
-  bta_gattc_generate_cache_file_name(fname, sizeof(fname), server_bda);
-  return bta_gattc_load_db(fname);
+  bta_gattc_cache_db_open();
+
+  auto it = cache_db.links.find(server_bda);
+  if (it == cache_db.links.end()) {
+    log::verbose("no GATT cache for {}",
+                 server_bda.ToRedactedStringForLogging());
+    return EMPTY_DB;
+  }
+
+  return bta_gattc_cache_db_load(it->second);
 }
 
 /*******************************************************************************
@@ -165,9 +578,8 @@ gatt::Database bta_gattc_cache_load(const RawAddress& server_bda) {
  *
  ******************************************************************************/
 gatt::Database bta_gattc_hash_load(const Octet16& hash) {
-  char fname[255] = {0};
-  bta_gattc_generate_hash_file_name(fname, sizeof(fname), hash);
-  return bta_gattc_load_db(fname);
+  bta_gattc_cache_db_open();
+  return bta_gattc_cache_db_load(hash);
 }
 
 void StoredAttribute::SerializeStoredAttribute(const StoredAttribute& attr,
@@ -227,53 +639,47 @@ void StoredAttribute::SerializeStoredAttribute(const StoredAttribute& attr,
 
 /*******************************************************************************
  *
- * Function         bta_gattc_store_db
+ * Function         bta_gattc_hash_remove_least_recently_used_if_possible
  *
- * Description      Storess GATT db.
+ * Description      Remove the expired databases no trusted device links to,
+ *                  and the least recently used ones when the max size reaches
  *
- * Parameter        fname: output file name
- *                  attr: attributes to save.
+ * Parameter
  *
- * Returns          true on success, false otherwise
+ * Returns          void
  *
  ******************************************************************************/
-static bool bta_gattc_store_db(const char* fname,
-                               const std::vector<StoredAttribute>& attr) {
-  FILE* fd = fopen(fname, "wb");
-  if (!fd) {
-    log::error("can't open GATT cache file for writing: {}", fname);
-    return false;
-  }
-
-  uint16_t cache_ver = GATT_CACHE_VERSION;
-  if (fwrite(&cache_ver, sizeof(uint16_t), 1, fd) != 1) {
-    log::error("can't write GATT cache version: {}", fname);
-    fclose(fd);
-    return false;
-  }
-
-  uint16_t num_attr = attr.size();
-  if (fwrite(&num_attr, sizeof(uint16_t), 1, fd) != 1) {
-    log::error("can't write GATT cache attribute count: {}", fname);
-    fclose(fd);
-    return false;
+static void bta_gattc_hash_remove_least_recently_used_if_possible() {
+  std::set<Octet16> linked;
+  for (const auto& [bda, hash] : cache_db.links) {
+    linked.insert(hash);
   }
 
-  std::vector<uint8_t> db_bytes;
-  db_bytes.reserve(num_attr * StoredAttribute::kSizeOnDisk);
-  for (const auto attribute : attr) {
-    StoredAttribute::SerializeStoredAttribute(attribute, db_bytes);
+  time_t current_time = time(NULL);
+  vector<std::pair<time_t, Octet16>> candidates;
+  for (auto it = cache_db.databases.begin(); it != cache_db.databases.end();) {
+    if (linked.count(it->first)) {
+      it++;
+    } else if (it->second.last_used + GATT_HASH_EXPIRED_TIME < current_time) {
+      log::debug("delete hash (expired), hash={}",
+                 base::HexEncode(it->first.data(), it->first.size()));
+      it = cache_db.databases.erase(it);
+    } else {
+      candidates.emplace_back(it->second.last_used, it->first);
+      it++;
+    }
   }
 
-  if (fwrite(db_bytes.data(), sizeof(uint8_t), db_bytes.size(), fd) !=
-      db_bytes.size()) {
-    log::error("can't write GATT cache attributes: {}", fname);
-    fclose(fd);
-    return false;
+  // if the number of databases exceeds the limit, remove the candidate items.
+  std::sort(candidates.begin(), candidates.end());
+  for (const auto& [last_used, hash] : candidates) {
+    if (cache_db.databases.size() <= GATT_HASH_MAX_SIZE) {
+      break;
+    }
+    log::debug("delete hash (size), hash={}",
+               base::HexEncode(hash.data(), hash.size()));
+    cache_db.databases.erase(hash);
   }
-
-  fclose(fd);
-  return true;
 }
 
 /*******************************************************************************
@@ -292,16 +698,14 @@ static bool bta_gattc_store_db(const char* fname,
  ******************************************************************************/
 void bta_gattc_cache_write(const RawAddress& server_bda,
                            const gatt::Database& database) {
-  char addr_file[255] = {0};
-  char hash_file[255] = {0};
-  Octet16 hash = database.Hash();
-  bta_gattc_generate_cache_file_name(addr_file, sizeof(addr_file), server_bda);
-  bta_gattc_generate_hash_file_name(hash_file, sizeof(hash_file), hash);
+  bta_gattc_cache_db_open();
 
-  bool result = bta_gattc_hash_write(hash, database);
-  // Only link addr_file to hash file when hash_file is created successfully.
-  if (result) {
-    bta_gattc_cache_link(server_bda, hash);
+  Octet16 hash = database.Hash();
+  bta_gattc_hash_remove_least_recently_used_if_possible();
+  // Only link the address when the database can be stored.
+  if (bta_gattc_cache_db_add(hash, database, time(NULL))) {
+    cache_db.links[server_bda] = hash;
+    bta_gattc_cache_db_commit();
   }
 }
 
@@ -309,24 +713,31 @@ void bta_gattc_cache_write(const RawAddress& server_bda,
  *
  * Function         bta_gattc_cache_link
  *
- * Description      Link address-database file to hash-database file
+ * Description      Link address to hash-database
  *
  * Parameter        server_bda: server bd address of this cache belongs to
  *                  hash: 16-byte value
  *
- * Returns          true on success, false otherwise
+ * Returns          void
  *
  ******************************************************************************/
 void bta_gattc_cache_link(const RawAddress& server_bda, const Octet16& hash) {
-  char addr_file[255] = {0};
-  char hash_file[255] = {0};
-  bta_gattc_generate_cache_file_name(addr_file, sizeof(addr_file), server_bda);
-  bta_gattc_generate_hash_file_name(hash_file, sizeof(hash_file), hash);
+  bta_gattc_cache_db_open();
 
-  unlink(addr_file);  // remove addr file first if the file exists
-  if (link(hash_file, addr_file) == -1) {
-    log::error("link {} to {}, errno={}", addr_file, hash_file, errno);
+  if (cache_db.databases.find(hash) == cache_db.databases.end()) {
+    log::error("link {} to unknown hash {}",
+               server_bda.ToRedactedStringForLogging(),
+               base::HexEncode(hash.data(), hash.size()));
+    return;
+  }
+
+  auto it = cache_db.links.find(server_bda);
+  if (it != cache_db.links.end() && it->second == hash) {
+    return;
   }
+
+  cache_db.links[server_bda] = hash;
+  bta_gattc_cache_db_commit();
 }
 
 /*******************************************************************************
@@ -343,10 +754,13 @@ void bta_gattc_cache_link(const RawAddress& server_bda, const Octet16& hash) {
  *
  ******************************************************************************/
 bool bta_gattc_hash_write(const Octet16& hash, const gatt::Database& database) {
-  char fname[255] = {0};
-  bta_gattc_generate_hash_file_name(fname, sizeof(fname), hash);
+  bta_gattc_cache_db_open();
+
   bta_gattc_hash_remove_least_recently_used_if_possible();
-  return bta_gattc_store_db(fname, database.Serialize());
+  if (!bta_gattc_cache_db_add(hash, database, time(NULL))) {
+    return false;
+  }
+  return bta_gattc_cache_db_commit();
 }
 
 /*******************************************************************************
@@ -363,95 +777,24 @@ bool bta_gattc_hash_write(const Octet16& hash, const gatt::Database& database) {
  ******************************************************************************/
 void bta_gattc_cache_reset(const RawAddress& server_bda) {
   log::verbose("");
-  char fname[255] = {0};
-  bta_gattc_generate_cache_file_name(fname, sizeof(fname), server_bda);
-  unlink(fname);
-}
-
-/*******************************************************************************
- *
- * Function         bta_gattc_hash_remove_least_recently_used_if_possible
- *
- * Description      When the max size reaches, find the oldest item and remove
- *                  it if possible
- *
- * Parameter
- *
- * Returns          void
- *
- ******************************************************************************/
-static void bta_gattc_hash_remove_least_recently_used_if_possible() {
-  std::unique_ptr<DIR, decltype(&closedir)> dirp(opendir(GATT_HASH_PATH),
-                                                 &closedir);
-  if (dirp == nullptr) {
-    log::error("open dir error, dir={}", GATT_HASH_PATH);
-    return;
-  }
-
-  time_t current_time = time(NULL);
-  time_t lru_time = current_time;
-  size_t count = 0;
-  string candidate_item;
-  vector<string> expired_items;
-
-  log::debug("<-----------Start Local Hash Cache---------->");
-  dirent* dp;
-  while ((dp = readdir(dirp.get())) != nullptr) {
-    if (strncmp(".", dp->d_name, 1) == 0 || strncmp("..", dp->d_name, 2) == 0) {
-      continue;
-    }
-
-    // pattern match: gatt_hash_
-    size_t fname_len = strlen(dp->d_name);
-    size_t pattern_len = strlen(GATT_HASH_FILE_PREFIX);
-    if (pattern_len > fname_len) {
-      continue;
-    }
-
-    // check if the file name has gatt_hash_ as prefix
-    char tmp[255] = {0};
-    strncpy(tmp, dp->d_name, pattern_len);
-    if (strncmp(tmp, GATT_HASH_FILE_PREFIX, pattern_len) != 0) {
-      continue;
-    }
+  bta_gattc_cache_db_open();
 
-    // increase hash file count
-    count++;
-
-    // generate the full path, in order to get the state of the file
-    snprintf(tmp, 255, "%s/%s", GATT_HASH_PATH, dp->d_name);
-
-    struct stat buf;
-    int result = lstat(tmp, &buf);
-    log::debug("name={}, result={}, linknum={}, mtime={}", dp->d_name, result,
-               (unsigned long)buf.st_nlink, (unsigned long)buf.st_mtime);
-
-    // if hard link count of the file is 1, it means no trusted device links to
-    // the inode. It is safe to be a candidate to be removed
-    if (buf.st_nlink == 1) {
-      if (buf.st_mtime < lru_time) {
-        lru_time = buf.st_mtime;
-        // Find the LRU candidate during for-loop itreation.
-        candidate_item.assign(tmp);
-      }
-
-      if (buf.st_mtime + GATT_HASH_EXPIRED_TIME < current_time) {
-        // Add expired item.
-        expired_items.emplace_back(tmp);
-      }
-    }
-  }
-  log::debug("<-----------End Local Hash Cache------------>");
-
-  // if the number of hash files exceeds the limit, remove the cadidate item.
-  if (count > GATT_HASH_MAX_SIZE && !candidate_item.empty()) {
-    unlink(candidate_item.c_str());
-    log::debug("delete hash file (size), name={}", candidate_item);
+  // the database itself is removed once it is not linked and expired
+  if (cache_db.links.erase(server_bda) != 0) {
+    bta_gattc_cache_db_commit();
   }
+}
 
-  // If there is any file expired, also delete it.
-  for (string expired_item : expired_items) {
-    unlink(expired_item.c_str());
-    log::debug("delete hash file (expired), name={}", expired_item);
+namespace bluetooth {
+namespace legacy {
+namespace testing {
+void bta_gattc_cache_db_set_dir(const std::string& dir) {
+  if (cache_db.map != nullptr) {
+    munmap((void*)cache_db.map, cache_db.map_size);
   }
+  cache_db = {};
+  cache_dir = dir;
 }
+}  // namespace testing
+}  // namespace legacy
+}  // namespace bluetooth
@@ -28,6 +28,7 @@
 
 #include <cstdint>
 #include <deque>
+#include <list>
 
 #include "bta/gatt/database.h"
 #include "bta/gatt/database_builder.h"
@@ -284,6 +285,9 @@ typedef struct {
   tBTA_GATTC_SERV* p_srcb;  /* server cache CB */
   const tBTA_GATTC_DATA* p_q_cmd; /* command in queue waiting for execution */
   std::deque<const tBTA_GATTC_DATA*> p_q_cmd_queue;
+  /* independent commands executing concurrently with p_q_cmd on additional
+   * EATT bearers, only non-empty while p_q_cmd is set */
+  std::list<const tBTA_GATTC_DATA*> p_q_cmd_eatt;
 
 // request during discover state
 #define BTA_GATTC_DISCOVER_REQ_NONE 0
@@ -448,6 +452,11 @@ BtaEnqueuedResult_t bta_gattc_enqueue(tBTA_GATTC_CLCB* p_clcb,
 bool bta_gattc_is_data_queued(tBTA_GATTC_CLCB* p_clcb,
                               const tBTA_GATTC_DATA* p_data);
 void bta_gattc_continue(tBTA_GATTC_CLCB* p_clcb);
+bool bta_gattc_requeue_eatt_cmd(tBTA_GATTC_CLCB* p_clcb,
+                                const tBTA_GATTC_DATA* p_data);
+void bta_gattc_select_eatt_cmd(tBTA_GATTC_CLCB* p_clcb, tGATTC_OPTYPE op,
+                               const tGATT_CL_COMPLETE* p_cmpl);
+void bta_gattc_promote_eatt_cmd(tBTA_GATTC_CLCB* p_clcb);
 void bta_gattc_send_mtu_response(tBTA_GATTC_CLCB* p_clcb,
                                  const tBTA_GATTC_DATA* p_data,
                                  uint16_t current_mtu);
@@ -19,6 +19,7 @@
 #include <base/logging.h>
 #include <bluetooth/log.h>
 
+#include <algorithm>
 #include <list>
 #include <unordered_map>
 #include <unordered_set>
@@ -27,6 +28,8 @@
 #include "bta_gatt_queue.h"
 #include "os/log.h"
 #include "osi/include/allocator.h"
+#include "stack/include/gatt_api.h"
+#include "stack/include/l2c_api.h"
 
 using gatt_operation = BtaGattQueue::gatt_operation;
 using namespace bluetooth;
@@ -38,17 +41,54 @@ constexpr uint8_t GATT_WRITE_DESC = 4;
 constexpr uint8_t GATT_CONFIG_MTU = 5;
 constexpr uint8_t GATT_READ_MULTI = 6;
 
+/* Maximum number of operations executing concurrently on one connection: one
+ * per EATT bearer */
+constexpr size_t GATT_MAX_EXECUTING_OPS = L2CAP_CREDIT_BASED_MAX_CIDS;
+
+/* Value length budgeted in a Read Multiple Variable Length response for the
+ * attributes not read yet on the connection. Longer values are truncated by
+ * the server, and read again individually. */
+constexpr size_t GATT_COALESCED_READ_DEFAULT_LEN = 8;
+
+/* MTU configuration and read multiple operations are executed alone */
+static bool is_exclusive_op(const gatt_operation& op) {
+  return op.type == GATT_CONFIG_MTU || op.type == GATT_READ_MULTI;
+}
+
+static bool is_read_op(const gatt_operation& op) {
+  return op.type == GATT_READ_CHAR || op.type == GATT_READ_DESC;
+}
+
 struct gatt_read_op_data {
   GATT_READ_OP_CB cb;
   void* cb_data;
+  uint16_t handle;
 };
 
 std::unordered_map<uint16_t, std::list<gatt_operation>>
     BtaGattQueue::gatt_op_queue;
-std::unordered_set<uint16_t> BtaGattQueue::gatt_op_queue_executing;
+std::unordered_map<uint16_t, BtaGattQueue::gatt_executing_ops>
+    BtaGattQueue::gatt_op_queue_executing;
+std::unordered_set<uint16_t> BtaGattQueue::gatt_coalesced_reads_failed;
+std::unordered_map<uint16_t, std::unordered_map<uint16_t, uint16_t>>
+    BtaGattQueue::gatt_value_lens;
+
+void BtaGattQueue::mark_as_not_executing(uint16_t conn_id,
+                                         const std::vector<uint16_t>& handles) {
+  auto it = gatt_op_queue_executing.find(conn_id);
+  if (it == gatt_op_queue_executing.end()) return;
+
+  gatt_executing_ops& executing = it->second;
+  if (executing.exclusive) {
+    executing.exclusive = false;
+  } else {
+    for (uint16_t handle : handles) executing.handles.erase(handle);
+    if (executing.num_ops > 0) executing.num_ops--;
+  }
 
-void BtaGattQueue::mark_as_not_executing(uint16_t conn_id) {
-  gatt_op_queue_executing.erase(conn_id);
+  if (!executing.exclusive && executing.num_ops == 0) {
+    gatt_op_queue_executing.erase(it);
+  }
 }
 
 void BtaGattQueue::gatt_read_op_finished(uint16_t conn_id, tGATT_STATUS status,
@@ -57,10 +97,13 @@ void BtaGattQueue::gatt_read_op_finished(uint16_t conn_id, tGATT_STATUS status,
   gatt_read_op_data* tmp = (gatt_read_op_data*)data;
   GATT_READ_OP_CB tmp_cb = tmp->cb;
   void* tmp_cb_data = tmp->cb_data;
+  uint16_t tmp_handle = tmp->handle;
 
   osi_free(data);
 
-  mark_as_not_executing(conn_id);
+  if (status == GATT_SUCCESS) gatt_value_lens[conn_id][tmp_handle] = len;
+
+  mark_as_not_executing(conn_id, {tmp_handle});
   gatt_execute_next_op(conn_id);
 
   if (tmp_cb) {
@@ -72,6 +115,7 @@ void BtaGattQueue::gatt_read_op_finished(uint16_t conn_id, tGATT_STATUS status,
 struct gatt_write_op_data {
   GATT_WRITE_OP_CB cb;
   void* cb_data;
+  uint16_t handle;
 };
 
 void BtaGattQueue::gatt_write_op_finished(uint16_t conn_id, tGATT_STATUS status,
@@ -80,10 +124,11 @@ void BtaGattQueue::gatt_write_op_finished(uint16_t conn_id, tGATT_STATUS status,
   gatt_write_op_data* tmp = (gatt_write_op_data*)data;
   GATT_WRITE_OP_CB tmp_cb = tmp->cb;
   void* tmp_cb_data = tmp->cb_data;
+  uint16_t tmp_handle = tmp->handle;
 
   osi_free(data);
 
-  mark_as_not_executing(conn_id);
+  mark_as_not_executing(conn_id, {tmp_handle});
   gatt_execute_next_op(conn_id);
 
   if (tmp_cb) {
@@ -106,7 +151,7 @@ void BtaGattQueue::gatt_configure_mtu_op_finished(uint16_t conn_id,
 
   osi_free(data);
 
-  mark_as_not_executing(conn_id);
+  mark_as_not_executing(conn_id, {});
   gatt_execute_next_op(conn_id);
 
   if (tmp_cb) {
@@ -131,7 +176,7 @@ void BtaGattQueue::gatt_read_multi_op_finished(uint16_t conn_id,
 
   osi_free(data);
 
-  mark_as_not_executing(conn_id);
+  mark_as_not_executing(conn_id, {});
   gatt_execute_next_op(conn_id);
 
   if (tmp_cb) {
@@ -153,22 +198,108 @@ void BtaGattQueue::gatt_execute_next_op(uint16_t conn_id) {
     return;
   }
 
-  if (gatt_op_queue_executing.count(conn_id)) {
-    log::verbose("can't enqueue next op, already executing");
-    return;
-  }
-
-  gatt_op_queue_executing.insert(conn_id);
-
   std::list<gatt_operation>& gatt_ops = map_ptr->second;
 
-  gatt_operation& op = gatt_ops.front();
+  /* Operations on distinct attributes are executed concurrently while EATT
+   * bearers are available. An operation waits for the completion of the
+   * earlier operations on the same attribute, and exclusive operations wait
+   * for the completion of all the earlier operations.
+   *
+   * The operations are posted to BTA, and only take a bearer once BTA executes
+   * them: the bearers are counted before dispatching, and each dispatched
+   * operation holds one until it completes, whether it started or not. */
+  size_t max_executing_ops = 1;
+  if (GATTC_IsEattBearerAvailable(conn_id)) {
+    max_executing_ops =
+        std::clamp<size_t>(GATTC_GetNumEattBearers(conn_id), 1,
+                           GATT_MAX_EXECUTING_OPS);
+  }
+
+  std::unordered_set<uint16_t> blocked_handles;
+  for (auto it = gatt_ops.begin(); it != gatt_ops.end();) {
+    auto executing = gatt_op_queue_executing.find(conn_id);
+    bool is_executing = executing != gatt_op_queue_executing.end();
+
+    if (is_executing && executing->second.exclusive) {
+      log::verbose("can't enqueue next op, exclusive op executing");
+      return;
+    }
+
+    if (is_exclusive_op(*it)) {
+      if (is_executing || it != gatt_ops.begin()) {
+        log::verbose("can't enqueue exclusive op, already executing");
+        return;
+      }
+      gatt_op_queue_executing[conn_id].exclusive = true;
+      gatt_execute_op(conn_id, *it);
+      gatt_ops.erase(it);
+      return;
+    }
+
+    if (blocked_handles.count(it->handle) ||
+        (is_executing && executing->second.handles.count(it->handle))) {
+      blocked_handles.insert(it->handle);
+      it++;
+      continue;
+    }
+
+    if (is_executing && executing->second.num_ops >= max_executing_ops) {
+      log::verbose("can't enqueue next op, already executing");
+      return;
+    }
+
+    /* Merge the following reads of attributes not being accessed, up to the
+     * first exclusive operation, while their values fit in the response */
+    size_t budget = is_read_op(*it) && !it->not_coalesced
+                        ? coalesced_reads_budget(conn_id)
+                        : 0;
+    size_t response_len = coalesced_read_len(conn_id, it->handle);
+    if (response_len < budget) {
+      std::vector<std::list<gatt_operation>::iterator> reads = {it};
+      std::unordered_set<uint16_t> skipped_handles = blocked_handles;
+      skipped_handles.insert(it->handle);
+      for (auto next = std::next(it);
+           next != gatt_ops.end() &&
+           reads.size() < GATT_MAX_READ_MULTI_HANDLES;
+           next++) {
+        if (is_exclusive_op(*next)) break;
+
+        bool available =
+            !skipped_handles.count(next->handle) &&
+            !(is_executing && executing->second.handles.count(next->handle));
+        skipped_handles.insert(next->handle);
+        if (!available || !is_read_op(*next) || next->not_coalesced) continue;
+
+        size_t read_len = coalesced_read_len(conn_id, next->handle);
+        if (response_len + read_len > budget) continue;
+
+        response_len += read_len;
+        reads.push_back(next);
+      }
+
+      if (reads.size() > 1) {
+        gatt_execute_coalesced_reads(conn_id, reads);
+        for (size_t i = 1; i < reads.size(); i++) gatt_ops.erase(reads[i]);
+        it = gatt_ops.erase(it);
+        continue;
+      }
+    }
+
+    gatt_executing_ops& executing_ops = gatt_op_queue_executing[conn_id];
+    executing_ops.handles.insert(it->handle);
+    executing_ops.num_ops++;
+    gatt_execute_op(conn_id, *it);
+    it = gatt_ops.erase(it);
+  }
+}
 
+void BtaGattQueue::gatt_execute_op(uint16_t conn_id, gatt_operation& op) {
   if (op.type == GATT_READ_CHAR) {
     gatt_read_op_data* data =
         (gatt_read_op_data*)osi_malloc(sizeof(gatt_read_op_data));
     data->cb = op.read_cb;
     data->cb_data = op.read_cb_data;
+    data->handle = op.handle;
     BTA_GATTC_ReadCharacteristic(conn_id, op.handle, GATT_AUTH_REQ_NONE,
                                  gatt_read_op_finished, data);
 
@@ -177,6 +308,7 @@ void BtaGattQueue::gatt_execute_next_op(uint16_t conn_id) {
         (gatt_read_op_data*)osi_malloc(sizeof(gatt_read_op_data));
     data->cb = op.read_cb;
     data->cb_data = op.read_cb_data;
+    data->handle = op.handle;
     BTA_GATTC_ReadCharDescr(conn_id, op.handle, GATT_AUTH_REQ_NONE,
                             gatt_read_op_finished, data);
 
@@ -185,6 +317,7 @@ void BtaGattQueue::gatt_execute_next_op(uint16_t conn_id) {
         (gatt_write_op_data*)osi_malloc(sizeof(gatt_write_op_data));
     data->cb = op.write_cb;
     data->cb_data = op.write_cb_data;
+    data->handle = op.handle;
     BTA_GATTC_WriteCharValue(conn_id, op.handle, op.write_type,
                              std::move(op.value), GATT_AUTH_REQ_NONE,
                              gatt_write_op_finished, data);
@@ -194,6 +327,7 @@ void BtaGattQueue::gatt_execute_next_op(uint16_t conn_id) {
         (gatt_write_op_data*)osi_malloc(sizeof(gatt_write_op_data));
     data->cb = op.write_cb;
     data->cb_data = op.write_cb_data;
+    data->handle = op.handle;
     BTA_GATTC_WriteCharDescr(conn_id, op.handle, std::move(op.value),
                              GATT_AUTH_REQ_NONE, gatt_write_op_finished, data);
   } else if (op.type == GATT_CONFIG_MTU) {
@@ -213,13 +347,138 @@ void BtaGattQueue::gatt_execute_next_op(uint16_t conn_id) {
                            GATT_AUTH_REQ_NONE, gatt_read_multi_op_finished,
                            data);
   }
+}
+
+size_t BtaGattQueue::coalesced_reads_budget(uint16_t conn_id) {
+  if (gatt_coalesced_reads_failed.count(conn_id)) return 0;
+
+  size_t mtu = GATTC_GetReadMultiVariableMtu(conn_id);
+  if (mtu == 0) return 0;
+
+  /* The Read Multiple Variable Length response opcode */
+  return mtu - 1;
+}
 
-  gatt_ops.pop_front();
+size_t BtaGattQueue::coalesced_read_len(uint16_t conn_id, uint16_t handle) {
+  /* The length field and the value of the Length Value Tuple */
+  auto lens = gatt_value_lens.find(conn_id);
+  if (lens != gatt_value_lens.end()) {
+    auto len = lens->second.find(handle);
+    if (len != lens->second.end()) return 2 + len->second;
+  }
+  return 2 + GATT_COALESCED_READ_DEFAULT_LEN;
+}
+
+struct gatt_coalesced_read_op_data {
+  uint8_t num_reads;
+  struct {
+    uint8_t type;
+    uint16_t handle;
+    GATT_READ_OP_CB cb;
+    void* cb_data;
+  } reads[GATT_MAX_READ_MULTI_HANDLES];
+};
+
+void BtaGattQueue::gatt_execute_coalesced_reads(
+    uint16_t conn_id,
+    const std::vector<std::list<gatt_operation>::iterator>& reads) {
+  log::verbose("conn_id=0x{:x}, merging {} reads", conn_id, reads.size());
+
+  gatt_coalesced_read_op_data* data = (gatt_coalesced_read_op_data*)osi_malloc(
+      sizeof(gatt_coalesced_read_op_data));
+  tBTA_GATTC_MULTI handles;
+  gatt_executing_ops& executing_ops = gatt_op_queue_executing[conn_id];
+
+  data->num_reads = handles.num_attr = reads.size();
+  for (size_t i = 0; i < reads.size(); i++) {
+    data->reads[i].type = reads[i]->type;
+    data->reads[i].handle = reads[i]->handle;
+    data->reads[i].cb = reads[i]->read_cb;
+    data->reads[i].cb_data = reads[i]->read_cb_data;
+    handles.handles[i] = reads[i]->handle;
+    executing_ops.handles.insert(reads[i]->handle);
+  }
+  executing_ops.num_ops++;
+
+  BTA_GATTC_ReadMultiple(conn_id, handles, true, GATT_AUTH_REQ_NONE,
+                         gatt_coalesced_read_op_finished, data);
+}
+
+void BtaGattQueue::gatt_coalesced_read_op_finished(
+    uint16_t conn_id, tGATT_STATUS status, tBTA_GATTC_MULTI& /* handles */,
+    uint16_t len, uint8_t* value, void* data) {
+  gatt_coalesced_read_op_data tmp = *(gatt_coalesced_read_op_data*)data;
+  osi_free(data);
+
+  /* Not retried on this connection whatever the error: the server does not
+   * support the request, or one of the attributes can't be read this way */
+  if (status != GATT_SUCCESS) {
+    log::info("conn_id=0x{:x}, read multiple variable length failed: {}",
+              conn_id, gatt_status_text(status));
+    gatt_coalesced_reads_failed.insert(conn_id);
+  }
+
+  /* Split the Length Value Tuple List. The last values might be truncated to
+   * the ATT MTU. */
+  uint8_t num_values = 0;
+  uint16_t value_lens[GATT_MAX_READ_MULTI_HANDLES];
+  uint8_t* values[GATT_MAX_READ_MULTI_HANDLES];
+  if (status == GATT_SUCCESS) {
+    uint8_t* p = value;
+    uint16_t remaining = len;
+    while (num_values < tmp.num_reads && remaining >= 2) {
+      uint16_t value_len = p[0] | (p[1] << 8);
+      p += 2;
+      remaining -= 2;
+      gatt_value_lens[conn_id][tmp.reads[num_values].handle] = value_len;
+      if (value_len > remaining) break;
+
+      value_lens[num_values] = value_len;
+      values[num_values] = p;
+      num_values++;
+      p += value_len;
+      remaining -= value_len;
+    }
+  }
+
+  /* Reads without a complete value are executed again individually, before
+   * the operations queued after them */
+  auto map_ptr = gatt_op_queue.find(conn_id);
+  bool cleaned = map_ptr == gatt_op_queue.end();
+  for (int i = tmp.num_reads - 1; i >= num_values && !cleaned; i--) {
+    map_ptr->second.push_front({.type = tmp.reads[i].type,
+                                .handle = tmp.reads[i].handle,
+                                .read_cb = tmp.reads[i].cb,
+                                .read_cb_data = tmp.reads[i].cb_data,
+                                .not_coalesced = true});
+  }
+
+  std::vector<uint16_t> read_handles;
+  for (uint8_t i = 0; i < tmp.num_reads; i++) {
+    read_handles.push_back(tmp.reads[i].handle);
+  }
+  mark_as_not_executing(conn_id, read_handles);
+  gatt_execute_next_op(conn_id);
+
+  for (uint8_t i = 0; i < tmp.num_reads; i++) {
+    if (i < num_values) {
+      if (tmp.reads[i].cb) {
+        tmp.reads[i].cb(conn_id, GATT_SUCCESS, tmp.reads[i].handle,
+                        value_lens[i], values[i], tmp.reads[i].cb_data);
+      }
+    } else if (cleaned && tmp.reads[i].cb) {
+      /* The queue was cleaned while the reads were executing */
+      tmp.reads[i].cb(conn_id, status == GATT_SUCCESS ? GATT_ERROR : status,
+                      tmp.reads[i].handle, 0, NULL, tmp.reads[i].cb_data);
+    }
+  }
 }
 
 void BtaGattQueue::Clean(uint16_t conn_id) {
   gatt_op_queue.erase(conn_id);
   gatt_op_queue_executing.erase(conn_id);
+  gatt_coalesced_reads_failed.erase(conn_id);
+  gatt_value_lens.erase(conn_id);
 }
 
 void BtaGattQueue::ReadCharacteristic(uint16_t conn_id, uint16_t handle,
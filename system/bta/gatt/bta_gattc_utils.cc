@@ -27,6 +27,7 @@
 #include <base/logging.h>
 #include <bluetooth/log.h>
 
+#include <algorithm>
 #include <cstdint>
 
 #include "bta/gatt/bta_gattc_int.h"
@@ -248,6 +249,12 @@ void bta_gattc_clcb_dealloc(tBTA_GATTC_CLCB* p_clcb) {
     osi_free_and_reset((void**)&p_q_cmd);
   }
 
+  while (!p_clcb->p_q_cmd_eatt.empty()) {
+    auto p_q_cmd = p_clcb->p_q_cmd_eatt.front();
+    p_clcb->p_q_cmd_eatt.pop_front();
+    osi_free_and_reset((void**)&p_q_cmd);
+  }
+
   if (p_clcb->p_q_cmd != NULL) {
     osi_free_and_reset((void**)&p_clcb->p_q_cmd);
   }
@@ -383,10 +390,71 @@ void bta_gattc_send_mtu_response(tBTA_GATTC_CLCB* p_clcb,
   }
 }
 
+/* Returns the attribute handle of a read by handle or a write request, zero
+ * for the commands that can not be executed concurrently with others */
+static uint16_t bta_gattc_independent_cmd_handle(
+    const tBTA_GATTC_DATA* p_data) {
+  if (p_data->hdr.event == BTA_GATTC_API_READ_EVT &&
+      !p_data->api_read.is_multi_read) {
+    return p_data->api_read.handle;
+  }
+
+  if (p_data->hdr.event == BTA_GATTC_API_WRITE_EVT &&
+      p_data->api_write.write_type != BTA_GATTC_WRITE_PREPARE) {
+    return p_data->api_write.handle;
+  }
+
+  return 0;
+}
+
+/* Check if the command can be sent on an idle EATT bearer while p_q_cmd is
+ * executing. Commands targeting an attribute already being accessed wait, to
+ * preserve the order of the operations on each attribute. */
+static bool bta_gattc_can_send_on_eatt(tBTA_GATTC_CLCB* p_clcb,
+                                       const tBTA_GATTC_DATA* p_data) {
+  if (p_clcb->p_q_cmd == NULL || p_clcb->state != BTA_GATTC_CONN_ST ||
+      p_clcb->auto_update != BTA_GATTC_NO_SCHEDULE) {
+    return false;
+  }
+
+  uint16_t handle = bta_gattc_independent_cmd_handle(p_data);
+  uint16_t current_handle = bta_gattc_independent_cmd_handle(p_clcb->p_q_cmd);
+  if (handle == 0 || current_handle == 0 || current_handle == handle) {
+    return false;
+  }
+
+  for (auto p_cmd : p_clcb->p_q_cmd_eatt) {
+    if (bta_gattc_independent_cmd_handle(p_cmd) == handle) return false;
+  }
+
+  return GATTC_IsEattBearerAvailable(p_clcb->bta_conn_id);
+}
+
+/* Send the commands at the head of the queue on idle EATT bearers */
+static void bta_gattc_continue_on_eatt(tBTA_GATTC_CLCB* p_clcb) {
+  while (!p_clcb->p_q_cmd_queue.empty()) {
+    const tBTA_GATTC_DATA* p_q_cmd = p_clcb->p_q_cmd_queue.front();
+    if (!bta_gattc_can_send_on_eatt(p_clcb, p_q_cmd)) return;
+
+    log::verbose("Sending queued command on EATT bearer conn_id = 0x{:04x}",
+                 p_clcb->bta_conn_id);
+    p_clcb->p_q_cmd_queue.pop_front();
+    p_clcb->p_q_cmd_eatt.push_back(p_q_cmd);
+    bta_gattc_sm_execute(p_clcb, p_q_cmd->hdr.event, p_q_cmd);
+
+    /* The command could not be sent, and was queued back */
+    if (!p_clcb->p_q_cmd_queue.empty() &&
+        p_clcb->p_q_cmd_queue.front() == p_q_cmd) {
+      return;
+    }
+  }
+}
+
 void bta_gattc_continue(tBTA_GATTC_CLCB* p_clcb) {
   if (p_clcb->p_q_cmd != NULL) {
     log::info("Already scheduled another request for conn_id = 0x{:04x}",
               p_clcb->bta_conn_id);
+    bta_gattc_continue_on_eatt(p_clcb);
     return;
   }
 
@@ -395,6 +463,7 @@ void bta_gattc_continue(tBTA_GATTC_CLCB* p_clcb) {
     if (p_q_cmd->hdr.event != BTA_GATTC_API_CFG_MTU_EVT) {
       p_clcb->p_q_cmd_queue.pop_front();
       bta_gattc_sm_execute(p_clcb, p_q_cmd->hdr.event, p_q_cmd);
+      bta_gattc_continue_on_eatt(p_clcb);
       return;
     }
 
@@ -441,10 +510,95 @@ bool bta_gattc_is_data_queued(tBTA_GATTC_CLCB* p_clcb,
     return true;
   }
 
+  if (std::find(p_clcb->p_q_cmd_eatt.begin(), p_clcb->p_q_cmd_eatt.end(),
+                p_data) != p_clcb->p_q_cmd_eatt.end()) {
+    return true;
+  }
+
   auto it = std::find(p_clcb->p_q_cmd_queue.begin(),
                       p_clcb->p_q_cmd_queue.end(), p_data);
   return it != p_clcb->p_q_cmd_queue.end();
 }
+
+/*******************************************************************************
+ *
+ * Function         bta_gattc_requeue_eatt_cmd
+ *
+ * Description      Put a command that failed to be sent on an EATT bearer
+ *                  back at the head of the queue, to be executed once the
+ *                  pending commands are completed.
+ *
+ * Returns          true if the command was executing on an EATT bearer.
+ *
+ ******************************************************************************/
+bool bta_gattc_requeue_eatt_cmd(tBTA_GATTC_CLCB* p_clcb,
+                                const tBTA_GATTC_DATA* p_data) {
+  auto it = std::find(p_clcb->p_q_cmd_eatt.begin(), p_clcb->p_q_cmd_eatt.end(),
+                      p_data);
+  if (it == p_clcb->p_q_cmd_eatt.end()) return false;
+
+  log::warn("Failed to send on EATT bearer, queuing for later conn_id=0x{:04x}",
+            p_clcb->bta_conn_id);
+  p_clcb->p_q_cmd_eatt.erase(it);
+  p_clcb->p_q_cmd_queue.push_front(p_data);
+  return true;
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_gattc_select_eatt_cmd
+ *
+ * Description      Make the command completed by an operation the current
+ *                  command, if it was executing on an additional EATT bearer.
+ *                  Commands are matched by operation and attribute handle.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void bta_gattc_select_eatt_cmd(tBTA_GATTC_CLCB* p_clcb, tGATTC_OPTYPE op,
+                               const tGATT_CL_COMPLETE* p_cmpl) {
+  if (p_clcb->p_q_cmd_eatt.empty() || p_cmpl == NULL) return;
+
+  uint16_t event;
+  if (op == GATTC_OPTYPE_READ) {
+    event = BTA_GATTC_API_READ_EVT;
+  } else if (op == GATTC_OPTYPE_WRITE) {
+    event = BTA_GATTC_API_WRITE_EVT;
+  } else {
+    return;
+  }
+
+  uint16_t handle = p_cmpl->att_value.handle;
+  auto matches = [event, handle](const tBTA_GATTC_DATA* p_cmd) {
+    return p_cmd->hdr.event == event &&
+           bta_gattc_independent_cmd_handle(p_cmd) == handle;
+  };
+
+  if (matches(p_clcb->p_q_cmd)) return;
+
+  auto it = std::find_if(p_clcb->p_q_cmd_eatt.begin(),
+                         p_clcb->p_q_cmd_eatt.end(), matches);
+  if (it == p_clcb->p_q_cmd_eatt.end()) return;
+
+  std::swap(*it, p_clcb->p_q_cmd);
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_gattc_promote_eatt_cmd
+ *
+ * Description      Once the current command is completed, make one of the
+ *                  commands still executing on EATT bearers the current one.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void bta_gattc_promote_eatt_cmd(tBTA_GATTC_CLCB* p_clcb) {
+  if (p_clcb->p_q_cmd != NULL || p_clcb->p_q_cmd_eatt.empty()) return;
+
+  p_clcb->p_q_cmd = p_clcb->p_q_cmd_eatt.front();
+  p_clcb->p_q_cmd_eatt.pop_front();
+}
 /*******************************************************************************
  *
  * Function         bta_gattc_enqueue
@@ -461,6 +615,21 @@ BtaEnqueuedResult_t bta_gattc_enqueue(tBTA_GATTC_CLCB* p_clcb,
     return ENQUEUED_READY_TO_SEND;
   }
 
+  /* Dequeued by bta_gattc_continue_on_eatt */
+  if (std::find(p_clcb->p_q_cmd_eatt.begin(), p_clcb->p_q_cmd_eatt.end(),
+                p_data) != p_clcb->p_q_cmd_eatt.end()) {
+    return ENQUEUED_READY_TO_SEND;
+  }
+
+  /* Independent commands are sent right away when an EATT bearer is idle */
+  if (p_clcb->p_q_cmd_queue.empty() &&
+      bta_gattc_can_send_on_eatt(p_clcb, p_data)) {
+    log::verbose("Sending command on EATT bearer conn_id=0x{:04x}",
+                 p_clcb->bta_conn_id);
+    p_clcb->p_q_cmd_eatt.push_back(p_data);
+    return ENQUEUED_READY_TO_SEND;
+  }
+
   log::info(
       "Already has a pending command to executer. Queuing for later {} conn "
       "id=0x{:04x}",
@@ -1452,9 +1452,11 @@ class HearingAidImpl : public HearingAid {
       return;
     }
 
-    std::vector<uint16_t> chan_left;
-    std::vector<uint16_t> chan_right;
+    // PCM for the encoders of the devices ready to receive audio, interleaved
+    // when both sides are streaming.
+    std::vector<int16_t> pcm;
     if (left == nullptr || right == nullptr) {
+      pcm.reserve(num_samples);
       for (int i = 0; i < num_samples; i++) {
         const uint8_t* sample = data.data() + i * 4;
 
@@ -1464,19 +1466,13 @@ class HearingAidImpl : public HearingAid {
         int16_t right = (int16_t)((*(sample + 1) << 8) + *sample) >> 1;
 
         uint16_t mono_data = (int16_t)(((uint32_t)left + (uint32_t)right) >> 1);
-        chan_left.push_back(mono_data);
-        chan_right.push_back(mono_data);
+        pcm.push_back(mono_data);
       }
     } else {
-      for (int i = 0; i < num_samples; i++) {
-        const uint8_t* sample = data.data() + i * 4;
-
-        uint16_t left = (int16_t)((*(sample + 1) << 8) + *sample) >> 1;
-        chan_left.push_back(left);
-
-        sample += 2;
-        uint16_t right = (int16_t)((*(sample + 1) << 8) + *sample) >> 1;
-        chan_right.push_back(right);
+      pcm.reserve(2 * num_samples);
+      for (int i = 0; i < 2 * num_samples; i++) {
+        const uint8_t* sample = data.data() + i * 2;
+        pcm.push_back((int16_t)((*(sample + 1) << 8) + *sample) >> 1);
       }
     }
 
@@ -1504,17 +1500,32 @@ class HearingAidImpl : public HearingAid {
     // TODO: make those buffers static and global to prevent constant
     // reallocations
     // TODO: this should basically fit the encoded data, tune the size later
+    // Both sides are encoded in a single pass over the PCM, each with its own
+    // encoder state.
+    // TODO: instead of a magic number, we need to figure out the correct
+    // buffer size
     std::vector<uint8_t> encoded_data_left;
-    auto time_point = std::chrono::steady_clock::now();
+    std::vector<uint8_t> encoded_data_right;
+    g722_encode_state_t* encoder_states[2];
+    uint8_t* encoded_data[2];
+    int channels = 0;
     if (left) {
-      // TODO: instead of a magic number, we need to figure out the correct
-      // buffer size
       encoded_data_left.resize(4000);
-      int encoded_size =
-          g722_encode(encoder_state_left, encoded_data_left.data(),
-                      (const int16_t*)chan_left.data(), chan_left.size());
-      encoded_data_left.resize(encoded_size);
+      encoder_states[channels] = encoder_state_left;
+      encoded_data[channels++] = encoded_data_left.data();
+    }
+    if (right) {
+      encoded_data_right.resize(4000);
+      encoder_states[channels] = encoder_state_right;
+      encoded_data[channels++] = encoded_data_right.data();
+    }
+    int encoded_size = g722_encode_multi(encoder_states, encoded_data, channels,
+                                         pcm.data(), num_samples);
+    if (left) encoded_data_left.resize(encoded_size);
+    if (right) encoded_data_right.resize(encoded_size);
 
+    auto time_point = std::chrono::steady_clock::now();
+    if (left) {
       uint16_t cid = GAP_ConnGetL2CAPCid(left->gap_handle);
       uint16_t packets_in_chans = L2CA_FlushChannel(cid, L2CAP_FLUSH_CHANS_GET);
       if (packets_in_chans > l2cap_flush_threshold) {
@@ -1537,16 +1548,7 @@ class HearingAidImpl : public HearingAid {
       check_and_do_rssi_read(left);
     }
 
-    std::vector<uint8_t> encoded_data_right;
     if (right) {
-      // TODO: instead of a magic number, we need to figure out the correct
-      // buffer size
-      encoded_data_right.resize(4000);
-      int encoded_size =
-          g722_encode(encoder_state_right, encoded_data_right.data(),
-                      (const int16_t*)chan_right.data(), chan_right.size());
-      encoded_data_right.resize(encoded_size);
-
       uint16_t cid = GAP_ConnGetL2CAPCid(right->gap_handle);
       uint16_t packets_in_chans = L2CA_FlushChannel(cid, L2CAP_FLUSH_CHANS_GET);
       if (packets_in_chans > l2cap_flush_threshold) {
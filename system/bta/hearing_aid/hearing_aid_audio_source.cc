@@ -31,13 +31,19 @@
 #include "common/repeating_timer.h"
 #include "common/time_util.h"
 #include "os/log.h"
+#include "osi/include/properties.h"
 #include "osi/include/wakelock.h"
 #include "stack/include/main_thread.h"
+#include "udrv/include/audio_fifo.h"
 #include "udrv/include/uipc.h"
 
 using base::FilePath;
+using bluetooth::udrv::AudioFifo;
 using namespace bluetooth;
 
+#define HEARING_AID_AUDIO_FIFO_ENABLED_PROPERTY \
+  "bluetooth.hearing_aid.audio_fifo.enabled"
+
 namespace fmt {
 template <>
 struct formatter<tUIPC_EVENT> : enum_formatter<tUIPC_EVENT> {};
@@ -65,6 +71,7 @@ const char* audio_ha_hw_dump_ctrl_event(tHEARING_AID_CTRL_CMD event) {
     CASE_RETURN_STR(HEARING_AID_CTRL_GET_OUTPUT_AUDIO_CONFIG)
     CASE_RETURN_STR(HEARING_AID_CTRL_SET_OUTPUT_AUDIO_CONFIG)
     CASE_RETURN_STR(HEARING_AID_CTRL_CMD_OFFLOAD_START)
+    CASE_RETURN_STR(HEARING_AID_CTRL_GET_AUDIO_FIFO)
     default:
       break;
   }
@@ -134,6 +141,32 @@ void hearing_aid_send_ack(tHEARING_AID_CTRL_ACK status) {
   UIPC_Send(*uipc_hearing_aid, UIPC_CH_ID_AV_CTRL, 0, &ack, sizeof(ack));
 }
 
+void hearing_aid_on_get_audio_fifo() {
+  if (!osi_property_get_bool(HEARING_AID_AUDIO_FIFO_ENABLED_PROPERTY, false)) {
+    hearing_aid_send_ack(HEARING_AID_CTRL_ACK_UNSUPPORTED);
+    return;
+  }
+
+  std::unique_ptr<AudioFifo> fifo =
+      AudioFifo::Create(AUDIO_STREAM_OUTPUT_BUFFER_SZ);
+  if (fifo == nullptr) {
+    hearing_aid_send_ack(HEARING_AID_CTRL_ACK_FAILURE);
+    return;
+  }
+
+  /* The FIFO memory is passed along with the acknowledgement */
+  uint8_t ack = HEARING_AID_CTRL_ACK_SUCCESS;
+  if (!UIPC_SendFd(*uipc_hearing_aid, UIPC_CH_ID_AV_CTRL, &ack, sizeof(ack),
+                   fifo->GetFd())) {
+    return;
+  }
+
+  log::info("audio data path switched to a {} bytes FIFO",
+            fifo->GetCapacity());
+  UIPC_Ioctl(*uipc_hearing_aid, UIPC_CH_ID_AV_AUDIO, UIPC_SET_AUDIO_FIFO,
+             fifo.release());
+}
+
 void start_audio_ticks() {
   if (data_interval_ms != HA_INTERVAL_10_MS &&
       data_interval_ms != HA_INTERVAL_20_MS) {
@@ -318,6 +351,10 @@ void hearing_aid_recv_ctrl_data() {
       break;
     }
 
+    case HEARING_AID_CTRL_GET_AUDIO_FIFO:
+      hearing_aid_on_get_audio_fifo();
+      break;
+
     default:
       log::error("UNSUPPORTED CMD: {}", cmd);
       hearing_aid_send_ack(HEARING_AID_CTRL_ACK_FAILURE);
@@ -28,7 +28,14 @@
  * before scheduling next operation.
  *
  * Methods below can be used as replacement to BTA_GATTC_* in BTA app. They do
- * queue the commands if another command is currently being executed.
+ * queue the commands if another command is currently being executed. When EATT
+ * bearers are available, commands accessing distinct attributes are executed
+ * concurrently, while commands accessing the same attribute are executed in
+ * order.
+ *
+ * Characteristic and descriptor reads pending on the same connection are
+ * merged into Read Multiple Variable Length requests when the server supports
+ * them, and the values are returned to the callbacks of the original reads.
  *
  * If you decide to use those methods in your app, make sure to not mix it with
  * existing BTA_GATTC_* API.
@@ -71,11 +78,31 @@ class BtaGattQueue {
     /* write-specific fields */
     tGATT_WRITE_TYPE write_type;
     std::vector<uint8_t> value;
+
+    /* read executed alone, not merged with other reads */
+    bool not_coalesced;
   };
 
  private:
-  static void mark_as_not_executing(uint16_t conn_id);
+  /* Operations executing on a connection */
+  struct gatt_executing_ops {
+    /* handles accessed by the operations executing concurrently */
+    std::unordered_set<uint16_t> handles;
+    /* number of operations executing concurrently */
+    size_t num_ops = 0;
+    /* an MTU configuration or read multiple operation is executing alone */
+    bool exclusive = false;
+  };
+
+  static void mark_as_not_executing(uint16_t conn_id,
+                                    const std::vector<uint16_t>& handles);
   static void gatt_execute_next_op(uint16_t conn_id);
+  static void gatt_execute_op(uint16_t conn_id, gatt_operation& op);
+  static size_t coalesced_reads_budget(uint16_t conn_id);
+  static size_t coalesced_read_len(uint16_t conn_id, uint16_t handle);
+  static void gatt_execute_coalesced_reads(
+      uint16_t conn_id,
+      const std::vector<std::list<gatt_operation>::iterator>& reads);
   static void gatt_read_op_finished(uint16_t conn_id, tGATT_STATUS status,
                                     uint16_t handle, uint16_t len,
                                     uint8_t* value, void* data);
@@ -88,8 +115,19 @@ class BtaGattQueue {
                                           tBTA_GATTC_MULTI& handle,
                                           uint16_t len, uint8_t* value,
                                           void* data);
+  static void gatt_coalesced_read_op_finished(uint16_t conn_id,
+                                              tGATT_STATUS status,
+                                              tBTA_GATTC_MULTI& handles,
+                                              uint16_t len, uint8_t* value,
+                                              void* data);
   // maps connection id to operations waiting for execution
   static std::unordered_map<uint16_t, std::list<gatt_operation>> gatt_op_queue;
-  // contain connection ids that currently execute operations
-  static std::unordered_set<uint16_t> gatt_op_queue_executing;
+  // maps connection id to operations currently executing
+  static std::unordered_map<uint16_t, gatt_executing_ops>
+      gatt_op_queue_executing;
+  // contain connection ids whose server failed a Read Multiple Variable Length
+  static std::unordered_set<uint16_t> gatt_coalesced_reads_failed;
+  // maps connection id to the value lengths of the attributes read
+  static std::unordered_map<uint16_t, std::unordered_map<uint16_t, uint16_t>>
+      gatt_value_lens;
 };
@@ -22,6 +22,7 @@
 #include <mutex>
 
 #include "bta/include/bta_le_audio_broadcaster_api.h"
+#include "bta/le_audio/broadcaster/encoding_pipeline.h"
 #include "bta/le_audio/broadcaster/state_machine.h"
 #include "bta/le_audio/codec_interface.h"
 #include "bta/le_audio/content_control_id_keeper.h"
@@ -57,6 +58,7 @@ using le_audio::broadcaster::BroadcastCodecWrapper;
 using le_audio::broadcaster::BroadcastQosConfig;
 using le_audio::broadcaster::BroadcastStateMachine;
 using le_audio::broadcaster::BroadcastStateMachineConfig;
+using le_audio::broadcaster::EncodingPipeline;
 using le_audio::broadcaster::IBroadcastStateMachineCallbacks;
 using le_audio::types::AudioContexts;
 using le_audio::types::CodecLocation;
@@ -1013,6 +1015,15 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
       auto const& codec_id = codec_wrapper_.GetLeAudioCodecId();
       /* TODO: We should act smart and reuse current configurations */
       sw_enc_.clear();
+
+      /* One thread per channel, the audio thread encoding the first one */
+      const size_t num_channels = codec_wrapper_.GetNumChannels();
+      if (!encoding_pipeline_ ||
+          encoding_pipeline_->GetNumThreads() != num_channels) {
+        encoding_pipeline_ = std::make_unique<EncodingPipeline>(num_channels);
+      }
+      channel_sdus_.resize(num_channels);
+
       while (sw_enc_.size() != codec_wrapper_.GetNumChannels()) {
         auto codec = le_audio::CodecInterface::CreateInstance(codec_id);
 
@@ -1037,9 +1048,8 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
       codec_wrapper_ = config;
     }
 
-    static void sendBroadcastData(
-        const std::unique_ptr<BroadcastStateMachine>& broadcast,
-        std::vector<std::unique_ptr<le_audio::CodecInterface>>& encoders) {
+    void allocateBroadcastSdus(
+        const std::unique_ptr<BroadcastStateMachine>& broadcast) {
       auto const& config = broadcast->GetBigConfig();
       if (config == std::nullopt) {
         LOG_ERROR(
@@ -1050,35 +1060,62 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
         return;
       }
 
-      if (config->connection_handles.size() < encoders.size()) {
+      if (config->connection_handles.size() < sw_enc_.size()) {
         LOG_ERROR("Not enough BIS'es to broadcast all channels!");
         return;
       }
 
-      for (uint8_t chan = 0; chan < encoders.size(); ++chan) {
-        IsoManager::GetInstance()->SendIsoData(
+      for (uint8_t chan = 0; chan < sw_enc_.size(); ++chan) {
+        BT_HDR* sdu = IsoManager::GetInstance()->AllocateIsoSdu(
             config->connection_handles[chan],
-            (const uint8_t*)encoders[chan]->GetDecodedSamples().data(),
-            encoders[chan]->GetDecodedSamples().size() * 2);
+            codec_wrapper_.GetOctetsPerCodecFrame());
+        if (sdu == nullptr) continue;
+
+        channel_sdus_[chan].push_back(sdu);
+        sdus_.push_back(sdu);
       }
     }
 
-    virtual void OnAudioDataReady(const std::vector<uint8_t>& data) override {
-      if (!instance) return;
-
-      LOG_VERBOSE("Received %zu bytes.", data.size());
-
-      /* Constants for the channel data configuration */
+    void encodeChannel(const std::vector<uint8_t>& data, uint8_t chan) {
       const auto num_channels = codec_wrapper_.GetNumChannels();
       const auto bytes_per_sample = (codec_wrapper_.GetBitsPerSample() / 8);
+      const auto octets_per_frame = codec_wrapper_.GetOctetsPerCodecFrame();
+      auto initial_channel_offset = chan * bytes_per_sample;
+      auto const& sdus = channel_sdus_[chan];
 
-      /* Prepare encoded data for all channels */
-      for (uint8_t chan = 0; chan < num_channels; ++chan) {
-        auto initial_channel_offset = chan * bytes_per_sample;
+      /* Keep the encoder state continuous even if nothing is sent */
+      if (sdus.empty()) {
         sw_enc_[chan]->Encode(data.data() + initial_channel_offset,
-                              num_channels,
-                              codec_wrapper_.GetOctetsPerCodecFrame());
+                              num_channels, octets_per_frame);
+        return;
+      }
+
+      /* Encode into the first SDU and copy to the other broadcasts. The SDUs
+       * are already accounted for as sent, so on error they go out zeroed
+       * rather than with uninitialized memory.
+       */
+      auto encoded = sdus.front()->data + sdus.front()->offset;
+      auto status = sw_enc_[chan]->EncodeInto(
+          data.data() + initial_channel_offset, num_channels, octets_per_frame,
+          encoded);
+      if (status != le_audio::CodecInterface::Status::STATUS_OK) {
+        LOG_ERROR("Encoding channel %d failed, status %d", chan,
+                  static_cast<int>(status));
+        for (auto sdu : sdus) {
+          memset(sdu->data + sdu->offset, 0, octets_per_frame);
+        }
+        return;
+      }
+
+      for (auto it = std::next(sdus.begin()); it != sdus.end(); ++it) {
+        memcpy((*it)->data + (*it)->offset, encoded, octets_per_frame);
       }
+    }
+
+    virtual void OnAudioDataReady(const std::vector<uint8_t>& data) override {
+      if (!instance || !encoding_pipeline_) return;
+
+      LOG_VERBOSE("Received %zu bytes.", data.size());
 
       /* Currently there is no way to broadcast multiple distinct streams.
        * We just receive all system sounds mixed into a one stream and each
@@ -1089,8 +1126,19 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
         if ((broadcast->GetState() ==
              BroadcastStateMachine::State::STREAMING) &&
             !broadcast->IsMuted())
-          sendBroadcastData(broadcast, sw_enc_);
+          allocateBroadcastSdus(broadcast);
+      }
+
+      /* Encode all channels in parallel, straight into the ISO SDUs */
+      encoding_pipeline_->Run(sw_enc_.size(), [this, &data](size_t chan) {
+        encodeChannel(data, chan);
+      });
+
+      for (auto sdu : sdus_) {
+        IsoManager::GetInstance()->SendIsoSdu(sdu);
       }
+      sdus_.clear();
+      for (auto& sdus : channel_sdus_) sdus.clear();
       LOG_VERBOSE("All data sent.");
     }
 
@@ -1138,6 +1186,10 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
    private:
     BroadcastCodecWrapper codec_wrapper_;
     std::vector<std::unique_ptr<le_audio::CodecInterface>> sw_enc_;
+    std::unique_ptr<EncodingPipeline> encoding_pipeline_;
+    /* SDUs of the current interval, per channel and in the sending order */
+    std::vector<std::vector<BT_HDR*>> channel_sdus_;
+    std::vector<BT_HDR*> sdus_;
   } audio_receiver_;
 
   bluetooth::le_audio::LeAudioBroadcasterCallbacks* callbacks_;
@@ -26,6 +26,7 @@
 #include "bta/le_audio/broadcaster/mock_state_machine.h"
 #include "bta/le_audio/content_control_id_keeper.h"
 #include "bta/le_audio/le_audio_types.h"
+#include "bta/le_audio/mock_codec_interface.h"
 #include "bta/le_audio/mock_iso_manager.h"
 #include "bta/test/common/mock_controller.h"
 #include "device/include/controller.h"
@@ -212,6 +213,15 @@ class BroadcasterTest : public Test {
     iso_manager_ = bluetooth::hci::IsoManager::GetInstance();
     ASSERT_NE(iso_manager_, nullptr);
     iso_manager_->Start();
+    ON_CALL(*MockIsoManager::GetInstance(), AllocateIsoSdu)
+        .WillByDefault([](uint16_t /* iso_handle */, uint16_t data_len) {
+          BT_HDR* sdu = (BT_HDR*)malloc(sizeof(BT_HDR) + data_len);
+          sdu->offset = 0;
+          sdu->len = data_len;
+          return sdu;
+        });
+    ON_CALL(*MockIsoManager::GetInstance(), SendIsoSdu)
+        .WillByDefault([](BT_HDR* sdu) { free(sdu); });
 
     is_audio_hal_acquired = false;
     mock_audio_source_ = new MockAudioHalClientEndpoint();
@@ -239,6 +249,8 @@ class BroadcasterTest : public Test {
   }
 
   void TearDown() override {
+    MockCodecInterface::RegisterMockInstanceHook(nullptr);
+
     // Message loop cleanup should wait for all the 'till now' scheduled calls
     // so it should be called right at the very begginning of teardown.
     cleanup_message_loop_thread();
@@ -374,7 +386,8 @@ TEST_F(BroadcasterTest, StartAudioBroadcast) {
   MockBroadcastStateMachine::GetLastInstance()->SetExpectedBigConfig(big_cfg);
 
   // Inject the audio and verify call on the Iso manager side.
-  EXPECT_CALL(*MockIsoManager::GetInstance(), SendIsoData).Times(1);
+  EXPECT_CALL(*MockIsoManager::GetInstance(), AllocateIsoSdu).Times(1);
+  EXPECT_CALL(*MockIsoManager::GetInstance(), SendIsoSdu).Times(1);
   std::vector<uint8_t> sample_data(320, 0);
   audio_receiver->OnAudioDataReady(sample_data);
 }
@@ -406,11 +419,70 @@ TEST_F(BroadcasterTest, StartAudioBroadcastMedia) {
   MockBroadcastStateMachine::GetLastInstance()->SetExpectedBigConfig(big_cfg);
 
   // Inject the audio and verify call on the Iso manager side.
-  EXPECT_CALL(*MockIsoManager::GetInstance(), SendIsoData).Times(2);
+  EXPECT_CALL(*MockIsoManager::GetInstance(), AllocateIsoSdu).Times(2);
+  EXPECT_CALL(*MockIsoManager::GetInstance(), SendIsoSdu).Times(2);
   std::vector<uint8_t> sample_data(1920, 0);
   audio_receiver->OnAudioDataReady(sample_data);
 }
 
+TEST_F(BroadcasterTest, EncodingErrorSendsZeroedSdus) {
+  int num_codecs = 0;
+  MockCodecInterface::RegisterMockInstanceHook(
+      [&num_codecs](MockCodecInterface* codec, bool is_destroyed) {
+        if (is_destroyed) return;
+        ON_CALL(*codec, EncodeInto)
+            .WillByDefault(Return(
+                le_audio::CodecInterface::Status::STATUS_ERR_CODEC_NOT_READY));
+        num_codecs++;
+      });
+
+  auto broadcast_id = InstantiateBroadcast(media_metadata);
+  LeAudioBroadcaster::Get()->StopAudioBroadcast(broadcast_id);
+
+  LeAudioSourceAudioHalClient::Callbacks* audio_receiver;
+  EXPECT_CALL(*mock_audio_source_, Start)
+      .WillOnce(DoAll(SaveArg<1>(&audio_receiver), Return(true)));
+
+  LeAudioBroadcaster::Get()->StartAudioBroadcast(broadcast_id);
+  ASSERT_NE(audio_receiver, nullptr);
+  ASSERT_EQ(2, num_codecs);
+
+  BigConfig big_cfg;
+  big_cfg.big_id =
+      MockBroadcastStateMachine::GetLastInstance()->GetAdvertisingSid();
+  big_cfg.connection_handles = {0x10, 0x12};
+  big_cfg.max_pdu = 128;
+  MockBroadcastStateMachine::GetLastInstance()->SetExpectedBigConfig(big_cfg);
+
+  // The SDU payloads are not initialized on allocation, as in IsoManager.
+  EXPECT_CALL(*MockIsoManager::GetInstance(), AllocateIsoSdu)
+      .Times(2)
+      .WillRepeatedly([](uint16_t /* iso_handle */, uint16_t data_len) {
+        BT_HDR* sdu = (BT_HDR*)malloc(sizeof(BT_HDR) + data_len);
+        sdu->offset = 0;
+        sdu->len = data_len;
+        memset(sdu->data, 0xA5, data_len);
+        return sdu;
+      });
+
+  std::vector<std::vector<uint8_t>> payloads;
+  EXPECT_CALL(*MockIsoManager::GetInstance(), SendIsoSdu)
+      .Times(2)
+      .WillRepeatedly([&payloads](BT_HDR* sdu) {
+        payloads.emplace_back(sdu->data + sdu->offset,
+                              sdu->data + sdu->offset + sdu->len);
+        free(sdu);
+      });
+  std::vector<uint8_t> sample_data(1920, 0);
+  audio_receiver->OnAudioDataReady(sample_data);
+
+  ASSERT_EQ(2u, payloads.size());
+  for (auto const& payload : payloads) {
+    ASSERT_FALSE(payload.empty());
+    ASSERT_EQ(std::vector<uint8_t>(payload.size(), 0), payload);
+  }
+}
+
 TEST_F(BroadcasterTest, StopAudioBroadcast) {
   auto broadcast_id = InstantiateBroadcast();
   LeAudioBroadcaster::Get()->StartAudioBroadcast(broadcast_id);
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bta/le_audio/broadcaster/encoding_pipeline.h"
+
+#include <string.h>
+
+#include "os/log.h"
+
+namespace le_audio {
+namespace broadcaster {
+
+EncodingPipeline::EncodingPipeline(size_t num_threads) {
+  for (size_t i = 1; i < num_threads; ++i) {
+    workers_.emplace_back(&EncodingPipeline::WorkerLoop, this);
+  }
+}
+
+EncodingPipeline::~EncodingPipeline() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  start_cv_.notify_all();
+
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void EncodingPipeline::Run(size_t num_jobs,
+                           const std::function<void(size_t)>& job) {
+  if (workers_.empty() || num_jobs < 2 || !MatchCallerScheduling()) {
+    for (size_t index = 0; index < num_jobs; ++index) job(index);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    job_ = &job;
+    num_jobs_ = num_jobs;
+    next_job_.store(0, std::memory_order_relaxed);
+    busy_workers_ = workers_.size();
+    generation_++;
+  }
+  start_cv_.notify_all();
+
+  RunJobs();
+
+  /* The job is owned by the caller, wait until no worker may use it */
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this] { return busy_workers_ == 0; });
+  job_ = nullptr;
+}
+
+/* Gives the workers the scheduling of the calling thread, if it changed since
+ * the previous run. Returns false if the workers could not get it.
+ */
+bool EncodingPipeline::MatchCallerScheduling() {
+  int policy;
+  struct sched_param param;
+  if (pthread_getschedparam(pthread_self(), &policy, &param) != 0) {
+    return workers_usable_;
+  }
+  if (policy == workers_policy_ && param.sched_priority == workers_priority_) {
+    return workers_usable_;
+  }
+
+  workers_policy_ = policy;
+  workers_priority_ = param.sched_priority;
+  workers_usable_ = true;
+  for (auto& worker : workers_) {
+    int rc = pthread_setschedparam(worker.native_handle(), policy, &param);
+    if (rc != 0) {
+      LOG_WARN("Unable to set policy %d priority %d on encoder worker: %s",
+               policy, param.sched_priority, strerror(rc));
+      workers_usable_ = false;
+    }
+  }
+  return workers_usable_;
+}
+
+void EncodingPipeline::RunJobs() {
+  for (size_t index = next_job_.fetch_add(1, std::memory_order_relaxed);
+       index < num_jobs_;
+       index = next_job_.fetch_add(1, std::memory_order_relaxed)) {
+    (*job_)(index);
+  }
+}
+
+void EncodingPipeline::WorkerLoop() {
+  uint64_t generation = 0;
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_cv_.wait(
+          lock, [&] { return stopping_ || generation_ != generation; });
+      if (stopping_) return;
+      generation = generation_;
+    }
+
+    RunJobs();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--busy_workers_ != 0) continue;
+    }
+    done_cv_.notify_one();
+  }
+}
+
+}  // namespace broadcaster
+}  // namespace le_audio
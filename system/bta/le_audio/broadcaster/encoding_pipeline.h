@@ -0,0 +1,80 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace le_audio {
+namespace broadcaster {
+
+/* Runs the encoding jobs of one SDU interval on a pool of worker threads.
+ * The calling thread takes part in the encoding, so a pipeline with a single
+ * thread does not spawn any worker and encodes sequentially.
+ *
+ * The caller waits for the workers, so they are given its scheduling policy
+ * and priority, e.g. the real-time one of the audio thread. When that fails,
+ * the jobs are run on the calling thread only.
+ */
+class EncodingPipeline {
+ public:
+  explicit EncodingPipeline(size_t num_threads);
+  ~EncodingPipeline();
+
+  EncodingPipeline(const EncodingPipeline&) = delete;
+  EncodingPipeline& operator=(const EncodingPipeline&) = delete;
+
+  size_t GetNumThreads() const { return workers_.size() + 1; }
+
+  /* Calls job(index) for every index in [0, num_jobs) and returns once all
+   * the jobs are done. Each job is executed exactly once, on any thread.
+   */
+  void Run(size_t num_jobs, const std::function<void(size_t)>& job);
+
+ private:
+  void WorkerLoop();
+  void RunJobs();
+  bool MatchCallerScheduling();
+
+  std::vector<std::thread> workers_;
+  int workers_policy_ = SCHED_OTHER;
+  int workers_priority_ = 0;
+  bool workers_usable_ = true;
+
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  uint64_t generation_ = 0;
+  size_t busy_workers_ = 0;
+  bool stopping_ = false;
+
+  const std::function<void(size_t)>* job_ = nullptr;
+  size_t num_jobs_ = 0;
+  std::atomic<size_t> next_job_{0};
+};
+
+}  // namespace broadcaster
+}  // namespace le_audio
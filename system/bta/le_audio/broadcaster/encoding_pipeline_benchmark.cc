@@ -0,0 +1,100 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "bta/le_audio/broadcaster/encoding_pipeline.h"
+#include "bta/le_audio/codec_interface.h"
+#include "bta/le_audio/le_audio_types.h"
+
+using le_audio::CodecInterface;
+using le_audio::LeAudioCodecConfiguration;
+using le_audio::broadcaster::EncodingPipeline;
+
+namespace {
+
+constexpr uint16_t kOctetsPerCodecFrame = 100;
+
+const LeAudioCodecConfiguration kCodecConfig = {
+    .num_channels = LeAudioCodecConfiguration::kChannelNumberMono,
+    .sample_rate = LeAudioCodecConfiguration::kSampleRate48000,
+    .bits_per_sample = LeAudioCodecConfiguration::kBitsPerSample16,
+    .data_interval_us = LeAudioCodecConfiguration::kInterval10000Us,
+};
+
+/* Encodes one SDU interval of a broadcast with one channel per BIS, each
+ * encoded frame being written to its own SDU buffer. The arguments are the
+ * number of BISes and the number of encoding threads. The reported CPU time
+ * is the process CPU time spent per SDU interval.
+ */
+void BM_EncodeInterval(benchmark::State& state) {
+  const size_t num_bis = state.range(0);
+  const size_t num_threads = state.range(1);
+  const size_t num_samples = kCodecConfig.sample_rate / 100;
+
+  std::vector<std::unique_ptr<CodecInterface>> encoders;
+  for (size_t i = 0; i < num_bis; ++i) {
+    encoders.push_back(CodecInterface::CreateInstance(
+        {.coding_format = le_audio::types::kLeAudioCodingFormatLC3}));
+    if (encoders.back()->InitEncoder(kCodecConfig, kCodecConfig) !=
+        CodecInterface::Status::STATUS_OK) {
+      state.SkipWithError("Encoder setup failed");
+      return;
+    }
+  }
+
+  /* Interleaved PCM, a different tone on each channel */
+  std::vector<int16_t> pcm(num_samples * num_bis);
+  for (size_t n = 0; n < num_samples; ++n) {
+    for (size_t chan = 0; chan < num_bis; ++chan) {
+      pcm[n * num_bis + chan] = static_cast<int16_t>(
+          8000 * std::sin(2 * M_PI * 440 * (chan + 1) * n / 48000.0));
+    }
+  }
+
+  std::vector<std::vector<uint8_t>> sdus(
+      num_bis, std::vector<uint8_t>(kOctetsPerCodecFrame));
+  EncodingPipeline pipeline(num_threads);
+
+  for (auto _ : state) {
+    pipeline.Run(num_bis, [&](size_t chan) {
+      encoders[chan]->EncodeInto(
+          reinterpret_cast<const uint8_t*>(pcm.data() + chan), num_bis,
+          kOctetsPerCodecFrame, sdus[chan].data());
+    });
+    benchmark::DoNotOptimize(sdus.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * num_bis);
+}
+BENCHMARK(BM_EncodeInterval)
+    ->Args({2, 1})
+    ->Args({2, 2})
+    ->Args({4, 1})
+    ->Args({4, 4})
+    ->Args({8, 1})
+    ->Args({8, 8})
+    ->MeasureProcessCPUTime()
+    ->UseRealTime();
+
+}  // namespace
+
+BENCHMARK_MAIN();
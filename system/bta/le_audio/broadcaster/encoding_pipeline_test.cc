@@ -0,0 +1,135 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bta/le_audio/broadcaster/encoding_pipeline.h"
+
+#include <gtest/gtest.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using le_audio::broadcaster::EncodingPipeline;
+
+namespace {
+
+/* Runs test on a thread of its own, so that the scheduling changes do not
+ * leak to the other tests.
+ */
+template <typename T>
+void RunOnThread(T test) {
+  std::thread thread(test);
+  thread.join();
+}
+
+void SetCallerPolicy(int policy) {
+  struct sched_param param = {.sched_priority = 0};
+  ASSERT_EQ(0, pthread_setschedparam(pthread_self(), policy, &param));
+}
+
+}  // namespace
+
+TEST(EncodingPipelineTest, RunsEveryJobOnce) {
+  for (size_t num_threads = 1; num_threads <= 4; ++num_threads) {
+    EncodingPipeline pipeline(num_threads);
+    ASSERT_EQ(num_threads, pipeline.GetNumThreads());
+
+    for (size_t num_jobs = 0; num_jobs <= 9; ++num_jobs) {
+      for (int round = 0; round < 50; ++round) {
+        std::vector<std::atomic<int>> runs(num_jobs);
+        pipeline.Run(num_jobs, [&runs](size_t index) { runs[index]++; });
+        for (size_t index = 0; index < num_jobs; ++index) {
+          ASSERT_EQ(1, runs[index].load())
+              << "threads " << num_threads << " jobs " << num_jobs;
+        }
+      }
+    }
+  }
+}
+
+TEST(EncodingPipelineTest, SingleJobRunsOnCaller) {
+  EncodingPipeline pipeline(2);
+  std::thread::id job_thread;
+  pipeline.Run(1, [&job_thread](size_t) {
+    job_thread = std::this_thread::get_id();
+  });
+  ASSERT_EQ(std::this_thread::get_id(), job_thread);
+}
+
+TEST(EncodingPipelineTest, RunsJobsConcurrently) {
+  EncodingPipeline pipeline(2);
+
+  /* Each job waits for the other one to start, which only happens if they
+   * run on two threads at once.
+   */
+  std::atomic<int> started{0};
+  std::atomic<bool> overlapped{true};
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+  pipeline.Run(2, [&](size_t) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      threads.insert(std::this_thread::get_id());
+    }
+    started++;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (started.load() < 2) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        overlapped = false;
+        return;
+      }
+      std::this_thread::yield();
+    }
+  });
+
+  ASSERT_TRUE(overlapped);
+  ASSERT_EQ(2u, threads.size());
+}
+
+TEST(EncodingPipelineTest, WorkersFollowCallerScheduling) {
+  RunOnThread([] {
+    EncodingPipeline pipeline(3);
+
+    for (int policy : {SCHED_BATCH, SCHED_OTHER}) {
+      SetCallerPolicy(policy);
+
+      /* Keep the jobs busy until every thread has taken one */
+      std::atomic<int> started{0};
+      std::mutex mutex;
+      std::set<int> job_policies;
+      pipeline.Run(3, [&](size_t) {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          job_policies.insert(sched_getscheduler(0));
+        }
+        started++;
+        auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (started.load() < 3 &&
+               std::chrono::steady_clock::now() < deadline) {
+          std::this_thread::yield();
+        }
+      });
+
+      ASSERT_EQ(std::set<int>({policy}), job_policies);
+    }
+  });
+}
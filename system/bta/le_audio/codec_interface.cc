@@ -135,6 +135,25 @@ struct CodecInterface::Impl {
                                 uint16_t out_size,
                                 std::vector<int16_t>* out_buffer = nullptr,
                                 uint16_t out_offset = 0) {
+    // Prepare the encoded output buffer
+    if (out_buffer == nullptr) {
+      out_buffer = &output_channel_data_;
+    }
+
+    // We have two bytes per sample in the buffer, while out_size and
+    // out_offset are in bytes
+    size_t channel_samples = (out_offset + out_size) / 2;
+    if (output_channel_samples_ < channel_samples) {
+      output_channel_samples_ = channel_samples;
+    }
+    adjustOutputBufferSizeIfNeeded(out_buffer);
+
+    return EncodeInto(data, stride, out_size,
+                      ((uint8_t*)out_buffer->data()) + out_offset);
+  }
+
+  CodecInterface::Status EncodeInto(const uint8_t* data, int stride,
+                                    uint16_t out_size, uint8_t* out_buffer) {
     if (!IsReady()) {
       LOG_ERROR("decoder not ready");
       return Status::STATUS_ERR_CODEC_NOT_READY;
@@ -147,23 +166,8 @@ struct CodecInterface::Impl {
 
     // For now only LC3 is supported
     if (codec_id_.coding_format == types::kLeAudioCodingFormatLC3) {
-      // Prepare the encoded output buffer
-      if (out_buffer == nullptr) {
-        out_buffer = &output_channel_data_;
-      }
-
-      // We have two bytes per sample in the buffer, while out_size and
-      // out_offset are in bytes
-      size_t channel_samples = (out_offset + out_size) / 2;
-      if (output_channel_samples_ < channel_samples) {
-        output_channel_samples_ = channel_samples;
-      }
-      adjustOutputBufferSizeIfNeeded(out_buffer);
-
-      // Encode
-      auto err =
-          lc3_encode(lc3_.encoder_, lc3_.pcm_format_, data, stride, out_size,
-                     ((uint8_t*)out_buffer->data()) + out_offset);
+      auto err = lc3_encode(lc3_.encoder_, lc3_.pcm_format_, data, stride,
+                            out_size, out_buffer);
       if (err < 0) {
         LOG(ERROR) << " bad encoding parameters: " << static_cast<int>(err);
         return Status::STATUS_ERR_CODING_ERROR;
@@ -286,6 +290,12 @@ CodecInterface::Status CodecInterface::Encode(const uint8_t* data, int stride,
                                               uint16_t out_offset) {
   return impl->Encode(data, stride, out_size, out_buffer, out_offset);
 }
+CodecInterface::Status CodecInterface::EncodeInto(const uint8_t* data,
+                                                  int stride,
+                                                  uint16_t out_size,
+                                                  uint8_t* out_buffer) {
+  return impl->EncodeInto(data, stride, out_size, out_buffer);
+}
 void CodecInterface::Cleanup() { return impl->Cleanup(); }
 
 uint16_t CodecInterface::GetNumOfSamplesPerChannel() {
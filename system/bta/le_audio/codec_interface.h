@@ -61,6 +61,11 @@ class CodecInterface {
   virtual CodecInterface::Status Encode(
       const uint8_t* data, int stride, uint16_t out_size,
       std::vector<int16_t>* out_buffer = nullptr, uint16_t out_offset = 0);
+  /* Encodes directly into the out_size bytes long out_buffer, e.g. the
+   * payload of an outgoing ISO SDU. */
+  virtual CodecInterface::Status EncodeInto(const uint8_t* data, int stride,
+                                            uint16_t out_size,
+                                            uint8_t* out_buffer);
   virtual CodecInterface::Status Decode(uint8_t* data, uint16_t size);
   virtual void Cleanup();
   virtual bool IsReady();
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <gmock/gmock.h>
+
+#include <memory>
+#include <vector>
+
+#include "btm_api_mock.h"
+#include "device_groups.h"
+#include "devices.h"
+#include "le_audio_set_configuration_provider.h"
+#include "le_audio_types.h"
+#include "mock_controller.h"
+#include "mock_csis_client.h"
+
+using ::le_audio::DeviceConnectState;
+using ::le_audio::LeAudioDevice;
+using ::le_audio::LeAudioDeviceGroup;
+using ::le_audio::set_configurations::CodecConfigSetting;
+using ::le_audio::types::acs_ac_record;
+using ::le_audio::types::AudioContexts;
+using ::le_audio::types::hdl_pair;
+using ::le_audio::types::LeAudioContextType;
+using ::le_audio::types::LeAudioLtvMap;
+using ::testing::_;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+namespace {
+
+constexpr int kGroupId = 1;
+constexpr int kNumDevices = 4;
+
+const std::vector<LeAudioContextType> kContexts = {
+    LeAudioContextType::MEDIA, LeAudioContextType::CONVERSATIONAL,
+    LeAudioContextType::GAME, LeAudioContextType::LIVE,
+    LeAudioContextType::RINGTONE};
+
+/* PAC record supporting exactly the LC3 setting of a configuration entry */
+acs_ac_record make_pac_record(const CodecConfigSetting& setting) {
+  using namespace ::le_audio::codec_spec_caps;
+
+  auto core_config = setting.params.GetAsCoreCodecConfig();
+  uint16_t sampling_frequencies =
+      SamplingFreqConfig2Capability(*core_config.sampling_frequency);
+  uint8_t frame_durations =
+      FrameDurationConfig2Capability(*core_config.frame_duration);
+  uint8_t audio_channel_counts = 1;
+  uint32_t octets_per_frame_range =
+      *core_config.octets_per_codec_frame |
+      (*core_config.octets_per_codec_frame << 16);
+  uint8_t max_codec_frames_per_sdu = 1;
+  return acs_ac_record(
+      {.codec_id = setting.id,
+       .codec_spec_caps = LeAudioLtvMap({
+           {kLeAudioLtvTypeSupportedSamplingFrequencies,
+            UINT16_TO_VEC_UINT8(sampling_frequencies)},
+           {kLeAudioLtvTypeSupportedFrameDurations,
+            UINT8_TO_VEC_UINT8(frame_durations)},
+           {kLeAudioLtvTypeSupportedAudioChannelCounts,
+            UINT8_TO_VEC_UINT8(audio_channel_counts)},
+           {kLeAudioLtvTypeSupportedOctetsPerCodecFrame,
+            UINT32_TO_VEC_UINT8(octets_per_frame_range)},
+           {kLeAudioLtvTypeSupportedMaxCodecFramesPerSdu,
+            UINT8_TO_VEC_UINT8(max_codec_frames_per_sdu)},
+       }),
+       .metadata = std::vector<uint8_t>(0)});
+}
+
+/* Devices publish each of their codec capabilities once */
+void add_pac_record(std::vector<acs_ac_record>& records,
+                    const CodecConfigSetting& setting) {
+  auto record = make_pac_record(setting);
+  for (const auto& existing : records) {
+    if (existing.codec_id == record.codec_id &&
+        existing.codec_spec_caps.Values() == record.codec_spec_caps.Values()) {
+      return;
+    }
+  }
+  records.push_back(std::move(record));
+}
+
+/* Group of four connected devices with two sink ASEs and one source ASE
+ * each, publishing the sink capabilities of the configurations below 48kHz
+ * and the source ones at 16kHz.
+ */
+class ContextSwitchFixture {
+ public:
+  ContextSwitchFixture() : group_(kGroupId) {
+    bluetooth::manager::SetMockBtmInterface(&btm_interface_);
+    controller::SetMockControllerInterface(&controller_interface_);
+    ::le_audio::AudioSetConfigurationProvider::Initialize(
+        ::le_audio::types::CodecLocation::HOST);
+    MockCsisClient::SetMockInstanceForTesting(&csis_client_);
+    ON_CALL(csis_client_, Get()).WillByDefault(Return(&csis_client_));
+    ON_CALL(csis_client_, IsCsisClientRunning()).WillByDefault(Return(true));
+    ON_CALL(csis_client_, GetDeviceList(_))
+        .WillByDefault([this](int) { return addresses_; });
+    ON_CALL(csis_client_, GetDesiredSize(_)).WillByDefault(Return(kNumDevices));
+
+    std::vector<acs_ac_record> snk_records, src_records;
+    for (auto context : kContexts) {
+      for (const auto* conf :
+           *::le_audio::AudioSetConfigurationProvider::Get()
+                ->GetConfigurations(context)) {
+        for (const auto& entry : conf->confs) {
+          if (entry.codec.id != ::le_audio::set_configurations::
+                                    LeAudioCodecIdLc3) {
+            continue;
+          }
+          auto sampling_frequency = entry.codec.GetSamplingFrequencyHz();
+          if (entry.direction == ::le_audio::types::kLeAudioDirectionSink) {
+            if (sampling_frequency < 48000) {
+              add_pac_record(snk_records, entry.codec);
+            }
+          } else if (sampling_frequency == 16000) {
+            add_pac_record(src_records, entry.codec);
+          }
+        }
+      }
+    }
+
+    for (int i = 0; i < kNumDevices; i++) {
+      auto device = std::make_shared<LeAudioDevice>(
+          RawAddress({0xC0, 0xDE, 0xC0, 0xDE, 0x00, (uint8_t)i}),
+          DeviceConnectState::DISCONNECTED);
+      devices_.push_back(device);
+      addresses_.push_back(device->address_);
+      group_.AddNode(device);
+
+      int ase_id = 1;
+      device->ases_.emplace_back(0x0000, 0x0000,
+                                 ::le_audio::types::kLeAudioDirectionSource,
+                                 ase_id++);
+      for (int j = 0; j < 2; j++) {
+        device->ases_.emplace_back(0x0000, 0x0000,
+                                   ::le_audio::types::kLeAudioDirectionSink,
+                                   ase_id++);
+      }
+
+      AudioContexts all_contexts(::le_audio::types::kLeAudioContextAllTypes);
+      device->SetSupportedContexts(
+          {.sink = all_contexts, .source = all_contexts});
+      device->SetAvailableContexts(
+          {.sink = all_contexts, .source = all_contexts});
+      device->snk_audio_locations_ =
+          ::le_audio::codec_spec_conf::kLeAudioLocationFrontLeft |
+          ::le_audio::codec_spec_conf::kLeAudioLocationFrontRight;
+      device->src_audio_locations_ =
+          ::le_audio::codec_spec_conf::kLeAudioLocationFrontLeft |
+          ::le_audio::codec_spec_conf::kLeAudioLocationFrontRight;
+      device->snk_pacs_ = {{hdl_pair(0x0000, 0x0000), snk_records}};
+      device->src_pacs_ = {{hdl_pair(0x0000, 0x0000), src_records}};
+      device->conn_id_ = i + 1;
+      device->SetConnectionState(DeviceConnectState::CONNECTED);
+      group_.ReloadAudioDirections();
+      group_.ReloadAudioLocations();
+    }
+    group_.UpdateAudioContextAvailability();
+  }
+
+  ~ContextSwitchFixture() {
+    controller::SetMockControllerInterface(nullptr);
+    bluetooth::manager::SetMockBtmInterface(nullptr);
+    devices_.clear();
+    ::le_audio::AudioSetConfigurationProvider::Cleanup();
+  }
+
+  LeAudioDeviceGroup group_;
+
+ private:
+  NiceMock<bluetooth::manager::MockBtmInterface> btm_interface_;
+  NiceMock<controller::MockControllerInterface> controller_interface_;
+  NiceMock<MockCsisClient> csis_client_;
+  std::vector<std::shared_ptr<LeAudioDevice>> devices_;
+  std::vector<RawAddress> addresses_;
+};
+
+/* Selects the configuration of five context types in turn on a 4-device
+ * group. With an argument of 1, the group configuration caches are
+ * invalidated before each round, as on PAC, location or membership changes.
+ */
+void BM_ContextSwitch(benchmark::State& state) {
+  const bool invalidate = state.range(0);
+  ContextSwitchFixture fixture;
+  LeAudioDeviceGroup& group = fixture.group_;
+
+  for (auto context : kContexts) {
+    group.UpdateAudioSetConfigurationCache(context);
+    if (group.GetCachedConfiguration(context) == nullptr) {
+      state.SkipWithError("No supported configuration");
+      return;
+    }
+  }
+
+  for (auto _ : state) {
+    if (invalidate) group.InvalidateCachedConfigurations();
+    for (auto context : kContexts) {
+      group.UpdateAudioSetConfigurationCache(context);
+      benchmark::DoNotOptimize(group.GetCachedConfiguration(context));
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * kContexts.size());
+}
+BENCHMARK(BM_ContextSwitch)->Arg(0)->Arg(1);
+
+}  // namespace
+
+BENCHMARK_MAIN();
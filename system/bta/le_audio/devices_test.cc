@@ -22,6 +22,7 @@
 
 #include "btif_storage_mock.h"
 #include "btm_api_mock.h"
+#include "codec_manager.h"
 #include "device_groups.h"
 #include "le_audio_set_configuration_provider.h"
 #include "le_audio_types.h"
@@ -34,6 +35,12 @@ tACL_CONN* btm_bda_to_acl(const RawAddress& bda, tBT_TRANSPORT transport) {
   return nullptr;
 }
 
+namespace le_audio {
+bool CheckIfStrategySupported(types::LeAudioConfigurationStrategy strategy,
+                              const set_configurations::SetConfiguration& conf,
+                              const LeAudioDevice& device);
+}  // namespace le_audio
+
 namespace bluetooth {
 namespace le_audio {
 namespace internal {
@@ -1654,6 +1661,150 @@ TEST_F(LeAudioAseConfigurationTest, test_num_of_connected) {
   ASSERT_EQ(0, group_->NumOfConnected());
 }
 
+/* Selects the first configuration of the context supported by the group,
+ * matching every configuration against the PAC records and ASEs of every
+ * device, independently of the group configuration selection.
+ */
+static const AudioSetConfiguration* FindFirstSupportedConfigurationPlain(
+    const LeAudioDeviceGroup* group, LeAudioContextType context_type) {
+  auto provider = ::le_audio::AudioSetConfigurationProvider::Get();
+  const AudioSetConfigurations* confs =
+      provider->GetConfigurations(context_type);
+
+  auto num_of_connected = group->NumOfConnected(context_type);
+  if (num_of_connected == 0) num_of_connected = group->NumOfConnected();
+  if (!check_if_may_cover_scenario(confs, num_of_connected)) return nullptr;
+
+  auto required_snk_strategy = group->GetGroupStrategy(group->Size());
+  auto is_supported = [&](const AudioSetConfiguration* conf) {
+    if (!check_if_may_cover_scenario(conf, num_of_connected)) return false;
+
+    for (const auto& ent : conf->confs) {
+      if (ent.direction == kLeAudioDirectionSink &&
+          ent.strategy != required_snk_strategy) {
+        return false;
+      }
+
+      uint8_t required_device_cnt = ent.device_cnt;
+      uint8_t max_required_ase_per_dev =
+          ent.ase_cnt / ent.device_cnt + (ent.ase_cnt % ent.device_cnt);
+      uint8_t active_ase_num = 0;
+      for (auto* device = group->GetFirstDevice();
+           device != nullptr && required_device_cnt > 0;
+           device = group->GetNextDevice(device)) {
+        if (device->ases_.empty()) continue;
+        if (device->GetCodecConfigurationSupportedPac(ent.direction,
+                                                      ent.codec) == nullptr) {
+          continue;
+        }
+        int needed_ase =
+            std::min(static_cast<int>(max_required_ase_per_dev),
+                     static_cast<int>(ent.ase_cnt - active_ase_num));
+        if (!::le_audio::CheckIfStrategySupported(ent.strategy, ent, *device)) {
+          continue;
+        }
+        for (auto& ase : device->ases_) {
+          if (ase.direction != ent.direction) continue;
+          active_ase_num++;
+          if (--needed_ase == 0) break;
+        }
+        if (needed_ase > 0) return false;
+        required_device_cnt--;
+      }
+      if (required_device_cnt > 0) return false;
+    }
+
+    if (group->Size() > 1 && provider->CheckConfigurationIsBiDirSwb(*conf)) {
+      auto codec_manager = ::le_audio::CodecManager::GetInstance();
+      if (!provider->IsDualBiDirSwbSupported() ||
+          (codec_manager->GetCodecLocation() == CodecLocation::ADSP &&
+           !codec_manager->IsOffloadDualBiDirSwbSupported())) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  for (const auto* conf : *confs) {
+    if (is_supported(conf)) return conf;
+  }
+  return nullptr;
+}
+
+TEST_F(LeAudioAseConfigurationTest, test_context_switching_four_devices) {
+  const std::vector<LeAudioContextType> contexts = {
+      LeAudioContextType::MEDIA, LeAudioContextType::CONVERSATIONAL,
+      LeAudioContextType::GAME, LeAudioContextType::LIVE,
+      LeAudioContextType::RINGTONE};
+
+  /* Publish the sink codec capabilities of the configurations below 48kHz,
+   * and the source ones at 16kHz, so that the preferred configurations are
+   * rejected by the PAC matching of some of their entries only.
+   */
+  PublishedAudioCapabilitiesBuilder snk_pac_builder, src_pac_builder;
+  for (auto context : contexts) {
+    for (const auto* conf :
+         *::le_audio::AudioSetConfigurationProvider::Get()->GetConfigurations(
+             context)) {
+      for (const auto& entry : conf->confs) {
+        auto sampling_frequency = entry.codec.GetSamplingFrequencyHz();
+        if (entry.direction == kLeAudioDirectionSink) {
+          if (sampling_frequency < 48000) snk_pac_builder.Add(entry.codec, 1);
+        } else {
+          if (sampling_frequency == 16000) src_pac_builder.Add(entry.codec, 1);
+        }
+      }
+    }
+  }
+
+  std::vector<LeAudioDevice*> devices;
+  for (int i = 0; i < 4; i++) {
+    auto* device = AddTestDevice(2, 1);
+    device->snk_pacs_ = snk_pac_builder.Get();
+    device->src_pacs_ = src_pac_builder.Get();
+    devices.push_back(device);
+  }
+  ASSERT_EQ(4, group_->Size());
+  group_->UpdateAudioContextAvailability();
+
+  /* Reference selection, outside of the group */
+  std::map<LeAudioContextType, const AudioSetConfiguration*> expected;
+  for (auto context : contexts) {
+    expected[context] = FindFirstSupportedConfigurationPlain(group_, context);
+  }
+  ASSERT_NE(nullptr, expected[LeAudioContextType::MEDIA]);
+
+  /* Switching contexts back and forth selects the same configurations */
+  group_->InvalidateCachedConfigurations();
+  for (int round = 0; round < 100; round++) {
+    for (auto context : contexts) {
+      group_->UpdateAudioSetConfigurationCache(context);
+      ASSERT_EQ(expected[context], group_->GetCachedConfiguration(context));
+    }
+  }
+
+  /* PAC changes are taken into account on the next selection */
+  const LeAudioCodecId UnsupportedCodecId = {
+      .coding_format = kLeAudioCodingFormatVendorSpecific,
+      .vendor_company_id = 0xBAD,
+      .vendor_codec_id = 0xC0DE,
+  };
+  PublishedAudioCapabilitiesBuilder unsupported_pac_builder;
+  unsupported_pac_builder.Add(
+      UnsupportedCodecId, GetSamplingFrequency(Lc3SettingId::LC3_16_2),
+      GetFrameDuration(Lc3SettingId::LC3_16_2),
+      kLeAudioCodecChannelCountSingleChannel,
+      GetOctetsPerCodecFrame(Lc3SettingId::LC3_16_2));
+  for (auto* device : devices) {
+    device->snk_pacs_ = unsupported_pac_builder.Get();
+    device->src_pacs_ = unsupported_pac_builder.Get();
+  }
+  group_->UpdateAudioSetConfigurationCache(LeAudioContextType::MEDIA);
+  ASSERT_EQ(nullptr, FindFirstSupportedConfigurationPlain(
+                         group_, LeAudioContextType::MEDIA));
+  ASSERT_EQ(nullptr, group_->GetCachedConfiguration(LeAudioContextType::MEDIA));
+}
+
 /*
  * Failure happens when there is no matching single device scenario for dual
  * device scanario. Stereo location for single earbud seems to be invalid but
@@ -16,7 +16,12 @@
  */
 
 #include <base/logging.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include <chrono>
 #include <mutex>
 #include <string>
 #include <string_view>
@@ -43,42 +48,81 @@ using le_audio::types::LeAudioContextType;
 namespace le_audio {
 using ::le_audio::CodecManager;
 
+/* Each content file is loaded from its pre-compiled flatbuffer when
+ * available, and parsed from JSON with the binary schema otherwise.
+ */
+struct ContentFiles {
+  const char* binary;
+  const char* schema;
+  const char* json;
+};
+
 #ifdef __ANDROID__
-static const std::vector<
-    std::pair<const char* /*schema*/, const char* /*content*/>>
-    kLeAudioSetConfigs = {
-        {"/apex/com.android.btservices/etc/bluetooth/le_audio/"
-         "audio_set_configurations.bfbs",
-         "/apex/com.android.btservices/etc/bluetooth/le_audio/"
-         "audio_set_configurations.json"}};
-static const std::vector<
-    std::pair<const char* /*schema*/, const char* /*content*/>>
-    kLeAudioSetScenarios = {{"/apex/com.android.btservices/etc/bluetooth/"
-                             "le_audio/audio_set_scenarios.bfbs",
-                             "/apex/com.android.btservices/etc/bluetooth/"
-                             "le_audio/audio_set_scenarios.json"}};
+static const std::vector<ContentFiles> kLeAudioSetConfigs = {
+    {"/apex/com.android.btservices/etc/bluetooth/le_audio/"
+     "audio_set_configurations.bin",
+     "/apex/com.android.btservices/etc/bluetooth/le_audio/"
+     "audio_set_configurations.bfbs",
+     "/apex/com.android.btservices/etc/bluetooth/le_audio/"
+     "audio_set_configurations.json"}};
+static const std::vector<ContentFiles> kLeAudioSetScenarios = {
+    {"/apex/com.android.btservices/etc/bluetooth/le_audio/"
+     "audio_set_scenarios.bin",
+     "/apex/com.android.btservices/etc/bluetooth/le_audio/"
+     "audio_set_scenarios.bfbs",
+     "/apex/com.android.btservices/etc/bluetooth/le_audio/"
+     "audio_set_scenarios.json"}};
 #elif defined(TARGET_FLOSS)
-static const std::vector<
-    std::pair<const char* /*schema*/, const char* /*content*/>>
-    kLeAudioSetConfigs = {
-        {"/etc/bluetooth/le_audio/audio_set_configurations.bfbs",
-         "/etc/bluetooth/le_audio/audio_set_configurations.json"}};
-static const std::vector<
-    std::pair<const char* /*schema*/, const char* /*content*/>>
-    kLeAudioSetScenarios = {
-        {"/etc/bluetooth/le_audio/audio_set_scenarios.bfbs",
-         "/etc/bluetooth/le_audio/audio_set_scenarios.json"}};
+static const std::vector<ContentFiles> kLeAudioSetConfigs = {
+    {"/etc/bluetooth/le_audio/audio_set_configurations.bin",
+     "/etc/bluetooth/le_audio/audio_set_configurations.bfbs",
+     "/etc/bluetooth/le_audio/audio_set_configurations.json"}};
+static const std::vector<ContentFiles> kLeAudioSetScenarios = {
+    {"/etc/bluetooth/le_audio/audio_set_scenarios.bin",
+     "/etc/bluetooth/le_audio/audio_set_scenarios.bfbs",
+     "/etc/bluetooth/le_audio/audio_set_scenarios.json"}};
 #else
-static const std::vector<
-    std::pair<const char* /*schema*/, const char* /*content*/>>
-    kLeAudioSetConfigs = {
-        {"audio_set_configurations.bfbs", "audio_set_configurations.json"}};
-static const std::vector<
-    std::pair<const char* /*schema*/, const char* /*content*/>>
-    kLeAudioSetScenarios = {
-        {"audio_set_scenarios.bfbs", "audio_set_scenarios.json"}};
+static const std::vector<ContentFiles> kLeAudioSetConfigs = {
+    {"audio_set_configurations.bin", "audio_set_configurations.bfbs",
+     "audio_set_configurations.json"}};
+static const std::vector<ContentFiles> kLeAudioSetScenarios = {
+    {"audio_set_scenarios.bin", "audio_set_scenarios.bfbs",
+     "audio_set_scenarios.json"}};
 #endif
 
+/* Read-only memory mapping of a pre-compiled flatbuffer file */
+class MappedFile {
+ public:
+  explicit MappedFile(const char* path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        data_ = static_cast<const uint8_t*>(data);
+        size_ = st.st_size;
+      }
+    }
+    close(fd);
+  }
+
+  ~MappedFile() {
+    if (data_ != nullptr) munmap(const_cast<uint8_t*>(data_), size_);
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+};
+
 /** Provides a set configurations for the given context type */
 struct AudioSetConfigurationProviderJson {
   static constexpr auto kDefaultScenario = "Media";
@@ -86,8 +130,16 @@ struct AudioSetConfigurationProviderJson {
   AudioSetConfigurationProviderJson(types::CodecLocation location) {
     dual_bidirection_swb_supported_ = osi_property_get_bool(
         "bluetooth.leaudio.dual_bidirection_swb.supported", false);
+
+    auto load_start = std::chrono::steady_clock::now();
     ASSERT_LOG(LoadContent(kLeAudioSetConfigs, kLeAudioSetScenarios, location),
                ": Unable to load le audio set configuration files.");
+    load_duration_ = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - load_start);
+    LOG_INFO("Loaded %zu configurations from %s in %lld us",
+             configurations_.size(),
+             loaded_from_json_ ? "JSON" : "binary flatbuffers",
+             static_cast<long long>(load_duration_.count()));
   }
 
   /* Use the same scenario configurations for different contexts to avoid
@@ -171,6 +223,10 @@ struct AudioSetConfigurationProviderJson {
     return dual_bidirection_swb_supported_;
   }
 
+  std::chrono::microseconds GetLoadDuration() const { return load_duration_; }
+
+  bool IsLoadedFromJson() const { return loaded_from_json_; }
+
  private:
   /* Codec configurations */
   std::map<std::string, const AudioSetConfiguration> configurations_;
@@ -184,6 +240,10 @@ struct AudioSetConfigurationProviderJson {
    */
   bool dual_bidirection_swb_supported_;
 
+  /* Startup cost of the configuration loading */
+  std::chrono::microseconds load_duration_{0};
+  bool loaded_from_json_ = false;
+
   static const bluetooth::le_audio::CodecSpecificConfiguration*
   LookupCodecSpecificParam(
       const flatbuffers::Vector<
@@ -434,6 +494,21 @@ struct AudioSetConfigurationProviderJson {
     }
   }
 
+  bool LoadConfigurationsFromBinary(const char* binary_file,
+                                    types::CodecLocation location) {
+    MappedFile file(binary_file);
+    if (file.data() == nullptr) return false;
+
+    flatbuffers::Verifier verifier(file.data(), file.size());
+    if (!bluetooth::le_audio::VerifyAudioSetConfigurationsBuffer(verifier)) {
+      LOG_ERROR("Invalid configurations file %s", binary_file);
+      return false;
+    }
+
+    return LoadConfigurations(
+        bluetooth::le_audio::GetAudioSetConfigurations(file.data()), location);
+  }
+
   bool LoadConfigurationsFromFiles(const char* schema_file,
                                    const char* content_file,
                                    types::CodecLocation location) {
@@ -460,8 +535,15 @@ struct AudioSetConfigurationProviderJson {
     if (!ok) return ok;
 
     /* Import from flatbuffers */
-    auto configurations_root = bluetooth::le_audio::GetAudioSetConfigurations(
-        configurations_parser_.builder_.GetBufferPointer());
+    return LoadConfigurations(
+        bluetooth::le_audio::GetAudioSetConfigurations(
+            configurations_parser_.builder_.GetBufferPointer()),
+        location);
+  }
+
+  bool LoadConfigurations(
+      const bluetooth::le_audio::AudioSetConfigurations* configurations_root,
+      types::CodecLocation location) {
     if (!configurations_root) return false;
 
     auto flat_qos_configs = configurations_root->qos_configurations();
@@ -515,6 +597,20 @@ struct AudioSetConfigurationProviderJson {
     return items;
   }
 
+  bool LoadScenariosFromBinary(const char* binary_file) {
+    MappedFile file(binary_file);
+    if (file.data() == nullptr) return false;
+
+    flatbuffers::Verifier verifier(file.data(), file.size());
+    if (!bluetooth::le_audio::VerifyAudioSetScenariosBuffer(verifier)) {
+      LOG_ERROR("Invalid scenarios file %s", binary_file);
+      return false;
+    }
+
+    return LoadScenarios(
+        bluetooth::le_audio::GetAudioSetScenarios(file.data()));
+  }
+
   bool LoadScenariosFromFiles(const char* schema_file,
                               const char* content_file) {
     flatbuffers::Parser scenarios_parser_;
@@ -539,8 +635,12 @@ struct AudioSetConfigurationProviderJson {
     if (!ok) return ok;
 
     /* Import from flatbuffers */
-    auto scenarios_root = bluetooth::le_audio::GetAudioSetScenarios(
-        scenarios_parser_.builder_.GetBufferPointer());
+    return LoadScenarios(bluetooth::le_audio::GetAudioSetScenarios(
+        scenarios_parser_.builder_.GetBufferPointer()));
+  }
+
+  bool LoadScenarios(
+      const bluetooth::le_audio::AudioSetScenarios* scenarios_root) {
     if (!scenarios_root) return false;
 
     auto flat_scenarios = scenarios_root->scenarios();
@@ -566,18 +666,25 @@ struct AudioSetConfigurationProviderJson {
     return true;
   }
 
-  bool LoadContent(
-      std::vector<std::pair<const char* /*schema*/, const char* /*content*/>>
-          config_files,
-      std::vector<std::pair<const char* /*schema*/, const char* /*content*/>>
-          scenario_files,
-      types::CodecLocation location) {
-    for (auto [schema, content] : config_files) {
-      if (!LoadConfigurationsFromFiles(schema, content, location)) return false;
+  bool LoadContent(const std::vector<ContentFiles>& config_files,
+                   const std::vector<ContentFiles>& scenario_files,
+                   types::CodecLocation location) {
+    for (auto const& files : config_files) {
+      if (LoadConfigurationsFromBinary(files.binary, location)) continue;
+
+      /* Fall back to parsing the JSON content */
+      LOG_WARN("Unable to load %s, parsing %s", files.binary, files.json);
+      loaded_from_json_ = true;
+      if (!LoadConfigurationsFromFiles(files.schema, files.json, location))
+        return false;
     }
 
-    for (auto [schema, content] : scenario_files) {
-      if (!LoadScenariosFromFiles(schema, content)) return false;
+    for (auto const& files : scenario_files) {
+      if (LoadScenariosFromBinary(files.binary)) continue;
+
+      LOG_WARN("Unable to load %s, parsing %s", files.binary, files.json);
+      loaded_from_json_ = true;
+      if (!LoadScenariosFromFiles(files.schema, files.json)) return false;
     }
     return true;
   }
@@ -603,6 +710,12 @@ struct AudioSetConfigurationProvider::impl {
   void Dump(int fd) {
     std::stringstream stream;
 
+    stream << "  Loaded from "
+           << (config_provider_impl_->IsLoadedFromJson() ? "JSON"
+                                                         : "binary flatbuffers")
+           << " in " << config_provider_impl_->GetLoadDuration().count()
+           << " us\n";
+
     for (LeAudioContextType context : types::kLeAudioContextAllTypesArray) {
       auto confs = Get()->GetConfigurations(context);
       stream << "\n  === Configurations for context type: " << (int)context
@@ -0,0 +1,201 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "le_audio_set_configuration_provider.h"
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "le_audio_types.h"
+
+using le_audio::AudioSetConfigurationProvider;
+using le_audio::set_configurations::AudioSetConfiguration;
+using le_audio::types::LeAudioContextType;
+
+namespace {
+constexpr const char* kConfigurationsBinary = "audio_set_configurations.bin";
+constexpr const char* kScenariosBinary = "audio_set_scenarios.bin";
+constexpr const char* kContentFiles[] = {
+    "audio_set_configurations.bfbs", "audio_set_configurations.json",
+    "audio_set_scenarios.bfbs", "audio_set_scenarios.json"};
+
+using ContextConfigurations =
+    std::map<LeAudioContextType, std::vector<AudioSetConfiguration>>;
+
+ContextConfigurations get_all_configurations() {
+  ContextConfigurations configurations;
+  for (LeAudioContextType context :
+       le_audio::types::kLeAudioContextAllTypesArray) {
+    auto confs =
+        AudioSetConfigurationProvider::Get()->GetConfigurations(context);
+    if (confs == nullptr) continue;
+    for (auto conf : *confs) configurations[context].push_back(*conf);
+  }
+  return configurations;
+}
+
+void expect_same_configurations(const ContextConfigurations& expected,
+                                const ContextConfigurations& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  for (auto const& [context, expected_confs] : expected) {
+    ASSERT_EQ(1u, actual.count(context));
+    auto const& actual_confs = actual.at(context);
+    ASSERT_EQ(expected_confs.size(), actual_confs.size());
+
+    for (size_t i = 0; i < expected_confs.size(); i++) {
+      auto const& lhs = expected_confs[i];
+      auto const& rhs = actual_confs[i];
+      ASSERT_EQ(lhs.name, rhs.name);
+      ASSERT_EQ(lhs.confs.size(), rhs.confs.size()) << lhs.name;
+
+      for (size_t j = 0; j < lhs.confs.size(); j++) {
+        auto const& a = lhs.confs[j];
+        auto const& b = rhs.confs[j];
+        EXPECT_EQ(a.direction, b.direction) << lhs.name;
+        EXPECT_EQ(a.device_cnt, b.device_cnt) << lhs.name;
+        EXPECT_EQ(a.ase_cnt, b.ase_cnt) << lhs.name;
+        EXPECT_EQ(a.strategy, b.strategy) << lhs.name;
+        EXPECT_EQ(a.codec.id, b.codec.id) << lhs.name;
+        EXPECT_EQ(a.codec.params.Values(), b.codec.params.Values())
+            << lhs.name;
+        EXPECT_EQ(a.codec.channel_count_per_iso_stream,
+                  b.codec.channel_count_per_iso_stream)
+            << lhs.name;
+        EXPECT_EQ(a.qos.target_latency, b.qos.target_latency) << lhs.name;
+        EXPECT_EQ(a.qos.retransmission_number, b.qos.retransmission_number)
+            << lhs.name;
+        EXPECT_EQ(a.qos.max_transport_latency, b.qos.max_transport_latency)
+            << lhs.name;
+      }
+    }
+  }
+}
+
+/* Returns the "Loaded from ..." line of the provider dump */
+std::string get_load_report() {
+  char* buffer = nullptr;
+  size_t size = 0;
+  FILE* stream = open_memstream(&buffer, &size);
+  AudioSetConfigurationProvider::DebugDump(fileno(stream));
+  fclose(stream);
+
+  std::string dump(buffer, size);
+  free(buffer);
+  size_t begin = dump.find("Loaded from ");
+  if (begin == std::string::npos) return "";
+  return dump.substr(begin, dump.find('\n', begin) - begin);
+}
+}  // namespace
+
+/* The content files are looked up in the working directory. Each test
+ * loads them from a copy, without or with altered pre-compiled files.
+ */
+class AudioSetConfigurationProviderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    data_dir_ = std::filesystem::current_path();
+    std::string dir_template =
+        (std::filesystem::temp_directory_path() / "leaudioXXXXXX").string();
+    ASSERT_NE(nullptr, mkdtemp(dir_template.data()));
+    dir_ = dir_template;
+    for (auto file : kContentFiles) {
+      std::filesystem::copy_file(data_dir_ / file, dir_ / file);
+    }
+  }
+
+  void TearDown() override {
+    AudioSetConfigurationProvider::Cleanup();
+    std::filesystem::current_path(data_dir_);
+    std::filesystem::remove_all(dir_);
+  }
+
+  /* Loads the content files of the directory, returning the configurations
+   * of all the context types.
+   */
+  ContextConfigurations Load(const std::filesystem::path& dir) {
+    AudioSetConfigurationProvider::Cleanup();
+    std::filesystem::current_path(dir);
+    AudioSetConfigurationProvider::Initialize(
+        le_audio::types::CodecLocation::HOST);
+    std::filesystem::current_path(data_dir_);
+    return get_all_configurations();
+  }
+
+  std::filesystem::path data_dir_;
+  std::filesystem::path dir_;
+};
+
+TEST_F(AudioSetConfigurationProviderTest, binary_and_json_are_equivalent) {
+  ContextConfigurations from_binary = Load(data_dir_);
+  std::string binary_report = get_load_report();
+  ASSERT_EQ(0u, binary_report.rfind("Loaded from binary flatbuffers", 0))
+      << binary_report;
+  ASSERT_FALSE(from_binary.empty());
+
+  ContextConfigurations from_json = Load(dir_);
+  std::string json_report = get_load_report();
+  ASSERT_EQ(0u, json_report.rfind("Loaded from JSON", 0)) << json_report;
+
+  expect_same_configurations(from_binary, from_json);
+  RecordProperty("binary_load", binary_report);
+  RecordProperty("json_load", json_report);
+}
+
+TEST_F(AudioSetConfigurationProviderTest, corrupt_binary_falls_back_to_json) {
+  ContextConfigurations expected = Load(data_dir_);
+
+  std::vector<char> bytes(
+      std::filesystem::file_size(data_dir_ / kConfigurationsBinary));
+  std::ifstream(data_dir_ / kConfigurationsBinary, std::ios::binary)
+      .read(bytes.data(), bytes.size());
+  std::filesystem::copy_file(data_dir_ / kScenariosBinary,
+                             dir_ / kScenariosBinary);
+  auto write_binary = [&](const std::vector<char>& content) {
+    std::ofstream(dir_ / kConfigurationsBinary,
+                  std::ios::binary | std::ios::trunc)
+        .write(content.data(), content.size());
+  };
+
+  // Root table offset out of the buffer
+  std::vector<char> corrupt = bytes;
+  corrupt[3] = 0x7f;
+  write_binary(corrupt);
+  expect_same_configurations(expected, Load(dir_));
+  ASSERT_EQ(0u, get_load_report().rfind("Loaded from JSON", 0));
+
+  // Truncated
+  corrupt = std::vector<char>(bytes.begin(), bytes.begin() + bytes.size() / 2);
+  write_binary(corrupt);
+  expect_same_configurations(expected, Load(dir_));
+  ASSERT_EQ(0u, get_load_report().rfind("Loaded from JSON", 0));
+
+  // Empty
+  write_binary({});
+  expect_same_configurations(expected, Load(dir_));
+  ASSERT_EQ(0u, get_load_report().rfind("Loaded from JSON", 0));
+
+  write_binary(bytes);
+  expect_same_configurations(expected, Load(dir_));
+  ASSERT_EQ(0u, get_load_report().rfind("Loaded from binary flatbuffers", 0));
+}
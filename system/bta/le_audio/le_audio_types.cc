@@ -46,7 +46,7 @@ static uint8_t min_req_devices_cnt(
     const AudioSetConfiguration* audio_set_conf) {
   std::pair<uint8_t /* sink */, uint8_t /* source */> snk_src_pair(0, 0);
 
-  for (auto ent : (*audio_set_conf).confs) {
+  for (const auto& ent : (*audio_set_conf).confs) {
     if (ent.direction == kLeAudioDirectionSink)
       snk_src_pair.first += ent.device_cnt;
     if (ent.direction == kLeAudioDirectionSource)
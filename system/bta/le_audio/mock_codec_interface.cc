@@ -16,14 +16,23 @@
 
 #include "mock_codec_interface.h"
 
+static MockCodecInterface::MockInstanceHook mock_instance_hook;
+
+void MockCodecInterface::RegisterMockInstanceHook(MockInstanceHook hook) {
+  mock_instance_hook = std::move(hook);
+}
+
 namespace le_audio {
 
 struct CodecInterface::Impl : public MockCodecInterface {
  public:
   Impl(const types::LeAudioCodecId& codec_id) {
     output_channel_data_.resize(1);
+    if (mock_instance_hook) mock_instance_hook(this, false);
   };
-  ~Impl() = default;
+  ~Impl() {
+    if (mock_instance_hook) mock_instance_hook(this, true);
+  }
 
   std::vector<int16_t>& GetDecodedSamples() { return output_channel_data_; }
   std::vector<int16_t> output_channel_data_;
@@ -56,6 +65,12 @@ CodecInterface::Status CodecInterface::Encode(const uint8_t* data, int stride,
                                               uint16_t out_offset) {
   return impl->Encode(data, stride, out_size, out_buffer, out_offset);
 }
+CodecInterface::Status CodecInterface::EncodeInto(const uint8_t* data,
+                                                  int stride,
+                                                  uint16_t out_size,
+                                                  uint8_t* out_buffer) {
+  return impl->EncodeInto(data, stride, out_size, out_buffer);
+}
 void CodecInterface::Cleanup() { return impl->Cleanup(); }
 
 uint16_t CodecInterface::GetNumOfSamplesPerChannel() {
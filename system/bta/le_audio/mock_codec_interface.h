@@ -18,6 +18,7 @@
 
 #include <gmock/gmock.h>
 
+#include <functional>
 #include <vector>
 
 #include "codec_interface.h"
@@ -30,6 +31,13 @@ class MockCodecInterface {
 
   virtual ~MockCodecInterface() = default;
 
+  /* Called with each codec instance on creation, and with is_destroyed set
+   * before its destruction, so that tests can set expectations on it.
+   */
+  using MockInstanceHook =
+      std::function<void(MockCodecInterface*, bool is_destroyed)>;
+  static void RegisterMockInstanceHook(MockInstanceHook hook);
+
   MOCK_METHOD((le_audio::CodecInterface::Status), InitEncoder,
               (const le_audio::LeAudioCodecConfiguration& pcm_config,
                const le_audio::LeAudioCodecConfiguration& codec_config));
@@ -39,6 +47,9 @@ class MockCodecInterface {
   MOCK_METHOD(le_audio::CodecInterface::Status, Encode,
               (const uint8_t* data, int stride, uint16_t out_size,
                std::vector<int16_t>* out_buffer, uint16_t out_offset));
+  MOCK_METHOD(le_audio::CodecInterface::Status, EncodeInto,
+              (const uint8_t* data, int stride, uint16_t out_size,
+               uint8_t* out_buffer));
   MOCK_METHOD(le_audio::CodecInterface::Status, Decode,
               (uint8_t * data, uint16_t size));
   MOCK_METHOD((void), Cleanup, ());
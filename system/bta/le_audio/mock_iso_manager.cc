@@ -100,6 +100,16 @@ void IsoManager::SendIsoData(uint16_t iso_handle, const uint8_t* data,
   pimpl_->SendIsoData(iso_handle, data, data_len);
 }
 
+BT_HDR* IsoManager::AllocateIsoSdu(uint16_t iso_handle, uint16_t data_len) {
+  if (!pimpl_) return nullptr;
+  return pimpl_->AllocateIsoSdu(iso_handle, data_len);
+}
+
+void IsoManager::SendIsoSdu(BT_HDR* sdu) {
+  if (!pimpl_) return;
+  pimpl_->SendIsoSdu(sdu);
+}
+
 void IsoManager::CreateBig(uint8_t big_id,
                            struct iso_manager::big_create_params big_params) {
   if (!pimpl_) return;
@@ -58,6 +58,9 @@ struct MockIsoManager {
               (uint16_t iso_handle, uint8_t data_path_dir));
   MOCK_METHOD((void), SendIsoData,
               (uint16_t iso_handle, const uint8_t* data, uint16_t data_len));
+  MOCK_METHOD((BT_HDR*), AllocateIsoSdu,
+              (uint16_t iso_handle, uint16_t data_len));
+  MOCK_METHOD((void), SendIsoSdu, (BT_HDR * sdu));
   MOCK_METHOD((void), ReadIsoLinkQuality, (uint16_t iso_handle));
   MOCK_METHOD(
       (void), CreateBig,
@@ -0,0 +1,394 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "bta/include/bta_gatt_api.h"
+#include "bta/include/bta_gatt_queue.h"
+#include "test/common/mock_functions.h"
+#include "test/mock/mock_stack_gatt_api.h"
+
+namespace {
+constexpr uint16_t kConnId = 0x0001;
+
+struct read_request {
+  uint16_t handle;
+  GATT_READ_OP_CB cb;
+  void* cb_data;
+};
+
+struct read_multi_request {
+  tBTA_GATTC_MULTI handles;
+  bool variable_len;
+  GATT_READ_MULTI_OP_CB cb;
+  void* cb_data;
+};
+
+struct write_request {
+  uint16_t handle;
+  GATT_WRITE_OP_CB cb;
+  void* cb_data;
+};
+
+struct read_result {
+  tGATT_STATUS status;
+  uint16_t handle;
+  std::vector<uint8_t> value;
+};
+
+std::deque<read_request> read_requests;
+std::deque<read_multi_request> read_multi_requests;
+std::deque<write_request> write_requests;
+std::vector<read_result> read_results;
+
+void read_cb(uint16_t /* conn_id */, tGATT_STATUS status, uint16_t handle,
+             uint16_t len, uint8_t* value, void* /* data */) {
+  read_results.push_back(
+      {status, handle, std::vector<uint8_t>(value, value + len)});
+}
+}  // namespace
+
+void BTA_GATTC_ReadCharacteristic(uint16_t /* conn_id */, uint16_t handle,
+                                  tGATT_AUTH_REQ /* auth_req */,
+                                  GATT_READ_OP_CB callback, void* cb_data) {
+  inc_func_call_count(__func__);
+  read_requests.push_back({handle, callback, cb_data});
+}
+
+void BTA_GATTC_ReadCharDescr(uint16_t /* conn_id */, uint16_t handle,
+                             tGATT_AUTH_REQ /* auth_req */,
+                             GATT_READ_OP_CB callback, void* cb_data) {
+  inc_func_call_count(__func__);
+  read_requests.push_back({handle, callback, cb_data});
+}
+
+void BTA_GATTC_ReadMultiple(uint16_t /* conn_id */, tBTA_GATTC_MULTI& handles,
+                            bool variable_len, tGATT_AUTH_REQ /* auth_req */,
+                            GATT_READ_MULTI_OP_CB callback, void* cb_data) {
+  inc_func_call_count(__func__);
+  read_multi_requests.push_back({handles, variable_len, callback, cb_data});
+}
+
+void BTA_GATTC_WriteCharValue(uint16_t /* conn_id */, uint16_t handle,
+                              tGATT_WRITE_TYPE /* write_type */,
+                              std::vector<uint8_t> /* value */,
+                              tGATT_AUTH_REQ /* auth_req */,
+                              GATT_WRITE_OP_CB callback, void* cb_data) {
+  inc_func_call_count(__func__);
+  write_requests.push_back({handle, callback, cb_data});
+}
+
+void BTA_GATTC_WriteCharDescr(uint16_t /* conn_id */, uint16_t /* handle */,
+                              std::vector<uint8_t> /* value */,
+                              tGATT_AUTH_REQ /* auth_req */,
+                              GATT_WRITE_OP_CB /* callback */,
+                              void* /* cb_data */) {
+  inc_func_call_count(__func__);
+}
+
+void BTA_GATTC_ConfigureMTU(uint16_t /* conn_id */, uint16_t /* mtu */,
+                            GATT_CONFIGURE_MTU_OP_CB /* callback */,
+                            void* /* cb_data */) {
+  inc_func_call_count(__func__);
+}
+
+class BtaGattQueueTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    reset_mock_function_count_map();
+    read_requests.clear();
+    read_multi_requests.clear();
+    write_requests.clear();
+    read_results.clear();
+    test::mock::stack_gatt_api::GATTC_GetReadMultiVariableMtu.body =
+        [](uint16_t /* conn_id */) { return 247; };
+  }
+
+  void TearDown() override {
+    // Completes the requests left to free their callback data.
+    while (!read_requests.empty() || !read_multi_requests.empty() ||
+           !write_requests.empty()) {
+      if (!read_requests.empty()) CompleteRead(GATT_ERROR, {});
+      if (!read_multi_requests.empty()) CompleteReadMultiple(GATT_ERROR, {});
+      if (!write_requests.empty()) CompleteWrite(GATT_ERROR);
+    }
+    BtaGattQueue::Clean(kConnId);
+    test::mock::stack_gatt_api::GATTC_GetReadMultiVariableMtu = {};
+    test::mock::stack_gatt_api::GATTC_IsEattBearerAvailable = {};
+    test::mock::stack_gatt_api::GATTC_GetNumEattBearers = {};
+  }
+
+  void CompleteRead(tGATT_STATUS status, std::vector<uint8_t> value) {
+    read_request request = read_requests.front();
+    read_requests.pop_front();
+    request.cb(kConnId, status, request.handle, value.size(), value.data(),
+               request.cb_data);
+  }
+
+  void CompleteReadMultiple(tGATT_STATUS status, std::vector<uint8_t> value) {
+    read_multi_request request = read_multi_requests.front();
+    read_multi_requests.pop_front();
+    request.cb(kConnId, status, request.handles, value.size(), value.data(),
+               request.cb_data);
+  }
+
+  void CompleteWrite(tGATT_STATUS status) {
+    write_request request = write_requests.front();
+    write_requests.pop_front();
+    request.cb(kConnId, status, request.handle, 0, nullptr, request.cb_data);
+  }
+
+  void WriteCharacteristics(uint16_t first_handle, uint16_t last_handle) {
+    for (uint16_t handle = first_handle; handle <= last_handle; handle++) {
+      BtaGattQueue::WriteCharacteristic(kConnId, handle, {0x01},
+                                        GATT_WRITE, nullptr, nullptr);
+    }
+  }
+
+  // Number of ATT requests sent to the server.
+  int RoundTrips() {
+    return get_func_call_count("BTA_GATTC_ReadCharacteristic") +
+           get_func_call_count("BTA_GATTC_ReadCharDescr") +
+           get_func_call_count("BTA_GATTC_ReadMultiple");
+  }
+};
+
+TEST_F(BtaGattQueueTest, coalesce_pending_reads) {
+  for (uint16_t handle = 0x0010; handle < 0x0016; handle++) {
+    BtaGattQueue::ReadCharacteristic(kConnId, handle, read_cb, nullptr);
+  }
+  BtaGattQueue::ReadDescriptor(kConnId, 0x0020, read_cb, nullptr);
+
+  // The first read is sent right away, the others are queued meanwhile.
+  ASSERT_EQ(1UL, read_requests.size());
+  CompleteRead(GATT_SUCCESS, {0x01});
+
+  ASSERT_EQ(1UL, read_multi_requests.size());
+  ASSERT_TRUE(read_multi_requests.front().variable_len);
+  ASSERT_EQ(6, read_multi_requests.front().handles.num_attr);
+  ASSERT_EQ(0x0011, read_multi_requests.front().handles.handles[0]);
+  ASSERT_EQ(0x0020, read_multi_requests.front().handles.handles[5]);
+
+  CompleteReadMultiple(GATT_SUCCESS, {0x01, 0x00, 0x11, 0x02, 0x00, 0x12, 0x12,
+                                      0x00, 0x00, 0x01, 0x00, 0x14, 0x01, 0x00,
+                                      0x15, 0x01, 0x00, 0x20});
+
+  ASSERT_EQ(7UL, read_results.size());
+  ASSERT_EQ(0x0011, read_results[1].handle);
+  ASSERT_EQ(std::vector<uint8_t>({0x11}), read_results[1].value);
+  ASSERT_EQ(std::vector<uint8_t>({0x12, 0x12}), read_results[2].value);
+  ASSERT_TRUE(read_results[3].value.empty());
+  ASSERT_EQ(0x0020, read_results[6].handle);
+  ASSERT_EQ(std::vector<uint8_t>({0x20}), read_results[6].value);
+  for (auto& result : read_results) ASSERT_EQ(GATT_SUCCESS, result.status);
+
+  // 7 reads in 2 round trips.
+  ASSERT_EQ(2, RoundTrips());
+  ASSERT_TRUE(read_requests.empty());
+}
+
+TEST_F(BtaGattQueueTest, coalesce_within_mtu_budget) {
+  test::mock::stack_gatt_api::GATTC_GetReadMultiVariableMtu.body =
+      [](uint16_t /* conn_id */) { return 23; };
+
+  for (uint16_t handle = 0x0010; handle < 0x0016; handle++) {
+    BtaGattQueue::ReadCharacteristic(kConnId, handle, read_cb, nullptr);
+  }
+  CompleteRead(GATT_SUCCESS, {});
+
+  ASSERT_EQ(1UL, read_multi_requests.size());
+  ASSERT_EQ(2, read_multi_requests.front().handles.num_attr);
+}
+
+TEST_F(BtaGattQueueTest, truncated_values_are_read_again) {
+  for (uint16_t handle = 0x0010; handle < 0x0014; handle++) {
+    BtaGattQueue::ReadCharacteristic(kConnId, handle, read_cb, nullptr);
+  }
+  CompleteRead(GATT_SUCCESS, {});
+
+  // The value of 0x0012 is truncated, and 0x0013 is missing.
+  CompleteReadMultiple(GATT_SUCCESS,
+                       {0x01, 0x00, 0x11, 0x08, 0x00, 0x12, 0x12, 0x12});
+  ASSERT_EQ(2UL, read_results.size());
+
+  ASSERT_EQ(1UL, read_requests.size());
+  ASSERT_EQ(0x0012, read_requests.front().handle);
+  CompleteRead(GATT_SUCCESS, std::vector<uint8_t>(8, 0x12));
+
+  ASSERT_EQ(1UL, read_requests.size());
+  ASSERT_EQ(0x0013, read_requests.front().handle);
+  CompleteRead(GATT_SUCCESS, {0x13});
+
+  ASSERT_EQ(4UL, read_results.size());
+  ASSERT_EQ(0x0012, read_results[2].handle);
+  ASSERT_EQ(8UL, read_results[2].value.size());
+  ASSERT_EQ(0x0013, read_results[3].handle);
+}
+
+TEST_F(BtaGattQueueTest, read_multiple_not_supported) {
+  for (uint16_t handle = 0x0010; handle < 0x0013; handle++) {
+    BtaGattQueue::ReadCharacteristic(kConnId, handle, read_cb, nullptr);
+  }
+  CompleteRead(GATT_SUCCESS, {});
+  CompleteReadMultiple(GATT_REQ_NOT_SUPPORTED, {});
+
+  // Reads are executed individually from now on.
+  BtaGattQueue::ReadCharacteristic(kConnId, 0x0020, read_cb, nullptr);
+  for (uint16_t handle : {0x0011, 0x0012, 0x0020}) {
+    ASSERT_EQ(1UL, read_requests.size());
+    ASSERT_EQ(handle, read_requests.front().handle);
+    CompleteRead(GATT_SUCCESS, {});
+  }
+
+  ASSERT_EQ(1, get_func_call_count("BTA_GATTC_ReadMultiple"));
+  ASSERT_EQ(4UL, read_results.size());
+}
+
+TEST_F(BtaGattQueueTest, server_not_supporting_read_multiple) {
+  test::mock::stack_gatt_api::GATTC_GetReadMultiVariableMtu.body =
+      [](uint16_t /* conn_id */) { return 0; };
+
+  for (uint16_t handle = 0x0010; handle < 0x0013; handle++) {
+    BtaGattQueue::ReadCharacteristic(kConnId, handle, read_cb, nullptr);
+  }
+  while (!read_requests.empty()) CompleteRead(GATT_SUCCESS, {});
+
+  ASSERT_EQ(0, get_func_call_count("BTA_GATTC_ReadMultiple"));
+  ASSERT_EQ(3, RoundTrips());
+}
+
+TEST_F(BtaGattQueueTest, same_attribute_reads_are_not_coalesced) {
+  BtaGattQueue::ReadCharacteristic(kConnId, 0x0010, read_cb, nullptr);
+  BtaGattQueue::ReadCharacteristic(kConnId, 0x0011, read_cb, nullptr);
+  BtaGattQueue::ReadCharacteristic(kConnId, 0x0011, read_cb, nullptr);
+  BtaGattQueue::ReadCharacteristic(kConnId, 0x0012, read_cb, nullptr);
+  CompleteRead(GATT_SUCCESS, {});
+
+  ASSERT_EQ(1UL, read_multi_requests.size());
+  ASSERT_EQ(2, read_multi_requests.front().handles.num_attr);
+  ASSERT_EQ(0x0011, read_multi_requests.front().handles.handles[0]);
+  ASSERT_EQ(0x0012, read_multi_requests.front().handles.handles[1]);
+
+  CompleteReadMultiple(GATT_SUCCESS, {0x00, 0x00, 0x00, 0x00});
+  ASSERT_EQ(1UL, read_requests.size());
+  ASSERT_EQ(0x0011, read_requests.front().handle);
+}
+
+TEST_F(BtaGattQueueTest, no_eatt_executes_one_op_at_a_time) {
+  WriteCharacteristics(0x0010, 0x0013);
+
+  for (uint16_t handle = 0x0010; handle <= 0x0013; handle++) {
+    ASSERT_EQ(1UL, write_requests.size());
+    ASSERT_EQ(handle, write_requests.front().handle);
+    CompleteWrite(GATT_SUCCESS);
+  }
+  ASSERT_TRUE(write_requests.empty());
+  ASSERT_EQ(4, get_func_call_count("BTA_GATTC_WriteCharValue"));
+}
+
+TEST_F(BtaGattQueueTest, one_op_per_eatt_bearer) {
+  // The operations are posted to BTA: the stack still sees the EATT bearers
+  // idle while the dispatched operations did not start.
+  test::mock::stack_gatt_api::GATTC_IsEattBearerAvailable.body =
+      [](uint16_t /* conn_id */) { return true; };
+  test::mock::stack_gatt_api::GATTC_GetNumEattBearers.body =
+      [](uint16_t /* conn_id */) { return 2; };
+
+  WriteCharacteristics(0x0010, 0x0014);
+  ASSERT_EQ(2UL, write_requests.size());
+
+  CompleteWrite(GATT_SUCCESS);
+  ASSERT_EQ(2UL, write_requests.size());
+  ASSERT_EQ(0x0012, write_requests.back().handle);
+
+  // The other client requests keep the EATT bearers busy.
+  test::mock::stack_gatt_api::GATTC_IsEattBearerAvailable.body =
+      [](uint16_t /* conn_id */) { return false; };
+  CompleteWrite(GATT_SUCCESS);
+  CompleteWrite(GATT_SUCCESS);
+  ASSERT_EQ(1UL, write_requests.size());
+  ASSERT_EQ(0x0013, write_requests.front().handle);
+
+  CompleteWrite(GATT_SUCCESS);
+  CompleteWrite(GATT_SUCCESS);
+  ASSERT_TRUE(write_requests.empty());
+  ASSERT_EQ(5, get_func_call_count("BTA_GATTC_WriteCharValue"));
+}
+
+TEST_F(BtaGattQueueTest, coalesce_known_value_lengths) {
+  test::mock::stack_gatt_api::GATTC_GetReadMultiVariableMtu.body =
+      [](uint16_t /* conn_id */) { return 0; };
+  for (uint16_t handle = 0x0010; handle < 0x0018; handle++) {
+    BtaGattQueue::ReadCharacteristic(kConnId, handle, read_cb, nullptr);
+  }
+  while (!read_requests.empty()) CompleteRead(GATT_SUCCESS, {0x01});
+
+  // The 1 octet values read fit 7 Length Value Tuples in the response.
+  test::mock::stack_gatt_api::GATTC_GetReadMultiVariableMtu.body =
+      [](uint16_t /* conn_id */) { return 23; };
+  for (uint16_t handle = 0x0010; handle < 0x0018; handle++) {
+    BtaGattQueue::ReadCharacteristic(kConnId, handle, read_cb, nullptr);
+  }
+  CompleteRead(GATT_SUCCESS, {0x01});
+
+  ASSERT_EQ(1UL, read_multi_requests.size());
+  ASSERT_EQ(7, read_multi_requests.front().handles.num_attr);
+}
+
+TEST_F(BtaGattQueueTest, truncated_value_length_is_learned) {
+  test::mock::stack_gatt_api::GATTC_GetReadMultiVariableMtu.body =
+      [](uint16_t /* conn_id */) { return 23; };
+
+  for (uint16_t handle = 0x0010; handle < 0x0013; handle++) {
+    BtaGattQueue::ReadCharacteristic(kConnId, handle, read_cb, nullptr);
+  }
+  CompleteRead(GATT_SUCCESS, {});
+  CompleteReadMultiple(GATT_SUCCESS, {0x00, 0x00, 0x20, 0x00, 0x12, 0x12});
+  ASSERT_EQ(0x0012, read_requests.front().handle);
+  CompleteRead(GATT_SUCCESS, std::vector<uint8_t>(32, 0x12));
+
+  // The 32 octets value of 0x0012 does not fit with the others anymore.
+  for (uint16_t handle = 0x0010; handle < 0x0014; handle++) {
+    BtaGattQueue::ReadCharacteristic(kConnId, handle, read_cb, nullptr);
+  }
+  CompleteRead(GATT_SUCCESS, {});
+
+  ASSERT_EQ(1UL, read_multi_requests.size());
+  ASSERT_EQ(2, read_multi_requests.front().handles.num_attr);
+  ASSERT_EQ(0x0011, read_multi_requests.front().handles.handles[0]);
+  ASSERT_EQ(0x0013, read_multi_requests.front().handles.handles[1]);
+}
+
+TEST_F(BtaGattQueueTest, read_multiple_error_is_remembered) {
+  for (uint16_t handle = 0x0010; handle < 0x0013; handle++) {
+    BtaGattQueue::ReadCharacteristic(kConnId, handle, read_cb, nullptr);
+  }
+  CompleteRead(GATT_SUCCESS, {});
+  CompleteReadMultiple(GATT_INSUF_AUTHENTICATION, {});
+
+  // The reads are not coalesced again on this connection.
+  for (uint16_t handle = 0x0020; handle < 0x0023; handle++) {
+    BtaGattQueue::ReadCharacteristic(kConnId, handle, read_cb, nullptr);
+  }
+  while (!read_requests.empty()) CompleteRead(GATT_SUCCESS, {});
+
+  ASSERT_EQ(1, get_func_call_count("BTA_GATTC_ReadMultiple"));
+  ASSERT_EQ(6UL, read_results.size());
+}
@@ -27,6 +27,8 @@
 #include "osi/include/allocator.h"
 #include "stack/gatt/gatt_int.h"
 #include "test/common/mock_functions.h"
+#include "test/mock/mock_osi_allocator.h"
+#include "test/mock/mock_stack_gatt_api.h"
 
 namespace param {
 struct {
@@ -297,3 +299,113 @@ TEST_F(BtaGattTest, bta_gattc_op_cmpl_read_interrupted) {
   bta_gattc_op_cmpl(&client_channel_control_block, &data);
   ASSERT_EQ(GATT_ERROR, param::bta_gatt_read_complete_callback.status);
 }
+
+class BtaGattEattTest : public BtaGattTest {
+ protected:
+  void SetUp() override {
+    BtaGattTest::SetUp();
+    test::mock::osi_allocator::osi_free_and_reset.body = [](void** p_ptr) {
+      *p_ptr = nullptr;
+    };
+    test::mock::stack_gatt_api::GATTC_IsEattBearerAvailable.body =
+        [](uint16_t /* conn_id */) { return true; };
+
+    command_queue = ReadCommand(123);
+    eatt_command = ReadCommand(2);
+    client_channel_control_block.state = BTA_GATTC_CONN_ST;
+    client_channel_control_block.p_q_cmd = &command_queue;
+  }
+
+  void TearDown() override {
+    test::mock::osi_allocator::osi_free_and_reset = {};
+    test::mock::stack_gatt_api::GATTC_IsEattBearerAvailable = {};
+    BtaGattTest::TearDown();
+  }
+
+  tBTA_GATTC_DATA ReadCommand(uint16_t handle) {
+    return {
+        .api_read =
+            {
+                .hdr =
+                    {
+                        .event = BTA_GATTC_API_READ_EVT,
+                    },
+                .handle = handle,
+                .read_cb = bta_gatt_read_complete_callback,
+                .read_cb_data = static_cast<void*>(this),
+            },
+    };
+  }
+
+  tBTA_GATTC_DATA eatt_command;
+};
+
+TEST_F(BtaGattEattTest, bta_gattc_enqueue_on_eatt_bearer) {
+  ASSERT_EQ(ENQUEUED_READY_TO_SEND,
+            bta_gattc_enqueue(&client_channel_control_block, &eatt_command));
+  ASSERT_EQ(1UL, client_channel_control_block.p_q_cmd_eatt.size());
+  ASSERT_TRUE(
+      bta_gattc_is_data_queued(&client_channel_control_block, &eatt_command));
+
+  // Same attribute as the command executing on an EATT bearer.
+  tBTA_GATTC_DATA same_handle_command = ReadCommand(2);
+  ASSERT_EQ(ENQUEUED_FOR_LATER, bta_gattc_enqueue(&client_channel_control_block,
+                                                  &same_handle_command));
+  ASSERT_EQ(1UL, client_channel_control_block.p_q_cmd_queue.size());
+
+  // Commands queued earlier are sent first.
+  tBTA_GATTC_DATA other_command = ReadCommand(3);
+  ASSERT_EQ(ENQUEUED_FOR_LATER,
+            bta_gattc_enqueue(&client_channel_control_block, &other_command));
+  ASSERT_EQ(2UL, client_channel_control_block.p_q_cmd_queue.size());
+  client_channel_control_block.p_q_cmd_queue.clear();
+}
+
+TEST_F(BtaGattEattTest, bta_gattc_enqueue_no_eatt_bearer) {
+  test::mock::stack_gatt_api::GATTC_IsEattBearerAvailable.body =
+      [](uint16_t /* conn_id */) { return false; };
+
+  ASSERT_EQ(ENQUEUED_FOR_LATER,
+            bta_gattc_enqueue(&client_channel_control_block, &eatt_command));
+  ASSERT_TRUE(client_channel_control_block.p_q_cmd_eatt.empty());
+  client_channel_control_block.p_q_cmd_queue.clear();
+}
+
+TEST_F(BtaGattEattTest, bta_gattc_op_cmpl_read_on_eatt_bearer) {
+  client_channel_control_block.p_q_cmd_eatt.push_back(&eatt_command);
+
+  tBTA_GATTC_DATA data = {
+      .op_cmpl =
+          {
+              .op_code = GATTC_OPTYPE_READ,
+              .status = GATT_SUCCESS,
+              .p_cmpl = &gatt_cl_complete,
+          },
+  };
+
+  bta_gattc_op_cmpl(&client_channel_control_block, &data);
+  ASSERT_EQ(1, get_func_call_count("osi_free_and_reset"));
+  ASSERT_EQ(2, param::bta_gatt_read_complete_callback.handle);
+  ASSERT_EQ(&command_queue, client_channel_control_block.p_q_cmd);
+  ASSERT_TRUE(client_channel_control_block.p_q_cmd_eatt.empty());
+}
+
+TEST_F(BtaGattEattTest, bta_gattc_op_cmpl_read_promotes_eatt_command) {
+  client_channel_control_block.p_q_cmd_eatt.push_back(&eatt_command);
+  gatt_cl_complete.att_value.handle = 123;
+
+  tBTA_GATTC_DATA data = {
+      .op_cmpl =
+          {
+              .op_code = GATTC_OPTYPE_READ,
+              .status = GATT_SUCCESS,
+              .p_cmpl = &gatt_cl_complete,
+          },
+  };
+
+  bta_gattc_op_cmpl(&client_channel_control_block, &data);
+  ASSERT_EQ(1, get_func_call_count("osi_free_and_reset"));
+  ASSERT_EQ(123, param::bta_gatt_read_complete_callback.handle);
+  ASSERT_EQ(&eatt_command, client_channel_control_block.p_q_cmd);
+  ASSERT_TRUE(client_channel_control_block.p_q_cmd_eatt.empty());
+}
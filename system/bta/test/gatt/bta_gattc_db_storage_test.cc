@@ -0,0 +1,244 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "bta/gatt/bta_gattc_int.h"
+#include "gatt/database.h"
+#include "gatt/database_builder.h"
+#include "types/bluetooth/uuid.h"
+#include "types/raw_address.h"
+
+using bluetooth::Uuid;
+
+namespace bluetooth {
+namespace legacy {
+namespace testing {
+void bta_gattc_cache_db_set_dir(const std::string& dir);
+}  // namespace testing
+}  // namespace legacy
+}  // namespace bluetooth
+
+namespace {
+const RawAddress kServer1({0x00, 0x11, 0x22, 0x33, 0x44, 0x55});
+const RawAddress kServer2({0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb});
+
+/* Version of the cache, which is also the version of the per device and per
+ * hash files of the previous cache format */
+constexpr uint16_t kCacheVersion = 6;
+
+/* Number of databases the cache keeps before storing a new one */
+constexpr size_t kMaxDatabases = 30;
+
+gatt::Database make_database(uint16_t service_uuid) {
+  gatt::DatabaseBuilder builder;
+  builder.AddService(0x0001, 0x0005, Uuid::From16Bit(service_uuid), true);
+  builder.AddCharacteristic(0x0002, 0x0003, Uuid::From16Bit(0x2a00), 0x02);
+  builder.AddDescriptor(0x0004, Uuid::From16Bit(0x2902));
+  builder.AddService(0x0010, 0x001f, Uuid::From16Bit(0x1801), false);
+  return builder.Build();
+}
+
+Octet16 make_hash(uint8_t value) {
+  Octet16 hash{};
+  hash[0] = value;
+  return hash;
+}
+
+std::vector<uint8_t> serialize(const gatt::Database& database) {
+  std::vector<uint8_t> bytes;
+  for (const auto& attr : database.Serialize()) {
+    gatt::StoredAttribute::SerializeStoredAttribute(attr, bytes);
+  }
+  return bytes;
+}
+
+bool same_database(const gatt::Database& a, const gatt::Database& b) {
+  return !a.IsEmpty() && serialize(a) == serialize(b);
+}
+}  // namespace
+
+class BtaGattcDbStorageTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::string dir_template =
+        (std::filesystem::temp_directory_path() / "btgattcXXXXXX").string();
+    ASSERT_NE(nullptr, mkdtemp(dir_template.data()));
+    dir_ = dir_template;
+    Reopen();
+  }
+
+  void TearDown() override {
+    bluetooth::legacy::testing::bta_gattc_cache_db_set_dir(dir_);
+    std::filesystem::remove_all(dir_);
+  }
+
+  // Forgets the cache state in memory, as after a restart.
+  void Reopen() {
+    bluetooth::legacy::testing::bta_gattc_cache_db_set_dir(dir_);
+  }
+
+  std::string CacheFile() const { return dir_ + "/gatt_db_cache"; }
+
+  void WriteLegacyFile(const std::string& name,
+                       const gatt::Database& database) {
+    std::vector<gatt::StoredAttribute> attr = database.Serialize();
+    uint16_t num_attr = attr.size();
+    std::ofstream file(dir_ + "/" + name, std::ios::binary);
+    file.write((const char*)&kCacheVersion, sizeof(kCacheVersion));
+    file.write((const char*)&num_attr, sizeof(num_attr));
+    file.write((const char*)attr.data(),
+               attr.size() * sizeof(gatt::StoredAttribute));
+  }
+
+  std::string dir_;
+};
+
+TEST_F(BtaGattcDbStorageTest, write_and_load) {
+  gatt::Database database1 = make_database(0x1800);
+  gatt::Database database2 = make_database(0x180f);
+  bta_gattc_cache_write(kServer1, database1);
+  bta_gattc_cache_write(kServer2, database2);
+  ASSERT_TRUE(bta_gattc_hash_write(make_hash(1), database2));
+
+  Reopen();
+  ASSERT_TRUE(same_database(database1, bta_gattc_cache_load(kServer1)));
+  ASSERT_TRUE(same_database(database2, bta_gattc_cache_load(kServer2)));
+  ASSERT_TRUE(same_database(database1, bta_gattc_hash_load(database1.Hash())));
+  ASSERT_TRUE(same_database(database2, bta_gattc_hash_load(make_hash(1))));
+  ASSERT_TRUE(bta_gattc_hash_load(make_hash(2)).IsEmpty());
+
+  bta_gattc_cache_reset(kServer1);
+  bta_gattc_cache_link(kServer2, make_hash(1));
+
+  Reopen();
+  ASSERT_TRUE(bta_gattc_cache_load(kServer1).IsEmpty());
+  ASSERT_TRUE(same_database(database2, bta_gattc_cache_load(kServer2)));
+  // The database is kept until it expires.
+  ASSERT_TRUE(same_database(database1, bta_gattc_hash_load(database1.Hash())));
+}
+
+TEST_F(BtaGattcDbStorageTest, import_legacy_files) {
+  gatt::Database database1 = make_database(0x1800);
+  gatt::Database database2 = make_database(0x180f);
+  WriteLegacyFile("gatt_cache_001122334455", database1);
+  WriteLegacyFile("gatt_hash_0102", database2);
+  WriteLegacyFile("gatt_cache_66778899aabb", gatt::Database());
+
+  Reopen();
+  ASSERT_TRUE(same_database(database1, bta_gattc_cache_load(kServer1)));
+  ASSERT_TRUE(same_database(database2, bta_gattc_hash_load(database2.Hash())));
+  ASSERT_TRUE(bta_gattc_cache_load(kServer2).IsEmpty());
+
+  // The imported files are removed, and the cache file is used from now on.
+  ASSERT_TRUE(std::filesystem::exists(CacheFile()));
+  ASSERT_FALSE(std::filesystem::exists(dir_ + "/gatt_cache_001122334455"));
+  ASSERT_FALSE(std::filesystem::exists(dir_ + "/gatt_hash_0102"));
+  ASSERT_FALSE(std::filesystem::exists(dir_ + "/gatt_cache_66778899aabb"));
+
+  Reopen();
+  ASSERT_TRUE(same_database(database1, bta_gattc_cache_load(kServer1)));
+}
+
+TEST_F(BtaGattcDbStorageTest, evict_least_recently_used) {
+  gatt::Database database = make_database(0x1800);
+  bta_gattc_cache_write(kServer1, make_database(0x180f));
+  for (uint8_t i = 0; i < kMaxDatabases + 10; i++) {
+    ASSERT_TRUE(bta_gattc_hash_write(make_hash(i), database));
+  }
+
+  Reopen();
+  size_t num_databases = 0;
+  for (uint8_t i = 0; i < kMaxDatabases + 10; i++) {
+    if (!bta_gattc_hash_load(make_hash(i)).IsEmpty()) num_databases++;
+  }
+  // The linked database and the last 30 databases written are kept. Written
+  // in the same second, the databases with the lowest hashes are evicted.
+  ASSERT_EQ(kMaxDatabases, num_databases);
+  ASSERT_TRUE(bta_gattc_hash_load(make_hash(0)).IsEmpty());
+  ASSERT_FALSE(bta_gattc_hash_load(make_hash(kMaxDatabases + 9)).IsEmpty());
+  // Linked databases are not evicted.
+  ASSERT_FALSE(bta_gattc_cache_load(kServer1).IsEmpty());
+}
+
+TEST_F(BtaGattcDbStorageTest, truncated_file_is_rejected) {
+  bta_gattc_cache_write(kServer1, make_database(0x1800));
+  std::filesystem::resize_file(
+      CacheFile(), std::filesystem::file_size(CacheFile()) - 1);
+
+  Reopen();
+  ASSERT_TRUE(bta_gattc_cache_load(kServer1).IsEmpty());
+
+  // The invalid file is replaced by the next write.
+  gatt::Database database = make_database(0x180f);
+  bta_gattc_cache_write(kServer2, database);
+  Reopen();
+  ASSERT_TRUE(same_database(database, bta_gattc_cache_load(kServer2)));
+}
+
+TEST_F(BtaGattcDbStorageTest, corrupt_file_is_rejected) {
+  gatt::Database database = make_database(0x1800);
+  bta_gattc_cache_write(kServer1, database);
+
+  std::vector<char> bytes(std::filesystem::file_size(CacheFile()));
+  std::ifstream(CacheFile(), std::ios::binary).read(bytes.data(), bytes.size());
+  auto write_file = [&](const std::vector<char>& content) {
+    std::ofstream(CacheFile(), std::ios::binary | std::ios::trunc)
+        .write(content.data(), content.size());
+    Reopen();
+  };
+
+  // Wrong magic
+  std::vector<char> corrupt = bytes;
+  corrupt[0] ^= 0xff;
+  write_file(corrupt);
+  ASSERT_TRUE(bta_gattc_cache_load(kServer1).IsEmpty());
+
+  // Wrong version
+  corrupt = bytes;
+  corrupt[4] ^= 0xff;
+  write_file(corrupt);
+  ASSERT_TRUE(bta_gattc_cache_load(kServer1).IsEmpty());
+
+  // Index larger than the file
+  corrupt = bytes;
+  corrupt[6] = 0x7f;
+  write_file(corrupt);
+  ASSERT_TRUE(bta_gattc_cache_load(kServer1).IsEmpty());
+
+  // Link to a database out of the index
+  corrupt = bytes;
+  corrupt[16 + 32 + 6] = 0x05;
+  write_file(corrupt);
+  ASSERT_TRUE(bta_gattc_cache_load(kServer1).IsEmpty());
+
+  // Attributes out of the file
+  corrupt = bytes;
+  corrupt[16 + 24 + 1] = 0x7f;
+  write_file(corrupt);
+  ASSERT_TRUE(bta_gattc_cache_load(kServer1).IsEmpty());
+
+  write_file(bytes);
+  ASSERT_TRUE(same_database(database, bta_gattc_cache_load(kServer1)));
+}
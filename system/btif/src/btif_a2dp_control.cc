@@ -32,12 +32,17 @@
 #include "btif_av.h"
 #include "btif_av_co.h"
 #include "btif_hf.h"
+#include "osi/include/properties.h"
 #include "types/raw_address.h"
+#include "udrv/include/audio_fifo.h"
 #include "udrv/include/uipc.h"
 
 #define A2DP_DATA_READ_POLL_MS 10
 
 using namespace bluetooth;
+using bluetooth::udrv::AudioFifo;
+
+#define A2DP_AUDIO_FIFO_ENABLED_PROPERTY "bluetooth.a2dp.audio_fifo.enabled"
 
 namespace fmt {
 template <>
@@ -249,6 +254,33 @@ static void btif_a2dp_control_on_get_presentation_position() {
   UIPC_Send(*a2dp_uipc, UIPC_CH_ID_AV_CTRL, 0, (uint8_t*)&nsec, sizeof(nsec));
 }
 
+static void btif_a2dp_control_on_get_audio_fifo() {
+  if (!osi_property_get_bool(A2DP_AUDIO_FIFO_ENABLED_PROPERTY, false)) {
+    btif_a2dp_command_ack(A2DP_CTRL_ACK_UNSUPPORTED);
+    return;
+  }
+
+  std::unique_ptr<AudioFifo> fifo =
+      AudioFifo::Create(AUDIO_STREAM_OUTPUT_BUFFER_SZ);
+  if (fifo == nullptr) {
+    btif_a2dp_command_ack(A2DP_CTRL_ACK_FAILURE);
+    return;
+  }
+
+  /* The FIFO memory is passed along with the acknowledgement */
+  uint8_t ack = A2DP_CTRL_ACK_SUCCESS;
+  a2dp_cmd_pending = A2DP_CTRL_CMD_NONE;
+  if (!UIPC_SendFd(*a2dp_uipc, UIPC_CH_ID_AV_CTRL, &ack, sizeof(ack),
+                   fifo->GetFd())) {
+    return;
+  }
+
+  log::info("audio data path switched to a {} bytes FIFO",
+            fifo->GetCapacity());
+  UIPC_Ioctl(*a2dp_uipc, UIPC_CH_ID_AV_AUDIO, UIPC_SET_AUDIO_FIFO,
+             fifo.release());
+}
+
 static void btif_a2dp_recv_ctrl_data(void) {
   tA2DP_CTRL_CMD cmd = A2DP_CTRL_CMD_NONE;
   int n;
@@ -306,6 +338,10 @@ static void btif_a2dp_recv_ctrl_data(void) {
       btif_a2dp_control_on_get_presentation_position();
       break;
 
+    case A2DP_CTRL_GET_AUDIO_FIFO:
+      btif_a2dp_control_on_get_audio_fifo();
+      break;
+
     default:
       log::error("UNSUPPORTED CMD ({})", cmd);
       btif_a2dp_command_ack(A2DP_CTRL_ACK_FAILURE);
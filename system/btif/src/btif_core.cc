@@ -54,6 +54,7 @@
 #include "internal_include/bt_target.h"
 #include "internal_include/bt_trace.h"
 #include "main/shim/entry.h"
+#include "main/shim/le_scanning_manager.h"
 #include "os/log.h"
 #include "osi/include/allocator.h"
 #include "osi/include/future.h"
@@ -462,15 +463,22 @@ void btif_get_adapter_property(bt_property_type_t type) {
     local_le_features.local_privacy_enabled = BTM_BleLocalPrivacyEnabled();
 
     prop.len = sizeof(bt_local_le_features_t);
+    /* Without filter offload, the filters are applied by the host */
     if (cmn_vsc_cb.filter_support == 1)
       local_le_features.max_adv_filter_supported = cmn_vsc_cb.max_filter;
     else
-      local_le_features.max_adv_filter_supported = 0;
+      local_le_features.max_adv_filter_supported =
+          bluetooth::shim::get_host_scan_filter_capacity();
     local_le_features.max_adv_instance = cmn_vsc_cb.adv_inst_max;
     local_le_features.max_irk_list_size = cmn_vsc_cb.max_irk_list_sz;
     local_le_features.rpa_offload_supported = cmn_vsc_cb.rpa_offloading;
-    local_le_features.scan_result_storage_size =
-        cmn_vsc_cb.tot_scan_results_strg;
+    /* Without batch scan offload, the reports are stored by the host */
+    if (cmn_vsc_cb.tot_scan_results_strg != 0)
+      local_le_features.scan_result_storage_size =
+          cmn_vsc_cb.tot_scan_results_strg;
+    else
+      local_le_features.scan_result_storage_size =
+          bluetooth::shim::get_host_batch_scan_storage_size();
     local_le_features.activity_energy_info_supported =
         cmn_vsc_cb.energy_support;
     local_le_features.version_supported = cmn_vsc_cb.version_supported;
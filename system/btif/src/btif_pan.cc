@@ -36,8 +36,8 @@
 #include <linux/if_ether.h>
 #include <linux/if_tun.h>
 #include <net/if.h>
-#include <poll.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "bta/include/bta_pan_api.h"
@@ -398,17 +398,19 @@ int btpan_tap_send(int tap_fd, const RawAddress& src, const RawAddress& dst,
     eth_hdr.h_dest = dst;
     eth_hdr.h_src = src;
     eth_hdr.h_proto = htons(proto);
-    char packet[TAP_MAX_PKT_WRITE_LEN + sizeof(tETH_HDR)];
-    memcpy(packet, &eth_hdr, sizeof(tETH_HDR));
     if (len > TAP_MAX_PKT_WRITE_LEN) {
       log::error("btpan_tap_send eth packet size:{} is exceeded limit!", len);
       return -1;
     }
-    memcpy(packet + sizeof(tETH_HDR), buf, len);
 
-    /* Send data to network interface */
+    /* Send data to network interface, the header and payload are gathered
+     * by the kernel so the payload is not copied again */
+    struct iovec iov[2] = {
+        {.iov_base = &eth_hdr, .iov_len = sizeof(tETH_HDR)},
+        {.iov_base = const_cast<char*>(buf), .iov_len = len},
+    };
     ssize_t ret;
-    OSI_NO_INTR(ret = write(tap_fd, packet, len + sizeof(tETH_HDR)));
+    OSI_NO_INTR(ret = writev(tap_fd, iov, 2));
     log::verbose("ret:{}", ret);
     return (int)ret;
   }
@@ -641,41 +643,31 @@ static void bta_pan_callback(tBTA_PAN_EVT event, tBTA_PAN* p_data) {
                         sizeof(tBTA_PAN), NULL);
 }
 
-#define IS_EXCEPTION(e) ((e) & (POLLHUP | POLLRDHUP | POLLERR | POLLNVAL))
 static void btu_exec_tap_fd_read(int fd) {
-  struct pollfd ufd;
-
   if (fd == INVALID_FD || fd != btpan_cb.tap_fd) return;
 
   // Don't occupy BTU context too long, avoid buffer overruns and
   // give other profiles a chance to run by limiting the amount of memory
   // PAN can use.
   for (int i = 0; i < PAN_BUF_MAX && btif_is_enabled() && btpan_cb.flow; i++) {
-    BT_HDR* buffer = (BT_HDR*)osi_malloc(PAN_BUF_SIZE);
-    buffer->offset = PAN_MINIMUM_OFFSET;
-    buffer->len = PAN_BUF_SIZE - sizeof(BT_HDR) - buffer->offset;
-
-    uint8_t* packet = (uint8_t*)buffer + sizeof(BT_HDR) + buffer->offset;
-
     // If we don't have an undelivered packet left over, pull one from the TAP
-    // driver.
-    // We save it in the congest_packet right away in case we can't deliver it
-    // in this
-    // attempt.
+    // driver. We save it in the congest_packet right away in case we can't
+    // deliver it in this attempt.
+    // The TAP fd is non blocking: the driver queue is drained until the read
+    // would block, without polling the fd between two frames.
     if (!btpan_cb.congest_packet_size) {
       ssize_t ret;
       OSI_NO_INTR(ret = read(fd, btpan_cb.congest_packet,
                              sizeof(btpan_cb.congest_packet)));
+      if (ret == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
       switch (ret) {
         case -1:
           log::error("unable to read from driver: {}", strerror(errno));
-          osi_free(buffer);
           // add fd back to monitor thread to try it again later
           btsock_thread_add_fd(pan_pth, fd, 0, SOCK_THREAD_FD_RD, 0);
           return;
         case 0:
           log::warn("end of file reached.");
-          osi_free(buffer);
           // add fd back to monitor thread to process the exception
           btsock_thread_add_fd(pan_pth, fd, 0, SOCK_THREAD_FD_RD, 0);
           return;
@@ -685,37 +677,32 @@ static void btu_exec_tap_fd_read(int fd) {
       }
     }
 
-    memcpy(packet, btpan_cb.congest_packet,
-           MIN(btpan_cb.congest_packet_size, buffer->len));
-    buffer->len = MIN(btpan_cb.congest_packet_size, buffer->len);
-
-    if (buffer->len > sizeof(tETH_HDR) && should_forward((tETH_HDR*)packet)) {
-      // Extract the ethernet header from the buffer since the PAN_WriteBuf
-      // inside
-      // forward_bnep can't handle two pointers that point inside the same GKI
-      // buffer.
-      tETH_HDR hdr;
-      memcpy(&hdr, packet, sizeof(tETH_HDR));
-
-      // Skip the ethernet header.
-      buffer->len -= sizeof(tETH_HDR);
-      buffer->offset += sizeof(tETH_HDR);
-      if (forward_bnep(&hdr, buffer) != FORWARD_CONGEST)
-        btpan_cb.congest_packet_size = 0;
-    } else {
-      log::warn("dropping packet of length {}", buffer->len);
+    uint16_t len = MIN(btpan_cb.congest_packet_size,
+                       PAN_BUF_SIZE - sizeof(BT_HDR) - PAN_MINIMUM_OFFSET);
+    tETH_HDR* eth_hdr = (tETH_HDR*)btpan_cb.congest_packet;
+    if (len <= sizeof(tETH_HDR) || !should_forward(eth_hdr)) {
+      log::warn("dropping packet of length {}", len);
       btpan_cb.congest_packet_size = 0;
-      osi_free(buffer);
+      continue;
     }
 
-    // Bail out of the loop if reading from the TAP fd would block.
-    ufd.fd = fd;
-    ufd.events = POLLIN;
-    ufd.revents = 0;
-
-    int ret;
-    OSI_NO_INTR(ret = poll(&ufd, 1, 0));
-    if (ret <= 0 || IS_EXCEPTION(ufd.revents)) break;
+    // The buffer is only allocated once a frame has been read. The ethernet
+    // header is kept out of the buffer since the PAN_WriteBuf inside
+    // forward_bnep can't handle two pointers that point inside the same
+    // buffer, so only the payload is copied.
+    // The buffer is not taken from a pool: PAN_WriteBuf hands it to BNEP and
+    // L2CAP, which release it with osi_free once sent, so it never comes back
+    // to this loop to be reused.
+    BT_HDR* buffer = (BT_HDR*)osi_malloc(PAN_BUF_SIZE);
+    buffer->offset = PAN_MINIMUM_OFFSET + sizeof(tETH_HDR);
+    buffer->len = len - sizeof(tETH_HDR);
+    memcpy((uint8_t*)(buffer + 1) + buffer->offset,
+           btpan_cb.congest_packet + sizeof(tETH_HDR), buffer->len);
+
+    tETH_HDR hdr;
+    memcpy(&hdr, eth_hdr, sizeof(tETH_HDR));
+    if (forward_bnep(&hdr, buffer) != FORWARD_CONGEST)
+      btpan_cb.congest_packet_size = 0;
   }
 
   if (btpan_cb.flow) {
@@ -0,0 +1,218 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <linux/if_ether.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "bta/include/bta_pan_api.h"
+#include "btif/include/btif_common.h"
+#include "btif/include/btif_pan_internal.h"
+#include "btif/include/btif_sock_thread.h"
+#include "osi/include/allocator.h"
+#include "stack/include/bt_hdr.h"
+#include "stack/include/main_thread.h"
+#include "stack/include/pan_api.h"
+#include "types/raw_address.h"
+
+namespace {
+const RawAddress kLocal({0x00, 0x11, 0x22, 0x33, 0x44, 0x55});
+const RawAddress kPeer({0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb});
+constexpr int kPanHandle = 1;
+
+struct forwarded_frame {
+  RawAddress dst;
+  RawAddress src;
+  uint16_t protocol;
+  std::vector<uint8_t> payload;
+};
+
+std::vector<forwarded_frame> forwarded_frames;
+int num_congested_writes;
+int num_fds_added;
+}  // namespace
+
+int btif_is_enabled(void) { return 1; }
+
+bt_status_t btif_transfer_context(tBTIF_CBACK* /* p_cback */,
+                                  uint16_t /* event */, char* /* p_params */,
+                                  int /* param_len */,
+                                  tBTIF_COPY_CBACK* /* p_copy_cback */) {
+  return BT_STATUS_SUCCESS;
+}
+
+bt_status_t do_in_main_thread(const base::Location& /* from_here */,
+                              base::OnceClosure task) {
+  std::move(task).Run();
+  return BT_STATUS_SUCCESS;
+}
+
+int btsock_thread_add_fd(int /* h */, int /* fd */, int /* type */,
+                         int /* flags */, uint32_t /* user_id */) {
+  num_fds_added++;
+  return 0;
+}
+
+int btsock_thread_create(btsock_signaled_cb /* callback */,
+                         btsock_cmd_cb /* cmd_callback */) {
+  return -1;
+}
+
+int btsock_thread_exit(int /* h */) { return 0; }
+
+int btsock_thread_wakeup(int /* h */) { return 0; }
+
+tPAN_RESULT PAN_WriteBuf(uint16_t /* handle */, const RawAddress& dst,
+                         const RawAddress& src, uint16_t protocol,
+                         BT_HDR* p_buf, bool /* ext */) {
+  if (num_congested_writes > 0) {
+    num_congested_writes--;
+    osi_free(p_buf);
+    return PAN_Q_SIZE_EXCEEDED;
+  }
+
+  uint8_t* payload = (uint8_t*)(p_buf + 1) + p_buf->offset;
+  forwarded_frames.push_back(
+      {dst, src, protocol,
+       std::vector<uint8_t>(payload, payload + p_buf->len)});
+  osi_free(p_buf);
+  return PAN_SUCCESS;
+}
+
+class BtifPanTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // TAP devices deliver one Ethernet frame per read, as sequenced packets.
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds_));
+    ASSERT_EQ(0, fcntl(fds_[0], F_SETFL, O_NONBLOCK));
+
+    memset(&btpan_cb, 0, sizeof(btpan_cb));
+    for (int i = 0; i < MAX_PAN_CONNS; i++) btpan_cb.conns[i].handle = -1;
+    btpan_cb.tap_fd = fds_[0];
+    ASSERT_NE(nullptr, btpan_new_conn(kPanHandle, kPeer, 0, 0));
+
+    forwarded_frames.clear();
+    num_congested_writes = 0;
+    num_fds_added = 0;
+  }
+
+  void TearDown() override {
+    btpan_cb.tap_fd = INVALID_FD;
+    close(fds_[0]);
+    close(fds_[1]);
+  }
+
+  // Writes an Ethernet frame on the network side of the TAP device.
+  void WriteFrame(const RawAddress& dst, uint16_t protocol,
+                  const std::vector<uint8_t>& payload) {
+    tETH_HDR hdr = {.h_dest = dst, .h_src = kLocal, .h_proto = 0};
+    hdr.h_proto = htons(protocol);
+    std::vector<uint8_t> frame((uint8_t*)&hdr, (uint8_t*)&hdr + sizeof(hdr));
+    frame.insert(frame.end(), payload.begin(), payload.end());
+    ASSERT_EQ((ssize_t)frame.size(),
+              send(fds_[1], frame.data(), frame.size(), 0));
+  }
+
+  int fds_[2];
+};
+
+TEST_F(BtifPanTest, tap_send_gathers_header_and_payload) {
+  std::vector<uint8_t> payload(1500);
+  for (size_t i = 0; i < payload.size(); i++) payload[i] = i;
+
+  ASSERT_EQ((int)(sizeof(tETH_HDR) + payload.size()),
+            btpan_tap_send(fds_[0], kPeer, kLocal, ETH_P_IP,
+                           (const char*)payload.data(), payload.size(), false,
+                           false));
+
+  uint8_t frame[1600];
+  ssize_t len = recv(fds_[1], frame, sizeof(frame), 0);
+  ASSERT_EQ((ssize_t)(sizeof(tETH_HDR) + payload.size()), len);
+
+  tETH_HDR hdr;
+  memcpy(&hdr, frame, sizeof(hdr));
+  ASSERT_EQ(kLocal, hdr.h_dest);
+  ASSERT_EQ(kPeer, hdr.h_src);
+  ASSERT_EQ(ETH_P_IP, ntohs(hdr.h_proto));
+  ASSERT_EQ(0, memcmp(payload.data(), frame + sizeof(hdr), payload.size()));
+
+  // Frames larger than the TAP device accepts are not written.
+  ASSERT_EQ(-1, btpan_tap_send(fds_[0], kPeer, kLocal, ETH_P_IP,
+                               (const char*)payload.data(),
+                               TAP_MAX_PKT_WRITE_LEN + 1, false, false));
+}
+
+TEST_F(BtifPanTest, read_tap_until_would_block) {
+  WriteFrame(kPeer, ETH_P_IP, {0x01});
+  WriteFrame(kPeer, ETH_P_ARP, {0x02, 0x02});
+  // Unknown protocols are dropped.
+  WriteFrame(kPeer, 0x88cc, {0x03});
+  WriteFrame(kPeer, ETH_P_IPV6, std::vector<uint8_t>(1400, 0x04));
+
+  btpan_set_flow_control(true);
+
+  ASSERT_EQ(3UL, forwarded_frames.size());
+  ASSERT_EQ(kPeer, forwarded_frames[0].dst);
+  ASSERT_EQ(kLocal, forwarded_frames[0].src);
+  ASSERT_EQ(ETH_P_IP, forwarded_frames[0].protocol);
+  ASSERT_EQ(std::vector<uint8_t>({0x01}), forwarded_frames[0].payload);
+  ASSERT_EQ(ETH_P_ARP, forwarded_frames[1].protocol);
+  ASSERT_EQ(std::vector<uint8_t>({0x02, 0x02}), forwarded_frames[1].payload);
+  ASSERT_EQ(ETH_P_IPV6, forwarded_frames[2].protocol);
+  ASSERT_EQ(std::vector<uint8_t>(1400, 0x04), forwarded_frames[2].payload);
+
+  // The TAP device is drained, and monitored again for the next frames.
+  uint8_t byte;
+  ASSERT_EQ(-1, recv(fds_[0], &byte, 1, 0));
+  ASSERT_EQ(EAGAIN, errno);
+  ASSERT_EQ(0, btpan_cb.congest_packet_size);
+  ASSERT_EQ(2, num_fds_added);
+
+  // Nothing is read without frames.
+  btpan_set_flow_control(true);
+  ASSERT_EQ(3UL, forwarded_frames.size());
+}
+
+TEST_F(BtifPanTest, congested_frame_is_sent_again) {
+  WriteFrame(kPeer, ETH_P_IP, {0x01});
+  WriteFrame(kPeer, ETH_P_IP, {0x02});
+  num_congested_writes = 2;
+
+  btpan_set_flow_control(true);
+
+  ASSERT_EQ(2UL, forwarded_frames.size());
+  ASSERT_EQ(std::vector<uint8_t>({0x01}), forwarded_frames[0].payload);
+  ASSERT_EQ(std::vector<uint8_t>({0x02}), forwarded_frames[1].payload);
+}
+
+TEST_F(BtifPanTest, no_read_while_flow_is_off) {
+  WriteFrame(kPeer, ETH_P_IP, {0x01});
+
+  btpan_set_flow_control(false);
+  ASSERT_TRUE(forwarded_frames.empty());
+  ASSERT_EQ(0, num_fds_added);
+
+  btpan_set_flow_control(true);
+  ASSERT_EQ(1UL, forwarded_frames.size());
+}
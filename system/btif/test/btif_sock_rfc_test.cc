@@ -0,0 +1,193 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG  // Undefine the LOG_TAG by this compilation unit
+#include "btif/src/btif_sock_rfc.cc"
+
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// The SDP records, connection logs and L2CAP sockets are not exercised.
+int add_rfc_sdp_rec(const char* name, bluetooth::Uuid uuid, int scn) {
+  return 0;
+}
+void del_rfc_sdp_rec(int handle) {}
+int get_reserved_rfc_channel(const bluetooth::Uuid& uuid) { return -1; }
+void btif_sock_connection_logger(int state, int role, const RawAddress& addr,
+                                 int channel, const char* server_name) {}
+void on_l2cap_psm_assigned(int id, int psm) {}
+void log_socket_connection_state(
+    const RawAddress& address, int port, int type,
+    android::bluetooth::SocketConnectionstateEnum connection_state,
+    int64_t tx_bytes, int64_t rx_bytes, int uid, int server_port,
+    android::bluetooth::SocketRoleEnum socket_role) {}
+
+namespace {
+
+// Offset of the payload in the queued buffers, as left by the RFCOMM layer.
+constexpr uint16_t kPayloadOffset = 8;
+
+// Buffers released by the incoming queue, freed by the test fixture.
+std::vector<void*> released_buffers;
+
+void release_buffer(void* ptr) { released_buffers.push_back(ptr); }
+
+}  // namespace
+
+class BtifSockRfcTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    released_buffers.clear();
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds_));
+    slot_.fd = fds_[0];
+    slot_.incoming_queue = list_new(release_buffer);
+    ASSERT_NE(nullptr, slot_.incoming_queue);
+  }
+
+  void TearDown() override {
+    list_free(slot_.incoming_queue);
+    close(fds_[0]);
+    close(fds_[1]);
+
+    // Every queued buffer is released exactly once.
+    std::vector<void*> released = released_buffers;
+    std::sort(released.begin(), released.end());
+    std::sort(queued_buffers_.begin(), queued_buffers_.end());
+    EXPECT_EQ(queued_buffers_, released);
+    for (void* ptr : queued_buffers_) osi_free(ptr);
+  }
+
+  // Limits the bytes the socket accepts before the app reads them.
+  void SetSendBufferSize(int size) {
+    ASSERT_EQ(0, setsockopt(slot_.fd, SOL_SOCKET, SO_SNDBUF, &size,
+                            sizeof(size)));
+  }
+
+  // Queues a buffer of |len| bytes of the data stream.
+  void QueueBuffer(uint16_t len) {
+    BT_HDR* p_buf = (BT_HDR*)osi_malloc(sizeof(BT_HDR) + kPayloadOffset + len);
+    p_buf->offset = kPayloadOffset;
+    p_buf->len = len;
+    for (uint16_t i = 0; i < len; i++) {
+      p_buf->data[kPayloadOffset + i] = (uint8_t)(expected_.size() * 7);
+      expected_.push_back(p_buf->data[kPayloadOffset + i]);
+    }
+    queued_buffers_.push_back(p_buf);
+    ASSERT_TRUE(list_append(slot_.incoming_queue, p_buf));
+  }
+
+  // Reads everything written to the app so far.
+  void ReadApp() {
+    uint8_t data[4096];
+    ssize_t len;
+    while ((len = recv(fds_[1], data, sizeof(data), MSG_DONTWAIT)) > 0) {
+      received_.insert(received_.end(), data, data + len);
+    }
+  }
+
+  // Fills the socket until the app reads from it.
+  void FillSocket() {
+    uint8_t data[1024] = {};
+    while (send(slot_.fd, data, sizeof(data), MSG_DONTWAIT) > 0) {
+    }
+    ASSERT_TRUE(errno == EAGAIN || errno == EWOULDBLOCK);
+    while (send(slot_.fd, data, 1, MSG_DONTWAIT) > 0) {
+    }
+  }
+
+  // Reads and discards the bytes written by FillSocket.
+  void DrainSocket() {
+    uint8_t data[4096];
+    while (recv(fds_[1], data, sizeof(data), MSG_DONTWAIT) > 0) {
+    }
+  }
+
+  int fds_[2] = {-1, -1};
+  rfc_slot_t slot_ = {};
+  std::vector<void*> queued_buffers_;
+  std::vector<uint8_t> expected_;
+  std::vector<uint8_t> received_;
+};
+
+TEST_F(BtifSockRfcTest, write_ends_mid_buffer) {
+  // The socket accepts less than the queued data. With buffers of a prime
+  // size, the write stops in the middle of a buffer.
+  constexpr uint16_t kBufferSize = 997;
+  SetSendBufferSize(4096);
+  for (int i = 0; i < 32; i++) QueueBuffer(kBufferSize);
+
+  ASSERT_EQ(SENT_PARTIAL, send_incoming_que_to_app(&slot_));
+  ReadApp();
+  size_t written = received_.size();
+  ASSERT_NE(0u, written % kBufferSize);
+  ASSERT_EQ(written / kBufferSize, released_buffers.size());
+  BT_HDR* p_buf = (BT_HDR*)list_front(slot_.incoming_queue);
+  ASSERT_EQ(kBufferSize - written % kBufferSize, p_buf->len);
+  ASSERT_EQ(kPayloadOffset + written % kBufferSize, p_buf->offset);
+
+  // The rest of the data follows, in order, as the app reads.
+  while (!list_is_empty(slot_.incoming_queue)) {
+    ASSERT_NE(SENT_FAILED, send_incoming_que_to_app(&slot_));
+    ReadApp();
+  }
+  ASSERT_EQ(expected_, received_);
+}
+
+TEST_F(BtifSockRfcTest, resumes_after_eagain) {
+  SetSendBufferSize(4096);
+  FillSocket();
+  for (int i = 0; i < 3; i++) QueueBuffer(100);
+
+  // Nothing is written while the app does not read, nor released.
+  ASSERT_EQ(SENT_NONE, send_incoming_que_to_app(&slot_));
+  ASSERT_EQ(SENT_NONE, send_incoming_que_to_app(&slot_));
+  ASSERT_EQ(3u, list_length(slot_.incoming_queue));
+  ASSERT_TRUE(released_buffers.empty());
+  BT_HDR* p_buf = (BT_HDR*)list_front(slot_.incoming_queue);
+  ASSERT_EQ(kPayloadOffset, p_buf->offset);
+  ASSERT_EQ(100, p_buf->len);
+
+  // The write resumes from the first buffer once the app reads.
+  DrainSocket();
+  ASSERT_EQ(SENT_ALL, send_incoming_que_to_app(&slot_));
+  ASSERT_TRUE(list_is_empty(slot_.incoming_queue));
+  ReadApp();
+  ASSERT_EQ(expected_, received_);
+}
+
+TEST_F(BtifSockRfcTest, more_buffers_than_iovecs) {
+  QueueBuffer(10);
+  QueueBuffer(0);
+  for (int i = 0; i < MAX_RFC_SEND_IOV + 7; i++) QueueBuffer(10);
+  size_t num_buffers = list_length(slot_.incoming_queue);
+
+  // A write gathers at most MAX_RFC_SEND_IOV buffers, the next write
+  // continues with the following ones.
+  ASSERT_EQ(SENT_ALL, send_incoming_que_to_app(&slot_));
+  ASSERT_EQ((size_t)MAX_RFC_SEND_IOV, released_buffers.size());
+  ASSERT_EQ(num_buffers - MAX_RFC_SEND_IOV,
+            list_length(slot_.incoming_queue));
+
+  ASSERT_EQ(SENT_ALL, send_incoming_que_to_app(&slot_));
+  ASSERT_TRUE(list_is_empty(slot_.incoming_queue));
+  ReadApp();
+  ASSERT_EQ(expected_, received_);
+}
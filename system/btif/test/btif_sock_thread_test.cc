@@ -0,0 +1,178 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "btif/include/btif_sock_thread.h"
+
+#include <errno.h>
+#include <gtest/gtest.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+constexpr int kNumSockets = 500;
+
+std::mutex signaled_mutex;
+std::condition_variable signaled_cv;
+std::vector<int> signaled_flags;
+int signaled_count;
+
+void signaled_cb(int fd, int /* type */, int flags, uint32_t user_id) {
+  std::unique_lock<std::mutex> lock(signaled_mutex);
+  if (flags & SOCK_THREAD_FD_RD) {
+    char byte;
+    (void)read(fd, &byte, 1);
+  }
+  signaled_flags[user_id] |= flags;
+  signaled_count++;
+  signaled_cv.notify_all();
+}
+
+void cmd_cb(int /* cmd_fd */, int /* type */, int /* size */,
+            uint32_t /* user_id */) {}
+}  // namespace
+
+class BtifSockThreadTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Each loopback socket uses two fds.
+    struct rlimit limit;
+    ASSERT_EQ(0, getrlimit(RLIMIT_NOFILE, &limit));
+    if (limit.rlim_cur < 2 * kNumSockets + 64) {
+      limit.rlim_cur = std::min<rlim_t>(limit.rlim_max, 2 * kNumSockets + 64);
+      setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    if (limit.rlim_cur < 2 * kNumSockets + 64) {
+      GTEST_SKIP() << "Not enough file descriptors available";
+    }
+
+    signaled_flags.assign(kNumSockets, 0);
+    signaled_count = 0;
+    btsock_thread_init();
+    handle_ = btsock_thread_create(signaled_cb, cmd_cb);
+    ASSERT_GE(handle_, 0);
+  }
+
+  void TearDown() override {
+    if (handle_ >= 0) btsock_thread_exit(handle_);
+    for (auto& fds : sockets_) {
+      close(fds[0]);
+      close(fds[1]);
+    }
+  }
+
+  void OpenSockets(int count) {
+    for (int i = 0; i < count; i++) {
+      std::array<int, 2> fds;
+      ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds.data()));
+      sockets_.push_back(fds);
+    }
+  }
+
+  bool WaitSignaled(int count) {
+    std::unique_lock<std::mutex> lock(signaled_mutex);
+    return signaled_cv.wait_for(lock, 5s,
+                                [count] { return signaled_count >= count; });
+  }
+
+  int handle_ = -1;
+  std::vector<std::array<int, 2>> sockets_;
+};
+
+TEST_F(BtifSockThreadTest, concurrent_loopback_sockets) {
+  OpenSockets(kNumSockets);
+  for (int i = 0; i < kNumSockets; i++) {
+    ASSERT_TRUE(btsock_thread_add_fd(handle_, sockets_[i][0], 0,
+                                     SOCK_THREAD_FD_RD, i));
+  }
+  for (int i = 0; i < kNumSockets; i++) {
+    ASSERT_EQ(1, write(sockets_[i][1], "x", 1));
+  }
+
+  ASSERT_TRUE(WaitSignaled(kNumSockets));
+  for (int i = 0; i < kNumSockets; i++) {
+    ASSERT_EQ(SOCK_THREAD_FD_RD, signaled_flags[i]);
+  }
+
+  // Signaled fds are no longer monitored until added again.
+  ASSERT_EQ(1, write(sockets_[0][1], "x", 1));
+  ASSERT_TRUE(btsock_thread_add_fd(handle_, sockets_[1][0], 0,
+                                   SOCK_THREAD_FD_RD, 1));
+  ASSERT_EQ(1, write(sockets_[1][1], "x", 1));
+  ASSERT_TRUE(WaitSignaled(kNumSockets + 1));
+  std::this_thread::sleep_for(50ms);
+  std::unique_lock<std::mutex> lock(signaled_mutex);
+  ASSERT_EQ(kNumSockets + 1, signaled_count);
+}
+
+TEST_F(BtifSockThreadTest, read_and_write_signaled_separately) {
+  OpenSockets(1);
+  ASSERT_TRUE(btsock_thread_add_fd(handle_, sockets_[0][0], 0,
+                                   SOCK_THREAD_FD_RD, 0));
+  ASSERT_TRUE(btsock_thread_add_fd(handle_, sockets_[0][0], 0,
+                                   SOCK_THREAD_FD_WR, 0));
+
+  // The socket is writable right away, the read monitor is kept.
+  ASSERT_TRUE(WaitSignaled(1));
+  ASSERT_EQ(SOCK_THREAD_FD_WR, signaled_flags[0]);
+
+  ASSERT_EQ(1, write(sockets_[0][1], "x", 1));
+  ASSERT_TRUE(WaitSignaled(2));
+  ASSERT_EQ(SOCK_THREAD_FD_RD | SOCK_THREAD_FD_WR, signaled_flags[0]);
+}
+
+TEST_F(BtifSockThreadTest, hangup_is_signaled_as_exception) {
+  OpenSockets(1);
+  ASSERT_TRUE(btsock_thread_add_fd(handle_, sockets_[0][0], 0,
+                                   SOCK_THREAD_FD_RD, 0));
+  close(sockets_[0][1]);
+  sockets_[0][1] = -1;
+
+  ASSERT_TRUE(WaitSignaled(1));
+  ASSERT_TRUE(signaled_flags[0] & SOCK_THREAD_FD_EXCEPTION);
+}
+
+TEST_F(BtifSockThreadTest, create_fails_without_file_descriptors) {
+  // Use up the file descriptors so that epoll_create1 fails.
+  std::vector<int> fds;
+  for (int fd; (fd = dup(0)) != -1;) fds.push_back(fd);
+  ASSERT_EQ(EMFILE, errno);
+
+  // The slot is released every time, so it isn't leaked.
+  for (int i = 0; i < 16; i++) {
+    ASSERT_EQ(-1, btsock_thread_create(signaled_cb, cmd_cb));
+  }
+
+  // Without the socket pair, the thread is not created either.
+  close(fds.back());
+  fds.pop_back();
+  ASSERT_EQ(-1, btsock_thread_create(signaled_cb, cmd_cb));
+
+  for (int fd : fds) close(fd);
+  int handle = btsock_thread_create(signaled_cb, cmd_cb);
+  ASSERT_GE(handle, 0);
+  ASSERT_TRUE(btsock_thread_exit(handle));
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "../g722_enc_dec.h"
+
+using ::benchmark::State;
+
+namespace {
+
+// 16kHz stereo PCM, encoded in 20ms intervals as done for hearing aids.
+constexpr int kFramesPerInterval = 320;
+constexpr int kIntervals = 100;
+
+std::vector<int16_t> MakeStereoStream() {
+  std::vector<int16_t> pcm(2 * kFramesPerInterval * kIntervals);
+  for (size_t frame = 0; frame < pcm.size() / 2; frame++) {
+    pcm[2 * frame] = (int16_t)(8000 * std::sin(frame * 0.07));
+    pcm[2 * frame + 1] = (int16_t)(8000 * std::sin(frame * 0.11 + 1));
+  }
+  return pcm;
+}
+
+// Deinterleave each interval and encode both channels one after the other.
+void BM_EncodeStereoSerially(State& state) {
+  std::vector<int16_t> pcm = MakeStereoStream();
+  std::vector<int16_t> left(kFramesPerInterval);
+  std::vector<int16_t> right(kFramesPerInterval);
+  std::vector<uint8_t> encoded_left(kFramesPerInterval);
+  std::vector<uint8_t> encoded_right(kFramesPerInterval);
+  g722_encode_state_t encoder_left;
+  g722_encode_state_t encoder_right;
+  g722_encode_init(&encoder_left, 64000, G722_PACKED);
+  g722_encode_init(&encoder_right, 64000, G722_PACKED);
+
+  for (auto _ : state) {
+    for (int interval = 0; interval < kIntervals; interval++) {
+      const int16_t* samples = &pcm[2 * kFramesPerInterval * interval];
+      for (int frame = 0; frame < kFramesPerInterval; frame++) {
+        left[frame] = samples[2 * frame];
+        right[frame] = samples[2 * frame + 1];
+      }
+      g722_encode(&encoder_left, encoded_left.data(), left.data(),
+                  kFramesPerInterval);
+      g722_encode(&encoder_right, encoded_right.data(), right.data(),
+                  kFramesPerInterval);
+      benchmark::DoNotOptimize(encoded_left.data());
+      benchmark::DoNotOptimize(encoded_right.data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kIntervals * kFramesPerInterval);
+}
+BENCHMARK(BM_EncodeStereoSerially);
+
+// Encode both channels in a single pass over the interleaved intervals.
+void BM_EncodeStereoMulti(State& state) {
+  std::vector<int16_t> pcm = MakeStereoStream();
+  std::vector<uint8_t> encoded_left(kFramesPerInterval);
+  std::vector<uint8_t> encoded_right(kFramesPerInterval);
+  g722_encode_state_t encoder_left;
+  g722_encode_state_t encoder_right;
+  g722_encode_init(&encoder_left, 64000, G722_PACKED);
+  g722_encode_init(&encoder_right, 64000, G722_PACKED);
+  g722_encode_state_t* encoders[2] = {&encoder_left, &encoder_right};
+  uint8_t* encoded[2] = {encoded_left.data(), encoded_right.data()};
+
+  for (auto _ : state) {
+    for (int interval = 0; interval < kIntervals; interval++) {
+      g722_encode_multi(encoders, encoded, 2,
+                        &pcm[2 * kFramesPerInterval * interval],
+                        kFramesPerInterval);
+      benchmark::DoNotOptimize(encoded_left.data());
+      benchmark::DoNotOptimize(encoded_right.data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kIntervals * kFramesPerInterval);
+}
+BENCHMARK(BM_EncodeStereoMulti);
+
+}  // namespace
+
+BENCHMARK_MAIN();
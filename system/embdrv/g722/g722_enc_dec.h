@@ -94,7 +94,7 @@ typedef struct
     int bits_per_sample;
 
     /*! Signal history for the QMF */
-    int x[24];
+    int16_t x[24];
 
     g722_band_t band[2];
 
@@ -136,6 +136,12 @@ extern "C" {
 g722_encode_state_t *g722_encode_init(g722_encode_state_t *s, unsigned int rate, int options);
 int g722_encode_release(g722_encode_state_t *s);
 int g722_encode(g722_encode_state_t *s, uint8_t g722_data[], const int16_t amp[], int len);
+/*! Encode several streams, e.g. the left and right hearing aids, in a single pass
+    over interleaved PCM of len frames. Each channel is encoded with its own state and
+    output buffer, exactly as g722_encode would do. The states must have been
+    initialized with the same rate and options. Returns the bytes per channel. */
+int g722_encode_multi(g722_encode_state_t *s[], uint8_t *g722_data[], int channels,
+                      const int16_t amp[], int len);
 
 g722_decode_state_t *g722_decode_init(g722_decode_state_t *s, unsigned int rate, int options);
 int g722_decode_release(g722_decode_state_t *s);
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "../../g722/g722_enc_dec.h"
+
+namespace {
+
+// 16kHz PCM, encoded in 20ms intervals as done for hearing aids.
+constexpr int kFramesPerInterval = 320;
+constexpr int kIntervals = 20;
+
+// Interleaved PCM: a sine, clipped noise and silence, one per channel.
+std::vector<int16_t> MakeStream(int channels) {
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> noise(-40000, 40000);
+  std::vector<int16_t> pcm(channels * kFramesPerInterval * kIntervals);
+  for (size_t frame = 0; frame < pcm.size() / channels; frame++) {
+    for (int c = 0; c < channels; c++) {
+      int sample = 0;
+      if (c % 3 == 0) sample = 16000 * std::sin(frame * 0.07 * (c + 1));
+      if (c % 3 == 1) sample = std::clamp(noise(gen), -32768, 32767);
+      pcm[channels * frame + c] = sample;
+    }
+  }
+  return pcm;
+}
+
+struct EncodeParams {
+  int rate;
+  int options;
+  bool itu_test_mode;
+};
+
+class G722EncodeMultiTest
+    : public ::testing::TestWithParam<std::tuple<EncodeParams, int>> {};
+
+// Each channel encoded in a single pass is bit exact with the channel
+// deinterleaved and encoded on its own, interval after interval.
+TEST_P(G722EncodeMultiTest, bit_exact_with_serial_encoding) {
+  auto [params, channels] = GetParam();
+  std::vector<int16_t> pcm = MakeStream(channels);
+
+  std::vector<g722_encode_state_t> serial(channels);
+  std::vector<g722_encode_state_t> multi(channels);
+  std::vector<g722_encode_state_t*> multi_states;
+  for (int c = 0; c < channels; c++) {
+    g722_encode_init(&serial[c], params.rate, params.options);
+    g722_encode_init(&multi[c], params.rate, params.options);
+    serial[c].itu_test_mode = params.itu_test_mode;
+    multi[c].itu_test_mode = params.itu_test_mode;
+    multi_states.push_back(&multi[c]);
+  }
+
+  std::vector<int16_t> channel_pcm(kFramesPerInterval);
+  std::vector<std::vector<uint8_t>> serial_out(
+      channels, std::vector<uint8_t>(kFramesPerInterval));
+  std::vector<std::vector<uint8_t>> multi_out(
+      channels, std::vector<uint8_t>(kFramesPerInterval));
+  std::vector<uint8_t*> multi_data;
+  for (auto& out : multi_out) multi_data.push_back(out.data());
+
+  for (int interval = 0; interval < kIntervals; interval++) {
+    const int16_t* samples = &pcm[channels * kFramesPerInterval * interval];
+    int multi_bytes =
+        g722_encode_multi(multi_states.data(), multi_data.data(), channels,
+                          samples, kFramesPerInterval);
+    ASSERT_GT(multi_bytes, 0);
+
+    for (int c = 0; c < channels; c++) {
+      for (int frame = 0; frame < kFramesPerInterval; frame++) {
+        channel_pcm[frame] = samples[channels * frame + c];
+      }
+      int serial_bytes = g722_encode(&serial[c], serial_out[c].data(),
+                                     channel_pcm.data(), kFramesPerInterval);
+      ASSERT_EQ(serial_bytes, multi_bytes);
+      ASSERT_EQ(0, memcmp(serial_out[c].data(), multi_out[c].data(),
+                          serial_bytes))
+          << "channel " << c << ", interval " << interval;
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    G722EncodeMultiTest, G722EncodeMultiTest,
+    ::testing::Combine(
+        ::testing::Values(EncodeParams{64000, G722_PACKED, false},
+                          EncodeParams{64000, 0, false},
+                          EncodeParams{56000, G722_PACKED, false},
+                          EncodeParams{48000, G722_PACKED, false},
+                          EncodeParams{64000, G722_SAMPLE_RATE_8000, false},
+                          EncodeParams{64000, G722_PACKED, true}),
+        ::testing::Values(1, 2, 3)));
+
+}  // namespace
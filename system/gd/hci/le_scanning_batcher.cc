@@ -0,0 +1,231 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/le_scanning_batcher.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "os/log.h"
+
+namespace bluetooth::hci {
+
+bool LeScanningBatcher::RecordKey::operator==(const RecordKey& other) const {
+  return address == other.address && address_type == other.address_type &&
+         data_hash == other.data_hash;
+}
+
+std::size_t LeScanningBatcher::RecordKeyHash::operator()(const RecordKey& key) const {
+  std::size_t val = std::hash<Address>()(key.address);
+  val = (val << 1) ^ std::hash<std::uint8_t>()(key.address_type);
+  val = (val << 1) ^ key.data_hash;
+  return val;
+}
+
+void LeScanningBatcher::ConfigureStorage(
+    uint8_t full_max, uint8_t truncated_max, uint8_t notify_threshold) {
+  if (full_max + truncated_max > 100) {
+    LOG_WARN(
+        "Invalid storage repartition full %u%% truncated %u%%",
+        (unsigned)full_max,
+        (unsigned)truncated_max);
+    return;
+  }
+
+  full_.capacity = kStorageSize * full_max / 100;
+  truncated_.capacity = kStorageSize * truncated_max / 100;
+  notify_threshold_ = std::min<uint8_t>(notify_threshold, 100);
+  for (Storage* storage : {&full_, &truncated_}) {
+    storage->threshold = storage->capacity * notify_threshold_ / 100;
+  }
+}
+
+void LeScanningBatcher::Enable(
+    bool truncated,
+    bool full,
+    BatchScanDiscardRule discard_rule,
+    std::chrono::milliseconds coalescing_window) {
+  truncated_.enabled = truncated;
+  full_.enabled = full;
+  discard_rule_ = discard_rule;
+  coalescing_window_ = coalescing_window;
+}
+
+void LeScanningBatcher::Disable() {
+  truncated_.enabled = false;
+  full_.enabled = false;
+}
+
+bool LeScanningBatcher::AddReport(
+    uint8_t address_type,
+    const Address& address,
+    int8_t tx_power,
+    int8_t rssi,
+    const std::vector<uint8_t>& advertising_data,
+    std::chrono::steady_clock::time_point now) {
+  bool threshold_crossed = false;
+
+  if (truncated_.enabled) {
+    threshold_crossed |=
+        Store(truncated_, {address, address_type, 0}, tx_power, rssi, nullptr, now);
+  }
+
+  if (full_.enabled) {
+    if (advertising_data.size() > kMaximumFullRecordData) {
+      LOG_DEBUG(
+          "Advertising data of %zu bytes does not fit in a full record",
+          advertising_data.size());
+    } else {
+      RecordKey key{address, address_type, HashData(advertising_data)};
+      threshold_crossed |= Store(full_, key, tx_power, rssi, &advertising_data, now);
+    }
+  }
+
+  return threshold_crossed;
+}
+
+bool LeScanningBatcher::Store(
+    Storage& storage,
+    const RecordKey& key,
+    int8_t tx_power,
+    int8_t rssi,
+    const std::vector<uint8_t>* advertising_data,
+    std::chrono::steady_clock::time_point now) {
+  auto it = storage.index.find(key);
+  if (it != storage.index.end() && coalescing_window_.count() != 0 &&
+      now - it->second->window_start >= coalescing_window_) {
+    // The window of the record is over, it is kept as is and the report
+    // starts a new record.
+    storage.index.erase(it);
+    it = storage.index.end();
+  }
+
+  if (it != storage.index.end()) {
+    // Repeated report: aggregate the RSSI and refresh the timestamp.
+    // The data is compared in case of a hash collision.
+    Record& record = *it->second;
+    record.tx_power = tx_power;
+    record.rssi_sum += rssi;
+    record.num_reports++;
+    record.timestamp = now;
+    if (advertising_data != nullptr && record.data != *advertising_data) {
+      record.data = *advertising_data;
+    }
+    return false;
+  }
+
+  if (storage.capacity == 0) {
+    return false;
+  }
+
+  if (storage.records.size() >= storage.capacity) {
+    auto discarded = storage.records.begin();
+    if (discard_rule_ == BatchScanDiscardRule::WEAKEST_RSSI) {
+      discarded = std::min_element(
+          storage.records.begin(), storage.records.end(), [](const Record& a, const Record& b) {
+            return (int64_t)a.rssi_sum * b.num_reports < (int64_t)b.rssi_sum * a.num_reports;
+          });
+      if (rssi * (int64_t)discarded->num_reports < discarded->rssi_sum) {
+        // The new report is weaker than all the stored records.
+        return false;
+      }
+    }
+    // Records of elapsed windows are no longer indexed.
+    auto indexed = storage.index.find(
+        {discarded->address, discarded->address_type, discarded->data_hash});
+    if (indexed != storage.index.end() && indexed->second == discarded) {
+      storage.index.erase(indexed);
+    }
+    storage.records.erase(discarded);
+  }
+
+  storage.records.push_back(Record{
+      .address = key.address,
+      .address_type = key.address_type,
+      .tx_power = tx_power,
+      .rssi_sum = rssi,
+      .num_reports = 1,
+      .window_start = now,
+      .timestamp = now,
+      .data_hash = key.data_hash,
+      .data = advertising_data != nullptr ? *advertising_data : std::vector<uint8_t>{},
+  });
+  storage.index.emplace(key, std::prev(storage.records.end()));
+
+  if (storage.threshold > 0 && !storage.threshold_notified &&
+      storage.records.size() >= storage.threshold) {
+    storage.threshold_notified = true;
+    return true;
+  }
+  return false;
+}
+
+std::pair<uint16_t, std::vector<uint8_t>> LeScanningBatcher::ReadReports(
+    BatchScanDataRead mode, std::chrono::steady_clock::time_point now) {
+  Storage& storage = mode == BatchScanDataRead::FULL_MODE_DATA ? full_ : truncated_;
+  std::vector<uint8_t> data;
+  uint16_t num_records = storage.records.size();
+
+  size_t size = 0;
+  for (const auto& record : storage.records) {
+    size += kTruncatedRecordSize;
+    if (mode == BatchScanDataRead::FULL_MODE_DATA) {
+      size += 2 + record.data.size();
+    }
+  }
+  data.reserve(size);
+
+  for (const auto& record : storage.records) {
+    uint16_t timestamp = EncodeTimestamp(record.timestamp, now);
+    data.insert(data.end(), record.address.data(), record.address.data() + Address::kLength);
+    data.push_back(record.address_type);
+    data.push_back((uint8_t)record.tx_power);
+    data.push_back((uint8_t)(record.rssi_sum / (int32_t)record.num_reports));
+    data.push_back((uint8_t)timestamp);
+    data.push_back((uint8_t)(timestamp >> 8));
+
+    if (mode == BatchScanDataRead::FULL_MODE_DATA) {
+      // Advertising data, then scan response data.
+      size_t advertising_size = std::min<size_t>(record.data.size(), kMaximumFullRecordData / 2);
+      data.push_back((uint8_t)advertising_size);
+      data.insert(data.end(), record.data.begin(), record.data.begin() + advertising_size);
+      data.push_back((uint8_t)(record.data.size() - advertising_size));
+      data.insert(data.end(), record.data.begin() + advertising_size, record.data.end());
+    }
+  }
+
+  storage.records.clear();
+  storage.index.clear();
+  storage.threshold_notified = false;
+  return {num_records, std::move(data)};
+}
+
+size_t LeScanningBatcher::HashData(const std::vector<uint8_t>& data) {
+  // FNV-1a.
+  uint64_t hash = 0xcbf29ce484222325;
+  for (uint8_t octet : data) {
+    hash = (hash ^ octet) * 0x100000001b3;
+  }
+  return (size_t)hash;
+}
+
+uint16_t LeScanningBatcher::EncodeTimestamp(
+    std::chrono::steady_clock::time_point timestamp, std::chrono::steady_clock::time_point now) {
+  auto age = std::chrono::duration_cast<std::chrono::milliseconds>(now - timestamp);
+  return (uint16_t)std::clamp<int64_t>(age / kTimestampUnit, 0, UINT16_MAX);
+}
+
+}  // namespace bluetooth::hci
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "hci/address.h"
+#include "hci/hci_packets.h"
+
+namespace bluetooth::hci {
+
+/// The LE Scanning batcher is a host implementation of the vendor batch
+/// scan storage, used when the controller does not support LE_BATCH_SCAN.
+/// Completed advertising reports are stored instead of being delivered one
+/// by one, and are read out as a single batch in the vendor record formats
+/// expected by the OnBatchScanReports callback.
+///
+/// Repeated reports of the same advertisement within a coalescing window
+/// are merged into one record: full mode records are keyed by advertiser
+/// and advertising data, truncated mode records by advertiser only. The
+/// RSSI of merged records is averaged, and their timestamp refreshed.
+/// A report received after the window of its record has elapsed starts a
+/// new record, as the controller stores one record per batch scan interval.
+class LeScanningBatcher {
+ public:
+  /// Number of records that can be stored, shared between the truncated
+  /// and full mode storages according to the configured percentages.
+  static constexpr size_t kStorageSize = 512;
+
+  /// Size of the truncated mode records: address, address type,
+  /// tx power, rssi and timestamp.
+  static constexpr size_t kTruncatedRecordSize = 11;
+
+  /// The advertising data of full mode records is split between the
+  /// advertising and scan response fields, whose lengths are parsed as
+  /// signed bytes by the upper layers.
+  static constexpr size_t kMaximumFullRecordData = 2 * 127;
+
+  /// Unit of the record timestamps, relative to the read time.
+  static constexpr std::chrono::milliseconds kTimestampUnit{50};
+
+  LeScanningBatcher() = default;
+
+  LeScanningBatcher(const LeScanningBatcher&) = delete;
+
+  LeScanningBatcher& operator=(const LeScanningBatcher&) = delete;
+
+  /// Configure the storage, with the same parameters as the vendor
+  /// Set Storage Parameters command: percentages of the storage reserved
+  /// for full and truncated records, and percentage of use that triggers
+  /// the threshold notification.
+  void ConfigureStorage(uint8_t full_max, uint8_t truncated_max, uint8_t notify_threshold);
+
+  /// Start storing reports in the selected modes, and select the
+  /// record discarded when the storage is full. Repeated reports are
+  /// merged for the duration of the coalescing window, or until the
+  /// records are read when the window is zero.
+  void Enable(
+      bool truncated,
+      bool full,
+      BatchScanDiscardRule discard_rule,
+      std::chrono::milliseconds coalescing_window = std::chrono::milliseconds::zero());
+
+  /// Stop storing reports. Stored records can still be read.
+  void Disable();
+
+  bool IsEnabled() const {
+    return truncated_.enabled || full_.enabled;
+  }
+
+  /// Store a completed advertising report.
+  /// Returns true when the notify threshold is crossed by this report,
+  /// the threshold is notified again only after the storage is read.
+  bool AddReport(
+      uint8_t address_type,
+      const Address& address,
+      int8_t tx_power,
+      int8_t rssi,
+      const std::vector<uint8_t>& advertising_data,
+      std::chrono::steady_clock::time_point now);
+
+  /// Read and clear the records of the selected storage.
+  /// Returns the number of records and the records serialized contiguously.
+  std::pair<uint16_t, std::vector<uint8_t>> ReadReports(
+      BatchScanDataRead mode, std::chrono::steady_clock::time_point now);
+
+ private:
+  struct Record {
+    Address address;
+    uint8_t address_type;
+    int8_t tx_power;
+    int32_t rssi_sum;
+    uint32_t num_reports;
+    std::chrono::steady_clock::time_point window_start;
+    std::chrono::steady_clock::time_point timestamp;
+    size_t data_hash;
+    std::vector<uint8_t> data;
+  };
+
+  struct RecordKey {
+    Address address;
+    uint8_t address_type;
+    size_t data_hash;
+
+    bool operator==(const RecordKey& other) const;
+  };
+
+  struct RecordKeyHash {
+    std::size_t operator()(const RecordKey& key) const;
+  };
+
+  /// Records are kept in insertion order, and indexed by key to merge
+  /// repeated reports in constant time.
+  struct Storage {
+    bool enabled{false};
+    size_t capacity{0};
+    size_t threshold{0};
+    bool threshold_notified{false};
+    std::list<Record> records;
+    std::unordered_map<RecordKey, std::list<Record>::iterator, RecordKeyHash> index;
+  };
+
+  Storage truncated_;
+  Storage full_;
+  uint8_t notify_threshold_{0};
+  BatchScanDiscardRule discard_rule_{BatchScanDiscardRule::OLDEST};
+  std::chrono::milliseconds coalescing_window_{0};
+
+  bool Store(
+      Storage& storage,
+      const RecordKey& key,
+      int8_t tx_power,
+      int8_t rssi,
+      const std::vector<uint8_t>* advertising_data,
+      std::chrono::steady_clock::time_point now);
+
+  static size_t HashData(const std::vector<uint8_t>& data);
+
+  static uint16_t EncodeTimestamp(
+      std::chrono::steady_clock::time_point timestamp, std::chrono::steady_clock::time_point now);
+};
+
+}  // namespace bluetooth::hci
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/le_scanning_batcher.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+namespace bluetooth::hci {
+
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+static const Address kTestAddress = Address({0, 1, 2, 3, 4, 5});
+static const Address kOtherAddress = Address({5, 4, 3, 2, 1, 0});
+static constexpr uint8_t kPublic = (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS;
+static constexpr int8_t kTxPower = 0x7f;
+static const std::vector<uint8_t> kAdvertisingData = {0x02, 0x01, 0x06, 0x03, 0x03, 0xaa, 0xfe};
+static const std::vector<uint8_t> kOtherAdvertisingData = {0x02, 0x01, 0x06};
+
+class LeScanningBatcherTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    batcher_.ConfigureStorage(50, 50, 0);
+  }
+
+  LeScanningBatcher batcher_;
+  steady_clock::time_point now_ = steady_clock::now();
+};
+
+TEST_F(LeScanningBatcherTest, disabled) {
+  ASSERT_FALSE(batcher_.IsEnabled());
+  batcher_.AddReport(kPublic, kTestAddress, kTxPower, -60, kAdvertisingData, now_);
+
+  auto [num_records, data] = batcher_.ReadReports(BatchScanDataRead::FULL_MODE_DATA, now_);
+  ASSERT_EQ(num_records, 0);
+  ASSERT_TRUE(data.empty());
+}
+
+TEST_F(LeScanningBatcherTest, full_mode_record_format) {
+  batcher_.Enable(false, true, BatchScanDiscardRule::OLDEST);
+  batcher_.AddReport(kPublic, kTestAddress, kTxPower, -60, kAdvertisingData, now_);
+
+  auto [num_records, data] =
+      batcher_.ReadReports(BatchScanDataRead::FULL_MODE_DATA, now_ + milliseconds(100));
+  std::vector<uint8_t> expected = {0, 1, 2, 3, 4, 5, kPublic, 0x7f, (uint8_t)-60, 0x02, 0x00, 0x07};
+  expected.insert(expected.end(), kAdvertisingData.begin(), kAdvertisingData.end());
+  expected.push_back(0x00);
+  ASSERT_EQ(num_records, 1);
+  ASSERT_EQ(data, expected);
+
+  // The storage is cleared by the read.
+  ASSERT_EQ(batcher_.ReadReports(BatchScanDataRead::FULL_MODE_DATA, now_).first, 0);
+}
+
+TEST_F(LeScanningBatcherTest, truncated_mode_record_format) {
+  batcher_.Enable(true, false, BatchScanDiscardRule::OLDEST);
+  batcher_.AddReport(kPublic, kTestAddress, kTxPower, -60, kAdvertisingData, now_);
+  batcher_.AddReport(kPublic, kTestAddress, kTxPower, -60, kOtherAdvertisingData, now_);
+
+  auto [num_records, data] = batcher_.ReadReports(BatchScanDataRead::TRUNCATED_MODE_DATA, now_);
+  ASSERT_EQ(num_records, 1);
+  ASSERT_EQ(data.size(), LeScanningBatcher::kTruncatedRecordSize);
+  ASSERT_EQ(batcher_.ReadReports(BatchScanDataRead::FULL_MODE_DATA, now_).first, 0);
+}
+
+TEST_F(LeScanningBatcherTest, duplicate_suppression) {
+  batcher_.Enable(false, true, BatchScanDiscardRule::OLDEST);
+  batcher_.AddReport(kPublic, kTestAddress, kTxPower, -60, kAdvertisingData, now_);
+  batcher_.AddReport(kPublic, kTestAddress, kTxPower, -70, kAdvertisingData, now_);
+  batcher_.AddReport(kPublic, kTestAddress, kTxPower, -80, kAdvertisingData, now_);
+  batcher_.AddReport(kPublic, kTestAddress, kTxPower, -60, kOtherAdvertisingData, now_);
+  batcher_.AddReport(kPublic, kOtherAddress, kTxPower, -60, kAdvertisingData, now_);
+
+  auto [num_records, data] = batcher_.ReadReports(BatchScanDataRead::FULL_MODE_DATA, now_);
+  ASSERT_EQ(num_records, 3);
+  // The RSSI of the merged reports is averaged.
+  ASSERT_EQ((int8_t)data[8], -70);
+}
+
+TEST_F(LeScanningBatcherTest, coalescing_window) {
+  batcher_.Enable(true, false, BatchScanDiscardRule::OLDEST, milliseconds(1000));
+  auto add_report = [&](int8_t rssi, milliseconds time) {
+    batcher_.AddReport(kPublic, kTestAddress, kTxPower, rssi, kAdvertisingData, now_ + time);
+  };
+  add_report(-60, milliseconds(0));
+  add_report(-70, milliseconds(500));
+  // The window of the first record is over: a new record is started,
+  // and the following reports are merged into it.
+  add_report(-80, milliseconds(1000));
+  add_report(-90, milliseconds(1500));
+
+  auto [num_records, data] =
+      batcher_.ReadReports(BatchScanDataRead::TRUNCATED_MODE_DATA, now_ + milliseconds(2000));
+  ASSERT_EQ(num_records, 2);
+  ASSERT_EQ(data.size(), 2 * LeScanningBatcher::kTruncatedRecordSize);
+  ASSERT_EQ((int8_t)data[8], -65);
+  ASSERT_EQ((int8_t)data[LeScanningBatcher::kTruncatedRecordSize + 8], -85);
+}
+
+TEST_F(LeScanningBatcherTest, discard_oldest) {
+  batcher_.ConfigureStorage(1, 0, 0);
+  batcher_.Enable(false, true, BatchScanDiscardRule::OLDEST);
+  for (uint8_t index = 0; index < LeScanningBatcher::kStorageSize / 100 + 1; index++) {
+    batcher_.AddReport(kPublic, Address({index, 0, 0, 0, 0, 0}), kTxPower, -60, {}, now_);
+  }
+
+  auto [num_records, data] = batcher_.ReadReports(BatchScanDataRead::FULL_MODE_DATA, now_);
+  ASSERT_EQ(num_records, LeScanningBatcher::kStorageSize / 100);
+  ASSERT_EQ(data[0], 1);
+}
+
+TEST_F(LeScanningBatcherTest, discard_weakest_rssi) {
+  batcher_.ConfigureStorage(1, 0, 0);
+  batcher_.Enable(false, true, BatchScanDiscardRule::WEAKEST_RSSI);
+  size_t capacity = LeScanningBatcher::kStorageSize / 100;
+  for (uint8_t index = 0; index < capacity; index++) {
+    batcher_.AddReport(
+        kPublic, Address({index, 0, 0, 0, 0, 0}), kTxPower, index == 1 ? -90 : -60, {}, now_);
+  }
+
+  // Weaker than all the stored records.
+  batcher_.AddReport(kPublic, Address({0xaa, 0, 0, 0, 0, 0}), kTxPower, -100, {}, now_);
+  // Replaces the weakest record.
+  batcher_.AddReport(kPublic, Address({0xbb, 0, 0, 0, 0, 0}), kTxPower, -50, {}, now_);
+
+  auto [num_records, data] = batcher_.ReadReports(BatchScanDataRead::FULL_MODE_DATA, now_);
+  ASSERT_EQ(num_records, capacity);
+  std::vector<uint8_t> addresses;
+  size_t record_size = LeScanningBatcher::kTruncatedRecordSize + 2;
+  for (size_t offset = 0; offset < data.size(); offset += record_size) {
+    addresses.push_back(data[offset]);
+  }
+  ASSERT_EQ(std::count(addresses.begin(), addresses.end(), 1), 0);
+  ASSERT_EQ(std::count(addresses.begin(), addresses.end(), 0xaa), 0);
+  ASSERT_EQ(std::count(addresses.begin(), addresses.end(), 0xbb), 1);
+}
+
+TEST_F(LeScanningBatcherTest, notify_threshold) {
+  batcher_.ConfigureStorage(100, 0, 50);
+  batcher_.Enable(false, true, BatchScanDiscardRule::OLDEST);
+
+  size_t threshold = LeScanningBatcher::kStorageSize / 2;
+  for (size_t index = 0; index < threshold - 1; index++) {
+    Address address({(uint8_t)index, (uint8_t)(index >> 8), 0, 0, 0, 0});
+    ASSERT_FALSE(batcher_.AddReport(kPublic, address, kTxPower, -60, {}, now_));
+  }
+  ASSERT_TRUE(batcher_.AddReport(kPublic, kTestAddress, kTxPower, -60, {}, now_));
+  ASSERT_FALSE(batcher_.AddReport(kPublic, kOtherAddress, kTxPower, -60, {}, now_));
+
+  // Notified again after a read.
+  batcher_.ReadReports(BatchScanDataRead::FULL_MODE_DATA, now_);
+  for (size_t index = 0; index < threshold - 1; index++) {
+    Address address({(uint8_t)index, (uint8_t)(index >> 8), 0, 0, 0, 0});
+    ASSERT_FALSE(batcher_.AddReport(kPublic, address, kTxPower, -60, {}, now_));
+  }
+  ASSERT_TRUE(batcher_.AddReport(kPublic, kTestAddress, kTxPower, -60, {}, now_));
+}
+
+}  // namespace bluetooth::hci
@@ -0,0 +1,509 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/le_scanning_filter.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "hci/address_with_type.h"
+#include "os/log.h"
+
+namespace bluetooth::hci {
+
+static bool IsEmptyIrk(const std::array<uint8_t, 16>& irk) {
+  return std::all_of(irk.begin(), irk.end(), [](uint8_t b) { return b == 0; });
+}
+
+std::size_t LeScanningFilter::UuidHash::operator()(const Uuid& uuid) const {
+  const Uuid::UUID128Bit& bytes = uuid.To128BitBE();
+  uint64_t msb, lsb;
+  std::memcpy(&msb, bytes.data(), sizeof(msb));
+  std::memcpy(&lsb, bytes.data() + sizeof(msb), sizeof(lsb));
+  return std::hash<uint64_t>{}(msb ^ (lsb * 0x9e3779b97f4a7c15));
+}
+
+bool LeScanningFilter::MaskedData::Matches(const uint8_t* entry, size_t size) const {
+  if (size < data.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < data.size(); i++) {
+    uint8_t m = mask.empty() ? 0xff : mask[i];
+    if ((entry[i] & m) != (data[i] & m)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool LeScanningFilter::ParameterSetup(
+    ApcfAction action, uint8_t filter_index, const AdvertisingFilterParameter& parameter) {
+  switch (action) {
+    case ApcfAction::ADD: {
+      auto it = filters_.find(filter_index);
+      if (it == filters_.end() && filters_.size() >= kMaximumFilters) {
+        LOG_WARN("No space left for filter index %d", filter_index);
+        return false;
+      }
+      CompiledFilter& filter = filters_[filter_index];
+      filter.has_parameters = true;
+      filter.feature_selection = parameter.feature_selection;
+      filter.list_logic_type = parameter.list_logic_type;
+      filter.filter_logic_type = parameter.filter_logic_type;
+      filter.rssi_high_thresh = static_cast<int8_t>(parameter.rssi_high_thresh);
+      break;
+    }
+    case ApcfAction::DELETE:
+      filters_.erase(filter_index);
+      break;
+    case ApcfAction::CLEAR:
+      filters_.clear();
+      break;
+    default:
+      LOG_ERROR("Unknown action type: %d", (uint16_t)action);
+      return false;
+  }
+
+  UpdateAdTypes();
+  return true;
+}
+
+bool LeScanningFilter::Add(
+    uint8_t filter_index, const std::vector<AdvertisingPacketContentFilterCommand>& filters) {
+  auto it = filters_.find(filter_index);
+  if (it == filters_.end()) {
+    if (filters_.size() >= kMaximumFilters) {
+      LOG_WARN("No space left for filter index %d", filter_index);
+      return false;
+    }
+    it = filters_.emplace(filter_index, CompiledFilter{}).first;
+  }
+
+  bool success = true;
+  for (const auto& command : filters) {
+    success &= AddCondition(it->second, command);
+  }
+
+  UpdateAdTypes();
+  return success;
+}
+
+bool LeScanningFilter::AddCondition(
+    CompiledFilter& filter, const AdvertisingPacketContentFilterCommand& command) {
+  /* If data is passed, both mask and data have to be the same length */
+  if (!command.data_mask.empty() && command.data.size() != command.data_mask.size()) {
+    LOG_ERROR("data and data_mask are of different size");
+    return false;
+  }
+
+  switch (command.filter_type) {
+    case ApcfFilterType::BROADCASTER_ADDRESS: {
+      AddressCondition condition{
+          .address = command.address, .address_type = command.application_address_type};
+      if (!IsEmptyIrk(command.irk)) {
+        condition.irk = command.irk;
+      }
+      filter.addresses.push_back(condition);
+      break;
+    }
+    case ApcfFilterType::SERVICE_UUID:
+    case ApcfFilterType::SERVICE_SOLICITATION_UUID: {
+      bool solicitation = command.filter_type == ApcfFilterType::SERVICE_SOLICITATION_UUID;
+      if (command.uuid_mask.IsEmpty()) {
+        (solicitation ? filter.solicitation_uuids : filter.service_uuids).insert(command.uuid);
+      } else {
+        (solicitation ? filter.masked_solicitation_uuids : filter.masked_service_uuids)
+            .push_back({command.uuid.To128BitLE(), command.uuid_mask.To128BitLE()});
+      }
+      break;
+    }
+    case ApcfFilterType::LOCAL_NAME:
+      filter.names.push_back(command.name);
+      break;
+    case ApcfFilterType::MANUFACTURER_DATA: {
+      // The company identifier is matched as the first two bytes of the
+      // manufacturer specific data, an empty mask matches all the bits.
+      uint16_t company_mask = command.company_mask != 0 ? command.company_mask : 0xffff;
+      MaskedData condition;
+      condition.data = {(uint8_t)command.company, (uint8_t)(command.company >> 8)};
+      condition.data.insert(condition.data.end(), command.data.begin(), command.data.end());
+      condition.mask = {(uint8_t)company_mask, (uint8_t)(company_mask >> 8)};
+      if (command.data_mask.empty()) {
+        condition.mask.insert(condition.mask.end(), command.data.size(), 0xff);
+      } else {
+        condition.mask.insert(
+            condition.mask.end(), command.data_mask.begin(), command.data_mask.end());
+      }
+      filter.manufacturer_data.push_back(std::move(condition));
+      break;
+    }
+    case ApcfFilterType::SERVICE_DATA:
+      // The service data includes the service UUID.
+      filter.service_data.push_back({command.data, command.data_mask});
+      break;
+    case ApcfFilterType::TRANSPORT_DISCOVERY_DATA: {
+      // Organization ID, TDS Flags, Transport Data Length, Transport Data.
+      MaskedData condition;
+      condition.data = {command.org_id, command.tds_flags};
+      condition.mask = {0xff, command.tds_flags_mask};
+      if (!command.data.empty()) {
+        condition.data.push_back(0);
+        condition.mask.push_back(0);
+        condition.data.insert(condition.data.end(), command.data.begin(), command.data.end());
+        if (command.data_mask.empty()) {
+          condition.mask.insert(condition.mask.end(), command.data.size(), 0xff);
+        } else {
+          condition.mask.insert(
+              condition.mask.end(), command.data_mask.begin(), command.data_mask.end());
+        }
+      }
+      filter.transport_discovery_data.push_back(std::move(condition));
+      break;
+    }
+    case ApcfFilterType::AD_TYPE:
+      filter.ad_type_data.emplace_back(command.ad_type, MaskedData{command.data, command.data_mask});
+      break;
+    default:
+      LOG_ERROR("Unsupported filter type: %d", (uint16_t)command.filter_type);
+      return false;
+  }
+
+  filter.num_conditions[(uint8_t)command.filter_type]++;
+  return true;
+}
+
+void LeScanningFilter::UpdateAdTypes() {
+  ad_types_.reset();
+  num_applied_filters_ = 0;
+  for (const auto& [filter_index, filter] : filters_) {
+    if (!filter.has_parameters) {
+      continue;
+    }
+    num_applied_filters_++;
+    if (!filter.service_uuids.empty() || !filter.masked_service_uuids.empty()) {
+      for (uint8_t type = kIncompleteListOf16BitUuids; type <= kCompleteListOf128BitUuids; type++) {
+        ad_types_.set(type);
+      }
+    }
+    if (!filter.solicitation_uuids.empty() || !filter.masked_solicitation_uuids.empty()) {
+      ad_types_.set(kListOf16BitSolicitationUuids);
+      ad_types_.set(kListOf32BitSolicitationUuids);
+      ad_types_.set(kListOf128BitSolicitationUuids);
+    }
+    if (!filter.names.empty()) {
+      ad_types_.set(kShortenedLocalName);
+      ad_types_.set(kCompleteLocalName);
+    }
+    if (!filter.manufacturer_data.empty()) {
+      ad_types_.set(kManufacturerSpecificData);
+    }
+    if (!filter.service_data.empty()) {
+      ad_types_.set(kServiceData16BitUuid);
+      ad_types_.set(kServiceData32BitUuid);
+      ad_types_.set(kServiceData128BitUuid);
+    }
+    if (!filter.transport_discovery_data.empty()) {
+      ad_types_.set(kTransportDiscoveryData);
+    }
+    for (const auto& [ad_type, data] : filter.ad_type_data) {
+      ad_types_.set(ad_type);
+    }
+  }
+}
+
+bool LeScanningFilter::Matches(
+    uint8_t address_type,
+    const Address& address,
+    int8_t rssi,
+    const std::vector<uint8_t>& advertising_data) const {
+  if (!enabled_ || num_applied_filters_ == 0) {
+    return true;
+  }
+
+  // Parse the advertising data once, keeping only the GAP Data entries
+  // looked at by the filters. The advertising data is already trimmed
+  // by the reassembler.
+  std::vector<AdEntry> entries;
+  for (size_t offset = 0; offset + 1 < advertising_data.size();) {
+    uint8_t entry_size = advertising_data[offset];
+    if (entry_size == 0 || offset + 1 + entry_size > advertising_data.size()) {
+      break;
+    }
+    uint8_t type = advertising_data[offset + 1];
+    if (ad_types_.test(type)) {
+      entries.push_back({type, advertising_data.data() + offset + 2, (size_t)entry_size - 1});
+    }
+    offset += entry_size + 1;
+  }
+
+  for (const auto& [filter_index, filter] : filters_) {
+    if (filter.has_parameters && MatchesFilter(filter, address_type, address, rssi, entries)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool LeScanningFilter::MatchesFilter(
+    const CompiledFilter& filter,
+    uint8_t address_type,
+    const Address& address,
+    int8_t rssi,
+    const std::vector<AdEntry>& entries) const {
+  constexpr int8_t kRssiUnknown = 127;
+  if (rssi != kRssiUnknown && rssi < filter.rssi_high_thresh) {
+    return false;
+  }
+
+  auto is_active = [&filter](ApcfFilterType type) {
+    return (filter.feature_selection & (1 << (uint8_t)type)) &&
+           filter.num_conditions[(uint8_t)type] > 0;
+  };
+  auto all = [&filter](ApcfFilterType type) {
+    return (filter.list_logic_type & (1 << (uint8_t)type)) != 0;
+  };
+
+  // The broadcaster address is always combined with a logical AND.
+  if (is_active(ApcfFilterType::BROADCASTER_ADDRESS) &&
+      !MatchesAddress(filter, address_type, address, all(ApcfFilterType::BROADCASTER_ADDRESS))) {
+    return false;
+  }
+
+  // Evaluate the content features in order, and stop as soon as the
+  // result is known: on the first mismatch with a logical AND, or on the
+  // first match with a logical OR.
+  bool filter_and = filter.filter_logic_type != 0;
+  bool any_active = false;
+
+  auto decides = [&](ApcfFilterType type, auto matches) {
+    if (!is_active(type)) {
+      return false;
+    }
+    any_active = true;
+    return matches(all(type)) != filter_and;
+  };
+
+  bool decided =
+      decides(
+          ApcfFilterType::SERVICE_UUID,
+          [&](bool all) {
+            return MatchesUuid(
+                filter.service_uuids, filter.masked_service_uuids, entries, false, all);
+          }) ||
+      decides(
+          ApcfFilterType::SERVICE_SOLICITATION_UUID,
+          [&](bool all) {
+            return MatchesUuid(
+                filter.solicitation_uuids, filter.masked_solicitation_uuids, entries, true, all);
+          }) ||
+      decides(
+          ApcfFilterType::LOCAL_NAME,
+          [&](bool all) { return MatchesName(filter.names, entries, all); }) ||
+      decides(
+          ApcfFilterType::MANUFACTURER_DATA,
+          [&](bool all) {
+            return MatchesData(
+                filter.manufacturer_data, entries, {kManufacturerSpecificData}, all);
+          }) ||
+      decides(
+          ApcfFilterType::SERVICE_DATA,
+          [&](bool all) {
+            return MatchesData(
+                filter.service_data,
+                entries,
+                {kServiceData16BitUuid, kServiceData32BitUuid, kServiceData128BitUuid},
+                all);
+          }) ||
+      decides(
+          ApcfFilterType::TRANSPORT_DISCOVERY_DATA,
+          [&](bool all) {
+            return MatchesData(
+                filter.transport_discovery_data, entries, {kTransportDiscoveryData}, all);
+          }) ||
+      decides(ApcfFilterType::AD_TYPE, [&](bool all) {
+        return MatchesAdTypeData(filter.ad_type_data, entries, all);
+      });
+
+  if (decided) {
+    return !filter_and;
+  }
+
+  // All the active features matched with a logical AND, or none matched
+  // with a logical OR; a filter without content features matches.
+  return filter_and || !any_active;
+}
+
+bool LeScanningFilter::MatchesAddress(
+    const CompiledFilter& filter, uint8_t address_type, const Address& address, bool all) {
+  // Identity addresses resolved by the controller keep their public or
+  // random nature.
+  bool is_random = address_type == (uint8_t)AddressType::RANDOM_DEVICE_ADDRESS ||
+                   address_type == (uint8_t)AddressType::RANDOM_IDENTITY_ADDRESS;
+  bool is_public = address_type == (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS ||
+                   address_type == (uint8_t)AddressType::PUBLIC_IDENTITY_ADDRESS;
+
+  auto matches = [&](const AddressCondition& condition) {
+    bool type_matches = false;
+    switch (condition.address_type) {
+      case ApcfApplicationAddressType::PUBLIC:
+        type_matches = is_public;
+        break;
+      case ApcfApplicationAddressType::RANDOM:
+        type_matches = is_random;
+        break;
+      default:
+        type_matches = true;
+        break;
+    }
+    if (condition.address == address && type_matches) {
+      return true;
+    }
+    if (condition.irk.has_value() &&
+        address_type == (uint8_t)AddressType::RANDOM_DEVICE_ADDRESS) {
+      return AddressWithType(address, AddressType::RANDOM_DEVICE_ADDRESS)
+          .IsRpaThatMatchesIrk(condition.irk.value());
+    }
+    return false;
+  };
+
+  return all ? std::all_of(filter.addresses.begin(), filter.addresses.end(), matches)
+             : std::any_of(filter.addresses.begin(), filter.addresses.end(), matches);
+}
+
+bool LeScanningFilter::MatchesUuid(
+    const std::unordered_set<Uuid, UuidHash>& uuids,
+    const std::vector<MaskedUuid>& masked_uuids,
+    const std::vector<AdEntry>& entries,
+    bool solicitation,
+    bool all) {
+  // Extract the UUIDs advertised in the report.
+  std::vector<Uuid> report_uuids;
+  for (const auto& entry : entries) {
+    size_t uuid_size = 0;
+    switch (entry.type) {
+      case kIncompleteListOf16BitUuids:
+      case kCompleteListOf16BitUuids:
+        uuid_size = solicitation ? 0 : Uuid::kNumBytes16;
+        break;
+      case kIncompleteListOf32BitUuids:
+      case kCompleteListOf32BitUuids:
+        uuid_size = solicitation ? 0 : Uuid::kNumBytes32;
+        break;
+      case kIncompleteListOf128BitUuids:
+      case kCompleteListOf128BitUuids:
+        uuid_size = solicitation ? 0 : Uuid::kNumBytes128;
+        break;
+      case kListOf16BitSolicitationUuids:
+        uuid_size = solicitation ? Uuid::kNumBytes16 : 0;
+        break;
+      case kListOf32BitSolicitationUuids:
+        uuid_size = solicitation ? Uuid::kNumBytes32 : 0;
+        break;
+      case kListOf128BitSolicitationUuids:
+        uuid_size = solicitation ? Uuid::kNumBytes128 : 0;
+        break;
+      default:
+        break;
+    }
+    if (uuid_size == 0) {
+      continue;
+    }
+    for (size_t offset = 0; offset + uuid_size <= entry.size; offset += uuid_size) {
+      const uint8_t* p = entry.data + offset;
+      if (uuid_size == Uuid::kNumBytes16) {
+        report_uuids.push_back(Uuid::From16Bit(p[0] | (p[1] << 8)));
+      } else if (uuid_size == Uuid::kNumBytes32) {
+        report_uuids.push_back(Uuid::From32Bit(
+            (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+            ((uint32_t)p[3] << 24)));
+      } else {
+        report_uuids.push_back(Uuid::From128BitLE(p));
+      }
+    }
+  }
+
+  auto in_report = [&report_uuids](const Uuid& uuid) {
+    return std::find(report_uuids.begin(), report_uuids.end(), uuid) != report_uuids.end();
+  };
+  auto masked_in_report = [&report_uuids](const MaskedUuid& condition) {
+    return std::any_of(report_uuids.begin(), report_uuids.end(), [&condition](const Uuid& uuid) {
+      Uuid::UUID128Bit bytes = uuid.To128BitLE();
+      for (size_t i = 0; i < bytes.size(); i++) {
+        if ((bytes[i] & condition.mask[i]) != (condition.uuid[i] & condition.mask[i])) {
+          return false;
+        }
+      }
+      return true;
+    });
+  };
+
+  if (all) {
+    return std::all_of(uuids.begin(), uuids.end(), in_report) &&
+           std::all_of(masked_uuids.begin(), masked_uuids.end(), masked_in_report);
+  }
+
+  return std::any_of(
+             report_uuids.begin(),
+             report_uuids.end(),
+             [&uuids](const Uuid& uuid) { return uuids.count(uuid) != 0; }) ||
+         std::any_of(masked_uuids.begin(), masked_uuids.end(), masked_in_report);
+}
+
+bool LeScanningFilter::MatchesName(
+    const std::vector<std::vector<uint8_t>>& names, const std::vector<AdEntry>& entries, bool all) {
+  auto matches = [&entries](const std::vector<uint8_t>& name) {
+    return std::any_of(entries.begin(), entries.end(), [&name](const AdEntry& entry) {
+      return (entry.type == kShortenedLocalName || entry.type == kCompleteLocalName) &&
+             entry.size >= name.size() &&
+             std::equal(name.begin(), name.end(), entry.data);
+    });
+  };
+
+  return all ? std::all_of(names.begin(), names.end(), matches)
+             : std::any_of(names.begin(), names.end(), matches);
+}
+
+bool LeScanningFilter::MatchesData(
+    const std::vector<MaskedData>& conditions,
+    const std::vector<AdEntry>& entries,
+    std::initializer_list<uint8_t> types,
+    bool all) {
+  auto matches = [&entries, &types](const MaskedData& condition) {
+    return std::any_of(entries.begin(), entries.end(), [&condition, &types](const AdEntry& entry) {
+      return std::find(types.begin(), types.end(), entry.type) != types.end() &&
+             condition.Matches(entry.data, entry.size);
+    });
+  };
+
+  return all ? std::all_of(conditions.begin(), conditions.end(), matches)
+             : std::any_of(conditions.begin(), conditions.end(), matches);
+}
+
+bool LeScanningFilter::MatchesAdTypeData(
+    const std::vector<std::pair<uint8_t, MaskedData>>& conditions,
+    const std::vector<AdEntry>& entries,
+    bool all) {
+  auto matches = [&entries](const std::pair<uint8_t, MaskedData>& condition) {
+    return std::any_of(entries.begin(), entries.end(), [&condition](const AdEntry& entry) {
+      return entry.type == condition.first && condition.second.Matches(entry.data, entry.size);
+    });
+  };
+
+  return all ? std::all_of(conditions.begin(), conditions.end(), matches)
+             : std::any_of(conditions.begin(), conditions.end(), matches);
+}
+
+}  // namespace bluetooth::hci
@@ -0,0 +1,220 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <optional>
+#include <unordered_set>
+#include <vector>
+
+#include "hci/address.h"
+#include "hci/hci_packets.h"
+#include "hci/le_scanning_callback.h"
+#include "hci/octets.h"
+#include "hci/uuid.h"
+
+namespace bluetooth::hci {
+
+/// The LE Scanning filter is a host implementation of the Advertising
+/// Packet Content Filter (APCF), used when the controller does not support
+/// filter offloading. Reports that do not match any of the configured
+/// filters are dropped before being delivered to the scanning callbacks.
+///
+/// Filters are configured with the same parameters as the APCF vendor
+/// commands, and are compiled into a matcher:
+/// - the AD types looked at by the filters are gathered in a bitset,
+///   so the advertising data is parsed once and only the relevant GAP
+///   entries are kept,
+/// - unmasked service UUIDs are looked up in a hashed set.
+class LeScanningFilter {
+ public:
+  /// Maximum number of filter indexes, the same value is reported
+  /// by controllers supporting APCF.
+  static constexpr size_t kMaximumFilters = 32;
+
+  LeScanningFilter() = default;
+
+  LeScanningFilter(const LeScanningFilter&) = delete;
+
+  LeScanningFilter& operator=(const LeScanningFilter&) = delete;
+
+  /// Enable or disable the filtering. When disabled, or when no filter
+  /// has parameters, all the reports are matched.
+  void Enable(bool enable) {
+    enabled_ = enable;
+  }
+
+  bool IsEnabled() const {
+    return enabled_;
+  }
+
+  /// Add, delete or clear the filter parameters of `filter_index`.
+  /// Deleting the parameters removes the associated filter content.
+  /// Returns false if the action could not be applied.
+  bool ParameterSetup(
+      ApcfAction action, uint8_t filter_index, const AdvertisingFilterParameter& parameter);
+
+  /// Add filter content to `filter_index`. The content can be added before
+  /// the parameters, as done by the upper layers, but the filter is only
+  /// applied once its parameters are set.
+  /// Returns false if no index is left, or a filter is invalid.
+  bool Add(uint8_t filter_index, const std::vector<AdvertisingPacketContentFilterCommand>& filters);
+
+  /// Return the number of filter indexes that can still be configured.
+  uint8_t GetAvailableSpaces() const {
+    return kMaximumFilters - filters_.size();
+  }
+
+  /// Check if an advertising report, after reassembly, matches
+  /// any of the configured filters.
+  bool Matches(
+      uint8_t address_type,
+      const Address& address,
+      int8_t rssi,
+      const std::vector<uint8_t>& advertising_data) const;
+
+ private:
+  /// GAP Data Types looked at by the filters.
+  static constexpr uint8_t kIncompleteListOf16BitUuids = 0x02;
+  static constexpr uint8_t kCompleteListOf16BitUuids = 0x03;
+  static constexpr uint8_t kIncompleteListOf32BitUuids = 0x04;
+  static constexpr uint8_t kCompleteListOf32BitUuids = 0x05;
+  static constexpr uint8_t kIncompleteListOf128BitUuids = 0x06;
+  static constexpr uint8_t kCompleteListOf128BitUuids = 0x07;
+  static constexpr uint8_t kShortenedLocalName = 0x08;
+  static constexpr uint8_t kCompleteLocalName = 0x09;
+  static constexpr uint8_t kListOf16BitSolicitationUuids = 0x14;
+  static constexpr uint8_t kListOf128BitSolicitationUuids = 0x15;
+  static constexpr uint8_t kServiceData16BitUuid = 0x16;
+  static constexpr uint8_t kListOf32BitSolicitationUuids = 0x1f;
+  static constexpr uint8_t kServiceData32BitUuid = 0x20;
+  static constexpr uint8_t kServiceData128BitUuid = 0x21;
+  static constexpr uint8_t kTransportDiscoveryData = 0x26;
+  static constexpr uint8_t kManufacturerSpecificData = 0xff;
+
+  /// GAP Data entry of a report, referencing the advertising data.
+  struct AdEntry {
+    uint8_t type;
+    const uint8_t* data;
+    size_t size;
+  };
+
+  struct UuidHash {
+    std::size_t operator()(const Uuid& uuid) const;
+  };
+
+  /// Content compared to the start of a GAP Data entry, under a mask.
+  /// An empty mask compares all the bits.
+  struct MaskedData {
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> mask;
+
+    bool Matches(const uint8_t* entry, size_t size) const;
+  };
+
+  struct MaskedUuid {
+    Uuid::UUID128Bit uuid;
+    Uuid::UUID128Bit mask;
+  };
+
+  /// Broadcaster address, with the IRK used to resolve private
+  /// addresses when present.
+  struct AddressCondition {
+    Address address;
+    ApcfApplicationAddressType address_type;
+    std::optional<Octet16> irk;
+  };
+
+  /// Compiled filter of one filter index. Conditions of the same feature
+  /// are combined according to the list logic type, and the features
+  /// according to the filter logic type.
+  struct CompiledFilter {
+    bool has_parameters{false};
+    uint16_t feature_selection{0};
+    uint16_t list_logic_type{0};
+    uint8_t filter_logic_type{0};
+    int8_t rssi_high_thresh{-128};
+
+    std::vector<AddressCondition> addresses;
+    std::unordered_set<Uuid, UuidHash> service_uuids;
+    std::vector<MaskedUuid> masked_service_uuids;
+    std::unordered_set<Uuid, UuidHash> solicitation_uuids;
+    std::vector<MaskedUuid> masked_solicitation_uuids;
+    std::vector<std::vector<uint8_t>> names;
+    std::vector<MaskedData> manufacturer_data;
+    std::vector<MaskedData> service_data;
+    std::vector<MaskedData> transport_discovery_data;
+    std::vector<std::pair<uint8_t, MaskedData>> ad_type_data;
+
+    /// Number of conditions configured for each ApcfFilterType.
+    std::array<size_t, 9> num_conditions{};
+  };
+
+  bool enabled_{false};
+  std::map<uint8_t, CompiledFilter> filters_;
+
+  /// Union of the AD types looked at by the configured filters.
+  std::bitset<256> ad_types_;
+
+  /// Number of filters with parameters, which are applied to the reports.
+  size_t num_applied_filters_{0};
+
+  void UpdateAdTypes();
+
+  bool AddCondition(CompiledFilter& filter, const AdvertisingPacketContentFilterCommand& command);
+
+  bool MatchesFilter(
+      const CompiledFilter& filter,
+      uint8_t address_type,
+      const Address& address,
+      int8_t rssi,
+      const std::vector<AdEntry>& entries) const;
+
+  static bool MatchesAddress(
+      const CompiledFilter& filter,
+      uint8_t address_type,
+      const Address& address,
+      bool all);
+
+  static bool MatchesUuid(
+      const std::unordered_set<Uuid, UuidHash>& uuids,
+      const std::vector<MaskedUuid>& masked_uuids,
+      const std::vector<AdEntry>& entries,
+      bool solicitation,
+      bool all);
+
+  static bool MatchesName(
+      const std::vector<std::vector<uint8_t>>& names,
+      const std::vector<AdEntry>& entries,
+      bool all);
+
+  static bool MatchesData(
+      const std::vector<MaskedData>& conditions,
+      const std::vector<AdEntry>& entries,
+      std::initializer_list<uint8_t> types,
+      bool all);
+
+  static bool MatchesAdTypeData(
+      const std::vector<std::pair<uint8_t, MaskedData>>& conditions,
+      const std::vector<AdEntry>& entries,
+      bool all);
+};
+
+}  // namespace bluetooth::hci
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hci/le_scanning_filter.h"
+
+using ::benchmark::State;
+
+namespace bluetooth::hci {
+
+static constexpr uint8_t kRandom = (uint8_t)AddressType::RANDOM_DEVICE_ADDRESS;
+
+// Filters registered by typical applications: Fast Pair service UUID,
+// Eddystone service data, iBeacon manufacturer data, device names and
+// bonded device addresses. Each filter uses its own filter index.
+class BM_LeScanningFilter : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+
+    filter_.Enable(true);
+    AddFilter(0, ServiceUuid(0xfe2c));
+    AddFilter(1, ServiceData({0xaa, 0xfe, 0x10}, {0xff, 0xff, 0xff}));
+    AddFilter(2, ManufacturerData(0x004c, {0x02, 0x15}));
+    AddFilter(3, Name("Pixel Buds"));
+    AddFilter(4, Name("Galaxy Buds"));
+    for (uint8_t index = 5; index < 5 + st.range(0); index++) {
+      AdvertisingPacketContentFilterCommand command{};
+      command.filter_type = ApcfFilterType::BROADCASTER_ADDRESS;
+      command.address = Address({0x00, 0x1a, 0x7d, 0xda, 0x71, index});
+      AddFilter(index, command);
+    }
+
+    // Reports received while scanning in a dense environment, most of them
+    // not matching any filter.
+    reports_.push_back({0x02, 0x01, 0x06, 0x03, 0x03, 0x2c, 0xfe, 0x06, 0x16, 0x2c, 0xfe, 0x00, 0x00,
+                        0x01});
+    reports_.push_back({0x02, 0x01, 0x06, 0x03, 0x03, 0xaa, 0xfe, 0x07, 0x16, 0xaa, 0xfe, 0x10, 0x00,
+                        0x03, 'a'});
+    reports_.push_back({0x02, 0x01, 0x06, 0x1a, 0xff, 0x4c, 0x00, 0x02, 0x15, 0x01, 0x02, 0x03, 0x04,
+                        0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10,
+                        0x00, 0x01, 0x00, 0x02, 0xc5});
+    reports_.push_back({0x02, 0x01, 0x1a, 0x0a, 0xff, 0x4c, 0x00, 0x10, 0x05, 0x01, 0x18, 0x2b,
+                        0x7c, 0x9e});
+    reports_.push_back({0x02, 0x01, 0x1a, 0x0a, 0xff, 0x4c, 0x00, 0x10, 0x05, 0x03, 0x1c, 0x11,
+                        0x5d, 0x31});
+    reports_.push_back({0x1e, 0xff, 0x06, 0x00, 0x01, 0x09, 0x20, 0x22, 0x6a, 0x4a, 0x61, 0x1b,
+                        0x2c, 0x75, 0x97, 0x1d, 0x2a, 0xf5, 0x1d, 0x64, 0x2d, 0x0d, 0x8e, 0xe8,
+                        0x07, 0x85, 0x4b, 0x30, 0x58, 0x41, 0x7a});
+    reports_.push_back({0x02, 0x01, 0x06, 0x05, 0x03, 0x0f, 0x18, 0x0a, 0x18, 0x08, 0x09, 'S', 'e',
+                        'n', 's', 'o', 'r', '1'});
+    reports_.push_back({0x02, 0x01, 0x06, 0x11, 0x07, 0x9e, 0xca, 0xdc, 0x24, 0x0e, 0xe5, 0xa9,
+                        0xe0, 0x93, 0xf3, 0xa3, 0xb5, 0x01, 0x00, 0x40, 0x6e});
+  }
+
+  void TearDown(State& st) override {
+    reports_.clear();
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  void AddFilter(uint8_t filter_index, AdvertisingPacketContentFilterCommand command) {
+    AdvertisingFilterParameter parameter{};
+    parameter.feature_selection = 1 << (uint8_t)command.filter_type;
+    parameter.filter_logic_type = 1;
+    parameter.rssi_high_thresh = (uint8_t)-128;
+    filter_.ParameterSetup(ApcfAction::ADD, filter_index, parameter);
+    filter_.Add(filter_index, {command});
+  }
+
+  static AdvertisingPacketContentFilterCommand ServiceUuid(uint16_t uuid) {
+    AdvertisingPacketContentFilterCommand command{};
+    command.filter_type = ApcfFilterType::SERVICE_UUID;
+    command.uuid = Uuid::From16Bit(uuid);
+    command.uuid_mask = Uuid::kEmpty;
+    return command;
+  }
+
+  static AdvertisingPacketContentFilterCommand ServiceData(
+      std::vector<uint8_t> data, std::vector<uint8_t> data_mask) {
+    AdvertisingPacketContentFilterCommand command{};
+    command.filter_type = ApcfFilterType::SERVICE_DATA;
+    command.data = data;
+    command.data_mask = data_mask;
+    return command;
+  }
+
+  static AdvertisingPacketContentFilterCommand ManufacturerData(
+      uint16_t company, std::vector<uint8_t> data) {
+    AdvertisingPacketContentFilterCommand command{};
+    command.filter_type = ApcfFilterType::MANUFACTURER_DATA;
+    command.company = company;
+    command.data = data;
+    return command;
+  }
+
+  static AdvertisingPacketContentFilterCommand Name(std::string name) {
+    AdvertisingPacketContentFilterCommand command{};
+    command.filter_type = ApcfFilterType::LOCAL_NAME;
+    command.name = std::vector<uint8_t>(name.begin(), name.end());
+    return command;
+  }
+
+  LeScanningFilter filter_;
+  std::vector<std::vector<uint8_t>> reports_;
+};
+
+BENCHMARK_DEFINE_F(BM_LeScanningFilter, match_dense_scan)(State& state) {
+  size_t num_matches = 0;
+  uint8_t index = 0;
+
+  for (auto _ : state) {
+    for (const auto& report : reports_) {
+      Address address({0xc0, 0x01, 0x02, 0x03, 0x04, index++});
+      num_matches += filter_.Matches(kRandom, address, -70, report);
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * reports_.size());
+  state.counters["matches"] =
+      ::benchmark::Counter(num_matches, ::benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK_REGISTER_F(BM_LeScanningFilter, match_dense_scan)
+    ->Arg(0)
+    ->Arg(8)
+    ->Arg(24)
+    ->Unit(::benchmark::kNanosecond);
+
+}  // namespace bluetooth::hci
@@ -0,0 +1,206 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/le_scanning_filter.h"
+
+#include <gtest/gtest.h>
+
+namespace bluetooth::hci {
+
+static const Address kTestAddress = Address({0, 1, 2, 3, 4, 5});
+static const Address kOtherAddress = Address({5, 4, 3, 2, 1, 0});
+static constexpr uint8_t kPublic = (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS;
+static constexpr uint8_t kRandom = (uint8_t)AddressType::RANDOM_DEVICE_ADDRESS;
+static constexpr int8_t kRssi = -60;
+
+// Flags, Complete List of 16-bit Service UUIDs (0x180f, 0xfeaa),
+// Complete Local Name "Pixel Buds", Manufacturer Data (0x00e0, 0x01 0x02).
+static const std::vector<uint8_t> kAdvertisingData = {
+    0x02, 0x01, 0x06, 0x05, 0x03, 0x0f, 0x18, 0xaa, 0xfe, 0x0b, 0x09, 'P', 'i', 'x', 'e',
+    'l',  ' ',  'B',  'u',  'd',  's',  0x05, 0xff, 0xe0, 0x00, 0x01, 0x02};
+
+class LeScanningFilterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    filter_.Enable(true);
+  }
+
+  void AddFilter(
+      uint8_t filter_index,
+      std::vector<AdvertisingPacketContentFilterCommand> commands,
+      uint8_t filter_logic_type = 1) {
+    AdvertisingFilterParameter parameter{};
+    for (const auto& command : commands) {
+      parameter.feature_selection |= 1 << (uint8_t)command.filter_type;
+    }
+    parameter.filter_logic_type = filter_logic_type;
+    parameter.rssi_high_thresh = (uint8_t)-128;
+    ASSERT_TRUE(filter_.ParameterSetup(ApcfAction::ADD, filter_index, parameter));
+    ASSERT_TRUE(filter_.Add(filter_index, commands));
+  }
+
+  static AdvertisingPacketContentFilterCommand ServiceUuid(Uuid uuid) {
+    AdvertisingPacketContentFilterCommand command{};
+    command.filter_type = ApcfFilterType::SERVICE_UUID;
+    command.uuid = uuid;
+    command.uuid_mask = Uuid::kEmpty;
+    return command;
+  }
+
+  static AdvertisingPacketContentFilterCommand ManufacturerData(
+      uint16_t company, std::vector<uint8_t> data, std::vector<uint8_t> data_mask) {
+    AdvertisingPacketContentFilterCommand command{};
+    command.filter_type = ApcfFilterType::MANUFACTURER_DATA;
+    command.company = company;
+    command.data = data;
+    command.data_mask = data_mask;
+    return command;
+  }
+
+  static AdvertisingPacketContentFilterCommand Name(std::string name) {
+    AdvertisingPacketContentFilterCommand command{};
+    command.filter_type = ApcfFilterType::LOCAL_NAME;
+    command.name = std::vector<uint8_t>(name.begin(), name.end());
+    return command;
+  }
+
+  static AdvertisingPacketContentFilterCommand BroadcasterAddress(
+      Address address,
+      ApcfApplicationAddressType address_type = ApcfApplicationAddressType::PUBLIC) {
+    AdvertisingPacketContentFilterCommand command{};
+    command.filter_type = ApcfFilterType::BROADCASTER_ADDRESS;
+    command.address = address;
+    command.application_address_type = address_type;
+    return command;
+  }
+
+  LeScanningFilter filter_;
+};
+
+TEST_F(LeScanningFilterTest, no_filter) {
+  ASSERT_TRUE(filter_.Matches(kPublic, kTestAddress, kRssi, kAdvertisingData));
+
+  filter_.Enable(false);
+  AddFilter(0, {ServiceUuid(Uuid::From16Bit(0x1234))});
+  ASSERT_TRUE(filter_.Matches(kPublic, kTestAddress, kRssi, kAdvertisingData));
+}
+
+TEST_F(LeScanningFilterTest, service_uuid) {
+  AddFilter(0, {ServiceUuid(Uuid::From16Bit(0x1234))});
+  ASSERT_FALSE(filter_.Matches(kPublic, kTestAddress, kRssi, kAdvertisingData));
+
+  AddFilter(1, {ServiceUuid(Uuid::From16Bit(0xfeaa))});
+  ASSERT_TRUE(filter_.Matches(kPublic, kTestAddress, kRssi, kAdvertisingData));
+
+  ASSERT_TRUE(filter_.ParameterSetup(ApcfAction::DELETE, 1, {}));
+  ASSERT_FALSE(filter_.Matches(kPublic, kTestAddress, kRssi, kAdvertisingData));
+}
+
+TEST_F(LeScanningFilterTest, masked_service_uuid) {
+  AdvertisingPacketContentFilterCommand command = ServiceUuid(Uuid::From16Bit(0x1800));
+  command.uuid_mask = Uuid::From16Bit(0xff00);
+  AddFilter(0, {command});
+  ASSERT_TRUE(filter_.Matches(kPublic, kTestAddress, kRssi, kAdvertisingData));
+}
+
+TEST_F(LeScanningFilterTest, manufacturer_data) {
+  AddFilter(0, {ManufacturerData(0x00e0, {0x01, 0x03}, {0xff, 0x00})});
+  ASSERT_TRUE(filter_.Matches(kPublic, kTestAddress, kRssi, kAdvertisingData));
+
+  ASSERT_TRUE(filter_.ParameterSetup(ApcfAction::CLEAR, 0, {}));
+  AddFilter(0, {ManufacturerData(0x00e0, {0x01, 0x03}, {})});
+  ASSERT_FALSE(filter_.Matches(kPublic, kTestAddress, kRssi, kAdvertisingData));
+}
+
+TEST_F(LeScanningFilterTest, local_name_prefix) {
+  AddFilter(0, {Name("Pixel")});
+  ASSERT_TRUE(filter_.Matches(kPublic, kTestAddress, kRssi, kAdvertisingData));
+
+  AddFilter(0, {Name("Galaxy")});
+  ASSERT_TRUE(filter_.Matches(kPublic, kTestAddress, kRssi, kAdvertisingData));
+
+  ASSERT_TRUE(filter_.ParameterSetup(ApcfAction::CLEAR, 0, {}));
+  AddFilter(0, {Name("Galaxy")});
+  ASSERT_FALSE(filter_.Matches(kPublic, kTestAddress, kRssi, kAdvertisingData));
+}
+
+TEST_F(LeScanningFilterTest, broadcaster_address) {
+  AddFilter(0, {BroadcasterAddress(kTestAddress), Name("Pixel")});
+  ASSERT_TRUE(filter_.Matches(kPublic, kTestAddress, kRssi, kAdvertisingData));
+  ASSERT_FALSE(filter_.Matches(kPublic, kOtherAddress, kRssi, kAdvertisingData));
+}
+
+TEST_F(LeScanningFilterTest, broadcaster_address_type) {
+  AddFilter(0, {BroadcasterAddress(kTestAddress, ApcfApplicationAddressType::PUBLIC)});
+  ASSERT_TRUE(filter_.Matches(kPublic, kTestAddress, kRssi, kAdvertisingData));
+  ASSERT_FALSE(filter_.Matches(kRandom, kTestAddress, kRssi, kAdvertisingData));
+
+  AddFilter(1, {BroadcasterAddress(kOtherAddress, ApcfApplicationAddressType::RANDOM)});
+  ASSERT_TRUE(filter_.Matches(kRandom, kOtherAddress, kRssi, kAdvertisingData));
+  ASSERT_FALSE(filter_.Matches(kPublic, kOtherAddress, kRssi, kAdvertisingData));
+
+  ASSERT_TRUE(filter_.ParameterSetup(ApcfAction::CLEAR, 0, {}));
+  AddFilter(0, {BroadcasterAddress(kTestAddress, ApcfApplicationAddressType::NOT_APPLICABLE)});
+  ASSERT_TRUE(filter_.Matches(kPublic, kTestAddress, kRssi, kAdvertisingData));
+  ASSERT_TRUE(filter_.Matches(kRandom, kTestAddress, kRssi, kAdvertisingData));
+}
+
+TEST_F(LeScanningFilterTest, filter_logic) {
+  // Logical AND between the features.
+  AddFilter(0, {ServiceUuid(Uuid::From16Bit(0x180f)), Name("Galaxy")}, 1);
+  ASSERT_FALSE(filter_.Matches(kPublic, kTestAddress, kRssi, kAdvertisingData));
+
+  // Logical OR between the features.
+  AddFilter(1, {ServiceUuid(Uuid::From16Bit(0x180f)), Name("Galaxy")}, 0);
+  ASSERT_TRUE(filter_.Matches(kPublic, kTestAddress, kRssi, kAdvertisingData));
+}
+
+TEST_F(LeScanningFilterTest, content_before_parameters) {
+  // The content is only applied once the parameters are set.
+  ASSERT_TRUE(filter_.Add(0, {Name("Galaxy")}));
+  ASSERT_TRUE(filter_.Matches(kPublic, kTestAddress, kRssi, kAdvertisingData));
+
+  AdvertisingFilterParameter parameter{};
+  parameter.feature_selection = 1 << (uint8_t)ApcfFilterType::LOCAL_NAME;
+  parameter.rssi_high_thresh = (uint8_t)-128;
+  ASSERT_TRUE(filter_.ParameterSetup(ApcfAction::ADD, 0, parameter));
+  ASSERT_FALSE(filter_.Matches(kPublic, kTestAddress, kRssi, kAdvertisingData));
+
+  ASSERT_TRUE(filter_.Add(0, {Name("Pixel")}));
+  ASSERT_TRUE(filter_.Matches(kPublic, kTestAddress, kRssi, kAdvertisingData));
+}
+
+TEST_F(LeScanningFilterTest, rssi_threshold) {
+  AdvertisingFilterParameter parameter{};
+  parameter.feature_selection = 1 << (uint8_t)ApcfFilterType::LOCAL_NAME;
+  parameter.filter_logic_type = 1;
+  parameter.rssi_high_thresh = (uint8_t)-50;
+  ASSERT_TRUE(filter_.ParameterSetup(ApcfAction::ADD, 0, parameter));
+  ASSERT_TRUE(filter_.Add(0, {Name("Pixel")}));
+
+  ASSERT_FALSE(filter_.Matches(kPublic, kTestAddress, -60, kAdvertisingData));
+  ASSERT_TRUE(filter_.Matches(kPublic, kTestAddress, -40, kAdvertisingData));
+}
+
+TEST_F(LeScanningFilterTest, available_spaces) {
+  for (uint8_t index = 0; index < LeScanningFilter::kMaximumFilters; index++) {
+    AddFilter(index, {Name("Pixel")});
+  }
+  ASSERT_EQ(filter_.GetAvailableSpaces(), 0);
+  ASSERT_FALSE(filter_.ParameterSetup(ApcfAction::ADD, LeScanningFilter::kMaximumFilters, {}));
+}
+
+}  // namespace bluetooth::hci
@@ -17,6 +17,7 @@
 
 #include <android_bluetooth_flags.h>
 
+#include <algorithm>
 #include <memory>
 #include <unordered_map>
 
@@ -26,6 +27,8 @@
 #include "hci/hci_layer.h"
 #include "hci/hci_packets.h"
 #include "hci/le_periodic_sync_manager.h"
+#include "hci/le_scanning_batcher.h"
+#include "hci/le_scanning_filter.h"
 #include "hci/le_scanning_interface.h"
 #include "hci/le_scanning_reassembler.h"
 #include "hci/vendor_specific_event_manager.h"
@@ -469,6 +472,13 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
             event_type, address_type, address, advertising_sid, advertising_data);
 
     if (processed_report.has_value()) {
+      // Without advertising filter offload, the configured filters are
+      // applied by the host before reporting the advertisement.
+      if (!is_filter_supported_ &&
+          !software_filter_.Matches(address_type, address, rssi, processed_report->data)) {
+        return;
+      }
+
       switch (address_type) {
         case (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS:
         case (uint8_t)AddressType::PUBLIC_IDENTITY_ADDRESS:
@@ -480,6 +490,24 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
           break;
       }
 
+      // Without batch scan offload, the reports are also stored by the
+      // host for the batch scan clients, and delivered in batches when read.
+      if (!is_batch_scan_supported_ && software_batcher_.IsEnabled()) {
+        if (software_batcher_.AddReport(
+                address_type,
+                address,
+                tx_power,
+                get_rssi_after_calibration(rssi),
+                processed_report->data,
+                std::chrono::steady_clock::now())) {
+          notify_storage_threshold_crossed();
+        }
+        // The reports of a batch only scan are delivered in batches only.
+        if (!scan_requested_) {
+          return;
+        }
+      }
+
       const uint16_t result_event_type = IS_FLAG_ENABLED(fix_nonconnectable_scannable_advertisement)
                                              ? processed_report->extended_event_type
                                              : event_type;
@@ -499,10 +527,14 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
   }
 
   void configure_scan() {
+    // A batch only scan runs with the duty cycle of the batch scan.
+    uint32_t interval = scan_requested_ ? interval_ms_ : batch_scan_interval_;
+    uint16_t window = scan_requested_ ? window_ms_ : batch_scan_window_;
+
     std::vector<PhyScanParameters> parameter_vector;
     PhyScanParameters phy_scan_parameters;
-    phy_scan_parameters.le_scan_window_ = window_ms_;
-    phy_scan_parameters.le_scan_interval_ = interval_ms_;
+    phy_scan_parameters.le_scan_window_ = window;
+    phy_scan_parameters.le_scan_interval_ = interval;
     phy_scan_parameters.le_scan_type_ = le_scan_type_;
     parameter_vector.push_back(phy_scan_parameters);
     uint8_t phys_in_use = 1;
@@ -526,7 +558,7 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
       case ScanApiType::ANDROID_HCI:
         le_scanning_interface_->EnqueueCommand(
             LeExtendedScanParamsBuilder::Create(
-                le_scan_type_, interval_ms_, window_ms_, own_address_type_, filter_policy_),
+                le_scan_type_, interval, window, own_address_type_, filter_policy_),
             module_handler_->BindOnceOn(this, &impl::on_set_scan_parameter_complete));
 
         break;
@@ -534,7 +566,7 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
         le_scanning_interface_->EnqueueCommand(
 
             LeSetScanParametersBuilder::Create(
-                le_scan_type_, interval_ms_, window_ms_, own_address_type_, filter_policy_),
+                le_scan_type_, interval, window, own_address_type_, filter_policy_),
             module_handler_->BindOnceOn(this, &impl::on_set_scan_parameter_complete));
         break;
     }
@@ -580,17 +612,30 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
   void scan(bool start) {
     // On-resume flag should always be reset if there is an explicit start/stop call.
     scan_on_resume_ = false;
+    scan_requested_ = start;
     if (start) {
       configure_scan();
       start_scan();
+    } else if (is_host_batch_scanning()) {
+      LOG_INFO("Host batch scan in progress, keep scanning");
+      configure_scan();
+      start_scan();
     } else {
-      if (address_manager_registered_) {
-        le_address_manager_->Unregister(this);
-        address_manager_registered_ = false;
-        paused_ = false;
-      }
-      stop_scan();
+      stop_scanning();
+    }
+  }
+
+  void stop_scanning() {
+    if (address_manager_registered_) {
+      le_address_manager_->Unregister(this);
+      address_manager_registered_ = false;
+      paused_ = false;
     }
+    stop_scan();
+  }
+
+  bool is_host_batch_scanning() {
+    return !is_batch_scan_supported_ && software_batcher_.IsEnabled();
   }
 
   void start_scan() {
@@ -697,12 +742,14 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
   }
 
   void scan_filter_enable(bool enable) {
+    Enable apcf_enable = enable ? Enable::ENABLED : Enable::DISABLED;
     if (!is_filter_supported_) {
-      LOG_WARN("Advertising filter is not supported");
+      LOG_INFO("Advertising filter is not supported, using host filtering");
+      software_filter_.Enable(enable);
+      scanning_callbacks_->OnFilterEnable(apcf_enable, (uint8_t)ErrorCode::SUCCESS);
       return;
     }
 
-    Enable apcf_enable = enable ? Enable::ENABLED : Enable::DISABLED;
     le_scanning_interface_->EnqueueCommand(
         LeAdvFilterEnableBuilder::Create(apcf_enable),
         module_handler_->BindOnceOn(this, &impl::on_advertising_filter_complete));
@@ -722,7 +769,12 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
   void scan_filter_parameter_setup(
       ApcfAction action, uint8_t filter_index, AdvertisingFilterParameter advertising_filter_parameter) {
     if (!is_filter_supported_) {
-      LOG_WARN("Advertising filter is not supported");
+      bool success =
+          software_filter_.ParameterSetup(action, filter_index, advertising_filter_parameter);
+      scanning_callbacks_->OnFilterParamSetup(
+          software_filter_.GetAvailableSpaces(),
+          action,
+          (uint8_t)(success ? ErrorCode::SUCCESS : ErrorCode::MEMORY_CAPACITY_EXCEEDED));
       return;
     }
 
@@ -785,7 +837,14 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
 
   void scan_filter_add(uint8_t filter_index, std::vector<AdvertisingPacketContentFilterCommand> filters) {
     if (!is_filter_supported_) {
-      LOG_WARN("Advertising filter is not supported");
+      for (auto filter : filters) {
+        bool success = software_filter_.Add(filter_index, {filter});
+        scanning_callbacks_->OnFilterConfigCallback(
+            filter.filter_type,
+            software_filter_.GetAvailableSpaces(),
+            ApcfAction::ADD,
+            (uint8_t)(success ? ErrorCode::SUCCESS : ErrorCode::INVALID_HCI_COMMAND_PARAMETERS));
+      }
       return;
     }
 
@@ -1138,12 +1197,15 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
       uint8_t batch_scan_truncated_max,
       uint8_t batch_scan_notify_threshold,
       ScannerId scanner_id) {
+    // scanner id for OnBatchScanThresholdCrossed
+    batch_scan_config_.ref_value = scanner_id;
+
     if (!is_batch_scan_supported_) {
-      LOG_WARN("Batch scan is not supported");
+      LOG_INFO("Batch scan is not supported, using host batching");
+      software_batcher_.ConfigureStorage(
+          batch_scan_full_max, batch_scan_truncated_max, batch_scan_notify_threshold);
       return;
     }
-    // scanner id for OnBatchScanThresholdCrossed
-    batch_scan_config_.ref_value = scanner_id;
 
     if (batch_scan_config_.current_state == BatchScanState::ERROR_STATE ||
         batch_scan_config_.current_state == BatchScanState::DISABLED_STATE ||
@@ -1166,7 +1228,20 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
       uint32_t duty_cycle_scan_interval_slots,
       BatchScanDiscardRule batch_scan_discard_rule) {
     if (!is_batch_scan_supported_) {
-      LOG_WARN("Batch scan is not supported");
+      LOG_INFO("Batch scan is not supported, using host batching");
+      // Reports are coalesced over the batch scan interval, in slots of
+      // 0.625 ms, like the controller storing one record per interval.
+      software_batcher_.Enable(
+          scan_mode == BatchScanMode::TRUNCATED || scan_mode == BatchScanMode::TRUNCATED_AND_FULL,
+          scan_mode == BatchScanMode::FULL || scan_mode == BatchScanMode::TRUNCATED_AND_FULL,
+          batch_scan_discard_rule,
+          std::chrono::milliseconds(duty_cycle_scan_interval_slots * 5 / 8));
+      set_batch_scan_duty_cycle(duty_cycle_scan_window_slots, duty_cycle_scan_interval_slots);
+      // The regular scan already delivers the reports to the batcher.
+      if (!scan_requested_) {
+        configure_scan();
+        start_scan();
+      }
       return;
     }
 
@@ -1190,7 +1265,10 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
 
   void batch_scan_disable() {
     if (!is_batch_scan_supported_) {
-      LOG_WARN("Batch scan is not supported");
+      software_batcher_.Disable();
+      if (!scan_requested_) {
+        stop_scanning();
+      }
       return;
     }
     batch_scan_config_.current_state = BatchScanState::DISABLE_CALLED;
@@ -1201,6 +1279,27 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
         batch_scan_config_.discard_rule);
   }
 
+  // The batch scan interval can exceed the maximum scan interval, in which
+  // case the window is scaled down to keep the duty cycle.
+  void set_batch_scan_duty_cycle(uint32_t window_slots, uint32_t interval_slots) {
+    uint32_t max_scan_interval = kLeScanIntervalMax;
+    uint32_t max_scan_window = kLeScanWindowMax;
+    if (api_type_ == ScanApiType::EXTENDED) {
+      max_scan_interval = kLeExtendedScanIntervalMax;
+      max_scan_window = kLeExtendedScanWindowMax;
+    }
+
+    uint32_t interval = std::max<uint32_t>(interval_slots, kLeScanIntervalMin);
+    uint32_t window = window_slots;
+    if (interval > max_scan_interval) {
+      window = (uint64_t)window * max_scan_interval / interval;
+      interval = max_scan_interval;
+    }
+    window = std::min(window, std::min(interval, max_scan_window));
+    batch_scan_interval_ = interval;
+    batch_scan_window_ = std::max<uint32_t>(window, kLeScanWindowMin);
+  }
+
   void batch_scan_set_scan_parameter(
       BatchScanMode scan_mode,
       uint32_t duty_cycle_scan_window_slots,
@@ -1248,13 +1347,6 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
   }
 
   void batch_scan_read_results(ScannerId scanner_id, uint16_t total_num_of_records, BatchScanMode scan_mode) {
-    if (!is_batch_scan_supported_) {
-      LOG_WARN("Batch scan is not supported");
-      int status = static_cast<int>(ErrorCode::UNSUPPORTED_FEATURE_OR_PARAMETER_VALUE);
-      scanning_callbacks_->OnBatchScanReports(scanner_id, status, 0, 0, {});
-      return;
-    }
-
     if (scan_mode != BatchScanMode::FULL && scan_mode != BatchScanMode::TRUNCATED) {
       LOG_WARN("Invalid scan mode %d", (uint16_t)scan_mode);
       int status = static_cast<int>(ErrorCode::INVALID_HCI_COMMAND_PARAMETERS);
@@ -1262,6 +1354,16 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
       return;
     }
 
+    if (!is_batch_scan_supported_) {
+      // The host storage is read at once, in the same format as the
+      // controller storage.
+      auto [num_of_records, raw_data] = software_batcher_.ReadReports(
+          static_cast<BatchScanDataRead>(scan_mode), std::chrono::steady_clock::now());
+      scanning_callbacks_->OnBatchScanReports(
+          scanner_id, 0x00, (int)scan_mode, num_of_records, std::move(raw_data));
+      return;
+    }
+
     if (batch_scan_result_cache_.find(scanner_id) == batch_scan_result_cache_.end()) {
       std::vector<uint8_t> empty_data = {};
       batch_scan_result_cache_.emplace(scanner_id, empty_data);
@@ -1387,6 +1489,17 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
     return is_ad_type_filter_supported_;
   }
 
+  uint8_t get_host_filter_capacity() {
+    return is_filter_supported_ ? 0 : LeScanningFilter::kMaximumFilters;
+  }
+
+  uint16_t get_host_batch_scan_storage_size() {
+    if (is_batch_scan_supported_) {
+      return 0;
+    }
+    return LeScanningBatcher::kStorageSize * LeScanningBatcher::kTruncatedRecordSize;
+  }
+
   void on_set_scan_parameter_complete(CommandCompleteView view) {
     switch (view.GetCommandOpCode()) {
       case (OpCode::LE_SET_SCAN_PARAMETERS): {
@@ -1610,6 +1723,10 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
   }
 
   void on_storage_threshold_breach(VendorSpecificEventView /* event */) {
+    notify_storage_threshold_crossed();
+  }
+
+  void notify_storage_threshold_crossed() {
     if (batch_scan_config_.ref_value == kInvalidScannerId) {
       LOG_WARN("storage threshold was not set !!");
       return;
@@ -1695,9 +1812,13 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
   PeriodicSyncManager periodic_sync_manager_{&null_scanning_callback_};
   std::vector<Scanner> scanners_;
   bool is_scanning_ = false;
+  // Whether a regular scan is requested, as opposed to a host batch scan only.
+  bool scan_requested_ = false;
   bool scan_on_resume_ = false;
   bool paused_ = false;
   LeScanningReassembler scanning_reassembler_;
+  LeScanningFilter software_filter_;
+  LeScanningBatcher software_batcher_;
   bool is_filter_supported_ = false;
   bool is_ad_type_filter_supported_ = false;
   bool is_batch_scan_supported_ = false;
@@ -1707,6 +1828,8 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
   LeScanType le_scan_type_ = LeScanType::ACTIVE;
   uint32_t interval_ms_{1000};
   uint16_t window_ms_{1000};
+  uint32_t batch_scan_interval_{1000};
+  uint16_t batch_scan_window_{1000};
   OwnAddressType own_address_type_{OwnAddressType::PUBLIC_DEVICE_ADDRESS};
   LeScanningFilterPolicy filter_policy_{LeScanningFilterPolicy::ACCEPT_ALL};
   BatchScanConfig batch_scan_config_;
@@ -1867,5 +1990,13 @@ bool LeScanningManager::IsAdTypeFilterSupported() const {
   return pimpl_->is_ad_type_filter_supported();
 }
 
+uint8_t LeScanningManager::GetHostFilterCapacity() const {
+  return pimpl_->get_host_filter_capacity();
+}
+
+uint16_t LeScanningManager::GetHostBatchScanStorageSize() const {
+  return pimpl_->get_host_batch_scan_storage_size();
+}
+
 }  // namespace hci
 }  // namespace bluetooth
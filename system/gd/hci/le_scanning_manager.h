@@ -107,6 +107,16 @@ class LeScanningManager : public bluetooth::Module {
 
   virtual bool IsAdTypeFilterSupported() const;
 
+  /// Number of filter indexes of the host scan filter, used when the
+  /// controller does not support advertising filter offload.
+  /// Zero when the filters are offloaded to the controller.
+  virtual uint8_t GetHostFilterCapacity() const;
+
+  /// Size in bytes of the host batch scan storage, used when the
+  /// controller does not support batch scan offload.
+  /// Zero when the batch scan is offloaded to the controller.
+  virtual uint16_t GetHostBatchScanStorageSize() const;
+
   static const ModuleFactory Factory;
 
  protected:
@@ -36,6 +36,8 @@
 #include "hci/controller.h"
 #include "hci/hci_layer.h"
 #include "hci/hci_layer_fake.h"
+#include "hci/le_scanning_batcher.h"
+#include "hci/le_scanning_filter.h"
 #include "hci/uuid.h"
 #include "os/thread.h"
 #include "packet/raw_builder.h"
@@ -453,6 +455,139 @@ TEST_F(LeScanningManagerTest, scan_filter_add_ad_type_not_supported_test) {
   le_scanning_manager->ScanFilterAdd(0x01, filters);
 }
 
+TEST_F(LeScanningManagerTest, software_filter_drops_non_matching_reports) {
+  start_le_scanning_manager();
+
+  // Advertising filter offload is not supported by the controller, the
+  // filters are applied by the host.
+  ASSERT_EQ(LeScanningFilter::kMaximumFilters, le_scanning_manager->GetHostFilterCapacity());
+
+  LeAdvertisingResponse report = make_advertising_report();
+  LeAdvertisingResponse other_report = make_advertising_report();
+  Address::FromString("cb:a9:87:65:43:21", other_report.address_);
+
+  // The content is added before the parameters, as by the upper layers.
+  AdvertisingPacketContentFilterCommand filter{};
+  filter.filter_type = ApcfFilterType::BROADCASTER_ADDRESS;
+  filter.address = report.address_;
+  filter.application_address_type = ApcfApplicationAddressType::PUBLIC;
+  EXPECT_CALL(
+      mock_callbacks_,
+      OnFilterConfigCallback(
+          ApcfFilterType::BROADCASTER_ADDRESS, _, ApcfAction::ADD, (uint8_t)ErrorCode::SUCCESS));
+  le_scanning_manager->ScanFilterAdd(0x01, {filter});
+
+  AdvertisingFilterParameter advertising_filter_parameter{};
+  advertising_filter_parameter.feature_selection =
+      1 << (uint8_t)ApcfFilterType::BROADCASTER_ADDRESS;
+  advertising_filter_parameter.rssi_high_thresh = (uint8_t)-128;
+  EXPECT_CALL(
+      mock_callbacks_, OnFilterParamSetup(_, ApcfAction::ADD, (uint8_t)ErrorCode::SUCCESS));
+  le_scanning_manager->ScanFilterParameterSetup(
+      ApcfAction::ADD, 0x01, advertising_filter_parameter);
+
+  EXPECT_CALL(mock_callbacks_, OnFilterEnable(Enable::ENABLED, (uint8_t)ErrorCode::SUCCESS));
+  le_scanning_manager->ScanFilterEnable(true);
+
+  le_scanning_manager->Scan(true);
+  ASSERT_EQ(OpCode::LE_SET_SCAN_PARAMETERS, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(
+      LeSetScanParametersCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  ASSERT_EQ(OpCode::LE_SET_SCAN_ENABLE, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(
+      LeSetScanEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+
+  // Only the reports of the filtered advertiser are delivered.
+  EXPECT_CALL(mock_callbacks_, OnScanResult(_, _, Eq(report.address_), _, _, _, _, _, _, _))
+      .Times(1);
+  EXPECT_CALL(mock_callbacks_, OnScanResult(_, _, Eq(other_report.address_), _, _, _, _, _, _, _))
+      .Times(0);
+  test_hci_layer_->IncomingLeMetaEvent(LeAdvertisingReportBuilder::Create({other_report}));
+  test_hci_layer_->IncomingLeMetaEvent(LeAdvertisingReportBuilder::Create({report}));
+  sync_client_handler();
+}
+
+TEST_F(LeScanningManagerTest, read_software_batch_scan_result) {
+  start_le_scanning_manager();
+
+  // Batch scan is not supported by the controller, the reports are
+  // stored by the host.
+  le_scanning_manager->BatchScanConifgStorage(50, 50, 0, 0x01);
+  le_scanning_manager->BatchScanEnable(BatchScanMode::FULL, 2400, 2400, BatchScanDiscardRule::OLDEST);
+  ASSERT_EQ(OpCode::LE_SET_SCAN_PARAMETERS, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(
+      LeSetScanParametersCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  ASSERT_EQ(OpCode::LE_SET_SCAN_ENABLE, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(
+      LeSetScanEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+
+  // The regular scan restarts the scan with its own parameters.
+  le_scanning_manager->Scan(true);
+  ASSERT_EQ(OpCode::LE_SET_SCAN_ENABLE, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(
+      LeSetScanEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  ASSERT_EQ(OpCode::LE_SET_SCAN_PARAMETERS, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(
+      LeSetScanParametersCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  ASSERT_EQ(OpCode::LE_SET_SCAN_ENABLE, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(
+      LeSetScanEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+
+  // The regular scan results are still delivered, and duplicate reports
+  // are merged into a single record.
+  EXPECT_CALL(mock_callbacks_, OnScanResult).Times(2);
+  LeAdvertisingResponse report = make_advertising_report();
+  test_hci_layer_->IncomingLeMetaEvent(LeAdvertisingReportBuilder::Create({report}));
+  test_hci_layer_->IncomingLeMetaEvent(LeAdvertisingReportBuilder::Create({report}));
+  sync_client_handler();
+
+  EXPECT_CALL(
+      mock_callbacks_, OnBatchScanReports(0x01, 0x00, (int)BatchScanMode::FULL, 1, _));
+  le_scanning_manager->BatchScanReadReport(0x01, BatchScanMode::FULL);
+  sync_client_handler();
+}
+
+TEST_F(LeScanningManagerTest, software_batch_only_scan) {
+  start_le_scanning_manager();
+  ASSERT_EQ(
+      LeScanningBatcher::kStorageSize * LeScanningBatcher::kTruncatedRecordSize,
+      le_scanning_manager->GetHostBatchScanStorageSize());
+
+  // Without a regular scan, the batch scan starts scanning. Its interval of
+  // 150 s is clamped to the maximum scan interval, keeping the duty cycle.
+  le_scanning_manager->BatchScanConifgStorage(50, 50, 0, 0x01);
+  le_scanning_manager->BatchScanEnable(
+      BatchScanMode::FULL, 24000, 240000, BatchScanDiscardRule::OLDEST);
+  auto command = test_hci_layer_->GetCommand();
+  ASSERT_EQ(OpCode::LE_SET_SCAN_PARAMETERS, command.GetOpCode());
+  auto parameters_view = LeSetScanParametersView::Create(LeScanningCommandView::Create(command));
+  ASSERT_TRUE(parameters_view.IsValid());
+  ASSERT_EQ(0x4000, parameters_view.GetLeScanInterval());
+  ASSERT_EQ(0x0666, parameters_view.GetLeScanWindow());
+  test_hci_layer_->IncomingEvent(
+      LeSetScanParametersCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  ASSERT_EQ(OpCode::LE_SET_SCAN_ENABLE, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(
+      LeSetScanEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+
+  // The reports are only delivered in batches.
+  EXPECT_CALL(mock_callbacks_, OnScanResult).Times(0);
+  LeAdvertisingResponse report = make_advertising_report();
+  test_hci_layer_->IncomingLeMetaEvent(LeAdvertisingReportBuilder::Create({report}));
+  sync_client_handler();
+
+  EXPECT_CALL(
+      mock_callbacks_, OnBatchScanReports(0x01, 0x00, (int)BatchScanMode::FULL, 1, _));
+  le_scanning_manager->BatchScanReadReport(0x01, BatchScanMode::FULL);
+  sync_client_handler();
+
+  // Disabling the batch scan stops scanning.
+  le_scanning_manager->BatchScanDisable();
+  ASSERT_EQ(OpCode::LE_SET_SCAN_ENABLE, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(
+      LeSetScanEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+}
+
 TEST_F(LeScanningManagerAndroidHciTest, startup_teardown) {}
 
 TEST_F(LeScanningManagerAndroidHciTest, start_scan_test) {
@@ -15,6 +15,7 @@
  */
 #include "hci/le_scanning_reassembler.h"
 
+#include <algorithm>
 #include <memory>
 #include <unordered_map>
 
@@ -66,20 +67,28 @@ LeScanningReassembler::ProcessAdvertisingReport(
     RemoveFragment(key);
   }
 
+  // TODO(b/272120114) waiting for a scan response here is prone to failure as the
+  // SCAN_REQ PDUs can be rejected by the advertiser according to the
+  // advertising filter parameter.
+  bool expect_scan_response = is_scannable && !is_scan_response && !ignore_scan_responses_;
+
+  // The report is complete on its own and no fragment is pending for
+  // this advertiser, the data is returned without going through the cache.
+  if (data_status != DataStatus::CONTINUING && !expect_scan_response && !ContainsFragment(key)) {
+    CompleteAdvertisingData result{.extended_event_type = event_type, .data = advertising_data};
+    TrimAdvertisingDataInPlace(&result.data);
+    return result;
+  }
+
   // Concatenate the data with existing fragments.
   std::list<AdvertisingFragment>::iterator advertising_fragment =
       AppendFragment(key, event_type, advertising_data);
 
   // Trim the advertising data when the complete payload is received.
   if (data_status != DataStatus::CONTINUING) {
-    advertising_fragment->data = TrimAdvertisingData(advertising_fragment->data);
+    TrimAdvertisingDataInPlace(&advertising_fragment->data);
   }
 
-  // TODO(b/272120114) waiting for a scan response here is prone to failure as the
-  // SCAN_REQ PDUs can be rejected by the advertiser according to the
-  // advertising filter parameter.
-  bool expect_scan_response = is_scannable && !is_scan_response && !ignore_scan_responses_;
-
   // Check if we should wait for additional fragments:
   // - For legacy advertising, when a scan response is expected.
   // - For extended advertising, when the current data is marked
@@ -93,12 +102,21 @@ LeScanningReassembler::ProcessAdvertisingReport(
   CompleteAdvertisingData result{
       .extended_event_type = advertising_fragment->extended_event_type,
       .data = std::move(advertising_fragment->data)};
-  cache_.erase(advertising_fragment);
+  RemoveFragment(key);
   return result;
 }
 
 std::optional<std::vector<uint8_t>> LeScanningReassembler::ProcessPeriodicAdvertisingReport(
     uint16_t sync_handle, DataStatus data_status, const std::vector<uint8_t>& advertising_data) {
+  // The report is complete on its own, the data is returned without
+  // going through the cache.
+  if (data_status != DataStatus::CONTINUING &&
+      FindPeriodicFragment(sync_handle) == periodic_cache_.end()) {
+    std::vector<uint8_t> result(advertising_data);
+    TrimAdvertisingDataInPlace(&result);
+    return result;
+  }
+
   // Concatenate the data with existing fragments.
   std::list<PeriodicAdvertisingFragment>::iterator advertising_fragment =
       AppendPeriodicFragment(sync_handle, advertising_data);
@@ -111,7 +129,8 @@ std::optional<std::vector<uint8_t>> LeScanningReassembler::ProcessPeriodicAdvert
 
   // The complete payload has been received; trim the advertising data,
   // remove the cache entry and return the complete advertising data.
-  std::vector<uint8_t> result = TrimAdvertisingData(advertising_fragment->data);
+  std::vector<uint8_t> result = std::move(advertising_fragment->data);
+  TrimAdvertisingDataInPlace(&result);
   periodic_cache_.erase(advertising_fragment);
   return result;
 }
@@ -120,24 +139,35 @@ std::optional<std::vector<uint8_t>> LeScanningReassembler::ProcessPeriodicAdvert
 /// GAP Data entries.
 std::vector<uint8_t> LeScanningReassembler::TrimAdvertisingData(
     const std::vector<uint8_t>& advertising_data) {
+  std::vector<uint8_t> significant_advertising_data(advertising_data);
+  TrimAdvertisingDataInPlace(&significant_advertising_data);
+  return significant_advertising_data;
+}
+
+void LeScanningReassembler::TrimAdvertisingDataInPlace(std::vector<uint8_t>* advertising_data) {
   // Remove empty and overflowing entries from the advertising data.
-  std::vector<uint8_t> significant_advertising_data;
-  for (size_t offset = 0; offset < advertising_data.size();) {
-    size_t remaining_size = advertising_data.size() - offset;
-    uint8_t entry_size = advertising_data[offset];
+  // The significant entries are moved down over the removed ones, the
+  // write offset never goes past the read offset.
+  std::vector<uint8_t>& data = *advertising_data;
+  size_t significant_size = 0;
+  for (size_t offset = 0; offset < data.size();) {
+    size_t remaining_size = data.size() - offset;
+    uint8_t entry_size = data[offset];
 
     if (entry_size != 0 && entry_size < remaining_size) {
-      significant_advertising_data.push_back(entry_size);
-      significant_advertising_data.insert(
-          significant_advertising_data.end(),
-          advertising_data.begin() + offset + 1,
-          advertising_data.begin() + offset + 1 + entry_size);
+      if (significant_size != offset) {
+        std::copy(
+            data.begin() + offset,
+            data.begin() + offset + 1 + entry_size,
+            data.begin() + significant_size);
+      }
+      significant_size += entry_size + 1;
     }
 
     offset += entry_size + 1;
   }
 
-  return significant_advertising_data;
+  data.resize(significant_size);
 }
 
 LeScanningReassembler::AdvertisingKey::AdvertisingKey(
@@ -154,13 +184,21 @@ LeScanningReassembler::AdvertisingKey::AdvertisingKey(
   }
 }
 
-bool LeScanningReassembler::AdvertisingKey::operator==(const AdvertisingKey& other) {
+bool LeScanningReassembler::AdvertisingKey::operator==(const AdvertisingKey& other) const {
   return address == other.address && sid == other.sid;
 }
 
+std::size_t LeScanningReassembler::AdvertisingKeyHash::operator()(
+    const AdvertisingKey& key) const {
+  std::size_t address_hash =
+      key.address.has_value() ? std::hash<AddressWithType>{}(key.address.value()) : 0;
+  std::size_t sid_hash = key.sid.has_value() ? key.sid.value() + 1 : 0;
+  return address_hash ^ (sid_hash << 1);
+}
+
 /// Append to the current advertising data of the selected advertiser.
 /// If the advertiser is unknown a new entry is added, optionally by
-/// dropping the oldest advertiser.
+/// dropping the least recently updated advertiser.
 std::list<LeScanningReassembler::AdvertisingFragment>::iterator
 LeScanningReassembler::AppendFragment(
     const AdvertisingKey& key, uint16_t extended_event_type, const std::vector<uint8_t>& data) {
@@ -176,21 +214,25 @@ LeScanningReassembler::AppendFragment(
       it->extended_event_type = extended_event_type;
     }
     it->data.insert(it->data.end(), data.cbegin(), data.cend());
+    cache_.splice(cache_.begin(), cache_, it);
     return it;
   }
 
-  if (cache_.size() > kMaximumCacheSize) {
+  if (cache_.size() >= kMaximumCacheSize) {
+    cache_index_.erase(cache_.back().key);
     cache_.pop_back();
   }
 
   cache_.emplace_front(key, extended_event_type, data);
+  cache_index_.emplace(key, cache_.begin());
   return cache_.begin();
 }
 
 void LeScanningReassembler::RemoveFragment(const AdvertisingKey& key) {
-  auto it = FindFragment(key);
-  if (it != cache_.end()) {
-    cache_.erase(it);
+  auto it = cache_index_.find(key);
+  if (it != cache_index_.end()) {
+    cache_.erase(it->second);
+    cache_index_.erase(it);
   }
 }
 
@@ -200,12 +242,8 @@ bool LeScanningReassembler::ContainsFragment(const AdvertisingKey& key) {
 
 std::list<LeScanningReassembler::AdvertisingFragment>::iterator LeScanningReassembler::FindFragment(
     const AdvertisingKey& key) {
-  for (auto it = cache_.begin(); it != cache_.end(); it++) {
-    if (it->key == key) {
-      return it;
-    }
-  }
-  return cache_.end();
+  auto it = cache_index_.find(key);
+  return it != cache_index_.end() ? it->second : cache_.end();
 }
 
 /// Append to the current advertising data of the selected periodic advertiser.
@@ -220,7 +258,7 @@ LeScanningReassembler::AppendPeriodicFragment(
     return it;
   }
 
-  if (periodic_cache_.size() > kMaximumPeriodicCacheSize) {
+  if (periodic_cache_.size() >= kMaximumPeriodicCacheSize) {
     periodic_cache_.pop_back();
   }
 
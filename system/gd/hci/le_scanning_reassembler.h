@@ -20,6 +20,7 @@
 #include <cstdint>
 #include <list>
 #include <optional>
+#include <unordered_map>
 #include <vector>
 
 #include "hci/address_with_type.h"
@@ -98,7 +99,11 @@ class LeScanningReassembler {
     std::optional<uint8_t> sid;
 
     AdvertisingKey(Address address, DirectAdvertisingAddressType address_type, uint8_t sid);
-    bool operator==(const AdvertisingKey& other);
+    bool operator==(const AdvertisingKey& other) const;
+  };
+
+  struct AdvertisingKeyHash {
+    std::size_t operator()(const AdvertisingKey& key) const;
   };
 
   /// Packs incomplete advertising data.
@@ -126,8 +131,15 @@ class LeScanningReassembler {
   /// applicable.
   /// The cached advertising data is removed as soon as the complete
   /// advertisement is got (including the scan response).
-  static constexpr size_t kMaximumCacheSize = 16;
+  /// The list is kept in least recently used order, the most recently
+  /// updated fragment first, and is indexed by advertising key.
+  static constexpr size_t kMaximumCacheSize = 64;
   std::list<AdvertisingFragment> cache_;
+  std::unordered_map<
+      AdvertisingKey,
+      std::list<AdvertisingFragment>::iterator,
+      AdvertisingKeyHash>
+      cache_index_;
 
   /// Advertising cache management methods.
   std::list<AdvertisingFragment>::iterator AppendFragment(
@@ -152,7 +164,12 @@ class LeScanningReassembler {
   /// GAP Data entries.
   static std::vector<uint8_t> TrimAdvertisingData(const std::vector<uint8_t>& advertising_data);
 
+  /// Same as TrimAdvertisingData, but compacts the entries
+  /// in the input buffer instead of allocating a new one.
+  static void TrimAdvertisingDataInPlace(std::vector<uint8_t>* advertising_data);
+
   FRIEND_TEST(LeScanningReassemblerTest, trim_advertising_data);
+  FRIEND_TEST(LeScanningReassemblerTest, cache_eviction);
 };
 
 }  // namespace bluetooth::hci
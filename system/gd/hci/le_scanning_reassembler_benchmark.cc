@@ -0,0 +1,136 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hci/le_scanning_reassembler.h"
+
+using ::benchmark::State;
+
+namespace bluetooth::hci {
+
+// Event type fields.
+static constexpr uint16_t kConnectable = 0x1;
+static constexpr uint16_t kScannable = 0x2;
+static constexpr uint16_t kScanResponse = 0x8;
+static constexpr uint16_t kLegacy = 0x10;
+static constexpr uint16_t kComplete = 0x0;
+static constexpr uint16_t kContinuation = 0x20;
+
+static constexpr uint8_t kSidNotPresent = 0xff;
+
+// Number of advertisers whose reports are interleaved.
+static constexpr size_t kInterleavedAdvertisers = 32;
+
+// Replays the reports received while scanning in a dense environment:
+// a third of the advertisers use legacy scannable advertising answered
+// by a scan response, the others send extended advertising chains
+// split over three reports. The reports of groups of advertisers are
+// interleaved, as received from the controller.
+class BM_LeScanningReassembler : public ::benchmark::Fixture {
+ protected:
+  struct Report {
+    uint16_t event_type;
+    uint8_t address_type;
+    Address address;
+    uint8_t sid;
+    std::vector<uint8_t> data;
+  };
+
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+
+    size_t num_advertisers = st.range(0);
+    std::vector<uint8_t> fragment(229);
+    for (size_t offset = 0; offset < fragment.size(); offset += 32) {
+      fragment[offset] = std::min<size_t>(31, fragment.size() - offset - 1);
+      fragment[offset + 1] = 0xff;
+    }
+    std::vector<uint8_t> legacy_data(fragment.begin(), fragment.begin() + 31);
+    legacy_data[0] = 30;
+
+    for (size_t group = 0; group < num_advertisers; group += kInterleavedAdvertisers) {
+      size_t group_end = std::min(group + kInterleavedAdvertisers, num_advertisers);
+      for (size_t step = 0; step < 3; step++) {
+        for (size_t index = group; index < group_end; index++) {
+          AddReport(index, step, fragment, legacy_data);
+        }
+      }
+    }
+  }
+
+  void AddReport(
+      size_t index,
+      size_t step,
+      const std::vector<uint8_t>& fragment,
+      const std::vector<uint8_t>& legacy_data) {
+    Address address({0xc0, 0x01, 0x02, 0x03, (uint8_t)(index >> 8), (uint8_t)index});
+    uint8_t address_type = (uint8_t)AddressType::RANDOM_DEVICE_ADDRESS;
+
+    if (index % 3 == 0) {
+      if (step == 0) {
+        trace_.push_back(
+            {kLegacy | kScannable | kConnectable, address_type, address, kSidNotPresent, legacy_data});
+      } else if (step == 2) {
+        trace_.push_back(
+            {kLegacy | kScanResponse | kScannable, address_type, address, kSidNotPresent, legacy_data});
+      }
+    } else {
+      trace_.push_back(
+          {(uint16_t)(step < 2 ? kContinuation : kComplete),
+           address_type,
+           address,
+           (uint8_t)(index % 16),
+           fragment});
+    }
+  }
+
+  void TearDown(State& st) override {
+    trace_.clear();
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  std::vector<Report> trace_;
+};
+
+BENCHMARK_DEFINE_F(BM_LeScanningReassembler, replay_dense_scan)(State& state) {
+  LeScanningReassembler reassembler;
+  size_t num_complete = 0;
+
+  for (auto _ : state) {
+    for (const auto& report : trace_) {
+      auto result = reassembler.ProcessAdvertisingReport(
+          report.event_type, report.address_type, report.address, report.sid, report.data);
+      num_complete += result.has_value();
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * trace_.size());
+  state.counters["complete"] =
+      ::benchmark::Counter(num_complete, ::benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK_REGISTER_F(BM_LeScanningReassembler, replay_dense_scan)
+    ->Arg(16)
+    ->Arg(48)
+    ->Arg(200)
+    ->Arg(500)
+    ->Unit(::benchmark::kMicrosecond);
+
+}  // namespace bluetooth::hci
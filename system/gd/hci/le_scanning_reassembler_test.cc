@@ -387,6 +387,67 @@ TEST_F(LeScanningReassemblerTest, interleaved_advertising) {
       std::vector<uint8_t>({0x2, 0x3, 0x3}));
 }
 
+TEST_F(LeScanningReassemblerTest, cache_eviction) {
+  // The least recently updated advertiser is dropped when the cache is full.
+  auto address = [](size_t index) {
+    return Address({0, 1, 2, 3, (uint8_t)(index >> 8), (uint8_t)index});
+  };
+
+  for (size_t index = 0; index < LeScanningReassembler::kMaximumCacheSize; index++) {
+    ASSERT_FALSE(reassembler_
+                     .ProcessAdvertisingReport(
+                         kContinuation,
+                         (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS,
+                         address(index),
+                         kSidNotPresent,
+                         {0x3, 0x0})
+                     .has_value());
+  }
+
+  // Refresh the first advertiser, the second one becomes the oldest.
+  ASSERT_FALSE(reassembler_
+                   .ProcessAdvertisingReport(
+                       kContinuation,
+                       (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS,
+                       address(0),
+                       kSidNotPresent,
+                       {0x1})
+                   .has_value());
+
+  ASSERT_FALSE(reassembler_
+                   .ProcessAdvertisingReport(
+                       kContinuation,
+                       (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS,
+                       address(LeScanningReassembler::kMaximumCacheSize),
+                       kSidNotPresent,
+                       {0x2, 0x0})
+                   .has_value());
+
+  ASSERT_EQ(
+      reassembler_
+          .ProcessAdvertisingReport(
+              kComplete,
+              (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS,
+              address(0),
+              kSidNotPresent,
+              {0x2})
+          .value()
+          .data,
+      std::vector<uint8_t>({0x3, 0x0, 0x1, 0x2}));
+
+  ASSERT_EQ(
+      reassembler_
+          .ProcessAdvertisingReport(
+              kComplete,
+              (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS,
+              address(1),
+              kSidNotPresent,
+              {0x1, 0x2})
+          .value()
+          .data,
+      std::vector<uint8_t>({0x1, 0x2}));
+}
+
 TEST_F(LeScanningReassemblerTest, periodic_advertising) {
   // Test periodic advertising.
   ASSERT_FALSE(
@@ -17,6 +17,9 @@
 
 #include "metrics/counter_metrics.h"
 
+#include <functional>
+#include <thread>
+
 #include "common/bind.h"
 #include "os/log.h"
 #include "os/metrics.h"
@@ -48,6 +51,29 @@ void CounterMetrics::Stop() {
   LOG_INFO("Counter metrics canceled");
 }
 
+size_t CounterMetrics::FindOrRegisterKey(int32_t key) {
+  int64_t registered_key = kKeyRegistered + key;
+  size_t hash = std::hash<int32_t>{}(key);
+  for (size_t probe = 0; probe < kMaxKeys; probe++) {
+    size_t slot = (hash + probe) % kMaxKeys;
+    int64_t slot_key = keys_[slot].load(std::memory_order_acquire);
+    if (slot_key == 0 &&
+        keys_[slot].compare_exchange_strong(slot_key, registered_key, std::memory_order_acq_rel)) {
+      return slot;
+    }
+    if (slot_key == registered_key) {
+      return slot;
+    }
+  }
+  return kMaxKeys;
+}
+
+CounterMetrics::Shard& CounterMetrics::GetShard(std::array<Shard, kNumShards>& shards) {
+  static std::atomic<size_t> next_shard = 0;
+  thread_local size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % kNumShards;
+  return shards[shard];
+}
+
 bool CounterMetrics::CacheCount(int32_t key, int64_t count) {
   if (!IsInitialized()) {
     LOG_WARN("Counter metrics isn't initialized");
@@ -57,6 +83,25 @@ bool CounterMetrics::CacheCount(int32_t key, int64_t count) {
     LOG_WARN("count is not larger than 0. count: %s, key: %d", std::to_string(count).c_str(), key);
     return false;
   }
+
+  size_t slot = FindOrRegisterKey(key);
+  if (slot != kMaxKeys) {
+    std::atomic<int64_t>& counter = GetShard(shards_).counts[slot];
+    int64_t total = counter.load(std::memory_order_relaxed);
+    do {
+      if (LLONG_MAX - total < count) {
+        LOG_WARN(
+            "Counter metric overflows. count %s current total: %s key: %d",
+            std::to_string(count).c_str(),
+            std::to_string(total).c_str(),
+            key);
+        counter.store(LLONG_MAX, std::memory_order_relaxed);
+        return false;
+      }
+    } while (!counter.compare_exchange_weak(total, total + count, std::memory_order_relaxed));
+    return true;
+  }
+
   int64_t total = 0;
   std::lock_guard<std::mutex> lock(mutex_);
   if (counters_.find(key) != counters_.end()) {
@@ -92,6 +137,20 @@ void CounterMetrics::DrainBufferedCounters() {
   }
   std::lock_guard<std::mutex> lock(mutex_);
   LOG_INFO("Draining buffered counters");
+  for (size_t slot = 0; slot < kMaxKeys; slot++) {
+    int64_t registered_key = keys_[slot].load(std::memory_order_acquire);
+    if (registered_key == 0) {
+      continue;
+    }
+    int64_t total = 0;
+    for (Shard& shard : shards_) {
+      int64_t count = shard.counts[slot].exchange(0, std::memory_order_relaxed);
+      total = LLONG_MAX - total < count ? LLONG_MAX : total + count;
+    }
+    if (total > 0) {
+      Count(static_cast<int32_t>(registered_key - kKeyRegistered), total);
+    }
+  }
   for (auto const& pair : counters_) {
     Count(pair.first, pair.second);
   }
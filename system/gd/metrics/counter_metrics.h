@@ -15,6 +15,8 @@
  */
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <unordered_map>
 
 #include "module.h"
@@ -41,7 +43,28 @@ class CounterMetrics : public bluetooth::Module {
     return initialized_;
   }
 
+  // Counters are cached in kNumShards shards, each thread adding to one of
+  // them without locking. Keys are registered once in a fixed size table,
+  // whose slot index is the index of the counter in each shard.
+  static constexpr size_t kNumShards = 8;
+  static constexpr size_t kMaxKeys = 256;
+
  private:
+  struct alignas(64) Shard {
+    std::array<std::atomic<int64_t>, kMaxKeys> counts{};
+  };
+
+  // Returns the slot of |key|, registering it if needed, or kMaxKeys when
+  // the registry is full.
+  size_t FindOrRegisterKey(int32_t key);
+  static Shard& GetShard(std::array<Shard, kNumShards>& shards);
+
+  // Registered key of each slot, stored as the key plus kKeyRegistered.
+  static constexpr int64_t kKeyRegistered = int64_t{1} << 32;
+  std::array<std::atomic<int64_t>, kMaxKeys> keys_{};
+  std::array<Shard, kNumShards> shards_;
+
+  // Counters of the keys not fitting in the registry.
   std::unordered_map<int32_t, int64_t> counters_;
   mutable std::mutex mutex_;
   std::unique_ptr<os::RepeatingAlarm> alarm_;
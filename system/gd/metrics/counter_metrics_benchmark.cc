@@ -0,0 +1,58 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark/benchmark.h"
+#include "metrics/counter_metrics.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace metrics {
+
+class BenchmarkCounterMetrics : public CounterMetrics {
+ public:
+  void DrainBuffer() {
+    DrainBufferedCounters();
+  }
+
+ private:
+  bool Count(int32_t /* key */, int64_t /* count */) override {
+    return true;
+  }
+  bool IsInitialized() override {
+    return true;
+  }
+};
+
+static BenchmarkCounterMetrics counter_metrics;
+
+// Increments a few hot counters from all the threads, as the HCI HAL and the
+// stack threads do.
+static void BM_CacheCountContention(State& state) {
+  int32_t key = state.thread_index() % 4;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(counter_metrics.CacheCount(key, 1));
+  }
+  if (state.thread_index() == 0) {
+    counter_metrics.DrainBuffer();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_CacheCountContention)->Threads(1)->Threads(8)->UseRealTime();
+
+}  // namespace metrics
+}  // namespace bluetooth
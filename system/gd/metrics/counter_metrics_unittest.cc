@@ -16,7 +16,9 @@
 
 #include "metrics/counter_metrics.h"
 
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -28,6 +30,7 @@ class CounterMetricsTest : public ::testing::Test {
  public:
   class TestableCounterMetrics : public CounterMetrics {
    public:
+    using CounterMetrics::kMaxKeys;
     void DrainBuffer() {
       DrainBufferedCounters();
     }
@@ -87,6 +90,37 @@ TEST_F(CounterMetricsTest, non_positive) {
   ASSERT_EQ(testable_counter_metrics_.test_counters_[1], 5);
 }
 
+TEST_F(CounterMetricsTest, concurrent_increments) {
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 16; i++) {
+    threads.emplace_back([this]() {
+      for (int j = 0; j < 10000; j++) {
+        ASSERT_TRUE(testable_counter_metrics_.CacheCount(j % 4, 1));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  testable_counter_metrics_.DrainBuffer();
+  for (int32_t key = 0; key < 4; key++) {
+    ASSERT_EQ(testable_counter_metrics_.test_counters_[key], 40000);
+  }
+}
+
+TEST_F(CounterMetricsTest, more_keys_than_registry) {
+  int32_t num_keys = TestableCounterMetrics::kMaxKeys + 10;
+  for (int32_t key = -num_keys / 2; key < num_keys / 2; key++) {
+    ASSERT_TRUE(testable_counter_metrics_.CacheCount(key, 1));
+    ASSERT_TRUE(testable_counter_metrics_.CacheCount(key, 2));
+  }
+  testable_counter_metrics_.DrainBuffer();
+  ASSERT_EQ(testable_counter_metrics_.test_counters_.size(), (size_t)num_keys);
+  for (auto const& pair : testable_counter_metrics_.test_counters_) {
+    ASSERT_EQ(pair.second, 3);
+  }
+}
+
 }  // namespace
 }  // namespace metrics
 }  // namespace bluetooth
@@ -5,12 +5,13 @@ use btif_macros::{btif_callback, btif_callbacks_dispatcher};
 use bt_topshim::bindings::root::bluetooth::Uuid;
 use bt_topshim::btif::{BluetoothInterface, BtStatus, BtTransport, RawAddress, Uuid128Bit};
 use bt_topshim::profiles::gatt::{
-    ffi::RustAdvertisingTrackInfo, AdvertisingStatus, BtGattDbElement, BtGattNotifyParams,
-    BtGattReadParams, BtGattResponse, BtGattValue, Gatt, GattAdvCallbacksDispatcher,
-    GattAdvInbandCallbacksDispatcher, GattClientCallbacks, GattClientCallbacksDispatcher,
-    GattScannerCallbacks, GattScannerCallbacksDispatcher, GattScannerInbandCallbacks,
+    ffi::RustAdvertisingTrackInfo, AdvertisingStatus, ApcfCommand, BtGattDbElement,
+    BtGattNotifyParams, BtGattReadParams, BtGattResponse, BtGattValue, Gatt,
+    GattAdvCallbacksDispatcher, GattAdvInbandCallbacksDispatcher, GattClientCallbacks,
+    GattClientCallbacksDispatcher, GattFilterParam, GattScannerCallbacks,
+    GattScannerCallbacksDispatcher, GattScannerInbandCallbacks,
     GattScannerInbandCallbacksDispatcher, GattServerCallbacks, GattServerCallbacksDispatcher,
-    GattStatus, LePhy, MsftAdvMonitor, MsftAdvMonitorPattern,
+    GattStatus, LePhy, MsftAdvMonitor, MsftAdvMonitorPattern, APCF_FILTER_TYPE_AD_TYPE,
 };
 use bt_topshim::sysprop;
 use bt_topshim::topstack;
@@ -1291,6 +1292,10 @@ type ScannersMap = HashMap<Uuid, ScannerInfo>;
 
 const DEFAULT_ASYNC_TIMEOUT_MS: u64 = 5000;
 
+// Actions of the APCF filter parameters.
+const APCF_ACTION_ADD: u8 = 0;
+const APCF_ACTION_DELETE: u8 = 1;
+
 /// Abstraction for async GATT operations. Contains async methods for coordinating async operations
 /// more conveniently.
 struct GattAsyncIntf {
@@ -1392,6 +1397,52 @@ impl GattAsyncIntf {
         }
         self.gatt.as_ref().unwrap().lock().unwrap().scanner.start_scan();
     }
+
+    /// Sets up the filter of |scanner_id| as an APCF filter, used when the MSFT extension is not
+    /// supported. The filter is applied by the controller, or by the host when the controller
+    /// does not support advertising filter offload. A filter without patterns matches all the
+    /// advertisements.
+    ///
+    /// Note: this does not need to be async, but declared as async for consistency in this struct.
+    async fn apcf_filter_add(&mut self, scanner_id: u8, filter: &ScanFilter) {
+        let commands: Vec<ApcfCommand> = (&filter.condition).into();
+        // The patterns are OR-ed, as the MSFT monitor patterns.
+        let param = GattFilterParam {
+            feat_seln: if commands.is_empty() { 0 } else { 1 << APCF_FILTER_TYPE_AD_TYPE },
+            rssi_high_thres: filter.rssi_high_threshold,
+            ..Default::default()
+        };
+
+        let mut gatt = self.gatt.as_ref().unwrap().lock().unwrap();
+        if !commands.is_empty() {
+            gatt.scanner.scan_filter_add(scanner_id, commands);
+        }
+        gatt.scanner.scan_filter_setup(scanner_id, APCF_ACTION_ADD, scanner_id, param);
+    }
+
+    /// Removes the APCF filter of |scanner_id|.
+    ///
+    /// Note: this does not need to be async, but declared as async for consistency in this struct.
+    async fn apcf_filter_remove(&mut self, scanner_id: u8) {
+        self.gatt.as_ref().unwrap().lock().unwrap().scanner.scan_filter_setup(
+            scanner_id,
+            APCF_ACTION_DELETE,
+            scanner_id,
+            GattFilterParam::default(),
+        );
+    }
+
+    /// Enables or disables the APCF filters.
+    ///
+    /// Note: this does not need to be async, but declared as async for consistency in this struct.
+    async fn apcf_filter_enable(&mut self, enable: bool) {
+        let mut gatt = self.gatt.as_ref().unwrap().lock().unwrap();
+        if enable {
+            gatt.scanner.scan_filter_enable();
+        } else {
+            gatt.scanner.scan_filter_disable();
+        }
+    }
 }
 
 pub enum GattActions {
@@ -1774,6 +1825,19 @@ impl BluetoothGatt {
                     // the state machine to avoid calling enable/disable if it's already at that state
                     log::error!("Error updating Advertisement Monitor enable");
                 }
+            } else {
+                // Otherwise the filter is set up as an APCF filter.
+                if let Some(filter) = &filter {
+                    gatt_async.apcf_filter_add(scanner_id, filter).await;
+                }
+
+                let has_enabled_unfiltered_scanner = scanners
+                    .lock()
+                    .unwrap()
+                    .iter()
+                    .any(|(_uuid, scanner)| scanner.is_enabled && scanner.filter.is_none());
+
+                gatt_async.apcf_filter_enable(!has_enabled_unfiltered_scanner).await;
             }
 
             gatt_async.update_scan(scanner_id).await;
@@ -1952,6 +2016,26 @@ impl Into<Vec<MsftAdvMonitorPattern>> for &ScanFilterCondition {
     }
 }
 
+impl Into<Vec<ApcfCommand>> for &ScanFilterCondition {
+    fn into(self) -> Vec<ApcfCommand> {
+        match self {
+            ScanFilterCondition::Patterns(patterns) => patterns
+                .iter()
+                .map(|pattern| {
+                    // The bytes before the start position are masked out.
+                    let start = pattern.start_position as usize;
+                    let mut data = vec![0; start];
+                    data.extend_from_slice(&pattern.content);
+                    let mut data_mask = vec![0; start];
+                    data_mask.resize(data.len(), 0xff);
+                    ApcfCommand::new_ad_type(pattern.ad_type, data, data_mask)
+                })
+                .collect(),
+            _ => vec![],
+        }
+    }
+}
+
 impl Into<MsftAdvMonitor> for &ScanFilter {
     fn into(self) -> MsftAdvMonitor {
         MsftAdvMonitor {
@@ -2104,6 +2188,16 @@ impl IBluetoothGatt for BluetoothGatt {
                 {
                     log::error!("Error updating Advertisement Monitor enable");
                 }
+            } else {
+                gatt_async.apcf_filter_remove(scanner_id).await;
+
+                let has_enabled_unfiltered_scanner = scanners
+                    .lock()
+                    .unwrap()
+                    .iter()
+                    .any(|(_uuid, scanner)| scanner.is_enabled && scanner.filter.is_none());
+
+                gatt_async.apcf_filter_enable(!has_enabled_unfiltered_scanner).await;
             }
 
             gatt_async.update_scan(scanner_id).await;
@@ -444,6 +444,52 @@ impl Default for PeriodicAdvertisingParameters {
     }
 }
 
+impl Default for GattFilterParam {
+    fn default() -> Self {
+        GattFilterParam {
+            feat_seln: 0,
+            list_logic_type: 0,
+            filt_logic_type: 0,
+            rssi_high_thres: 0,
+            rssi_low_thres: 0,
+            delay_mode: 0,
+            found_timeout: 0,
+            lost_timeout: 0,
+            found_timeout_count: 0,
+            num_of_tracking_entries: 0,
+        }
+    }
+}
+
+/// APCF filter type of the AD type conditions.
+pub const APCF_FILTER_TYPE_AD_TYPE: u8 = 8;
+
+impl ApcfCommand {
+    /// Creates an AD type condition, matching the advertising data entries of type `ad_type`
+    /// whose content starts with `data` under `data_mask`.
+    pub fn new_ad_type(ad_type: u8, data: Vec<u8>, data_mask: Vec<u8>) -> Self {
+        ApcfCommand {
+            type_: APCF_FILTER_TYPE_AD_TYPE,
+            address: RawAddress::empty(),
+            addr_type: 0,
+            uuid: Uuid::empty().into(),
+            uuid_mask: Uuid::empty().into(),
+            name: vec![],
+            company: 0,
+            company_mask: 0,
+            ad_type,
+            org_id: 0,
+            tds_flags: 0,
+            tds_flags_mask: 0,
+            meta_data_type: 0,
+            meta_data: vec![],
+            data,
+            data_mask,
+            irk: [0; 16],
+        }
+    }
+}
+
 impl From<ffi::RustUuid> for Uuid {
     fn from(item: ffi::RustUuid) -> Self {
         Uuid::from(item.uu)
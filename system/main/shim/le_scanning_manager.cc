@@ -873,6 +873,14 @@ bool bluetooth::shim::is_ad_type_filter_supported() {
   return bluetooth::shim::GetScanning()->IsAdTypeFilterSupported();
 }
 
+uint8_t bluetooth::shim::get_host_scan_filter_capacity() {
+  return bluetooth::shim::GetScanning()->GetHostFilterCapacity();
+}
+
+uint16_t bluetooth::shim::get_host_batch_scan_storage_size() {
+  return bluetooth::shim::GetScanning()->GetHostBatchScanStorageSize();
+}
+
 void bluetooth::shim::set_ad_type_rsi_filter(bool enable) {
   bluetooth::hci::AdvertisingFilterParameter advertising_filter_parameter;
   bluetooth::shim::GetScanning()->ScanFilterParameterSetup(
@@ -27,6 +27,8 @@ namespace shim {
 ::BleScannerInterface* get_ble_scanner_instance();
 void init_scanning_manager();
 bool is_ad_type_filter_supported();
+uint8_t get_host_scan_filter_capacity();
+uint16_t get_host_batch_scan_storage_size();
 void set_ad_type_rsi_filter(bool enable);
 void set_empty_filter(bool enable);
 void set_target_announcements_filter(bool enable);
@@ -22,6 +22,8 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#include <vector>
+
 typedef void* (*alloc_fn)(size_t size);
 typedef void (*free_fn)(void* ptr);
 
@@ -47,6 +49,21 @@ void osi_free(void* ptr);
 // |p_ptr| cannot be NULL.
 void osi_free_and_reset(void** p_ptr);
 
+// Number of osi_malloc and osi_calloc allocations of a size class, from the
+// |max_size| of the previous class excluded to |max_size| included. The last
+// class counts the allocations of any larger size, its |max_size| is
+// SIZE_MAX.
+typedef struct {
+  size_t max_size;
+  uint64_t allocations;
+} osi_alloc_stats_t;
+
+// Returns the allocation statistics of each size class, in increasing order.
+std::vector<osi_alloc_stats_t> osi_allocator_get_stats();
+
+// Dumps the allocation statistics to |fd|.
+void osi_allocator_debug_dump(int fd);
+
 class OsiObject {
  public:
   OsiObject(void* ptr);
@@ -18,11 +18,35 @@
 #include "osi/include/allocator.h"
 
 #include <base/logging.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <atomic>
+
 #include "check.h"
 
+namespace {
+
+// The legacy stack allocates a BT_HDR buffer for nearly every packet, with a
+// handful of sizes: e.g. BT_SMALL_BUFFER_SIZE (660) for HCI and L2CAP
+// commands, and BT_DEFAULT_BUFFER_SIZE (4096 + 16) for L2CAP, RFCOMM and PAN
+// data. The allocations are counted per size class, the last class counting
+// the larger ones.
+constexpr size_t kSizeClasses[] = {288, 672, 1296, 4112, SIZE_MAX};
+constexpr size_t kNumSizeClasses =
+    sizeof(kSizeClasses) / sizeof(kSizeClasses[0]);
+
+std::atomic<uint64_t> allocations[kNumSizeClasses];
+
+void count_allocation(size_t size) {
+  size_t index = 0;
+  while (size > kSizeClasses[index]) index++;
+  allocations[index].fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace
+
 char* osi_strdup(const char* str) {
   size_t size = strlen(str) + 1;  // + 1 for the null terminator
   char* new_string = (char*)malloc(size);
@@ -50,6 +74,7 @@ char* osi_strndup(const char* str, size_t len) {
 
 void* osi_malloc(size_t size) {
   CHECK(static_cast<ssize_t>(size) >= 0);
+  count_allocation(size);
   void* ptr = malloc(size);
   CHECK(ptr);
   return ptr;
@@ -57,6 +82,7 @@ void* osi_malloc(size_t size) {
 
 void* osi_calloc(size_t size) {
   CHECK(static_cast<ssize_t>(size) >= 0);
+  count_allocation(size);
   void* ptr = calloc(1, size);
   CHECK(ptr);
   return ptr;
@@ -72,6 +98,39 @@ void osi_free_and_reset(void** p_ptr) {
 
 const allocator_t allocator_calloc = {osi_calloc, osi_free};
 
+std::vector<osi_alloc_stats_t> osi_allocator_get_stats() {
+  std::vector<osi_alloc_stats_t> stats;
+  for (size_t i = 0; i < kNumSizeClasses; i++) {
+    stats.push_back({
+        .max_size = kSizeClasses[i],
+        .allocations = allocations[i].load(std::memory_order_relaxed),
+    });
+  }
+  return stats;
+}
+
+void osi_allocator_debug_dump(int fd) {
+  dprintf(fd, "\nBluetooth Buffer Allocations:\n");
+  std::vector<osi_alloc_stats_t> stats = osi_allocator_get_stats();
+  uint64_t total = 0;
+  for (const osi_alloc_stats_t& size_class : stats) {
+    total += size_class.allocations;
+  }
+
+  dprintf(fd, "  Max size  Allocations  Share\n");
+  for (const osi_alloc_stats_t& size_class : stats) {
+    if (size_class.max_size == SIZE_MAX) {
+      dprintf(fd, "       any");
+    } else {
+      dprintf(fd, "  %8zu", size_class.max_size);
+    }
+    dprintf(fd, "  %11llu  %4llu%%\n",
+            (unsigned long long)size_class.allocations,
+            (unsigned long long)(total ? size_class.allocations * 100 / total
+                                       : 0));
+  }
+}
+
 const allocator_t allocator_malloc = {osi_malloc, osi_free};
 
 OsiObject::OsiObject(void* ptr) : ptr_(ptr) {}
@@ -20,6 +20,8 @@
 #include <gtest/gtest.h>
 
 #include <cstring>
+#include <thread>
+#include <vector>
 
 class AllocatorTest : public ::testing::Test {};
 
@@ -48,3 +50,45 @@ TEST_F(AllocatorTest, test_osi_strndup) {
   EXPECT_EQ(0, strcmp(str, copy_str));
   osi_free(copy_str);
 }
+
+namespace {
+constexpr size_t kSmallBufferSize = 660;
+
+// Returns the number of allocations counted in the size class of |size|.
+uint64_t get_allocations(size_t size) {
+  for (const osi_alloc_stats_t& size_class : osi_allocator_get_stats()) {
+    if (size <= size_class.max_size) return size_class.allocations;
+  }
+  return 0;
+}
+}  // namespace
+
+TEST_F(AllocatorTest, test_allocations_counted_per_size_class) {
+  std::vector<osi_alloc_stats_t> stats = osi_allocator_get_stats();
+  ASSERT_FALSE(stats.empty());
+  EXPECT_EQ(SIZE_MAX, stats.back().max_size);
+
+  uint64_t small_before = get_allocations(kSmallBufferSize);
+  uint64_t large_before = get_allocations(65536);
+
+  osi_free(osi_malloc(kSmallBufferSize));
+  osi_free(osi_calloc(kSmallBufferSize));
+  osi_free(osi_malloc(65536));
+
+  EXPECT_EQ(small_before + 2, get_allocations(kSmallBufferSize));
+  EXPECT_EQ(large_before + 1, get_allocations(65536));
+}
+
+TEST_F(AllocatorTest, test_allocations_from_other_threads) {
+  uint64_t before = get_allocations(kSmallBufferSize);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([]() {
+      for (int j = 0; j < 100; j++) osi_free(osi_malloc(kSmallBufferSize));
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  EXPECT_EQ(before + 400, get_allocations(kSmallBufferSize));
+}
@@ -20,6 +20,8 @@
 
 #include <bluetooth/log.h>
 
+#include <algorithm>
+
 #include "abstract_message_loop.h"
 #include "avrcp_common.h"
 #include "include/check.h"
@@ -86,6 +88,11 @@ void Device::SetBrowseMtu(uint16_t browse_mtu) {
 
 void Device::SetBipClientStatus(bool connected) {
   log::info("{}: connected = {}", ADDRESS_TO_LOGGABLE_STR(address_), connected);
+  if (has_bip_client_ != connected) {
+    // The cover art of the cached songs is filtered based on the client
+    InvalidateFolderCache();
+    InvalidateNowPlayingCache();
+  }
   has_bip_client_ = connected;
 }
 
@@ -1150,15 +1157,13 @@ void Device::HandleGetFolderItems(uint8_t label,
                      weak_ptr_factory_.GetWeakPtr(), label, pkt));
       break;
     case Scope::VFS:
-      media_interface_->GetFolderItems(
-          curr_browsed_player_id_, CurrentFolder(),
-          base::Bind(&Device::GetVFSListResponse,
-                     weak_ptr_factory_.GetWeakPtr(), label, pkt));
+      GetBrowsedFolder(CurrentFolder(),
+                       base::Bind(&Device::GetVFSListResponse,
+                                  weak_ptr_factory_.GetWeakPtr(), label, pkt));
       break;
     case Scope::NOW_PLAYING:
-      media_interface_->GetNowPlayingList(
-          base::Bind(&Device::GetNowPlayingListResponse,
-                     weak_ptr_factory_.GetWeakPtr(), label, pkt));
+      GetNowPlaying(base::Bind(&Device::GetNowPlayingListResponse,
+                               weak_ptr_factory_.GetWeakPtr(), label, pkt));
       break;
     default:
       log::error("{}: scope={}", ADDRESS_TO_LOGGABLE_STR(address_),
@@ -1191,13 +1196,13 @@ void Device::HandleGetTotalNumberOfItems(
       break;
     }
     case Scope::VFS:
-      media_interface_->GetFolderItems(
-          curr_browsed_player_id_, CurrentFolder(),
+      GetBrowsedFolder(
+          CurrentFolder(),
           base::Bind(&Device::GetTotalNumberOfItemsVFSResponse,
                      weak_ptr_factory_.GetWeakPtr(), label));
       break;
     case Scope::NOW_PLAYING:
-      media_interface_->GetNowPlayingList(
+      GetNowPlaying(
           base::Bind(&Device::GetTotalNumberOfItemsNowPlayingResponse,
                      weak_ptr_factory_.GetWeakPtr(), label));
       break;
@@ -1217,21 +1222,21 @@ void Device::GetTotalNumberOfItemsMediaPlayersResponse(
   send_message(label, true, std::move(builder));
 }
 
-void Device::GetTotalNumberOfItemsVFSResponse(uint8_t label,
-                                              std::vector<ListItem> list) {
-  log::verbose("num_items={}", list.size());
+void Device::GetTotalNumberOfItemsVFSResponse(
+    uint8_t label, const BrowsedFolderItems& folder) {
+  log::verbose("num_items={}", folder.items.size());
 
   auto builder = GetTotalNumberOfItemsResponseBuilder::MakeBuilder(
-      Status::NO_ERROR, 0x0000, list.size());
+      Status::NO_ERROR, 0x0000, folder.items.size());
   send_message(label, true, std::move(builder));
 }
 
 void Device::GetTotalNumberOfItemsNowPlayingResponse(
-    uint8_t label, std::string curr_song_id, std::vector<SongInfo> list) {
-  log::verbose("num_items={}", list.size());
+    uint8_t label, const NowPlayingItems& now_playing) {
+  log::verbose("num_items={}", now_playing.songs.size());
 
   auto builder = GetTotalNumberOfItemsResponseBuilder::MakeBuilder(
-      Status::NO_ERROR, 0x0000, list.size());
+      Status::NO_ERROR, 0x0000, now_playing.songs.size());
   send_message(label, true, std::move(builder));
 }
 
@@ -1278,19 +1283,16 @@ void Device::HandleChangePath(uint8_t label,
     log::verbose("Popping Path from stack: new path=\"{}\"", CurrentFolder());
   }
 
-  media_interface_->GetFolderItems(
-      curr_browsed_player_id_, CurrentFolder(),
-      base::Bind(&Device::ChangePathResponse, weak_ptr_factory_.GetWeakPtr(),
-                 label, pkt));
+  GetBrowsedFolder(CurrentFolder(),
+                   base::Bind(&Device::ChangePathResponse,
+                              weak_ptr_factory_.GetWeakPtr(), label, pkt));
 }
 
 void Device::ChangePathResponse(uint8_t label,
                                 std::shared_ptr<ChangePathRequest> pkt,
-                                std::vector<ListItem> list) {
-  // TODO (apanicke): Reconstruct the VFS ID's here. Right now it gets
-  // reconstructed in GetFolderItemsVFS
-  auto builder =
-      ChangePathResponseBuilder::MakeBuilder(Status::NO_ERROR, list.size());
+                                const BrowsedFolderItems& folder) {
+  auto builder = ChangePathResponseBuilder::MakeBuilder(Status::NO_ERROR,
+                                                        folder.items.size());
   send_message(label, true, std::move(builder));
 }
 
@@ -1317,17 +1319,16 @@ void Device::HandleGetItemAttributes(
 
   switch (pkt->GetScope()) {
     case Scope::NOW_PLAYING: {
-      media_interface_->GetNowPlayingList(
-          base::Bind(&Device::GetItemAttributesNowPlayingResponse,
-                     weak_ptr_factory_.GetWeakPtr(), label, pkt));
+      GetNowPlaying(base::Bind(&Device::GetItemAttributesNowPlayingResponse,
+                               weak_ptr_factory_.GetWeakPtr(), label, pkt));
     } break;
     case Scope::VFS:
       // TODO (apanicke): Check the vfs_ids_ here. If the item doesn't exist
       // then we can auto send the error without calling up. We do this check
       // later right now though in order to prevent race conditions with updates
       // on the media layer.
-      media_interface_->GetFolderItems(
-          curr_browsed_player_id_, CurrentFolder(),
+      GetBrowsedFolder(
+          CurrentFolder(),
           base::Bind(&Device::GetItemAttributesVFSResponse,
                      weak_ptr_factory_.GetWeakPtr(), label, pkt));
       break;
@@ -1340,35 +1341,30 @@ void Device::HandleGetItemAttributes(
 
 void Device::GetItemAttributesNowPlayingResponse(
     uint8_t label, std::shared_ptr<GetItemAttributesRequest> pkt,
-    std::string curr_media_id, std::vector<SongInfo> song_list) {
+    const NowPlayingItems& now_playing) {
   log::verbose("uid={}", loghex(pkt->GetUid()));
   auto builder = GetItemAttributesResponseBuilder::MakeBuilder(Status::NO_ERROR,
                                                                browse_mtu_);
 
   auto media_id = now_playing_ids_.get_media_id(pkt->GetUid());
   if (media_id == "") {
-    media_id = curr_media_id;
+    media_id = now_playing.curr_song_id;
   }
 
   log::verbose("media_id=\"{}\"", media_id);
 
+  // The cover art of the cached songs is already filtered
   SongInfo info;
-  if (song_list.size() == 1) {
+  if (now_playing.songs.size() == 1) {
     log::verbose("Send out the only song in the queue as now playing song.");
-    info = song_list.front();
+    info = now_playing.songs.front();
   } else {
-    for (const auto& temp : song_list) {
-      if (temp.media_id == media_id) {
-        info = temp;
-      }
+    auto it = now_playing.index.find(media_id);
+    if (it != now_playing.index.end()) {
+      info = now_playing.songs[it->second];
     }
   }
 
-  // Filter out DEFAULT_COVER_ART handle if this device has no client
-  if (!HasBipClient()) {
-    filter_cover_art(info);
-  }
-
   auto attributes_requested = pkt->GetAttributesRequested();
   if (attributes_requested.size() != 0) {
     for (const auto& attribute : attributes_requested) {
@@ -1389,7 +1385,7 @@ void Device::GetItemAttributesNowPlayingResponse(
 
 void Device::GetItemAttributesVFSResponse(
     uint8_t label, std::shared_ptr<GetItemAttributesRequest> pkt,
-    std::vector<ListItem> item_list) {
+    const BrowsedFolderItems& folder) {
   log::verbose("uid={}", loghex(pkt->GetUid()));
 
   auto media_id = vfs_ids_.get_media_id(pkt->GetUid());
@@ -1404,19 +1400,13 @@ void Device::GetItemAttributesVFSResponse(
   auto builder = GetItemAttributesResponseBuilder::MakeBuilder(Status::NO_ERROR,
                                                                browse_mtu_);
 
+  // The cover art of the cached songs is already filtered
   ListItem item_requested;
   item_requested.type = ListItem::SONG;
 
-  for (const auto& temp : item_list) {
-    if ((temp.type == ListItem::FOLDER && temp.folder.media_id == media_id) ||
-        (temp.type == ListItem::SONG && temp.song.media_id == media_id)) {
-      item_requested = temp;
-    }
-  }
-
-  // Filter out DEFAULT_COVER_ART handle if this device has no client
-  if (item_requested.type == ListItem::SONG && !HasBipClient()) {
-    filter_cover_art(item_requested.song);
+  auto it = folder.index.find(media_id);
+  if (it != folder.index.end()) {
+    item_requested = folder.items[it->second];
   }
 
   // TODO (apanicke): Add a helper function or allow adding a map
@@ -1505,7 +1495,7 @@ std::set<AttributeEntry> filter_attributes_requested(
 
 void Device::GetVFSListResponse(uint8_t label,
                                 std::shared_ptr<GetFolderItemsRequest> pkt,
-                                std::vector<ListItem> items) {
+                                const BrowsedFolderItems& folder) {
   log::verbose("start_item={} end_item={}", pkt->GetStartItem(),
                pkt->GetEndItem());
 
@@ -1513,36 +1503,22 @@ void Device::GetVFSListResponse(uint8_t label,
   auto builder = GetFolderItemsResponseBuilder::MakeVFSBuilder(
       Status::NO_ERROR, 0x0000, browse_mtu_);
 
-  // TODO (apanicke): Add test that checks if vfs_ids_ is the correct size after
-  // an operation.
-  for (const auto& item : items) {
-    if (item.type == ListItem::FOLDER) {
-      vfs_ids_.insert(item.folder.media_id);
-    } else if (item.type == ListItem::SONG) {
-      vfs_ids_.insert(item.song.media_id);
-    }
-  }
-
-  // Add the elements retrieved in the last get folder items request and map
-  // them to UIDs The maps will be cleared every time a directory change
-  // happens. These items do not need to correspond with the now playing list as
-  // the UID's only need to be unique in the context of the current scope and
-  // the current folder
+  // Add the elements of the requested range. They were mapped to UIDs when
+  // the folder was cached. These items do not need to correspond with the now
+  // playing list as the UID's only need to be unique in the context of the
+  // current scope and the current folder
+  const auto& items = folder.items;
   for (auto i = pkt->GetStartItem(); i <= pkt->GetEndItem() && i < items.size();
        i++) {
     if (items[i].type == ListItem::FOLDER) {
-      auto folder = items[i].folder;
+      const auto& folder_info = items[i].folder;
       // right now we always use folders of mixed type
-      FolderItem folder_item(vfs_ids_.get_uid(folder.media_id), 0x00,
-                             folder.is_playable, folder.name);
+      FolderItem folder_item(vfs_ids_.get_uid(folder_info.media_id), 0x00,
+                             folder_info.is_playable, folder_info.name);
       if (!builder->AddFolder(folder_item)) break;
     } else if (items[i].type == ListItem::SONG) {
-      auto song = items[i].song;
-
-      // Filter out DEFAULT_COVER_ART handle if this device has no client
-      if (!HasBipClient()) {
-        filter_cover_art(song);
-      }
+      // The cover art of the cached songs is already filtered
+      const auto& song = items[i].song;
 
       auto title =
           song.attributes.find(Attribute::TITLE) != song.attributes.end()
@@ -1552,7 +1528,7 @@ void Device::GetVFSListResponse(uint8_t label,
                                  std::set<AttributeEntry>());
 
       if (pkt->GetNumAttributes() == 0x00) {  // All attributes requested
-        song_item.attributes_ = std::move(song.attributes);
+        song_item.attributes_ = song.attributes;
       } else {
         song_item.attributes_ =
             filter_attributes_requested(song, pkt->GetAttributesRequested());
@@ -1569,24 +1545,17 @@ void Device::GetVFSListResponse(uint8_t label,
 
 void Device::GetNowPlayingListResponse(
     uint8_t label, std::shared_ptr<GetFolderItemsRequest> pkt,
-    std::string /* unused curr_song_id */, std::vector<SongInfo> song_list) {
+    const NowPlayingItems& now_playing) {
   log::verbose("");
   auto builder = GetFolderItemsResponseBuilder::MakeNowPlayingBuilder(
       Status::NO_ERROR, 0x0000, browse_mtu_);
 
-  now_playing_ids_.clear();
-  for (const SongInfo& song : song_list) {
-    now_playing_ids_.insert(song.media_id);
-  }
-
+  // The songs were mapped to UIDs, and their cover art filtered, when the now
+  // playing list was cached
+  const auto& song_list = now_playing.songs;
   for (size_t i = pkt->GetStartItem();
        i <= pkt->GetEndItem() && i < song_list.size(); i++) {
-    auto song = song_list[i];
-
-    // Filter out DEFAULT_COVER_ART handle if this device has no client
-    if (!HasBipClient()) {
-      filter_cover_art(song);
-    }
+    const auto& song = song_list[i];
 
     auto title = song.attributes.find(Attribute::TITLE) != song.attributes.end()
                      ? song.attributes.find(Attribute::TITLE)->value()
@@ -1594,7 +1563,7 @@ void Device::GetNowPlayingListResponse(
 
     MediaElementItem item(i + 1, title, std::set<AttributeEntry>());
     if (pkt->GetNumAttributes() == 0x00) {
-      item.attributes_ = std::move(song.attributes);
+      item.attributes_ = song.attributes;
     } else {
       item.attributes_ =
           filter_attributes_requested(song, pkt->GetAttributesRequested());
@@ -1608,6 +1577,125 @@ void Device::GetNowPlayingListResponse(
   send_message(label, true, std::move(builder));
 }
 
+void Device::GetBrowsedFolder(const std::string& folder_id,
+                              BrowsedFolderCallback folder_cb) {
+  auto it = folder_cache_.find({curr_browsed_player_id_, folder_id});
+  if (it != folder_cache_.end()) {
+    log::verbose("folder \"{}\" is cached", folder_id);
+    it->second.last_used = ++folder_cache_clock_;
+    folder_cb.Run(it->second.folder);
+    return;
+  }
+
+  media_interface_->GetFolderItems(
+      curr_browsed_player_id_, folder_id,
+      base::Bind(&Device::BrowsedFolderFetched, weak_ptr_factory_.GetWeakPtr(),
+                 curr_browsed_player_id_, folder_id,
+                 browsing_cache_generation_, folder_cb));
+}
+
+void Device::BrowsedFolderFetched(int player_id, std::string folder_id,
+                                  uint32_t generation,
+                                  BrowsedFolderCallback folder_cb,
+                                  std::vector<ListItem> items) {
+  log::verbose("folder=\"{}\" num_items={}", folder_id, items.size());
+
+  BrowsedFolderItems folder;
+  folder.index.reserve(items.size());
+  for (size_t i = 0; i < items.size(); i++) {
+    ListItem& item = items[i];
+    if (item.type == ListItem::FOLDER) {
+      vfs_ids_.insert(item.folder.media_id);
+      folder.index[item.folder.media_id] = i;
+    } else if (item.type == ListItem::SONG) {
+      // Filter out DEFAULT_COVER_ART handle if this device has no client
+      if (!HasBipClient()) {
+        filter_cover_art(item.song);
+      }
+      vfs_ids_.insert(item.song.media_id);
+      folder.index[item.song.media_id] = i;
+    }
+  }
+  folder.items = std::move(items);
+
+  if (generation != browsing_cache_generation_) {
+    // The folder changed while it was fetched
+    folder_cb.Run(folder);
+    return;
+  }
+
+  if (folder_cache_.size() >= kMaxCachedFolders) {
+    auto lru = std::min_element(
+        folder_cache_.begin(), folder_cache_.end(),
+        [](const auto& a, const auto& b) {
+          return a.second.last_used < b.second.last_used;
+        });
+    folder_cache_.erase(lru);
+  }
+
+  CachedFolder& cached = folder_cache_[{player_id, folder_id}];
+  cached.folder = std::move(folder);
+  cached.last_used = ++folder_cache_clock_;
+  folder_cb.Run(cached.folder);
+}
+
+void Device::GetNowPlaying(CachedNowPlayingCallback now_playing_cb) {
+  if (now_playing_cached_) {
+    log::verbose("now playing list is cached");
+    now_playing_cb.Run(now_playing_cache_);
+    return;
+  }
+
+  media_interface_->GetNowPlayingList(
+      base::Bind(&Device::NowPlayingFetched, weak_ptr_factory_.GetWeakPtr(),
+                 browsing_cache_generation_, now_playing_cb));
+}
+
+void Device::NowPlayingFetched(uint32_t generation,
+                               CachedNowPlayingCallback now_playing_cb,
+                               std::string curr_song_id,
+                               std::vector<SongInfo> song_list) {
+  log::verbose("num_items={}", song_list.size());
+
+  NowPlayingItems now_playing;
+  now_playing_ids_.clear();
+  now_playing.index.reserve(song_list.size());
+  for (size_t i = 0; i < song_list.size(); i++) {
+    SongInfo& song = song_list[i];
+    // Filter out DEFAULT_COVER_ART handle if this device has no client
+    if (!HasBipClient()) {
+      filter_cover_art(song);
+    }
+    now_playing_ids_.insert(song.media_id);
+    now_playing.index[song.media_id] = i;
+  }
+  now_playing.curr_song_id = std::move(curr_song_id);
+  now_playing.songs = std::move(song_list);
+
+  if (generation != browsing_cache_generation_) {
+    // The now playing list changed while it was fetched
+    now_playing_cb.Run(now_playing);
+    return;
+  }
+
+  now_playing_cache_ = std::move(now_playing);
+  now_playing_cached_ = true;
+  now_playing_cb.Run(now_playing_cache_);
+}
+
+void Device::InvalidateFolderCache() {
+  log::verbose("");
+  folder_cache_.clear();
+  browsing_cache_generation_++;
+}
+
+void Device::InvalidateNowPlayingCache() {
+  log::verbose("");
+  now_playing_cache_ = NowPlayingItems();
+  now_playing_cached_ = false;
+  browsing_cache_generation_++;
+}
+
 void Device::HandleSetBrowsedPlayer(
     uint8_t label, std::shared_ptr<SetBrowsedPlayerRequest> pkt) {
   if (!pkt->IsValid()) {
@@ -1665,6 +1753,10 @@ void Device::SendMediaUpdate(bool metadata, bool play_status, bool queue) {
   log::verbose("Metadata={} : play_status= {} : queue={} : is_silence={}",
                metadata, play_status, queue, is_silence);
 
+  if (queue || metadata) {
+    InvalidateNowPlayingCache();
+  }
+
   if (queue) {
     HandleNowPlayingUpdate();
   }
@@ -1684,6 +1776,14 @@ void Device::SendFolderUpdate(bool available_players, bool addressed_player,
   CHECK(media_interface_);
   log::verbose("");
 
+  if (available_players || addressed_player || uids) {
+    InvalidateFolderCache();
+  }
+
+  if (uids) {
+    InvalidateNowPlayingCache();
+  }
+
   if (available_players) {
     HandleAvailablePlayerUpdate();
   }
@@ -20,8 +20,10 @@
 #include <base/functional/bind.h>
 
 #include <iostream>
+#include <map>
 #include <memory>
 #include <stack>
+#include <unordered_map>
 #include <vector>
 
 #include "avrcp_internal.h"
@@ -223,30 +225,30 @@ class Device {
       uint16_t curr_player, std::vector<MediaPlayerInfo> players);
   virtual void GetVFSListResponse(uint8_t label,
                                   std::shared_ptr<GetFolderItemsRequest> pkt,
-                                  std::vector<ListItem> items);
+                                  const BrowsedFolderItems& folder);
   virtual void GetNowPlayingListResponse(
       uint8_t label, std::shared_ptr<GetFolderItemsRequest> pkt,
-      std::string curr_song_id, std::vector<SongInfo> song_list);
+      const NowPlayingItems& now_playing);
 
   // GET TOTAL NUMBER OF ITEMS
   virtual void HandleGetTotalNumberOfItems(
       uint8_t label, std::shared_ptr<GetTotalNumberOfItemsRequest> pkt);
   virtual void GetTotalNumberOfItemsMediaPlayersResponse(
       uint8_t label, uint16_t curr_player, std::vector<MediaPlayerInfo> list);
-  virtual void GetTotalNumberOfItemsVFSResponse(uint8_t label,
-                                                std::vector<ListItem> items);
+  virtual void GetTotalNumberOfItemsVFSResponse(
+      uint8_t label, const BrowsedFolderItems& folder);
   virtual void GetTotalNumberOfItemsNowPlayingResponse(
-      uint8_t label, std::string curr_song_id, std::vector<SongInfo> song_list);
+      uint8_t label, const NowPlayingItems& now_playing);
 
   // GET ITEM ATTRIBUTES
   virtual void HandleGetItemAttributes(
       uint8_t label, std::shared_ptr<GetItemAttributesRequest> request);
   virtual void GetItemAttributesNowPlayingResponse(
       uint8_t label, std::shared_ptr<GetItemAttributesRequest> pkt,
-      std::string curr_media_id, std::vector<SongInfo> song_list);
+      const NowPlayingItems& now_playing);
   virtual void GetItemAttributesVFSResponse(
       uint8_t label, std::shared_ptr<GetItemAttributesRequest> pkt,
-      std::vector<ListItem> item_list);
+      const BrowsedFolderItems& folder);
 
   // SET BROWSED PLAYER
   virtual void HandleSetBrowsedPlayer(
@@ -260,7 +262,7 @@ class Device {
                                 std::shared_ptr<ChangePathRequest> request);
   virtual void ChangePathResponse(uint8_t label,
                                   std::shared_ptr<ChangePathRequest> request,
-                                  std::vector<ListItem> list);
+                                  const BrowsedFolderItems& folder);
 
   // PLAY ITEM
   virtual void HandlePlayItem(uint8_t label,
@@ -322,6 +324,29 @@ class Device {
     return current_path_.top();
   }
 
+  // Browsing cache. The items of the browsed folders and the now playing list
+  // are fetched once from the media interface, then the requests paging
+  // through them are served from the cache until the media layer reports a
+  // change of the UIDs or of the queue.
+  using BrowsedFolderCallback =
+      base::Callback<void(const BrowsedFolderItems& folder)>;
+  using CachedNowPlayingCallback =
+      base::Callback<void(const NowPlayingItems& now_playing)>;
+
+  void GetBrowsedFolder(const std::string& folder_id,
+                        BrowsedFolderCallback folder_cb);
+  void BrowsedFolderFetched(int player_id, std::string folder_id,
+                            uint32_t generation,
+                            BrowsedFolderCallback folder_cb,
+                            std::vector<ListItem> items);
+  void GetNowPlaying(CachedNowPlayingCallback now_playing_cb);
+  void NowPlayingFetched(uint32_t generation,
+                         CachedNowPlayingCallback now_playing_cb,
+                         std::string curr_song_id,
+                         std::vector<SongInfo> song_list);
+  void InvalidateFolderCache();
+  void InvalidateNowPlayingCache();
+
   void send_message(uint8_t label, bool browse,
                     std::unique_ptr<::bluetooth::PacketBuilder> message) {
     active_labels_.erase(label);
@@ -361,6 +386,21 @@ class Device {
   MediaIdMap vfs_ids_;
   MediaIdMap now_playing_ids_;
 
+  // Maximum number of browsed folders kept in the cache.
+  static constexpr size_t kMaxCachedFolders = 8;
+  struct CachedFolder {
+    BrowsedFolderItems folder;
+    uint64_t last_used;
+  };
+  // Cached folders, keyed by player ID and folder media ID.
+  std::map<std::pair<int, std::string>, CachedFolder> folder_cache_;
+  uint64_t folder_cache_clock_ = 0;
+  NowPlayingItems now_playing_cache_;
+  bool now_playing_cached_ = false;
+  // Incremented when the cache is invalidated, so that the lists fetched
+  // before are not cached.
+  uint32_t browsing_cache_generation_ = 0;
+
   uint32_t play_pos_interval_ = 0;
 
   SongInfo last_song_info_;
@@ -110,6 +110,15 @@ class AvrcpDeviceTest : public ::testing::Test {
       test_device->SetBipClientStatus(connected);
   }
 
+  void SendMediaUpdate(bool metadata, bool play_status, bool queue) {
+    test_device->SendMediaUpdate(metadata, play_status, queue);
+  }
+
+  void SendFolderUpdate(bool available_players, bool addressed_player,
+                        bool uids) {
+    test_device->SendFolderUpdate(available_players, addressed_player, uids);
+  }
+
   void FilterCoverArt(SongInfo& s) {
     for (auto it = s.attributes.begin(); it != s.attributes.end(); it++) {
       if (it->attribute() == Attribute::DEFAULT_COVER_ART) {
@@ -1084,8 +1093,9 @@ TEST_F(AvrcpDeviceTest, changePathTest) {
   ListItem item3 = {ListItem::FOLDER, info3, SongInfo()};
   ListItem item4 = {ListItem::FOLDER, info4, SongInfo()};
   std::vector<ListItem> list1 = {item2, item3, item4};
+  // The items of Test Folder1 are cached when changing path into the folder.
   EXPECT_CALL(interface, GetFolderItems(_, "test_id1", _))
-      .Times(3)
+      .Times(1)
       .WillRepeatedly(InvokeCb<2>(list1));
 
   std::vector<ListItem> list2 = {};
@@ -1157,6 +1167,77 @@ TEST_F(AvrcpDeviceTest, changePathTest) {
   SendBrowseMessage(5, request);
 }
 
+TEST_F(AvrcpDeviceTest, browsingCacheTest) {
+  MockMediaInterface interface;
+  NiceMock<MockA2dpInterface> a2dp_interface;
+
+  test_device->RegisterInterfaces(&interface, &a2dp_interface, nullptr,
+                                  nullptr);
+
+  constexpr size_t kNumSongs = 10000;
+  constexpr size_t kPageSize = 100;
+  std::vector<ListItem> folder;
+  std::vector<SongInfo> now_playing;
+  for (size_t i = 0; i < kNumSongs; i++) {
+    SongInfo song = {"song_" + std::to_string(i),
+                     {AttributeEntry(Attribute::TITLE,
+                                     "Song " + std::to_string(i))}};
+    folder.push_back({ListItem::SONG, FolderInfo(), song});
+    now_playing.push_back(song);
+  }
+
+  // The folder and the now playing list are fetched once for all the pages,
+  // and fetched again after the media layer reports a change.
+  EXPECT_CALL(interface, GetFolderItems(_, "", _))
+      .Times(2)
+      .WillRepeatedly(InvokeCb<2>(folder));
+  EXPECT_CALL(interface, GetNowPlayingList(_))
+      .Times(2)
+      .WillRepeatedly(InvokeCb<0>("song_0", now_playing));
+
+  EXPECT_CALL(response_cb, Call(1, true, _)).Times(2 * kNumSongs / kPageSize);
+
+  auto total_response = GetTotalNumberOfItemsResponseBuilder::MakeBuilder(
+      Status::NO_ERROR, 0, kNumSongs);
+  EXPECT_CALL(response_cb,
+              Call(2, true, matchPacket(std::move(total_response))))
+      .Times(1);
+  SendBrowseMessage(
+      2, TestBrowsePacket::Make(get_total_number_of_items_request_vfs));
+
+  for (size_t start = 0; start < kNumSongs; start += kPageSize) {
+    for (Scope scope : {Scope::VFS, Scope::NOW_PLAYING}) {
+      auto request = TestBrowsePacket::Make();
+      GetFolderItemsRequestBuilder::MakeBuilder(scope, start,
+                                                start + kPageSize - 1, {})
+          ->Serialize(request);
+      SendBrowseMessage(1, request);
+    }
+  }
+
+  SendFolderUpdate(false, false, true);
+  SendMediaUpdate(false, false, true);
+
+  auto page_response = GetFolderItemsResponseBuilder::MakeVFSBuilder(
+      Status::NO_ERROR, 0x0000, 0xFFFF);
+  page_response->AddSong(MediaElementItem(
+      5001, "Song 5000", {AttributeEntry(Attribute::TITLE, "Song 5000")}));
+  EXPECT_CALL(response_cb, Call(3, true, matchPacket(std::move(page_response))))
+      .Times(1);
+  auto request = TestBrowsePacket::Make();
+  GetFolderItemsRequestBuilder::MakeBuilder(Scope::VFS, 5000, 5000, {})
+      ->Serialize(request);
+  SendBrowseMessage(3, request);
+
+  auto now_playing_total = GetTotalNumberOfItemsResponseBuilder::MakeBuilder(
+      Status::NO_ERROR, 0, kNumSongs);
+  EXPECT_CALL(response_cb,
+              Call(4, true, matchPacket(std::move(now_playing_total))))
+      .Times(1);
+  SendBrowseMessage(
+      4, TestBrowsePacket::Make(get_total_number_of_items_request_now_playing));
+}
+
 TEST_F(AvrcpDeviceTest, getItemAttributesNowPlayingTest) {
   MockMediaInterface interface;
   NiceMock<MockA2dpInterface> a2dp_interface;
@@ -111,7 +111,7 @@ void btm_gen_resolvable_private_addr(
 bool btm_ble_init_pseudo_addr(tBTM_SEC_DEV_REC* p_dev_rec,
                               const RawAddress& new_pseudo_addr) {
   if (p_dev_rec->ble.pseudo_addr.IsEmpty()) {
-    p_dev_rec->ble.pseudo_addr = new_pseudo_addr;
+    btm_sec_dev_rec_set_pseudo_addr(p_dev_rec, new_pseudo_addr);
     return true;
   }
 
@@ -200,23 +200,34 @@ static tBTM_SEC_DEV_REC* btm_find_dev_by_identity_addr(
     const RawAddress& bd_addr, uint8_t addr_type) {
   if (btm_sec_cb.sec_dev_rec == nullptr) return nullptr;
 
+  /* see btm_find_dev for the index */
+  tBTM_SEC_DEV_REC* p_match = nullptr;
+  auto it = btm_sec_cb.dev_rec_identity_index.find(bd_addr);
+  if (it != btm_sec_cb.dev_rec_identity_index.end() &&
+      it->second->ble.identity_address_with_type.bda == bd_addr) {
+    p_match = it->second;
+  }
+
   list_node_t* end = list_end(btm_sec_cb.sec_dev_rec);
-  for (list_node_t* node = list_begin(btm_sec_cb.sec_dev_rec); node != end;
-       node = list_next(node)) {
+  for (list_node_t* node = list_begin(btm_sec_cb.sec_dev_rec);
+       p_match == nullptr && node != end; node = list_next(node)) {
     tBTM_SEC_DEV_REC* p_dev_rec =
         static_cast<tBTM_SEC_DEV_REC*>(list_node(node));
     if (p_dev_rec->ble.identity_address_with_type.bda == bd_addr) {
-      if ((p_dev_rec->ble.identity_address_with_type.type &
-           (~BLE_ADDR_TYPE_ID_BIT)) != (addr_type & (~BLE_ADDR_TYPE_ID_BIT)))
-        log::warn("pseudo->random match with diff addr type: {} vs {}",
-                  p_dev_rec->ble.identity_address_with_type.type, addr_type);
-
-      /* found the match */
-      return p_dev_rec;
+      p_match = p_dev_rec;
+      btm_sec_cb.dev_rec_identity_index[bd_addr] = p_dev_rec;
     }
   }
 
-  return NULL;
+  if (p_match == nullptr) return NULL;
+
+  if ((p_match->ble.identity_address_with_type.type &
+       (~BLE_ADDR_TYPE_ID_BIT)) != (addr_type & (~BLE_ADDR_TYPE_ID_BIT)))
+    log::warn("pseudo->random match with diff addr type: {} vs {}",
+              p_match->ble.identity_address_with_type.type, addr_type);
+
+  /* found the match */
+  return p_match;
 }
 
 /*******************************************************************************
@@ -38,7 +38,6 @@
 #include <vector>
 
 #include "bta/include/bta_api.h"
-#include "common/time_util.h"
 #include "device/include/controller.h"
 #include "hci/controller.h"
 #include "hci/controller_interface.h"
@@ -2539,14 +2538,14 @@ void btm_ble_process_adv_pkt_cont(uint16_t evt_type, tBLE_ADDR_TYPE addr_type,
     p_i = btm_inq_db_new(bda, true);
     if (p_i != NULL) {
       btm_cb.btm_inq_vars.inq_cmpl_info.num_resp++;
-      p_i->time_of_resp = bluetooth::common::time_get_os_boottime_ms();
+      btm_inq_db_touch(p_i);
     } else
       return;
   } else if (p_i->inq_count !=
              btm_cb.btm_inq_vars
                  .inq_counter) /* first time seen in this inquiry */
   {
-    p_i->time_of_resp = bluetooth::common::time_get_os_boottime_ms();
+    btm_inq_db_touch(p_i);
     btm_cb.btm_inq_vars.inq_cmpl_info.num_resp++;
   }
 
@@ -2645,7 +2644,7 @@ void btm_ble_process_adv_pkt_cont_for_inquiry(
     p_i = btm_inq_db_new(bda, true);
     if (p_i != NULL) {
       btm_cb.btm_inq_vars.inq_cmpl_info.num_resp++;
-      p_i->time_of_resp = bluetooth::common::time_get_os_boottime_ms();
+      btm_inq_db_touch(p_i);
       btm_cb.neighbor.le_inquiry.results++;
       btm_cb.neighbor.le_legacy_scan.results++;
     } else {
@@ -2656,7 +2655,7 @@ void btm_ble_process_adv_pkt_cont_for_inquiry(
              btm_cb.btm_inq_vars
                  .inq_counter) /* first time seen in this inquiry */
   {
-    p_i->time_of_resp = bluetooth::common::time_get_os_boottime_ms();
+    btm_inq_db_touch(p_i);
     btm_cb.btm_inq_vars.inq_cmpl_info.num_resp++;
   }
 
@@ -584,10 +584,11 @@ void btm_ble_resolving_list_load_dev(tBTM_SEC_DEV_REC& dev_rec) {
   const Octet16& local_irk = get_local_irk();
 
   if (dev_rec.ble.identity_address_with_type.bda.IsEmpty()) {
-    dev_rec.ble.identity_address_with_type = {
-        .type = dev_rec.ble.AddressType(),
-        .bda = dev_rec.bd_addr,
-    };
+    btm_sec_dev_rec_set_identity_addr(&dev_rec,
+                                      {
+                                          .type = dev_rec.ble.AddressType(),
+                                          .bda = dev_rec.bd_addr,
+                                      });
   }
 
   if (!is_ble_addr_type_known(dev_rec.ble.identity_address_with_type.type)) {
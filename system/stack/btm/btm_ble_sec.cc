@@ -84,9 +84,13 @@ void BTM_SecAddBleDevice(const RawAddress& bd_addr, tBT_DEVICE_TYPE dev_type,
   if (!p_dev_rec) {
     p_dev_rec = btm_sec_allocate_dev_rec();
 
-    p_dev_rec->bd_addr = bd_addr;
-    p_dev_rec->hci_handle = BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_BR_EDR);
-    p_dev_rec->ble_hci_handle = BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_LE);
+    btm_sec_dev_rec_set_bd_addr(p_dev_rec, bd_addr);
+    btm_sec_dev_rec_set_hci_handle(
+        p_dev_rec, BT_TRANSPORT_BR_EDR,
+        BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_BR_EDR));
+    btm_sec_dev_rec_set_hci_handle(
+        p_dev_rec, BT_TRANSPORT_LE,
+        BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_LE));
 
     /* update conn params, use default value for background connection params */
     p_dev_rec->conn_params.min_conn_int = BTM_BLE_CONN_PARAM_UNDEF;
@@ -906,12 +910,12 @@ void btm_sec_save_le_key(const RawAddress& bd_addr, tBTM_LE_KEY_TYPE key_type,
         break;
 
       case BTM_LE_KEY_PID:
-        p_rec->sec_rec.ble_keys.irk = p_keys->pid_key.irk;
-        p_rec->ble.identity_address_with_type.bda =
-            p_keys->pid_key.identity_addr;
-        p_rec->ble.identity_address_with_type.type =
-            p_keys->pid_key.identity_addr_type;
-        p_rec->sec_rec.ble_keys.key_type |= BTM_LE_KEY_PID;
+        btm_sec_dev_rec_set_irk(p_rec, p_keys->pid_key.irk);
+        btm_sec_dev_rec_set_identity_addr(
+            p_rec, {
+                       .type = p_keys->pid_key.identity_addr_type,
+                       .bda = p_keys->pid_key.identity_addr,
+                   });
         log::verbose(
             "BTM_LE_KEY_PID key_type=0x{:x} save peer IRK, change bd_addr={} "
             "to id_addr={} id_addr_type=0x{:x}",
@@ -920,7 +924,7 @@ void btm_sec_save_le_key(const RawAddress& bd_addr, tBTM_LE_KEY_TYPE key_type,
             ADDRESS_TO_LOGGABLE_CSTR(p_keys->pid_key.identity_addr),
             p_keys->pid_key.identity_addr_type);
         /* update device record address as identity address */
-        p_rec->bd_addr = p_keys->pid_key.identity_addr;
+        btm_sec_dev_rec_set_bd_addr(p_rec, p_keys->pid_key.identity_addr);
         /* combine DUMO device security record if needed */
         btm_consolidate_dev(p_rec);
         break;
@@ -1531,8 +1535,8 @@ void btm_ble_connected(const RawAddress& bda, uint16_t handle, uint8_t enc_mode,
     log::warn(
         "Please do not update device record from anonymous le advertisement");
 
-  p_dev_rec->ble.pseudo_addr = bda;
-  p_dev_rec->ble_hci_handle = handle;
+  btm_sec_dev_rec_set_pseudo_addr(p_dev_rec, bda);
+  btm_sec_dev_rec_set_hci_handle(p_dev_rec, BT_TRANSPORT_LE, handle);
   p_dev_rec->device_type |= BT_DEVICE_TYPE_BLE;
   p_dev_rec->role_central = (role == HCI_ROLE_CENTRAL) ? true : false;
   p_dev_rec->can_read_discoverable = can_read_discoverable_characteristics;
@@ -30,6 +30,7 @@
 #include <bluetooth/log.h>
 
 #include <string>
+#include <unordered_map>
 
 #include "btm_api.h"
 #include "btm_int_types.h"
@@ -62,6 +63,16 @@ constexpr char kBtmLogTag[] = "BOND";
 
 }
 
+/* The btm_find_dev* lookups remember the record found for a key in the
+ * btm_sec_cb indexes, and the resolvable private addresses that no record
+ * resolves. The fields the lookups match on are set through the
+ * btm_sec_dev_rec_set_* functions, which drop the indexes since another
+ * record may then match a key first. The indexes are also dropped when a
+ * record is added or removed. An indexed record is still checked against the
+ * key before being returned. */
+static constexpr size_t kMaxDevRecAddrIndexSize =
+    4 * BTM_SEC_MAX_DEVICE_RECORDS;
+
 static void wipe_secrets_and_remove(tBTM_SEC_DEV_REC* p_dev_rec) {
   p_dev_rec->sec_rec.link_key.fill(0);
   memset(&p_dev_rec->sec_rec.ble_keys, 0, sizeof(tBTM_SEC_BLE_KEYS));
@@ -99,8 +110,10 @@ bool BTM_SecAddDevice(const RawAddress& bd_addr, DEV_CLASS dev_class,
         ADDRESS_TO_LOGGABLE_STR(bd_addr), key_type,
         reinterpret_cast<const char*>(bd_name));
 
-    p_dev_rec->bd_addr = bd_addr;
-    p_dev_rec->hci_handle = BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_BR_EDR);
+    btm_sec_dev_rec_set_bd_addr(p_dev_rec, bd_addr);
+    btm_sec_dev_rec_set_hci_handle(
+        p_dev_rec, BT_TRANSPORT_BR_EDR,
+        BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_BR_EDR));
 
     /* use default value for background connection params */
     /* update conn params, use default value for background connection params */
@@ -299,10 +312,13 @@ tBTM_SEC_DEV_REC* btm_sec_alloc_dev(const RawAddress& bd_addr) {
   /* update conn params, use default value for background connection params */
   memset(&p_dev_rec->conn_params, 0xff, sizeof(tBTM_LE_CONN_PRAMS));
 
-  p_dev_rec->bd_addr = bd_addr;
+  btm_sec_dev_rec_set_bd_addr(p_dev_rec, bd_addr);
 
-  p_dev_rec->ble_hci_handle = BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_LE);
-  p_dev_rec->hci_handle = BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_BR_EDR);
+  btm_sec_dev_rec_set_hci_handle(
+      p_dev_rec, BT_TRANSPORT_LE, BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_LE));
+  btm_sec_dev_rec_set_hci_handle(
+      p_dev_rec, BT_TRANSPORT_BR_EDR,
+      BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_BR_EDR));
 
   return (p_dev_rec);
 }
@@ -352,6 +368,44 @@ bool btm_dev_support_role_switch(const RawAddress& bd_addr) {
   return false;
 }
 
+void btm_sec_dev_rec_set_bd_addr(tBTM_SEC_DEV_REC* p_dev_rec,
+                                 const RawAddress& bd_addr) {
+  if (p_dev_rec->bd_addr == bd_addr) return;
+  p_dev_rec->bd_addr = bd_addr;
+  btm_sec_cb.ClearDevRecIndex();
+}
+
+void btm_sec_dev_rec_set_pseudo_addr(tBTM_SEC_DEV_REC* p_dev_rec,
+                                     const RawAddress& pseudo_addr) {
+  if (p_dev_rec->ble.pseudo_addr == pseudo_addr) return;
+  p_dev_rec->ble.pseudo_addr = pseudo_addr;
+  btm_sec_cb.ClearDevRecIndex();
+}
+
+void btm_sec_dev_rec_set_identity_addr(tBTM_SEC_DEV_REC* p_dev_rec,
+                                       const tBLE_BD_ADDR& identity_addr) {
+  if (p_dev_rec->ble.identity_address_with_type == identity_addr) return;
+  p_dev_rec->ble.identity_address_with_type = identity_addr;
+  btm_sec_cb.ClearDevRecIndex();
+}
+
+void btm_sec_dev_rec_set_hci_handle(tBTM_SEC_DEV_REC* p_dev_rec,
+                                    tBT_TRANSPORT transport, uint16_t handle) {
+  uint16_t& hci_handle = (transport == BT_TRANSPORT_LE)
+                             ? p_dev_rec->ble_hci_handle
+                             : p_dev_rec->hci_handle;
+  if (hci_handle == handle) return;
+  hci_handle = handle;
+  btm_sec_cb.ClearDevRecIndex();
+}
+
+void btm_sec_dev_rec_set_irk(tBTM_SEC_DEV_REC* p_dev_rec, const Octet16& irk) {
+  p_dev_rec->sec_rec.ble_keys.irk = irk;
+  p_dev_rec->sec_rec.ble_keys.key_type |= BTM_LE_KEY_PID;
+  // Resolvable private addresses that did not resolve may now.
+  btm_sec_cb.ClearDevRecIndex();
+}
+
 static bool is_handle_equal(void* data, void* context) {
   tBTM_SEC_DEV_REC* p_dev_rec = static_cast<tBTM_SEC_DEV_REC*>(data);
   uint16_t* handle = static_cast<uint16_t*>(context);
@@ -375,13 +429,44 @@ static bool is_handle_equal(void* data, void* context) {
 tBTM_SEC_DEV_REC* btm_find_dev_by_handle(uint16_t handle) {
   if (btm_sec_cb.sec_dev_rec == nullptr) return nullptr;
 
+  auto it = btm_sec_cb.dev_rec_handle_index.find(handle);
+  if (it != btm_sec_cb.dev_rec_handle_index.end() &&
+      !is_handle_equal(it->second, &handle)) {
+    return it->second;
+  }
+
   list_node_t* n =
       list_foreach(btm_sec_cb.sec_dev_rec, is_handle_equal, &handle);
-  if (n) return static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
+  if (n) {
+    tBTM_SEC_DEV_REC* p_dev_rec =
+        static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
+    if (handle != HCI_INVALID_HANDLE) {
+      btm_sec_cb.dev_rec_handle_index[handle] = p_dev_rec;
+    }
+    return p_dev_rec;
+  }
 
   return NULL;
 }
 
+/* Whether a record has an IRK but is not known to be a LE device yet, which
+ * btm_ble_addr_resolvable then skips. The device type of a record is not
+ * set through btm_sec_dev_rec_set_* functions, so the addresses unresolved
+ * in that case are not remembered. */
+static bool btm_dev_rec_may_become_resolvable() {
+  list_node_t* end = list_end(btm_sec_cb.sec_dev_rec);
+  for (list_node_t* node = list_begin(btm_sec_cb.sec_dev_rec); node != end;
+       node = list_next(node)) {
+    tBTM_SEC_DEV_REC* p_dev_rec =
+        static_cast<tBTM_SEC_DEV_REC*>(list_node(node));
+    if (!(p_dev_rec->device_type & BT_DEVICE_TYPE_BLE) &&
+        (p_dev_rec->sec_rec.ble_keys.key_type & BTM_LE_KEY_PID)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 static bool is_address_equal(void* data, void* context) {
   tBTM_SEC_DEV_REC* p_dev_rec = static_cast<tBTM_SEC_DEV_REC*>(data);
   const RawAddress* bd_addr = ((RawAddress*)context);
@@ -407,11 +492,32 @@ static bool is_address_equal(void* data, void* context) {
 tBTM_SEC_DEV_REC* btm_find_dev(const RawAddress& bd_addr) {
   if (btm_sec_cb.sec_dev_rec == nullptr) return nullptr;
 
+  auto it = btm_sec_cb.dev_rec_addr_index.find(bd_addr);
+  if (it != btm_sec_cb.dev_rec_addr_index.end()) {
+    // A resolvable private address that no record resolves.
+    if (it->second == nullptr) return nullptr;
+    // Checking a resolvable address may update the record and the index.
+    tBTM_SEC_DEV_REC* p_dev_rec = it->second;
+    if (!is_address_equal(p_dev_rec, (void*)&bd_addr)) return p_dev_rec;
+  }
+
   list_node_t* n =
       list_foreach(btm_sec_cb.sec_dev_rec, is_address_equal, (void*)&bd_addr);
-  if (n) return static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
+  tBTM_SEC_DEV_REC* p_dev_rec =
+      n ? static_cast<tBTM_SEC_DEV_REC*>(list_node(n)) : nullptr;
+
+  // Other unknown addresses are only compared, without resolving them with
+  // the IRK of each record, and are not remembered.
+  if (p_dev_rec != nullptr || (BTM_BLE_IS_RESOLVE_BDA(bd_addr) &&
+                                !btm_dev_rec_may_become_resolvable())) {
+    // Resolvable private addresses are indexed too, bound their number.
+    if (btm_sec_cb.dev_rec_addr_index.size() >= kMaxDevRecAddrIndexSize) {
+      btm_sec_cb.dev_rec_addr_index.clear();
+    }
+    btm_sec_cb.dev_rec_addr_index[bd_addr] = p_dev_rec;
+  }
 
-  return NULL;
+  return p_dev_rec;
 }
 
 static bool has_lenc_and_address_is_equal(void* data, void* context) {
@@ -496,6 +602,9 @@ void btm_consolidate_dev(tBTM_SEC_DEV_REC* p_target_rec) {
       }
     }
   }
+
+  /* the target record may have taken the handles and keys of another one */
+  btm_sec_cb.ClearDevRecIndex();
 }
 
 static BTM_CONSOLIDATION_CB* btm_consolidate_cb = nullptr;
@@ -547,7 +656,8 @@ void btm_dev_consolidate_existing_connections(const RawAddress& bd_addr) {
           p_dev_rec->ble_hci_handle);
 
       RawAddress ble_conn_addr = p_dev_rec->bd_addr;
-      p_target_rec->ble_hci_handle = p_dev_rec->ble_hci_handle;
+      btm_sec_dev_rec_set_hci_handle(p_target_rec, BT_TRANSPORT_LE,
+                                     p_dev_rec->ble_hci_handle);
 
       /* remove the old LE record */
       wipe_secrets_and_remove(p_dev_rec);
@@ -664,6 +774,7 @@ tBTM_SEC_DEV_REC* btm_sec_allocate_dev_rec(void) {
   p_dev_rec =
       static_cast<tBTM_SEC_DEV_REC*>(osi_calloc(sizeof(tBTM_SEC_DEV_REC)));
   list_append(btm_sec_cb.sec_dev_rec, p_dev_rec);
+  btm_sec_cb.ClearDevRecIndex();
 
   // Initialize defaults
   p_dev_rec->sec_rec.sec_flags = BTM_SEC_IN_USE;
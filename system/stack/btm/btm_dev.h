@@ -106,6 +106,20 @@ tBTM_SEC_DEV_REC* btm_find_dev_by_handle(uint16_t handle);
  ******************************************************************************/
 tBTM_SEC_DEV_REC* btm_find_dev(const RawAddress& bd_addr);
 
+/* Set the fields of a device record that the btm_find_dev* lookups match on.
+ * These fields are only to be written through these functions, which keep the
+ * lookup indexes up to date. btm_sec_dev_rec_set_irk also marks the record as
+ * having a peer IRK (BTM_LE_KEY_PID). */
+void btm_sec_dev_rec_set_bd_addr(tBTM_SEC_DEV_REC* p_dev_rec,
+                                 const RawAddress& bd_addr);
+void btm_sec_dev_rec_set_pseudo_addr(tBTM_SEC_DEV_REC* p_dev_rec,
+                                     const RawAddress& pseudo_addr);
+void btm_sec_dev_rec_set_identity_addr(tBTM_SEC_DEV_REC* p_dev_rec,
+                                       const tBLE_BD_ADDR& identity_addr);
+void btm_sec_dev_rec_set_hci_handle(tBTM_SEC_DEV_REC* p_dev_rec,
+                                    tBT_TRANSPORT transport, uint16_t handle);
+void btm_sec_dev_rec_set_irk(tBTM_SEC_DEV_REC* p_dev_rec, const Octet16& irk);
+
 /*******************************************************************************
  *
  * Function         btm_find_dev_with_lenc
@@ -34,7 +34,11 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
+#include <list>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "advertise_data_parser.h"
 #include "btif/include/btif_acl.h"
@@ -113,12 +117,88 @@ void btm_log_history_scan_mode(uint8_t scan_mode) {
 std::mutex inq_db_lock_;
 // Inquiry database
 tINQ_DB_ENT inq_db_[BTM_INQ_DB_SIZE];
+// Index of the in use inquiry database entries by address, kept in sync
+// with the in_use flag of the entries.
+std::unordered_map<RawAddress, tINQ_DB_ENT*> inq_db_index_;
+
+// LRU aging of the inquiry database. Each half of the database (classic,
+// then BLE) orders its in use entries from the least to the most recently
+// responding device, and stacks its free entries lowest index on top.
+struct InqDbAging {
+  std::list<tINQ_DB_ENT*> lru;
+  std::vector<tINQ_DB_ENT*> free;
+};
+InqDbAging inq_db_aging_[2];
+// Position of each in use entry in the LRU list of its half
+std::list<tINQ_DB_ENT*>::iterator inq_db_lru_pos_[BTM_INQ_DB_SIZE];
+
+InqDbAging& btm_inq_db_aging(const tINQ_DB_ENT* p_ent) {
+  return inq_db_aging_[(p_ent - inq_db_) / (BTM_INQ_DB_SIZE / 2)];
+}
+
+// Rebuild the index and the aging lists from the entries, after they were
+// moved or cleared in bulk. The in use entries are aged in the order of
+// |lru_order| addresses if given, else by time of response. inq_db_lock_ is
+// held.
+void btm_inq_db_rebuild(const std::vector<RawAddress>& lru_order = {}) {
+  std::vector<tINQ_DB_ENT*> in_use;
+
+  inq_db_index_.clear();
+  for (InqDbAging& aging : inq_db_aging_) {
+    aging.lru.clear();
+    aging.free.clear();
+  }
+  for (int xx = BTM_INQ_DB_SIZE - 1; xx >= 0; xx--) {
+    if (!inq_db_[xx].in_use) {
+      btm_inq_db_aging(&inq_db_[xx]).free.push_back(&inq_db_[xx]);
+    }
+  }
+  for (int xx = 0; xx < BTM_INQ_DB_SIZE; xx++) {
+    tINQ_DB_ENT* p_ent = &inq_db_[xx];
+    if (p_ent->in_use) {
+      inq_db_index_[p_ent->inq_info.results.remote_bd_addr] = p_ent;
+      in_use.push_back(p_ent);
+    }
+  }
+
+  if (lru_order.empty()) {
+    std::stable_sort(in_use.begin(), in_use.end(),
+                     [](const tINQ_DB_ENT* a, const tINQ_DB_ENT* b) {
+                       return a->time_of_resp < b->time_of_resp;
+                     });
+  } else {
+    in_use.clear();
+    for (const RawAddress& bd_addr : lru_order) {
+      auto it = inq_db_index_.find(bd_addr);
+      if (it != inq_db_index_.end()) in_use.push_back(it->second);
+    }
+  }
+
+  for (tINQ_DB_ENT* p_ent : in_use) {
+    InqDbAging& aging = btm_inq_db_aging(p_ent);
+    inq_db_lru_pos_[p_ent - inq_db_] =
+        aging.lru.insert(aging.lru.end(), p_ent);
+  }
+}
+
+// Return an in use entry to the free entries of its half, inq_db_lock_ is
+// held.
+void btm_inq_db_release(tINQ_DB_ENT* p_ent) {
+  InqDbAging& aging = btm_inq_db_aging(p_ent);
+  auto it = inq_db_index_.find(p_ent->inq_info.results.remote_bd_addr);
+  if (it != inq_db_index_.end() && it->second == p_ent) inq_db_index_.erase(it);
+  aging.lru.erase(inq_db_lru_pos_[p_ent - inq_db_]);
+  aging.free.push_back(p_ent);
+  p_ent->in_use = false;
+}
 
 // Inquiry bluetooth device database lock
 std::mutex bd_db_lock_;
 tINQ_BDADDR* p_bd_db_;    /* Pointer to memory that holds bdaddrs */
 uint16_t num_bd_entries_; /* Number of entries in database */
 uint16_t max_bd_entries_; /* Maximum number of entries that can be stored */
+// Index of the bdaddr database, to the inquiry count of the last entry
+std::unordered_map<RawAddress, uint32_t> bd_db_index_;
 
 }  // namespace
 
@@ -993,8 +1073,9 @@ void btm_clear_all_pending_le_entry(void) {
      * response outstanding */
     if ((p_ent->in_use) &&
         (p_ent->inq_info.results.device_type == BT_DEVICE_TYPE_BLE) &&
-        !p_ent->scan_rsp)
-      p_ent->in_use = false;
+        !p_ent->scan_rsp) {
+      btm_inq_db_release(p_ent);
+    }
   }
 }
 
@@ -1167,14 +1248,16 @@ void btm_clr_inq_db(const RawAddress* p_bda) {
                btm_cb.btm_inq_vars.inq_active, btm_cb.btm_inq_vars.state);
 #endif
   std::lock_guard<std::mutex> lock(inq_db_lock_);
-  tINQ_DB_ENT* p_ent = inq_db_;
-  for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
-    if (p_ent->in_use) {
-      /* If this is the specified BD_ADDR or clearing all devices */
-      if (p_bda == NULL || (p_ent->inq_info.results.remote_bd_addr == *p_bda)) {
-        p_ent->in_use = false;
-      }
+  if (p_bda == NULL) {
+    /* Clearing all devices */
+    tINQ_DB_ENT* p_ent = inq_db_;
+    for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
+      p_ent->in_use = false;
     }
+    btm_inq_db_rebuild();
+  } else {
+    auto it = inq_db_index_.find(*p_bda);
+    if (it != inq_db_index_.end()) btm_inq_db_release(it->second);
   }
 #if (BTM_INQ_DEBUG == TRUE)
   log::verbose("inq_active:0x{:x} state:{}", btm_cb.btm_inq_vars.inq_active,
@@ -1202,6 +1285,8 @@ static void btm_init_inq_result_flt(void) {
   /* Allocate memory to hold bd_addrs responding */
   p_bd_db_ = (tINQ_BDADDR*)osi_calloc(BT_DEFAULT_BUFFER_SIZE);
   max_bd_entries_ = (uint16_t)(BT_DEFAULT_BUFFER_SIZE / sizeof(tINQ_BDADDR));
+  bd_db_index_.clear();
+  bd_db_index_.reserve(max_bd_entries_);
 }
 
 void btm_clr_inq_result_flt(void) {
@@ -1213,6 +1298,7 @@ void btm_clr_inq_result_flt(void) {
   osi_free_and_reset((void**)&p_bd_db_);
   num_bd_entries_ = 0;
   max_bd_entries_ = 0;
+  bd_db_index_.clear();
 }
 
 /*******************************************************************************
@@ -1227,21 +1313,20 @@ void btm_clr_inq_result_flt(void) {
  ******************************************************************************/
 bool btm_inq_find_bdaddr(const RawAddress& p_bda) {
   std::lock_guard<std::mutex> lock(bd_db_lock_);
-  tINQ_BDADDR* p_db = p_bd_db_;
-  uint16_t xx;
 
   /* Don't bother searching, database doesn't exist or periodic mode */
-  if (!p_db) return (false);
+  if (!p_bd_db_) return (false);
 
-  for (xx = 0; xx < num_bd_entries_; xx++, p_db++) {
-    if (p_db->bd_addr == p_bda &&
-        p_db->inq_count == btm_cb.btm_inq_vars.inq_counter)
-      return (true);
-  }
+  auto it = bd_db_index_.find(p_bda);
+  if (it != bd_db_index_.end() &&
+      it->second == btm_cb.btm_inq_vars.inq_counter)
+    return (true);
 
-  if (xx < max_bd_entries_) {
+  if (num_bd_entries_ < max_bd_entries_) {
+    tINQ_BDADDR* p_db = &p_bd_db_[num_bd_entries_];
     p_db->inq_count = btm_cb.btm_inq_vars.inq_counter;
     p_db->bd_addr = p_bda;
+    bd_db_index_[p_bda] = p_db->inq_count;
     num_bd_entries_++;
   }
 
@@ -1260,14 +1345,10 @@ bool btm_inq_find_bdaddr(const RawAddress& p_bda) {
  *
  ******************************************************************************/
 tINQ_DB_ENT* btm_inq_db_find(const RawAddress& p_bda) {
-  uint16_t xx;
   std::lock_guard<std::mutex> lock(inq_db_lock_);
-  tINQ_DB_ENT* p_ent = inq_db_;
 
-  for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
-    if (p_ent->in_use && p_ent->inq_info.results.remote_bd_addr == p_bda)
-      return (p_ent);
-  }
+  auto it = inq_db_index_.find(p_bda);
+  if (it != inq_db_index_.end()) return (it->second);
 
   /* If here, not found */
   return (NULL);
@@ -1277,54 +1358,68 @@ tINQ_DB_ENT* btm_inq_db_find(const RawAddress& p_bda) {
  *
  * Function         btm_inq_db_new
  *
- * Description      This function looks through the inquiry database for an
- *                  unused entry. If no entry is free, it allocates the oldest
- *                  entry.
+ * Description      This function allocates an unused entry of the inquiry
+ *                  database. If no entry is free, it reuses the least recently
+ *                  responding entry, or the weakest one when aging by RSSI.
  *
  * Returns          pointer to entry
  *
  ******************************************************************************/
 tINQ_DB_ENT* btm_inq_db_new(const RawAddress& p_bda, bool is_ble) {
-  uint16_t xx = 0, yy = 0;
-  uint32_t ot = 0xFFFFFFFF;
-  int8_t i_rssi = 0;
-
-  if (is_ble) yy = BTM_INQ_DB_SIZE / 2;
-  else yy = 0;
-
   std::lock_guard<std::mutex> lock(inq_db_lock_);
-  tINQ_DB_ENT* p_ent = &inq_db_[yy];
-  tINQ_DB_ENT* p_old = &inq_db_[yy];
-
-  for (xx = 0; xx < BTM_INQ_DB_SIZE / 2; xx++, p_ent++) {
-    if (!p_ent->in_use) {
-      memset(p_ent, 0, sizeof(tINQ_DB_ENT));
-      p_ent->inq_info.results.remote_bd_addr = p_bda;
-      p_ent->in_use = true;
+  InqDbAging& aging = inq_db_aging_[is_ble ? 1 : 0];
+  tINQ_DB_ENT* p_ent;
 
-      return (p_ent);
-    }
+  /* The aging lists are built on the first use of the database */
+  if (aging.lru.size() + aging.free.size() != BTM_INQ_DB_SIZE / 2) {
+    btm_inq_db_rebuild();
+  }
 
+  if (!aging.free.empty()) {
+    p_ent = aging.free.back();
+    aging.free.pop_back();
+  } else {
+    p_ent = aging.lru.front();
     if (internal_.inq_by_rssi) {
-      if (p_ent->inq_info.results.rssi < i_rssi) {
-        p_old = p_ent;
-        i_rssi = p_ent->inq_info.results.rssi;
-      }
-    } else {
-      if (p_ent->time_of_resp < ot) {
-        p_old = p_ent;
-        ot = p_ent->time_of_resp;
+      for (tINQ_DB_ENT* p_cur : aging.lru) {
+        if (p_cur->inq_info.results.rssi < p_ent->inq_info.results.rssi) {
+          p_ent = p_cur;
+        }
       }
     }
+    btm_inq_db_release(p_ent);
+    aging.free.pop_back();
   }
 
-  /* If here, no free entry found. Return the oldest. */
+  memset(p_ent, 0, sizeof(tINQ_DB_ENT));
+  p_ent->inq_info.results.remote_bd_addr = p_bda;
+  p_ent->in_use = true;
+  inq_db_index_[p_bda] = p_ent;
+  /* Not responded yet, the entry is the oldest until it is touched */
+  inq_db_lru_pos_[p_ent - inq_db_] = aging.lru.insert(aging.lru.begin(), p_ent);
 
-  memset(p_old, 0, sizeof(tINQ_DB_ENT));
-  p_old->inq_info.results.remote_bd_addr = p_bda;
-  p_old->in_use = true;
+  return (p_ent);
+}
 
-  return (p_old);
+/*******************************************************************************
+ *
+ * Function         btm_inq_db_touch
+ *
+ * Description      This function records a response of the device of an
+ *                  inquiry database entry, making it the most recently
+ *                  responding entry.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void btm_inq_db_touch(tINQ_DB_ENT* p_ent) {
+  std::lock_guard<std::mutex> lock(inq_db_lock_);
+  p_ent->time_of_resp = bluetooth::common::time_get_os_boottime_ms();
+  if (!p_ent->in_use) return;
+
+  InqDbAging& aging = btm_inq_db_aging(p_ent);
+  aging.lru.splice(aging.lru.end(), aging.lru,
+                   inq_db_lru_pos_[p_ent - inq_db_]);
 }
 
 /*******************************************************************************
@@ -1409,7 +1504,7 @@ static void btm_process_inq_results_standard(bluetooth::hci::EventView event) {
       p_cur->dev_class[2] = dc[2];
       p_cur->clock_offset = clock_offset | BTM_CLOCK_OFFSET_VALID;
 
-      p_i->time_of_resp = bluetooth::common::time_get_os_boottime_ms();
+      btm_inq_db_touch(p_i);
 
       if (p_i->inq_count != btm_cb.btm_inq_vars.inq_counter) {
         /* A new response was found */
@@ -1554,7 +1649,7 @@ static void btm_process_inq_results_rssi(bluetooth::hci::EventView event) {
       p_cur->dev_class[2] = dc[2];
       p_cur->clock_offset = clock_offset | BTM_CLOCK_OFFSET_VALID;
 
-      p_i->time_of_resp = bluetooth::common::time_get_os_boottime_ms();
+      btm_inq_db_touch(p_i);
 
       if (p_i->inq_count != btm_cb.btm_inq_vars.inq_counter) {
         /* A new response was found */
@@ -1704,7 +1799,7 @@ static void btm_process_inq_results_extended(bluetooth::hci::EventView event) {
       p_cur->dev_class[2] = dc[2];
       p_cur->clock_offset = clock_offset | BTM_CLOCK_OFFSET_VALID;
 
-      p_i->time_of_resp = bluetooth::common::time_get_os_boottime_ms();
+      btm_inq_db_touch(p_i);
 
       if (p_i->inq_count != btm_cb.btm_inq_vars.inq_counter) {
         /* A new response was found */
@@ -1770,29 +1865,30 @@ static void btm_process_inq_results_extended(bluetooth::hci::EventView event) {
  *
  ******************************************************************************/
 void btm_sort_inq_result(void) {
-  uint8_t xx, yy, num_resp;
+  uint8_t num_resp;
   std::lock_guard<std::mutex> lock(inq_db_lock_);
-  tINQ_DB_ENT* p_ent = inq_db_;
-  tINQ_DB_ENT* p_next = inq_db_ + 1;
-  int size;
-  tINQ_DB_ENT* p_tmp = (tINQ_DB_ENT*)osi_malloc(sizeof(tINQ_DB_ENT));
 
   num_resp = (btm_cb.btm_inq_vars.inq_cmpl_info.num_resp < BTM_INQ_DB_SIZE)
                  ? btm_cb.btm_inq_vars.inq_cmpl_info.num_resp
                  : BTM_INQ_DB_SIZE;
-
-  size = sizeof(tINQ_DB_ENT);
-  for (xx = 0; xx < num_resp - 1; xx++, p_ent++) {
-    for (yy = xx + 1, p_next = p_ent + 1; yy < num_resp; yy++, p_next++) {
-      if (p_ent->inq_info.results.rssi < p_next->inq_info.results.rssi) {
-        memcpy(p_tmp, p_next, size);
-        memcpy(p_next, p_ent, size);
-        memcpy(p_ent, p_tmp, size);
-      }
+  if (num_resp < 2) return;
+
+  /* Remember the aging order of the entries, by address, as they move */
+  std::vector<RawAddress> lru_order;
+  lru_order.reserve(BTM_INQ_DB_SIZE);
+  for (const InqDbAging& aging : inq_db_aging_) {
+    for (const tINQ_DB_ENT* p_ent : aging.lru) {
+      lru_order.push_back(p_ent->inq_info.results.remote_bd_addr);
     }
   }
 
-  osi_free(p_tmp);
+  std::stable_sort(inq_db_, inq_db_ + num_resp,
+                   [](const tINQ_DB_ENT& a, const tINQ_DB_ENT& b) {
+                     return a.inq_info.results.rssi > b.inq_info.results.rssi;
+                   });
+
+  /* The sorted entries moved, update their index and aging */
+  btm_inq_db_rebuild(lru_order);
 }
 
 /*******************************************************************************
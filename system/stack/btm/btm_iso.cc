@@ -106,6 +106,14 @@ void IsoManager::SendIsoData(uint16_t iso_handle, const uint8_t* data,
   pimpl_->iso_impl_->send_iso_data(iso_handle, data, data_len);
 }
 
+BT_HDR* IsoManager::AllocateIsoSdu(uint16_t iso_handle, uint16_t data_len) {
+  return pimpl_->iso_impl_->allocate_iso_sdu(iso_handle, data_len);
+}
+
+void IsoManager::SendIsoSdu(BT_HDR* sdu) {
+  pimpl_->iso_impl_->send_iso_sdu(sdu);
+}
+
 void IsoManager::CreateBig(uint8_t big_id,
                            struct iso_manager::big_create_params big_params) {
   pimpl_->iso_impl_->create_big(big_id, std::move(big_params));
@@ -530,8 +530,7 @@ struct iso_impl {
     return packet;
   }
 
-  void send_iso_data(uint16_t iso_handle, const uint8_t* data,
-                     uint16_t data_len) {
+  BT_HDR* allocate_iso_sdu(uint16_t iso_handle, uint16_t data_len) {
     iso_base* iso = GetIsoIfKnown(iso_handle);
     LOG_ASSERT(iso != nullptr)
         << "No such iso connection handle: " << loghex(iso_handle);
@@ -539,13 +538,13 @@ struct iso_impl {
     if (!(iso->state_flags & kStateFlagIsBroadcast)) {
       if (!(iso->state_flags & kStateFlagIsConnected)) {
         log::warn("Cis handle: {} not established", loghex(iso_handle));
-        return;
+        return nullptr;
       }
     }
 
     if (!(iso->state_flags & kStateFlagHasDataPathSet)) {
       log::warn("Data path not set for handle: 0x{:04x}", iso_handle);
-      return;
+      return nullptr;
     }
 
     /* Calculate sequence number for the ISO data packet.
@@ -564,19 +563,37 @@ struct iso_impl {
           ", dropping ISO packet, len: {}, iso credits: {}, iso handle: {}",
           static_cast<int>(data_len), static_cast<int>(iso_credits_),
           loghex(iso_handle));
-      return;
+      return nullptr;
     }
 
     iso_credits_--;
     iso->used_credits++;
 
+    /* Expose only the SDU payload until the packet is sent */
     BT_HDR* packet = prepare_hci_packet(iso_handle, seq_nb, data_len);
-    memcpy(packet->data + kIsoHeaderWithoutTsLen, data, data_len);
+    packet->offset = kIsoHeaderWithoutTsLen;
+    packet->len = data_len;
+    return packet;
+  }
+
+  void send_iso_sdu(BT_HDR* packet) {
+    packet->len += packet->offset;
+    packet->offset = 0;
+
     auto hci = bluetooth::shim::hci_layer_get_interface();
     packet->event = MSG_STACK_TO_HC_HCI_ISO | 0x0001;
     hci->transmit_downward(packet, iso_buffer_size_);
   }
 
+  void send_iso_data(uint16_t iso_handle, const uint8_t* data,
+                     uint16_t data_len) {
+    BT_HDR* packet = allocate_iso_sdu(iso_handle, data_len);
+    if (packet == nullptr) return;
+
+    memcpy(packet->data + packet->offset, data, data_len);
+    send_iso_sdu(packet);
+  }
+
   void process_cis_est_pkt(uint8_t len, uint8_t* data) {
     cis_establish_cmpl_evt evt;
 
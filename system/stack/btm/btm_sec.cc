@@ -1592,7 +1592,9 @@ tBTM_STATUS btm_sec_l2cap_access_req_by_requirement(
   /* Find or get oldest record */
   tBTM_SEC_DEV_REC* p_dev_rec = btm_find_or_alloc_dev(bd_addr);
 
-  p_dev_rec->hci_handle = BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_BR_EDR);
+  btm_sec_dev_rec_set_hci_handle(
+      p_dev_rec, BT_TRANSPORT_BR_EDR,
+      BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_BR_EDR));
 
   if ((!is_originator) && (security_required & BTM_SEC_MODE4_LEVEL4)) {
     bool local_supports_sc =
@@ -3871,7 +3873,7 @@ void btm_sec_connected(const RawAddress& bda, uint16_t handle,
                                       p_dev_rec->sec_rec.sec_flags));
   }
 
-  p_dev_rec->hci_handle = handle;
+  btm_sec_dev_rec_set_hci_handle(p_dev_rec, BT_TRANSPORT_BR_EDR, handle);
   btm_acl_created(bda, handle, assigned_role, BT_TRANSPORT_BR_EDR);
 
   /* role may not be correct here, it will be updated by l2cap, but we need to
@@ -4011,7 +4013,8 @@ void btm_sec_disconnected(uint16_t handle, tHCI_REASON reason,
   /* see sec_flags processing in btm_acl_removed */
 
   if (transport == BT_TRANSPORT_LE) {
-    p_dev_rec->ble_hci_handle = HCI_INVALID_HANDLE;
+    btm_sec_dev_rec_set_hci_handle(p_dev_rec, BT_TRANSPORT_LE,
+                                   HCI_INVALID_HANDLE);
     p_dev_rec->sec_rec.sec_flags &=
         ~(BTM_SEC_LE_AUTHENTICATED | BTM_SEC_LE_ENCRYPTED |
           BTM_SEC_ROLE_SWITCHED);
@@ -4023,7 +4026,8 @@ void btm_sec_disconnected(uint16_t handle, tHCI_REASON reason,
           ~(BTM_SEC_LE_LINK_KEY_AUTHED | BTM_SEC_LE_AUTHENTICATED);
     }
   } else {
-    p_dev_rec->hci_handle = HCI_INVALID_HANDLE;
+    btm_sec_dev_rec_set_hci_handle(p_dev_rec, BT_TRANSPORT_BR_EDR,
+                                   HCI_INVALID_HANDLE);
     p_dev_rec->sec_rec.sec_flags &=
         ~(BTM_SEC_AUTHENTICATED | BTM_SEC_ENCRYPTED | BTM_SEC_ROLE_SWITCHED |
           BTM_SEC_16_DIGIT_PIN_AUTHED);
@@ -53,7 +53,9 @@ void tBTM_SEC_CB::Init(uint8_t initial_security_mode) {
 
   security_mode = initial_security_mode;
   pairing_bda = RawAddress::kAny;
+  ClearDevRecIndex();
   sec_dev_rec = list_new([](void* ptr) {
+    btm_sec_cb.ClearDevRecIndex();
     // Invoke destructor for all record objects and reset to default
     // initialized value so memory may be properly freed
     *((tBTM_SEC_DEV_REC*)ptr) = {};
@@ -67,6 +69,7 @@ void tBTM_SEC_CB::Free() {
 
   list_free(sec_dev_rec);
   sec_dev_rec = nullptr;
+  ClearDevRecIndex();
 
   alarm_free(sec_collision_timer);
   sec_collision_timer = nullptr;
@@ -78,6 +81,12 @@ void tBTM_SEC_CB::Free() {
   execution_wait_timer = nullptr;
 }
 
+void tBTM_SEC_CB::ClearDevRecIndex() {
+  dev_rec_addr_index.clear();
+  dev_rec_handle_index.clear();
+  dev_rec_identity_index.clear();
+}
+
 tBTM_SEC_CB btm_sec_cb;
 
 void BTM_Sec_Init() {
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <cstdint>
+#include <unordered_map>
 
 #include "internal_include/bt_target.h"
 #include "osi/include/alarm.h"
@@ -68,6 +69,10 @@ class tBTM_SEC_CB {
   alarm_t* pairing_timer{nullptr};        /* Timer for pairing process    */
   alarm_t* execution_wait_timer{nullptr}; /* To avoid concurrent auth request */
   list_t* sec_dev_rec{nullptr}; /* list of tBTM_SEC_DEV_REC */
+  /* Results of the btm_find_dev* lookups, see btm_dev.cc */
+  std::unordered_map<RawAddress, tBTM_SEC_DEV_REC*> dev_rec_addr_index;
+  std::unordered_map<uint16_t, tBTM_SEC_DEV_REC*> dev_rec_handle_index;
+  std::unordered_map<RawAddress, tBTM_SEC_DEV_REC*> dev_rec_identity_index;
   tBTM_SEC_SERV_REC* p_out_serv{nullptr};
   tBTM_MKEY_CALLBACK* mkey_cback{nullptr};
 
@@ -83,6 +88,10 @@ class tBTM_SEC_CB {
   void Init(uint8_t initial_security_mode);
   void Free();
 
+  // Drops the device record lookup indexes. Called when a record is added or
+  // removed, and by the btm_sec_dev_rec_set_* functions of btm_dev.h.
+  void ClearDevRecIndex();
+
   tBTM_SEC_SERV_REC* find_first_serv_rec(bool is_originator, uint16_t psm);
 
   bool IsDeviceBonded(const RawAddress bd_addr);
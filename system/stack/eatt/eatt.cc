@@ -185,6 +185,14 @@ EattChannel* EattExtension::GetChannelAvailableForClientRequest(
   return pimpl_->eatt_impl_->get_channel_available_for_client_request(bd_addr);
 }
 
+uint8_t EattExtension::GetNumChannelsOpened(const RawAddress& bd_addr) {
+  return pimpl_->eatt_impl_->get_num_channels_opened(bd_addr);
+}
+
+uint16_t EattExtension::GetMinChannelMtu(const RawAddress& bd_addr) {
+  return pimpl_->eatt_impl_->get_min_channel_mtu(bd_addr);
+}
+
 /* Start stop GATT indication timer per CID */
 void EattExtension::StartIndicationConfirmationTimer(const RawAddress& bd_addr,
                                                      uint16_t cid) {
@@ -244,6 +244,25 @@ class EattExtension {
   virtual EattChannel* GetChannelAvailableForClientRequest(
       const RawAddress& bd_addr);
 
+  /**
+   * Get number of EATT channels opened to send GATT requests.
+   *
+   * @param bd_addr peer device address
+   *
+   * @return number of opened EATT channels.
+   */
+  virtual uint8_t GetNumChannelsOpened(const RawAddress& bd_addr);
+
+  /**
+   * Get the smallest ATT MTU of the EATT channels which can carry GATT
+   * requests, including the channels being reconfigured.
+   *
+   * @param bd_addr peer device address
+   *
+   * @return ATT MTU, or 0 if no channel is opened.
+   */
+  virtual uint16_t GetMinChannelMtu(const RawAddress& bd_addr);
+
   /**
    * Start GATT indication timer per CID.
    *
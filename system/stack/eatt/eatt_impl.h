@@ -679,6 +679,36 @@ struct eatt_impl {
                                                    : iter->second.get();
   }
 
+  uint8_t get_num_channels_opened(const RawAddress& bd_addr) {
+    eatt_device* eatt_dev = find_device_by_address(bd_addr);
+    if (!eatt_dev) return 0;
+
+    return count_if(
+        eatt_dev->eatt_channels.begin(), eatt_dev->eatt_channels.end(),
+        [](const std::pair<uint16_t, std::shared_ptr<EattChannel>>& el) {
+          return el.second->state_ == EattChannelState::EATT_CHANNEL_OPENED;
+        });
+  }
+
+  uint16_t get_min_channel_mtu(const RawAddress& bd_addr) {
+    eatt_device* eatt_dev = find_device_by_address(bd_addr);
+    if (!eatt_dev) return 0;
+
+    uint16_t min_mtu = 0;
+    for (const auto& el : eatt_dev->eatt_channels) {
+      EattChannel* channel = el.second.get();
+      /* The MTU of a channel never decreases on reconfiguration */
+      if (channel->state_ != EattChannelState::EATT_CHANNEL_OPENED &&
+          channel->state_ != EattChannelState::EATT_CHANNEL_RECONFIGURING)
+        continue;
+
+      /* ATT MTU for EATT is min from tx and rx mtu*/
+      uint16_t mtu = std::min<uint16_t>(channel->tx_mtu_, channel->rx_mtu_);
+      if (min_mtu == 0 || mtu < min_mtu) min_mtu = mtu;
+    }
+    return min_mtu;
+  }
+
   void free_gatt_resources(const RawAddress& bd_addr) {
     eatt_device* eatt_dev = find_device_by_address(bd_addr);
     if (!eatt_dev) return;
@@ -29,6 +29,7 @@
 #include <base/strings/string_number_conversions.h>
 #include <bluetooth/log.h>
 
+#include <algorithm>
 #include <string>
 
 #include "device/include/controller.h"
@@ -42,6 +43,7 @@
 #include "rust/src/connection/ffi/connection_shim.h"
 #include "stack/arbiter/acl_arbiter.h"
 #include "stack/btm/btm_dev.h"
+#include "stack/eatt/eatt.h"
 #include "stack/gatt/connection_manager.h"
 #include "stack/gatt/gatt_int.h"
 #include "stack/include/bt_hdr.h"
@@ -56,6 +58,7 @@ using namespace bluetooth::legacy::stack::sdp;
 using namespace bluetooth;
 
 using bluetooth::Uuid;
+using bluetooth::eatt::EattExtension;
 
 /**
  * Add an service handle range to the list in decending order of the start
@@ -924,6 +927,94 @@ tGATT_STATUS GATTC_Discover(uint16_t conn_id, tGATT_DISC_TYPE disc_type,
                         Uuid::kEmpty);
 }
 
+/*******************************************************************************
+ *
+ * Function         GATTC_IsEattBearerAvailable
+ *
+ * Description      This function is called to check whether a client request
+ *                  sent on the connection would be carried by an idle EATT
+ *                  bearer, and thus be executed concurrently with the
+ *                  requests already outstanding on the connection.
+ *
+ * Parameters       conn_id: connection identifier.
+ *
+ * Returns          true if an EATT bearer is available for a client request.
+ *
+ ******************************************************************************/
+bool GATTC_IsEattBearerAvailable(uint16_t conn_id) {
+  tGATT_IF gatt_if = GATT_GET_GATT_IF(conn_id);
+  uint8_t tcb_idx = GATT_GET_TCB_IDX(conn_id);
+  tGATT_TCB* p_tcb = gatt_get_tcb_by_idx(tcb_idx);
+  tGATT_REG* p_reg = gatt_get_regcb(gatt_if);
+
+  if ((p_tcb == NULL) || (p_reg == NULL)) return false;
+  if (!p_reg->eatt_support || !p_tcb->eatt) return false;
+
+  return gatt_tcb_get_att_cid(*p_tcb, p_reg->eatt_support) !=
+         p_tcb->att_lcid;
+}
+
+/*******************************************************************************
+ *
+ * Function         GATTC_GetNumEattBearers
+ *
+ * Description      This function is called to get the number of EATT bearers
+ *                  opened on the connection, busy or not, which can carry
+ *                  client requests concurrently.
+ *
+ * Parameters       conn_id: connection identifier.
+ *
+ * Returns          number of EATT bearers, 0 if the connection does not use
+ *                  EATT.
+ *
+ ******************************************************************************/
+uint8_t GATTC_GetNumEattBearers(uint16_t conn_id) {
+  tGATT_IF gatt_if = GATT_GET_GATT_IF(conn_id);
+  uint8_t tcb_idx = GATT_GET_TCB_IDX(conn_id);
+  tGATT_TCB* p_tcb = gatt_get_tcb_by_idx(tcb_idx);
+  tGATT_REG* p_reg = gatt_get_regcb(gatt_if);
+
+  if ((p_tcb == NULL) || (p_reg == NULL)) return 0;
+  if (!p_reg->eatt_support || !p_tcb->eatt) return 0;
+
+  return EattExtension::GetInstance()->GetNumChannelsOpened(p_tcb->peer_bda);
+}
+
+/*******************************************************************************
+ *
+ * Function         GATTC_GetReadMultiVariableMtu
+ *
+ * Description      This function is called to get the ATT MTU available for
+ *                  the Read Multiple Variable Length requests sent on the
+ *                  connection. Servers supporting EATT support this request.
+ *                  The request is sent on the unenhanced bearer or on any
+ *                  EATT channel free when it is sent, so the smallest MTU of
+ *                  these bearers is returned.
+ *
+ * Parameters       conn_id: connection identifier.
+ *
+ * Returns          The ATT MTU, or 0 if the server does not support Read
+ *                  Multiple Variable Length requests.
+ *
+ ******************************************************************************/
+uint16_t GATTC_GetReadMultiVariableMtu(uint16_t conn_id) {
+  tGATT_IF gatt_if = GATT_GET_GATT_IF(conn_id);
+  uint8_t tcb_idx = GATT_GET_TCB_IDX(conn_id);
+  tGATT_TCB* p_tcb = gatt_get_tcb_by_idx(tcb_idx);
+  tGATT_REG* p_reg = gatt_get_regcb(gatt_if);
+
+  if ((p_tcb == NULL) || (p_reg == NULL)) return 0;
+  if (!gatt_profile_get_eatt_support(p_tcb->peer_bda)) return 0;
+
+  uint16_t mtu = p_tcb->payload_size;
+  if (p_reg->eatt_support && p_tcb->eatt) {
+    uint16_t eatt_mtu =
+        EattExtension::GetInstance()->GetMinChannelMtu(p_tcb->peer_bda);
+    if (eatt_mtu != 0) mtu = std::min(mtu, eatt_mtu);
+  }
+  return mtu;
+}
+
 /*******************************************************************************
  *
  * Function         GATTC_Read
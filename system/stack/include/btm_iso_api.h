@@ -172,6 +172,25 @@ class IsoManager {
   virtual void SendIsoData(uint16_t conn_handle, const uint8_t* data,
                            uint16_t data_len);
 
+  /**
+   * Allocates an iso data packet for the next SDU, so that the caller can
+   * write the payload in place instead of having it copied by SendIsoData.
+   * The packet is accounted for as sent: it must be passed to SendIsoSdu.
+   *
+   * @param conn_handle handle of BIS or CIS connection
+   * @param data_len SDU length
+   * @return packet with offset pointing at the data_len bytes long payload,
+   * or nullptr if the SDU can not be sent and should be dropped.
+   */
+  virtual BT_HDR* AllocateIsoSdu(uint16_t conn_handle, uint16_t data_len);
+
+  /**
+   * Sends an iso data packet allocated with AllocateIsoSdu to the controller
+   *
+   * @param sdu packet with the payload written. The ownership is transferred.
+   */
+  virtual void SendIsoSdu(BT_HDR* sdu);
+
   /**
    * Creates the Broadcast Isochronous Group
    *
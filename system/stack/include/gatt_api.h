@@ -1034,6 +1034,52 @@ tGATT_STATUS GATTC_Discover(uint16_t conn_id, tGATT_DISC_TYPE disc_type,
 tGATT_STATUS GATTC_Discover(uint16_t conn_id, tGATT_DISC_TYPE disc_type,
                             uint16_t start_handle, uint16_t end_handle);
 
+/*******************************************************************************
+ *
+ * Function         GATTC_IsEattBearerAvailable
+ *
+ * Description      This function is called to check whether a client request
+ *                  sent on the connection would be carried by an idle EATT
+ *                  bearer.
+ *
+ * Parameters       conn_id: connection identifier.
+ *
+ * Returns          true if an EATT bearer is available for a client request.
+ *
+ ******************************************************************************/
+bool GATTC_IsEattBearerAvailable(uint16_t conn_id);
+
+/*******************************************************************************
+ *
+ * Function         GATTC_GetNumEattBearers
+ *
+ * Description      This function is called to get the number of EATT bearers
+ *                  opened on the connection, busy or not.
+ *
+ * Parameters       conn_id: connection identifier.
+ *
+ * Returns          number of EATT bearers, 0 if the connection does not use
+ *                  EATT.
+ *
+ ******************************************************************************/
+uint8_t GATTC_GetNumEattBearers(uint16_t conn_id);
+
+/*******************************************************************************
+ *
+ * Function         GATTC_GetReadMultiVariableMtu
+ *
+ * Description      This function is called to get the ATT MTU available for
+ *                  the Read Multiple Variable Length requests sent on the
+ *                  connection.
+ *
+ * Parameters       conn_id: connection identifier.
+ *
+ * Returns          The ATT MTU, or 0 if the server does not support Read
+ *                  Multiple Variable Length requests.
+ *
+ ******************************************************************************/
+uint16_t GATTC_GetReadMultiVariableMtu(uint16_t conn_id);
+
 /*******************************************************************************
  *
  * Function         GATTC_Read
@@ -28,7 +28,12 @@
 #include <bluetooth/log.h>
 #include <string.h>
 
+#include <algorithm>
 #include <cstdint>
+#include <functional>
+#include <set>
+#include <unordered_map>
+#include <vector>
 
 #include "internal_include/bt_target.h"
 #include "os/log.h"
@@ -38,19 +43,88 @@
 #include "stack/include/sdpdefs.h"
 #include "stack/sdp/sdp_discovery_db.h"
 #include "stack/sdp/sdpint.h"
+#include "types/bluetooth/uuid.h"
 
 using namespace bluetooth;
 
+/* Inverted index of the server database: records containing each UUID,
+ * by handle. Handles are allocated in increasing order and records are never
+ * reordered, so the sorted handles follow the order of the records.
+ * For each record, the number of attributes containing a UUID is counted
+ * so that the record is unindexed only when the last of them is deleted. */
+static std::unordered_map<Uuid, std::set<uint32_t>> sdp_db_uuid_index;
+static std::unordered_map<uint32_t, std::unordered_map<Uuid, uint16_t>>
+    sdp_db_record_uuids;
+
 /******************************************************************************/
 /*            L O C A L    F U N C T I O N     P R O T O T Y P E S            */
 /******************************************************************************/
 static bool find_uuid_in_seq(uint8_t* p, uint32_t seq_len,
                              const uint8_t* p_his_uuid, uint16_t his_len,
                              int nest_level);
+static bool uuid_from_array(const uint8_t* p_uuid, uint32_t len, Uuid* p_out);
+static bool sdp_db_is_server_record(const tSDP_RECORD* p_rec);
+static void sdp_db_index_attr(const tSDP_RECORD* p_rec,
+                              const tSDP_ATTRIBUTE* p_attr);
+static void sdp_db_unindex_attr(const tSDP_RECORD* p_rec,
+                                const tSDP_ATTRIBUTE* p_attr);
+static void sdp_db_unindex_record(uint32_t handle);
 
 bool SDP_AddAttribute(uint32_t handle, uint16_t attr_id, uint8_t attr_type,
                       uint32_t attr_len, uint8_t* p_val);
 
+/*******************************************************************************
+ *
+ * Function         sdp_db_init
+ *
+ * Description      This function clears the indexes of the server database.
+ *                  It is called when the SDP unit is initialized.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void sdp_db_init(void) {
+  sdp_db_uuid_index.clear();
+  sdp_db_record_uuids.clear();
+}
+
+/*******************************************************************************
+ *
+ * Function         record_has_uuids
+ *
+ * Description      This function checks that a record contains all the UUIDs
+ *                  of a sequence.
+ *
+ * Returns          true if all the UUIDs were found, else false
+ *
+ ******************************************************************************/
+static bool record_has_uuids(const tSDP_RECORD* p_rec,
+                             const tSDP_UUID_SEQ* p_seq) {
+  uint16_t xx, yy;
+  const tSDP_ATTRIBUTE* p_attr;
+
+  for (yy = 0; yy < p_seq->num_uids; yy++) {
+    p_attr = &p_rec->attribute[0];
+    for (xx = 0; xx < p_rec->num_attributes; xx++, p_attr++) {
+      if (p_attr->type == UUID_DESC_TYPE) {
+        if (sdpu_compare_uuid_arrays(p_attr->value_ptr, p_attr->len,
+                                     &p_seq->uuid_entry[yy].value[0],
+                                     p_seq->uuid_entry[yy].len))
+          break;
+      } else if (p_attr->type == DATA_ELE_SEQ_DESC_TYPE) {
+        if (find_uuid_in_seq(p_attr->value_ptr, p_attr->len,
+                             &p_seq->uuid_entry[yy].value[0],
+                             p_seq->uuid_entry[yy].len, 0))
+          break;
+      }
+    }
+    /* If any UUID was not found, the record does not match */
+    if (xx == p_rec->num_attributes) return (false);
+  }
+
+  return (true);
+}
+
 /*******************************************************************************
  *
  * Function         sdp_db_service_search
@@ -64,41 +138,45 @@ bool SDP_AddAttribute(uint32_t handle, uint16_t attr_id, uint8_t attr_type,
  ******************************************************************************/
 const tSDP_RECORD* sdp_db_service_search(const tSDP_RECORD* p_rec,
                                          const tSDP_UUID_SEQ* p_seq) {
-  uint16_t xx, yy;
-  const tSDP_ATTRIBUTE* p_attr;
-  tSDP_RECORD* p_end = &sdp_cb.server_db.record[sdp_cb.server_db.num_records];
+  const tSDP_RECORD* p_end =
+      &sdp_cb.server_db.record[sdp_cb.server_db.num_records];
+  const std::set<uint32_t>* p_handles = NULL;
+  Uuid uuid;
 
-  /* If NULL, start at the beginning, else start at the first specified record
+  /* If NULL, start at the beginning, else start after the specified record
    */
-  if (!p_rec)
-    p_rec = &sdp_cb.server_db.record[0];
-  else
-    p_rec++;
-
-  /* Look through the records. The spec says that a match occurs if */
-  /* the record contains all the passed UUIDs in it.                */
-  for (; p_rec < p_end; p_rec++) {
-    for (yy = 0; yy < p_seq->num_uids; yy++) {
-      p_attr = &p_rec->attribute[0];
-      for (xx = 0; xx < p_rec->num_attributes; xx++, p_attr++) {
-        if (p_attr->type == UUID_DESC_TYPE) {
-          if (sdpu_compare_uuid_arrays(p_attr->value_ptr, p_attr->len,
-                                       &p_seq->uuid_entry[yy].value[0],
-                                       p_seq->uuid_entry[yy].len))
-            break;
-        } else if (p_attr->type == DATA_ELE_SEQ_DESC_TYPE) {
-          if (find_uuid_in_seq(p_attr->value_ptr, p_attr->len,
-                               &p_seq->uuid_entry[yy].value[0],
-                               p_seq->uuid_entry[yy].len, 0))
-            break;
-        }
-      }
-      /* If any UUID was not found,  on to the next record */
-      if (xx == p_rec->num_attributes) break;
-    }
+  if (p_rec && p_rec + 1 >= p_end) return (NULL);
+
+  /* The spec says that a match occurs if the record contains all the passed
+   * UUIDs in it: only the records containing the least indexed of the UUIDs
+   * need to be looked at. */
+  for (uint16_t yy = 0; yy < p_seq->num_uids; yy++) {
+    if (!uuid_from_array(&p_seq->uuid_entry[yy].value[0],
+                         p_seq->uuid_entry[yy].len, &uuid))
+      return (NULL);
+
+    auto it = sdp_db_uuid_index.find(uuid);
+    if (it == sdp_db_uuid_index.end()) return (NULL);
+    if (!p_handles || it->second.size() < p_handles->size())
+      p_handles = &it->second;
+  }
+
+  /* An empty sequence matches every record */
+  if (!p_handles) {
+    if (!p_rec)
+      p_rec = &sdp_cb.server_db.record[0];
+    else
+      p_rec++;
+    return (p_rec < p_end) ? p_rec : NULL;
+  }
+
+  auto it = p_rec ? p_handles->upper_bound(p_rec->record_handle)
+                  : p_handles->begin();
+  for (; it != p_handles->end(); it++) {
+    const tSDP_RECORD* p_found = sdp_db_find_record(*it);
 
     /* If every UUID was found in the record, return the record */
-    if (yy == p_seq->num_uids) return (p_rec);
+    if (p_found && record_has_uuids(p_found, p_seq)) return (p_found);
   }
 
   /* If here, no more records found */
@@ -145,6 +223,184 @@ static bool find_uuid_in_seq(uint8_t* p, uint32_t seq_len,
   return (false);
 }
 
+/*******************************************************************************
+ *
+ * Function         uuid_from_array
+ *
+ * Description      This function converts a BE UUID of 2, 4 or 16 bytes.
+ *
+ * Returns          true if converted, else false
+ *
+ ******************************************************************************/
+static bool uuid_from_array(const uint8_t* p_uuid, uint32_t len, Uuid* p_out) {
+  switch (len) {
+    case Uuid::kNumBytes16:
+      *p_out = Uuid::From16Bit((p_uuid[0] << 8) | p_uuid[1]);
+      return (true);
+    case Uuid::kNumBytes32:
+      *p_out = Uuid::From32Bit(((uint32_t)p_uuid[0] << 24) |
+                               ((uint32_t)p_uuid[1] << 16) |
+                               ((uint32_t)p_uuid[2] << 8) | p_uuid[3]);
+      return (true);
+    case Uuid::kNumBytes128:
+      *p_out = Uuid::From128BitBE(p_uuid);
+      return (true);
+    default:
+      return (false);
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         collect_uuids_in_seq
+ *
+ * Description      This function collects the UUIDs of a data element
+ *                  sequence, as they are matched by find_uuid_in_seq.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void collect_uuids_in_seq(uint8_t* p, uint32_t seq_len,
+                                 int nest_level, std::vector<Uuid>* p_uuids) {
+  uint8_t* p_end = p + seq_len;
+  uint8_t type;
+  uint32_t len;
+  Uuid uuid;
+
+  if (nest_level > 3) return;
+
+  while (p < p_end) {
+    type = *p++;
+    p = sdpu_get_len_from_type(p, p_end, type, &len);
+    if (p == NULL || (p + len) > p_end) break;
+    type = type >> 3;
+    if (type == UUID_DESC_TYPE) {
+      if (uuid_from_array(p, len, &uuid)) p_uuids->push_back(uuid);
+    } else if (type == DATA_ELE_SEQ_DESC_TYPE) {
+      collect_uuids_in_seq(p, len, nest_level + 1, p_uuids);
+    }
+    p = p + len;
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         attr_uuids
+ *
+ * Description      This function returns the UUIDs contained in an attribute,
+ *                  as they are matched by sdp_db_service_search.
+ *
+ * Returns          the UUIDs, possibly repeated
+ *
+ ******************************************************************************/
+static std::vector<Uuid> attr_uuids(const tSDP_ATTRIBUTE* p_attr) {
+  std::vector<Uuid> uuids;
+  Uuid uuid;
+
+  if (p_attr->len == 0) return uuids;
+
+  if (p_attr->type == UUID_DESC_TYPE) {
+    if (uuid_from_array(p_attr->value_ptr, p_attr->len, &uuid))
+      uuids.push_back(uuid);
+  } else if (p_attr->type == DATA_ELE_SEQ_DESC_TYPE) {
+    collect_uuids_in_seq(p_attr->value_ptr, p_attr->len, 0, &uuids);
+  }
+  return uuids;
+}
+
+/*******************************************************************************
+ *
+ * Function         sdp_db_is_server_record
+ *
+ * Description      This function checks whether a record is one of the server
+ *                  database. Records built elsewhere, such as the static PBAP
+ *                  record of the server, are not indexed.
+ *
+ * Returns          true if the record is in the server database
+ *
+ ******************************************************************************/
+static bool sdp_db_is_server_record(const tSDP_RECORD* p_rec) {
+  std::less<const tSDP_RECORD*> before;
+  return !before(p_rec, &sdp_cb.server_db.record[0]) &&
+         before(p_rec, &sdp_cb.server_db.record[sdp_cb.server_db.num_records]);
+}
+
+/*******************************************************************************
+ *
+ * Function         sdp_db_index_attr
+ *
+ * Description      This function adds the UUIDs of an attribute newly added
+ *                  to a record to the UUID index.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void sdp_db_index_attr(const tSDP_RECORD* p_rec,
+                              const tSDP_ATTRIBUTE* p_attr) {
+  if (!sdp_db_is_server_record(p_rec)) return;
+
+  std::vector<Uuid> uuids = attr_uuids(p_attr);
+  if (uuids.empty()) return;
+
+  auto& counts = sdp_db_record_uuids[p_rec->record_handle];
+  for (const Uuid& uuid : uuids) {
+    if (counts[uuid]++ == 0)
+      sdp_db_uuid_index[uuid].insert(p_rec->record_handle);
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         sdp_db_unindex_attr
+ *
+ * Description      This function removes the UUIDs of an attribute about to
+ *                  be deleted from a record from the UUID index.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void sdp_db_unindex_attr(const tSDP_RECORD* p_rec,
+                                const tSDP_ATTRIBUTE* p_attr) {
+  if (!sdp_db_is_server_record(p_rec)) return;
+
+  auto record = sdp_db_record_uuids.find(p_rec->record_handle);
+  if (record == sdp_db_record_uuids.end()) return;
+
+  for (const Uuid& uuid : attr_uuids(p_attr)) {
+    auto count = record->second.find(uuid);
+    if (count == record->second.end() || --count->second > 0) continue;
+
+    record->second.erase(count);
+    auto handles = sdp_db_uuid_index.find(uuid);
+    if (handles == sdp_db_uuid_index.end()) continue;
+    handles->second.erase(p_rec->record_handle);
+    if (handles->second.empty()) sdp_db_uuid_index.erase(handles);
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         sdp_db_unindex_record
+ *
+ * Description      This function removes a deleted record from the UUID
+ *                  index.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void sdp_db_unindex_record(uint32_t handle) {
+  auto record = sdp_db_record_uuids.find(handle);
+  if (record == sdp_db_record_uuids.end()) return;
+
+  for (const auto& entry : record->second) {
+    auto handles = sdp_db_uuid_index.find(entry.first);
+    if (handles == sdp_db_uuid_index.end()) continue;
+    handles->second.erase(handle);
+    if (handles->second.empty()) sdp_db_uuid_index.erase(handles);
+  }
+  sdp_db_record_uuids.erase(record);
+}
+
 /*******************************************************************************
  *
  * Function         sdp_db_find_record
@@ -159,10 +415,12 @@ tSDP_RECORD* sdp_db_find_record(uint32_t handle) {
   tSDP_RECORD* p_rec;
   tSDP_RECORD* p_end = &sdp_cb.server_db.record[sdp_cb.server_db.num_records];
 
-  /* Look through the records for the caller's handle */
-  for (p_rec = &sdp_cb.server_db.record[0]; p_rec < p_end; p_rec++) {
-    if (p_rec->record_handle == handle) return (p_rec);
-  }
+  /* Records are sorted by handle, see SDP_CreateRecord */
+  p_rec = std::lower_bound(&sdp_cb.server_db.record[0], p_end, handle,
+                           [](const tSDP_RECORD& rec, uint32_t value) {
+                             return rec.record_handle < value;
+                           });
+  if (p_rec < p_end && p_rec->record_handle == handle) return (p_rec);
 
   /* Record with that handle not found. */
   return (NULL);
@@ -183,14 +441,15 @@ tSDP_RECORD* sdp_db_find_record(uint32_t handle) {
 const tSDP_ATTRIBUTE* sdp_db_find_attr_in_rec(const tSDP_RECORD* p_rec,
                                               uint16_t start_attr,
                                               uint16_t end_attr) {
+  const tSDP_ATTRIBUTE* p_end = &p_rec->attribute[p_rec->num_attributes];
   const tSDP_ATTRIBUTE* p_at;
-  uint16_t xx;
 
-  /* Note that the attributes in a record are assumed to be in sorted order */
-  for (xx = 0, p_at = &p_rec->attribute[0]; xx < p_rec->num_attributes;
-       xx++, p_at++) {
-    if ((p_at->id >= start_attr) && (p_at->id <= end_attr)) return (p_at);
-  }
+  /* Note that the attributes in a record are kept in sorted order */
+  p_at = std::lower_bound(&p_rec->attribute[0], p_end, start_attr,
+                          [](const tSDP_ATTRIBUTE& attr, uint16_t id) {
+                            return attr.id < id;
+                          });
+  if ((p_at < p_end) && (p_at->id <= end_attr)) return (p_at);
 
   /* No matching attribute found */
   return (NULL);
@@ -315,11 +574,15 @@ bool SDP_DeleteRecord(uint32_t handle) {
     /* require new DI record to be created in SDP_SetLocalDiRecord */
     sdp_cb.server_db.di_primary_handle = 0;
 
+    sdp_db_init();
+
     return (true);
   } else {
     /* Find the record in the database */
     for (xx = 0; xx < sdp_cb.server_db.num_records; xx++, p_rec++) {
       if (p_rec->record_handle == handle) {
+        sdp_db_unindex_record(handle);
+
         /* Found it. Shift everything up one */
         for (yy = xx; yy < sdp_cb.server_db.num_records - 1; yy++, p_rec++) {
           *p_rec = *(p_rec + 1);
@@ -471,19 +734,8 @@ bool SDP_AddAttributeToRecord(tSDP_RECORD* p_rec, uint16_t attr_id,
 
   if (p_rec->num_attributes >= SDP_MAX_REC_ATTR) return (false);
 
-  /* If not found, see if we can allocate a new entry */
-  if (xx == p_rec->num_attributes)
-    p_attr = &p_rec->attribute[p_rec->num_attributes];
-  else {
-    /* Since the attributes are kept in sorted order, insert ours here */
-    for (yy = p_rec->num_attributes; yy > xx; yy--)
-      p_rec->attribute[yy] = p_rec->attribute[yy - 1];
-  }
-
-  p_attr->id = attr_id;
-  p_attr->type = attr_type;
-  p_attr->len = attr_len;
-
+  /* Check the length before inserting, so that the attributes are left in
+   * sorted order on failure */
   if (p_rec->free_pad_ptr + attr_len >= SDP_MAX_PAD_LEN) {
     if (p_rec->free_pad_ptr >= SDP_MAX_PAD_LEN) {
       log::error(
@@ -501,25 +753,37 @@ bool SDP_AddAttributeToRecord(tSDP_RECORD* p_rec, uint16_t attr_id,
 
       attr_len = SDP_MAX_PAD_LEN - p_rec->free_pad_ptr;
       p_val[SDP_MAX_PAD_LEN - p_rec->free_pad_ptr - 1] = '\0';
-    } else
-      attr_len = 0;
+    } else {
+      /* if truncate to 0 length, simply don't add */
+      log::error(
+          "SDP_AddAttributeToRecord fail, length exceed maximum: ID {}: "
+          "attr_len:{}",
+          attr_id, attr_len);
+      return (false);
+    }
   }
 
+  /* If not found, see if we can allocate a new entry */
+  if (xx == p_rec->num_attributes)
+    p_attr = &p_rec->attribute[p_rec->num_attributes];
+  else {
+    /* Since the attributes are kept in sorted order, insert ours here */
+    for (yy = p_rec->num_attributes; yy > xx; yy--)
+      p_rec->attribute[yy] = p_rec->attribute[yy - 1];
+  }
+
+  p_attr->id = attr_id;
+  p_attr->type = attr_type;
+  p_attr->len = attr_len;
+
   if (attr_len > 0) {
-    p_attr->len = attr_len;
     memcpy(&p_rec->attr_pad[p_rec->free_pad_ptr], p_val, (size_t)attr_len);
     p_attr->value_ptr = &p_rec->attr_pad[p_rec->free_pad_ptr];
     p_rec->free_pad_ptr += attr_len;
-  } else if (attr_len == 0 && p_attr->len != 0) {
-    /* if truncate to 0 length, simply don't add */
-    log::error(
-        "SDP_AddAttributeToRecord fail, length exceed maximum: ID {}: "
-        "attr_len:{}",
-        attr_id, attr_len);
-    p_attr->id = p_attr->type = p_attr->len = 0;
-    return (false);
   }
   p_rec->num_attributes++;
+
+  sdp_db_index_attr(p_rec, p_attr);
   return (true);
 }
 
@@ -878,6 +1142,8 @@ bool SDP_DeleteAttributeFromRecord(tSDP_RECORD* p_rec, uint16_t attr_id) {
   for (uint16_t attribute_index = 0; attribute_index < p_rec->num_attributes;
        attribute_index++, p_attr++) {
     if (p_attr->id == attr_id) {
+      sdp_db_unindex_attr(p_rec, p_attr);
+
       pad_ptr = p_attr->value_ptr;
       len = p_attr->len;
 
@@ -74,6 +74,7 @@ static void sdp_on_l2cap_error(uint16_t l2cap_cid, uint16_t result);
 void sdp_init(void) {
   /* Clears all structures and local SDP database (if Server is enabled) */
   memset(&sdp_cb, 0, sizeof(tSDP_CB));
+  sdp_db_init();
 
   for (int i = 0; i < SDP_MAX_CONNECTIONS; i++) {
     sdp_cb.ccb[i].sdp_conn_timer = alarm_new("sdp.sdp_conn_timer");
@@ -0,0 +1,133 @@
+/*
+ *  Copyright 2024 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "osi/include/allocator.h"
+#include "stack/btm/btm_dev.h"
+#include "stack/btm/btm_sec_cb.h"
+#include "stack/include/btm_ble_addr.h"
+#include "stack/include/hcidefs.h"
+
+using ::benchmark::State;
+
+namespace {
+
+RawAddress public_address(size_t index) {
+  return RawAddress({0x00, 0x1b, 0xdc, (uint8_t)(index >> 16),
+                     (uint8_t)(index >> 8), (uint8_t)index});
+}
+
+RawAddress identity_address(size_t index) {
+  return RawAddress({0xc0, 0x1b, 0xdc, (uint8_t)(index >> 16),
+                     (uint8_t)(index >> 8), (uint8_t)index});
+}
+
+// Fills the device record list with |num_records| LE records with an IRK.
+// The records are appended directly, btm_sec_allocate_dev_rec caps their
+// number.
+void add_records(size_t num_records) {
+  btm_sec_cb.Init(BTM_SEC_MODE_SC);
+  for (size_t index = 0; index < num_records; index++) {
+    tBTM_SEC_DEV_REC* p_dev_rec =
+        static_cast<tBTM_SEC_DEV_REC*>(osi_calloc(sizeof(tBTM_SEC_DEV_REC)));
+    list_append(btm_sec_cb.sec_dev_rec, p_dev_rec);
+    p_dev_rec->device_type = BT_DEVICE_TYPE_DUMO;
+    btm_sec_dev_rec_set_bd_addr(p_dev_rec, public_address(index));
+    btm_sec_dev_rec_set_pseudo_addr(p_dev_rec, public_address(index));
+    btm_sec_dev_rec_set_hci_handle(p_dev_rec, BT_TRANSPORT_BR_EDR, index);
+    btm_sec_dev_rec_set_hci_handle(p_dev_rec, BT_TRANSPORT_LE,
+                                   HCI_INVALID_HANDLE);
+    btm_sec_dev_rec_set_identity_addr(p_dev_rec,
+                                      {
+                                          .type = BLE_ADDR_RANDOM_ID,
+                                          .bda = identity_address(index),
+                                      });
+    Octet16 irk{};
+    irk[0] = index;
+    irk[1] = index >> 8;
+    btm_sec_dev_rec_set_irk(p_dev_rec, irk);
+  }
+}
+
+// Replays the lookups of an HCI event flow: mostly by connection handle and
+// by address, with some identity addresses and unknown devices.
+void BM_MixedLookups(State& state) {
+  size_t num_records = state.range(0);
+  add_records(num_records);
+
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<size_t> record(0, num_records - 1);
+  std::uniform_int_distribution<int> kind(0, 9);
+  for (auto _ : state) {
+    size_t index = record(gen);
+    switch (kind(gen)) {
+      case 0:
+      case 1:
+      case 2:
+      case 3:
+        benchmark::DoNotOptimize(btm_find_dev_by_handle(index));
+        break;
+      case 4:
+      case 5:
+      case 6:
+        benchmark::DoNotOptimize(btm_find_dev(public_address(index)));
+        break;
+      case 7:
+      case 8: {
+        RawAddress bd_addr = identity_address(index);
+        tBLE_ADDR_TYPE addr_type = BLE_ADDR_RANDOM_ID;
+        benchmark::DoNotOptimize(
+            btm_identity_addr_to_random_pseudo(&bd_addr, &addr_type, false));
+      } break;
+      default:
+        benchmark::DoNotOptimize(
+            btm_find_dev(public_address(num_records + index)));
+        break;
+    }
+  }
+
+  btm_sec_cb.Free();
+}
+
+// Replays the lookups of advertising reports from 16 devices using
+// resolvable private addresses that none of the records resolves.
+void BM_UnresolvedRpaLookups(State& state) {
+  size_t num_records = state.range(0);
+  add_records(num_records);
+
+  std::vector<RawAddress> rpas;
+  for (uint8_t index = 0; index < 16; index++) {
+    rpas.push_back(RawAddress({0x4a, 0x2b, index, 0x3c, 0x4d, index}));
+  }
+  size_t index = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(btm_find_dev(rpas[index++ % rpas.size()]));
+  }
+
+  btm_sec_cb.Free();
+}
+
+}  // namespace
+
+BENCHMARK(BM_MixedLookups)->Arg(50)->Arg(500)->Arg(2000);
+BENCHMARK(BM_UnresolvedRpaLookups)->Arg(50)->Arg(500)->Arg(2000);
+
+BENCHMARK_MAIN();
@@ -18,11 +18,34 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "crypto_toolbox/crypto_toolbox.h"
 #include "stack/btm/btm_dev.h"
 #include "stack/btm/btm_sec_cb.h"
 #include "test/common/mock_functions.h"
 #include "test/mock/mock_main_shim_entry.h"
 
+namespace {
+
+// Builds the resolvable private address of |prand| for |irk|.
+RawAddress make_rpa(const Octet16& irk, uint32_t prand) {
+  RawAddress rpa;
+  rpa.address[0] = ((prand >> 16) & 0x3f) | 0x40;
+  rpa.address[1] = prand >> 8;
+  rpa.address[2] = prand;
+
+  Octet16 rand{};
+  rand[0] = rpa.address[2];
+  rand[1] = rpa.address[1];
+  rand[2] = rpa.address[0];
+  Octet16 hash = crypto_toolbox::aes_128(irk, rand);
+  rpa.address[3] = hash[2];
+  rpa.address[4] = hash[1];
+  rpa.address[5] = hash[0];
+  return rpa;
+}
+
+}  // namespace
+
 class StackBtmTest : public testing::Test {
  public:
  protected:
@@ -48,3 +71,111 @@ TEST_F(StackBtmDevTest, btm_sec_allocate_dev_rec__with_list) {
   ASSERT_NE(nullptr, btm_sec_allocate_dev_rec());
   ::btm_sec_cb.Free();
 }
+
+TEST_F(StackBtmDevTest, btm_find_dev__records_updated_in_place) {
+  const RawAddress bd_addr1({0x01, 0x02, 0x03, 0x04, 0x05, 0x06});
+  const RawAddress bd_addr2({0x11, 0x12, 0x13, 0x14, 0x15, 0x16});
+  const RawAddress bd_addr3({0x21, 0x22, 0x23, 0x24, 0x25, 0x26});
+
+  ::btm_sec_cb.Init(BTM_SEC_MODE_SC);
+  tBTM_SEC_DEV_REC* p_dev_rec1 = btm_sec_allocate_dev_rec();
+  btm_sec_dev_rec_set_bd_addr(p_dev_rec1, bd_addr1);
+  btm_sec_dev_rec_set_hci_handle(p_dev_rec1, BT_TRANSPORT_BR_EDR, 0x0010);
+  tBTM_SEC_DEV_REC* p_dev_rec2 = btm_sec_allocate_dev_rec();
+  btm_sec_dev_rec_set_bd_addr(p_dev_rec2, bd_addr2);
+  btm_sec_dev_rec_set_hci_handle(p_dev_rec2, BT_TRANSPORT_BR_EDR, 0x0020);
+
+  ASSERT_EQ(p_dev_rec1, btm_find_dev(bd_addr1));
+  ASSERT_EQ(p_dev_rec2, btm_find_dev(bd_addr2));
+  ASSERT_EQ(p_dev_rec2, btm_find_dev_by_handle(0x0020));
+  ASSERT_EQ(nullptr, btm_find_dev(bd_addr3));
+
+  // The indexed records no longer match.
+  btm_sec_dev_rec_set_bd_addr(p_dev_rec1, bd_addr3);
+  btm_sec_dev_rec_set_hci_handle(p_dev_rec2, BT_TRANSPORT_BR_EDR, 0x0030);
+  ASSERT_EQ(nullptr, btm_find_dev(bd_addr1));
+  ASSERT_EQ(p_dev_rec1, btm_find_dev(bd_addr3));
+  ASSERT_EQ(nullptr, btm_find_dev_by_handle(0x0020));
+  ASSERT_EQ(p_dev_rec2, btm_find_dev_by_handle(0x0030));
+
+  // Removed records are dropped from the indexes.
+  list_remove(::btm_sec_cb.sec_dev_rec, p_dev_rec1);
+  ASSERT_EQ(nullptr, btm_find_dev(bd_addr3));
+  ASSERT_EQ(p_dev_rec2, btm_find_dev(bd_addr2));
+
+  ::btm_sec_cb.Free();
+}
+
+TEST_F(StackBtmDevTest, btm_find_dev__first_record_matches) {
+  const RawAddress bd_addr({0x01, 0x02, 0x03, 0x04, 0x05, 0x06});
+
+  ::btm_sec_cb.Init(BTM_SEC_MODE_SC);
+  tBTM_SEC_DEV_REC* p_dev_rec1 = btm_sec_allocate_dev_rec();
+  tBTM_SEC_DEV_REC* p_dev_rec2 = btm_sec_allocate_dev_rec();
+  btm_sec_dev_rec_set_bd_addr(p_dev_rec2, bd_addr);
+  ASSERT_EQ(p_dev_rec2, btm_find_dev(bd_addr));
+
+  // An earlier record now matches as well, e.g. after a LE connection.
+  btm_sec_dev_rec_set_pseudo_addr(p_dev_rec1, bd_addr);
+  ASSERT_EQ(p_dev_rec1, btm_find_dev(bd_addr));
+
+  ::btm_sec_cb.Free();
+}
+
+TEST_F(StackBtmDevTest, btm_find_dev_by_handle__transports) {
+  ::btm_sec_cb.Init(BTM_SEC_MODE_SC);
+  tBTM_SEC_DEV_REC* p_dev_rec1 = btm_sec_allocate_dev_rec();
+  btm_sec_dev_rec_set_hci_handle(p_dev_rec1, BT_TRANSPORT_BR_EDR, 0x0010);
+  btm_sec_dev_rec_set_hci_handle(p_dev_rec1, BT_TRANSPORT_LE, 0x0011);
+  tBTM_SEC_DEV_REC* p_dev_rec2 = btm_sec_allocate_dev_rec();
+  btm_sec_dev_rec_set_hci_handle(p_dev_rec2, BT_TRANSPORT_LE, 0x0020);
+
+  ASSERT_EQ(0x0010, p_dev_rec1->hci_handle);
+  ASSERT_EQ(0x0011, p_dev_rec1->ble_hci_handle);
+  ASSERT_EQ(p_dev_rec1, btm_find_dev_by_handle(0x0010));
+  ASSERT_EQ(p_dev_rec1, btm_find_dev_by_handle(0x0011));
+  ASSERT_EQ(p_dev_rec2, btm_find_dev_by_handle(0x0020));
+
+  // The LE link of the first record is disconnected, and its handle reused.
+  btm_sec_dev_rec_set_hci_handle(p_dev_rec1, BT_TRANSPORT_LE,
+                                 HCI_INVALID_HANDLE);
+  ASSERT_EQ(nullptr, btm_find_dev_by_handle(0x0011));
+  btm_sec_dev_rec_set_hci_handle(p_dev_rec2, BT_TRANSPORT_BR_EDR, 0x0011);
+  ASSERT_EQ(p_dev_rec2, btm_find_dev_by_handle(0x0011));
+  ASSERT_EQ(p_dev_rec1, btm_find_dev_by_handle(0x0010));
+
+  ::btm_sec_cb.Free();
+}
+
+TEST_F(StackBtmDevTest, btm_find_dev__unresolved_rpa) {
+  Octet16 irk{};
+  irk.fill(0x5a);
+  const RawAddress rpa = make_rpa(irk, 0x123456);
+
+  ::btm_sec_cb.Init(BTM_SEC_MODE_SC);
+  tBTM_SEC_DEV_REC* p_dev_rec = btm_sec_allocate_dev_rec();
+  btm_sec_dev_rec_set_bd_addr(p_dev_rec,
+                              RawAddress({0x00, 0x1b, 0xdc, 0x01, 0x02, 0x03}));
+  p_dev_rec->device_type = BT_DEVICE_TYPE_BLE;
+
+  // No record has an IRK yet, the address is remembered as not resolved.
+  ASSERT_EQ(nullptr, btm_find_dev(rpa));
+  ASSERT_EQ(1UL, ::btm_sec_cb.dev_rec_addr_index.count(rpa));
+  ASSERT_EQ(nullptr, btm_find_dev(rpa));
+
+  // The address resolves once the record gets the IRK.
+  btm_sec_dev_rec_set_irk(p_dev_rec, irk);
+  ASSERT_EQ(p_dev_rec, btm_find_dev(rpa));
+  ASSERT_EQ(rpa, p_dev_rec->ble.pseudo_addr);
+
+  // Or once the record is known to be a LE device, the address is then not
+  // remembered.
+  const RawAddress rpa2 = make_rpa(irk, 0x654321);
+  p_dev_rec->device_type = BT_DEVICE_TYPE_BREDR;
+  ASSERT_EQ(nullptr, btm_find_dev(rpa2));
+  ASSERT_EQ(0UL, ::btm_sec_cb.dev_rec_addr_index.count(rpa2));
+  p_dev_rec->device_type |= BT_DEVICE_TYPE_BLE;
+  ASSERT_EQ(p_dev_rec, btm_find_dev(rpa2));
+
+  ::btm_sec_cb.Free();
+}
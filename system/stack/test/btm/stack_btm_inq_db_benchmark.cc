@@ -0,0 +1,98 @@
+/*
+ *  Copyright 2024 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <random>
+
+#include "stack/btm/btm_int_types.h"
+#include "stack/btm/neighbor_inquiry.h"
+#include "stack/include/bt_uuid16.h"
+#include "stack/include/hcidefs.h"
+#include "stack/include/inq_hci_link_interface.h"
+
+using ::benchmark::State;
+
+extern tBTM_CB btm_cb;
+extern void btm_sort_inq_result(void);
+extern void btm_set_eir_uuid(const uint8_t* p_eir, tBTM_INQ_RESULTS* p_results);
+
+namespace bluetooth {
+namespace legacy {
+namespace testing {
+void btm_clr_inq_db(const RawAddress* p_bda);
+}  // namespace testing
+}  // namespace legacy
+}  // namespace bluetooth
+
+namespace {
+
+constexpr size_t kNumResponses = 500;
+
+RawAddress inquiry_address(size_t index) {
+  return RawAddress({0x00, 0x1b, 0xdc, (uint8_t)(index >> 16),
+                     (uint8_t)(index >> 8), (uint8_t)index});
+}
+
+// Replays the inquiry database work of an inquiry receiving 500 extended
+// inquiry results from |state.range(0)| devices, then sorts the results.
+void BM_InquiryResponses(State& state) {
+  size_t num_devices = state.range(0);
+
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<size_t> device(0, num_devices - 1);
+  std::uniform_int_distribution<int> rssi(-100, -30);
+  const uint16_t kUuids[] = {UUID_SERVCLASS_AUDIO_SINK,
+                             UUID_SERVCLASS_HF_HANDSFREE,
+                             UUID_SERVCLASS_SERIAL_PORT};
+  uint8_t eir[HCI_EXT_INQ_RESPONSE_LEN] = {
+      7, HCI_EIR_COMPLETE_16BITS_UUID_TYPE,
+      (uint8_t)kUuids[0], (uint8_t)(kUuids[0] >> 8),
+      (uint8_t)kUuids[1], (uint8_t)(kUuids[1] >> 8),
+      (uint8_t)kUuids[2], (uint8_t)(kUuids[2] >> 8)};
+
+  for (auto _ : state) {
+    bluetooth::legacy::testing::btm_clr_inq_db(nullptr);
+    btm_cb.btm_inq_vars.inq_cmpl_info.num_resp = 0;
+
+    for (size_t i = 0; i < kNumResponses; i++) {
+      RawAddress bd_addr = inquiry_address(device(gen));
+      tINQ_DB_ENT* p_ent = btm_inq_db_find(bd_addr);
+      if (p_ent == nullptr) {
+        p_ent = btm_inq_db_new(bd_addr, false);
+        btm_cb.btm_inq_vars.inq_cmpl_info.num_resp++;
+      }
+      p_ent->inq_info.results.rssi = rssi(gen);
+      btm_inq_db_touch(p_ent);
+      memset(p_ent->inq_info.results.eir_uuid, 0,
+             sizeof(p_ent->inq_info.results.eir_uuid));
+      btm_set_eir_uuid(eir, &p_ent->inq_info.results);
+    }
+
+    btm_sort_inq_result();
+  }
+
+  bluetooth::legacy::testing::btm_clr_inq_db(nullptr);
+  state.SetItemsProcessed(state.iterations() * kNumResponses);
+}
+
+}  // namespace
+
+BENCHMARK(BM_InquiryResponses)->Arg(20)->Arg(100)->Arg(500);
+
+BENCHMARK_MAIN();
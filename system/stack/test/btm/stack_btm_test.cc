@@ -31,9 +31,14 @@
 #include "stack/btm/btm_sco.h"
 #include "stack/btm/btm_sec.h"
 #include "stack/btm/btm_sec_cb.h"
+#include "stack/btm/neighbor_inquiry.h"
 #include "stack/include/acl_api.h"
 #include "stack/include/acl_hci_link_interface.h"
+#include "stack/include/bt_uuid16.h"
+#include "stack/include/btm_api.h"
 #include "stack/include/btm_client_interface.h"
+#include "stack/include/hcidefs.h"
+#include "stack/include/inq_hci_link_interface.h"
 #include "stack/l2cap/l2c_int.h"
 #include "test/common/mock_functions.h"
 #include "test/mock/mock_legacy_hci_interface.h"
@@ -44,6 +49,16 @@ using testing::Each;
 using testing::Eq;
 
 extern tBTM_CB btm_cb;
+extern void btm_sort_inq_result(void);
+extern void btm_set_eir_uuid(const uint8_t* p_eir, tBTM_INQ_RESULTS* p_results);
+
+namespace bluetooth {
+namespace legacy {
+namespace testing {
+void btm_clr_inq_db(const RawAddress* p_bda);
+}  // namespace testing
+}  // namespace legacy
+}  // namespace bluetooth
 
 tL2C_CB l2cb;
 
@@ -307,3 +322,122 @@ TEST_F(StackBtmWithInitFreeTest, is_disconnect_reason_valid) {
 TEST_F(StackBtmWithInitFreeTest, Init) {
   ASSERT_FALSE(btm_cb.btm_inq_vars.remname_active);
 }
+
+namespace {
+
+RawAddress inquiry_address(size_t index) {
+  RawAddress bd_addr = {};
+  bd_addr.address[0] = 0x0a;
+  bd_addr.address[1] = 0x0b;
+  bd_addr.address[4] = (uint8_t)(index >> 8);
+  bd_addr.address[5] = (uint8_t)index;
+  return bd_addr;
+}
+
+// Stores an extended inquiry result the way
+// btm_process_inq_results_extended does: the entry of the device is found
+// or allocated, aged, and its EIR service list replaced.
+tINQ_DB_ENT* inquiry_response(const RawAddress& bd_addr, int8_t rssi,
+                              uint16_t uuid16) {
+  uint8_t eir[HCI_EXT_INQ_RESPONSE_LEN] = {
+      3, HCI_EIR_COMPLETE_16BITS_UUID_TYPE, (uint8_t)uuid16,
+      (uint8_t)(uuid16 >> 8)};
+
+  tINQ_DB_ENT* p_ent = btm_inq_db_find(bd_addr);
+  if (p_ent == nullptr) p_ent = btm_inq_db_new(bd_addr, false);
+  p_ent->inq_info.results.rssi = rssi;
+  btm_inq_db_touch(p_ent);
+  memset(p_ent->inq_info.results.eir_uuid, 0,
+         sizeof(p_ent->inq_info.results.eir_uuid));
+  btm_set_eir_uuid(eir, &p_ent->inq_info.results);
+  return p_ent;
+}
+
+}  // namespace
+
+TEST_F(StackBtmWithInitFreeTest, inquiry_db_many_responses) {
+  constexpr size_t kNumResponses = 500;
+  constexpr size_t kNumClassicEntries = BTM_INQ_DB_SIZE / 2;
+  constexpr size_t kNumRegulars = 8;
+  constexpr size_t kRegularsPeriod = 10;
+  constexpr size_t kFirstRegular = 0x1000;
+  constexpr uint16_t kDeviceUuid = UUID_SERVCLASS_SERIAL_PORT;
+  const uint16_t kRegularUuids[] = {UUID_SERVCLASS_AUDIO_SINK,
+                                    UUID_SERVCLASS_HF_HANDSFREE};
+
+  bluetooth::legacy::testing::btm_clr_inq_db(nullptr);
+
+  // New devices keep responding, with regular devices updating their EIR
+  // in between. The least recently responding entry is reused once the
+  // database is full, so the regular devices are never evicted.
+  size_t round = 0;
+  for (size_t i = 0; i < kNumResponses; i++) {
+    RawAddress bd_addr = inquiry_address(i);
+    ASSERT_EQ(nullptr, btm_inq_db_find(bd_addr));
+    tINQ_DB_ENT* p_ent =
+        inquiry_response(bd_addr, -(int8_t)(i % 100), kDeviceUuid);
+    ASSERT_EQ(p_ent, btm_inq_db_find(bd_addr));
+
+    if (i % kRegularsPeriod == 0) {
+      for (size_t r = 0; r < kNumRegulars; r++) {
+        bd_addr = inquiry_address(kFirstRegular + r);
+        tINQ_DB_ENT* p_regular = btm_inq_db_find(bd_addr);
+        ASSERT_TRUE(round == 0 || p_regular != nullptr);
+        p_ent = inquiry_response(bd_addr, -1, kRegularUuids[round % 2]);
+        ASSERT_TRUE(p_regular == nullptr || p_ent == p_regular);
+      }
+      round++;
+    }
+  }
+
+  const size_t kFirstRemaining =
+      kNumResponses - (kNumClassicEntries - kNumRegulars);
+  for (size_t i = 0; i < kNumResponses; i++) {
+    tINQ_DB_ENT* p_ent = btm_inq_db_find(inquiry_address(i));
+    if (i < kFirstRemaining) {
+      ASSERT_EQ(nullptr, p_ent);
+    } else {
+      ASSERT_NE(nullptr, p_ent);
+      ASSERT_EQ(inquiry_address(i), p_ent->inq_info.results.remote_bd_addr);
+      ASSERT_TRUE(
+          BTM_HasEirService(p_ent->inq_info.results.eir_uuid, kDeviceUuid));
+    }
+  }
+
+  // The regular devices keep the services of their last EIR only.
+  for (size_t r = 0; r < kNumRegulars; r++) {
+    tINQ_DB_ENT* p_ent = btm_inq_db_find(inquiry_address(kFirstRegular + r));
+    ASSERT_NE(nullptr, p_ent);
+    ASSERT_TRUE(BTM_HasEirService(p_ent->inq_info.results.eir_uuid,
+                                  kRegularUuids[(round - 1) % 2]));
+    ASSERT_FALSE(BTM_HasEirService(p_ent->inq_info.results.eir_uuid,
+                                   kRegularUuids[round % 2]));
+  }
+
+  // Sorting the results by RSSI keeps the entries indexed, and aged.
+  btm_cb.btm_inq_vars.inq_cmpl_info.num_resp = kNumClassicEntries;
+  btm_sort_inq_result();
+  int8_t rssi = 0;
+  size_t num_entries = 0;
+  for (tBTM_INQ_INFO* p_inq = BTM_InqDbFirst(); p_inq != nullptr;
+       p_inq = BTM_InqDbNext(p_inq)) {
+    ASSERT_LE(p_inq->results.rssi, rssi);
+    rssi = p_inq->results.rssi;
+    ASSERT_EQ(&btm_inq_db_find(p_inq->results.remote_bd_addr)->inq_info,
+              p_inq);
+    num_entries++;
+  }
+  ASSERT_EQ(kNumClassicEntries, num_entries);
+
+  RawAddress bd_addr = inquiry_address(kNumResponses);
+  inquiry_response(bd_addr, -50, kDeviceUuid);
+  ASSERT_EQ(nullptr, btm_inq_db_find(inquiry_address(kFirstRemaining)));
+  ASSERT_NE(nullptr, btm_inq_db_find(inquiry_address(kFirstRegular)));
+
+  bluetooth::legacy::testing::btm_clr_inq_db(&bd_addr);
+  ASSERT_EQ(nullptr, btm_inq_db_find(bd_addr));
+  ASSERT_NE(nullptr, btm_inq_db_find(inquiry_address(kNumResponses - 1)));
+
+  bluetooth::legacy::testing::btm_clr_inq_db(nullptr);
+  ASSERT_EQ(nullptr, BTM_InqDbFirst());
+}
@@ -2185,6 +2185,51 @@ TEST_F(IsoManagerTest, SendIsoDataBigValid) {
   }
 }
 
+TEST_F(IsoManagerTest, SendIsoSduBigValid) {
+  IsoManager::GetInstance()->CreateBig(volatile_test_big_params_evt_.big_id,
+                                       kDefaultBigParams);
+
+  uint16_t handle = volatile_test_big_params_evt_.conn_handles[0];
+  IsoManager::GetInstance()->SetupIsoDataPath(handle,
+                                              kDefaultIsoDataPathParams);
+  constexpr uint8_t data_len = 108;
+
+  EXPECT_CALL(iso_interface_, HciSend)
+      .WillOnce([handle, data_len](BT_HDR* p_msg) {
+        uint8_t* p = p_msg->data;
+        uint16_t msg_handle;
+        uint16_t iso_load_len;
+        uint16_t msg_data_len;
+        uint16_t msg_dummy;
+
+        ASSERT_EQ(p_msg->offset, 0);
+        ASSERT_EQ(p_msg->len, data_len + 8);
+
+        STREAM_TO_UINT16(msg_handle, p);
+        ASSERT_EQ(msg_handle, handle);
+        STREAM_TO_UINT16(iso_load_len, p);
+        ASSERT_EQ(iso_load_len, data_len + 4);
+        STREAM_TO_UINT16(msg_dummy, p);  // skip seq_nb
+        STREAM_TO_UINT16(msg_data_len, p);
+        ASSERT_EQ(msg_data_len, data_len);
+
+        // The payload written in place is sent as is
+        ASSERT_EQ(std::vector<uint8_t>(p, p + data_len),
+                  std::vector<uint8_t>(data_len, 0xA5));
+      });
+
+  BT_HDR* sdu = IsoManager::GetInstance()->AllocateIsoSdu(handle, data_len);
+  ASSERT_NE(sdu, nullptr);
+  ASSERT_EQ(sdu->len, data_len);
+  memset(sdu->data + sdu->offset, 0xA5, sdu->len);
+  IsoManager::GetInstance()->SendIsoSdu(sdu);
+
+  // SDUs are not allocated for handles without data path
+  ASSERT_EQ(IsoManager::GetInstance()->AllocateIsoSdu(
+                volatile_test_big_params_evt_.conn_handles[1], data_len),
+            nullptr);
+}
+
 TEST_F(IsoManagerTest, SendIsoDataNoCredits) {
   uint8_t num_buffers = controller_interface_.GetIsoBufferCount();
   std::vector<uint8_t> data_vec(108, 0);
@@ -96,6 +96,14 @@ EattChannel* EattExtension::GetChannelAvailableForClientRequest(
   return pimpl_->GetChannelAvailableForClientRequest(bd_addr);
 }
 
+uint8_t EattExtension::GetNumChannelsOpened(const RawAddress& bd_addr) {
+  return pimpl_->GetNumChannelsOpened(bd_addr);
+}
+
+uint16_t EattExtension::GetMinChannelMtu(const RawAddress& bd_addr) {
+  return pimpl_->GetMinChannelMtu(bd_addr);
+}
+
 /* Start stop GATT indication timer per CID */
 void EattExtension::StartIndicationConfirmationTimer(const RawAddress& bd_addr,
                                                      uint16_t cid) {
@@ -593,6 +593,32 @@ TEST_F(EattTest, ReconfigPeerSucceed) {
   DisconnectEattDevice(connected_cids_);
 }
 
+TEST_F(EattTest, MinChannelMtu) {
+  ConnectDeviceEattSupported(3);
+  ASSERT_EQ(EATT_MIN_MTU_MPS,
+            eatt_instance_->GetMinChannelMtu(test_address));
+
+  /* The smallest MTU stays until every channel is reconfigured */
+  uint16_t new_mtu = 300;
+  tL2CAP_LE_CFG_INFO cfg = {.result = L2CAP_CFG_OK, .mtu = new_mtu};
+  l2cap_app_info_.pL2CA_CreditBasedReconfigCompleted_Cb(
+      test_address, connected_cids_[0], false, &cfg);
+  l2cap_app_info_.pL2CA_CreditBasedReconfigCompleted_Cb(
+      test_address, connected_cids_[1], false, &cfg);
+  ASSERT_EQ(EATT_MIN_MTU_MPS,
+            eatt_instance_->GetMinChannelMtu(test_address));
+
+  l2cap_app_info_.pL2CA_CreditBasedReconfigCompleted_Cb(
+      test_address, connected_cids_[2], false, &cfg);
+  EattChannel* channel =
+      eatt_instance_->FindEattChannelByCid(test_address, connected_cids_[2]);
+  ASSERT_EQ(std::min<uint16_t>(new_mtu, channel->rx_mtu_),
+            eatt_instance_->GetMinChannelMtu(test_address));
+
+  DisconnectEattDevice(connected_cids_);
+  ASSERT_EQ(0, eatt_instance_->GetMinChannelMtu(test_address));
+}
+
 TEST_F(EattTest, ReconfigPeerFailed) {
   ConnectDeviceEattSupported(2);
 
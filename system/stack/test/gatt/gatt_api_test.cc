@@ -60,7 +60,10 @@ class GattApiTest : public ::testing::Test {
     logging::SetMinLogLevel(-2);
   }
 
-  void TearDown() override { list_free(btm_sec_cb.sec_dev_rec); }
+  void TearDown() override {
+    list_free(btm_sec_cb.sec_dev_rec);
+    btm_sec_cb.ClearDevRecIndex();
+  }
 };
 
 static const RawAddress SAMPLE_PUBLIC_BDA = {
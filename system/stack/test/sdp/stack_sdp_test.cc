@@ -19,6 +19,7 @@
 #include <stdlib.h>
 
 #include <cstddef>
+#include <vector>
 
 #include "osi/include/allocator.h"
 #include "stack/include/bt_uuid16.h"
@@ -395,3 +396,193 @@ TEST_F(SDP_GetDiRecord_Tests, SDP_GetDiRecord_Regression_test0) {
   ASSERT_EQ(device_info.rec.version, 0);
   ASSERT_FALSE(device_info.rec.primary_record);
 }
+
+static std::vector<uint8_t> sdp_server_rsp;
+
+class StackSdpServerDbTest : public StackSdpMainTest {
+ protected:
+  void SetUp() override {
+    StackSdpMainTest::SetUp();
+    test::mock::stack_l2cap_api::L2CA_DataWrite.body = [](uint16_t cid,
+                                                          BT_HDR* p_data) {
+      uint8_t* p = (uint8_t*)(p_data + 1) + p_data->offset;
+      sdp_server_rsp.assign(p, p + p_data->len);
+      osi_free_and_reset((void**)&p_data);
+      return 0;
+    };
+
+    // Fill the database: every fourth record is a serial port service.
+    for (int i = 0; i < SDP_MAX_RECORDS; i++) {
+      uint16_t service = (i % 4 == 0) ? UUID_SERVCLASS_SERIAL_PORT
+                                       : UUID_SERVCLASS_AUDIO_SINK;
+      uint32_t handle = SDP_CreateRecord();
+      ASSERT_NE(handle, 0u);
+      ASSERT_TRUE(SDP_AddServiceClassIdList(handle, 1, &service));
+      handles.push_back(handle);
+    }
+  }
+
+  void TearDown() override {
+    SDP_DeleteRecord(0);
+    handles.clear();
+    sdp_server_rsp.clear();
+    StackSdpMainTest::TearDown();
+  }
+
+  static tSDP_UUID_SEQ Uuid16Seq(std::vector<uint16_t> uuids) {
+    tSDP_UUID_SEQ seq{};
+    for (uint16_t uuid : uuids) {
+      seq.uuid_entry[seq.num_uids].len = 2;
+      seq.uuid_entry[seq.num_uids].value[0] = uuid >> 8;
+      seq.uuid_entry[seq.num_uids].value[1] = uuid & 0xff;
+      seq.num_uids++;
+    }
+    return seq;
+  }
+
+  static std::vector<uint32_t> Search(const tSDP_UUID_SEQ& seq) {
+    std::vector<uint32_t> found;
+    for (const tSDP_RECORD* p_rec = sdp_db_service_search(NULL, &seq); p_rec;
+         p_rec = sdp_db_service_search(p_rec, &seq)) {
+      found.push_back(p_rec->record_handle);
+    }
+    return found;
+  }
+
+  std::vector<uint32_t> handles;
+};
+
+TEST_F(StackSdpServerDbTest, sdp_db_service_search) {
+  std::vector<uint32_t> serial_ports;
+  for (size_t i = 0; i < handles.size(); i += 4) {
+    serial_ports.push_back(handles[i]);
+  }
+  ASSERT_EQ(Search(Uuid16Seq({UUID_SERVCLASS_SERIAL_PORT})), serial_ports);
+  ASSERT_TRUE(Search(Uuid16Seq({UUID_SERVCLASS_SERIAL_PORT,
+                                UUID_SERVCLASS_AUDIO_SINK}))
+                  .empty());
+  ASSERT_TRUE(Search(Uuid16Seq({UUID_PROTOCOL_L2CAP})).empty());
+
+  // Records must contain all the UUIDs of the sequence, in any attribute.
+  tSDP_PROTOCOL_ELEM proto{.protocol_uuid = UUID_PROTOCOL_L2CAP,
+                           .num_params = 1,
+                           .params = {0x1001}};
+  ASSERT_TRUE(SDP_AddProtocolList(handles[4], 1, &proto));
+  ASSERT_TRUE(SDP_AddProtocolList(handles[5], 1, &proto));
+  ASSERT_EQ(Search(Uuid16Seq({UUID_SERVCLASS_SERIAL_PORT, UUID_PROTOCOL_L2CAP})),
+            std::vector<uint32_t>({handles[4]}));
+
+  // UUIDs are matched whatever their size.
+  uint8_t uuid128[16] = {0x00, 0x00, 0x12, 0x34, 0x00, 0x00, 0x10, 0x00,
+                         0x80, 0x00, 0x00, 0x80, 0x5f, 0x9b, 0x34, 0xfb};
+  ASSERT_TRUE(SDP_AddAttribute(handles[1], ATTR_ID_SERVICE_ID, UUID_DESC_TYPE,
+                               sizeof(uuid128), uuid128));
+  ASSERT_EQ(Search(Uuid16Seq({0x1234})), std::vector<uint32_t>({handles[1]}));
+
+  // Replaced and deleted attributes are no longer matched.
+  uint16_t service = UUID_SERVCLASS_AUDIO_SINK;
+  ASSERT_TRUE(SDP_AddServiceClassIdList(handles[0], 1, &service));
+  ASSERT_TRUE(SDP_DeleteAttributeFromRecord(sdp_db_find_record(handles[4]),
+                                            ATTR_ID_PROTOCOL_DESC_LIST));
+  ASSERT_TRUE(Search(Uuid16Seq({UUID_PROTOCOL_L2CAP})).empty());
+
+  // Deleted records are no longer matched.
+  ASSERT_TRUE(SDP_DeleteRecord(handles[8]));
+  serial_ports.clear();
+  for (size_t i = 4; i < handles.size(); i += 4) {
+    if (i != 8) serial_ports.push_back(handles[i]);
+  }
+  ASSERT_EQ(Search(Uuid16Seq({UUID_SERVCLASS_SERIAL_PORT})), serial_ports);
+  ASSERT_EQ(sdp_db_find_record(handles[8]), nullptr);
+  ASSERT_EQ(sdp_db_find_record(handles[9])->record_handle, handles[9]);
+
+  ASSERT_TRUE(SDP_DeleteRecord(0));
+  ASSERT_TRUE(Search(Uuid16Seq({UUID_SERVCLASS_SERIAL_PORT})).empty());
+}
+
+TEST_F(StackSdpServerDbTest, sdp_db_find_attr_in_rec) {
+  const tSDP_RECORD* p_rec = sdp_db_find_record(handles[0]);
+  ASSERT_NE(p_rec, nullptr);
+
+  const tSDP_ATTRIBUTE* p_attr = sdp_db_find_attr_in_rec(
+      p_rec, ATTR_ID_SERVICE_CLASS_ID_LIST, ATTR_ID_SERVICE_CLASS_ID_LIST);
+  ASSERT_NE(p_attr, nullptr);
+  ASSERT_EQ(p_attr->id, ATTR_ID_SERVICE_CLASS_ID_LIST);
+
+  p_attr = sdp_db_find_attr_in_rec(p_rec, 0x0000, 0xffff);
+  ASSERT_NE(p_attr, nullptr);
+  ASSERT_EQ(p_attr->id, ATTR_ID_SERVICE_RECORD_HDL);
+
+  ASSERT_EQ(sdp_db_find_attr_in_rec(p_rec, ATTR_ID_SERVICE_CLASS_ID_LIST + 1,
+                                    0xffff),
+            nullptr);
+}
+
+TEST_F(StackSdpServerDbTest, records_outside_server_db) {
+  // Records built outside the server database, like the static PBAP record
+  // of the server, are not indexed even when their handle is in use.
+  static tSDP_RECORD record;
+  memset(&record, 0, sizeof(record));
+  record.record_handle = 0;
+  uint8_t pbap_uuid[2] = {UUID_SERVCLASS_PBAP_PSE >> 8,
+                          UUID_SERVCLASS_PBAP_PSE & 0xff};
+  ASSERT_TRUE(SDP_AddAttributeToRecord(&record, ATTR_ID_SERVICE_ID,
+                                       UUID_DESC_TYPE, sizeof(pbap_uuid),
+                                       pbap_uuid));
+  ASSERT_TRUE(Search(Uuid16Seq({UUID_SERVCLASS_PBAP_PSE})).empty());
+
+  // Editing a copy of a server record leaves the server record indexed.
+  const tSDP_RECORD* p_rec = sdp_db_find_record(handles[0]);
+  ASSERT_NE(p_rec, nullptr);
+  record = *p_rec;
+  for (uint16_t i = 0; i < record.num_attributes; i++) {
+    record.attribute[i].value_ptr =
+        record.attr_pad + (p_rec->attribute[i].value_ptr - p_rec->attr_pad);
+  }
+  ASSERT_TRUE(SDP_DeleteAttributeFromRecord(&record,
+                                            ATTR_ID_SERVICE_CLASS_ID_LIST));
+  std::vector<uint32_t> found = Search(Uuid16Seq({UUID_SERVCLASS_SERIAL_PORT}));
+  ASSERT_FALSE(found.empty());
+  ASSERT_EQ(found.front(), handles[0]);
+}
+
+TEST_F(StackSdpServerDbTest, sdp_server_service_search) {
+  tCONN_CB* p_ccb = sdpu_allocate_ccb();
+  ASSERT_NE(p_ccb, nullptr);
+  p_ccb->con_state = SDP_STATE_CONNECTED;
+  p_ccb->connection_id = 0x42;
+  p_ccb->rem_mtu_size = SDP_MTU_SIZE;
+
+  const uint8_t req[] = {SDP_PDU_SERVICE_SEARCH_REQ,
+                         0x00,
+                         0x01,
+                         0x00,
+                         0x08,
+                         (DATA_ELE_SEQ_DESC_TYPE << 3) | SIZE_IN_NEXT_BYTE,
+                         0x03,
+                         (UUID_DESC_TYPE << 3) | SIZE_TWO_BYTES,
+                         UUID_SERVCLASS_SERIAL_PORT >> 8,
+                         UUID_SERVCLASS_SERIAL_PORT & 0xff,
+                         0xff,
+                         0xff,
+                         0x00};
+  BT_HDR* p_msg = (BT_HDR*)osi_malloc(sizeof(BT_HDR) + sizeof(req));
+  p_msg->offset = 0;
+  p_msg->len = sizeof(req);
+  memcpy(p_msg + 1, req, sizeof(req));
+  sdp_server_handle_client_req(p_ccb, p_msg);
+  osi_free(p_msg);
+
+  uint16_t num_handles = (handles.size() + 3) / 4;
+  ASSERT_EQ(sdp_server_rsp.size(), 10u + 4 * num_handles);
+  ASSERT_EQ(sdp_server_rsp[0], SDP_PDU_SERVICE_SEARCH_RSP);
+  ASSERT_EQ((sdp_server_rsp[5] << 8) | sdp_server_rsp[6], num_handles);
+  ASSERT_EQ((sdp_server_rsp[7] << 8) | sdp_server_rsp[8], num_handles);
+  for (uint16_t i = 0; i < num_handles; i++) {
+    uint8_t* p = &sdp_server_rsp[9 + 4 * i];
+    ASSERT_EQ((uint32_t)((p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]),
+              handles[4 * i]);
+  }
+
+  sdpu_release_ccb(*p_ccb);
+}
@@ -34,6 +34,16 @@ bool bluetooth::shim::is_ad_type_filter_supported() {
   return false;
 }
 
+uint8_t bluetooth::shim::get_host_scan_filter_capacity() {
+  inc_func_call_count(__func__);
+  return 0;
+}
+
+uint16_t bluetooth::shim::get_host_batch_scan_storage_size() {
+  inc_func_call_count(__func__);
+  return 0;
+}
+
 void bluetooth::shim::set_ad_type_rsi_filter(bool /* enable */) {
   inc_func_call_count(__func__);
 }
@@ -48,6 +48,8 @@ namespace mock {
 namespace osi_allocator {
 
 // Function state capture and return values, if needed
+struct osi_allocator_debug_dump osi_allocator_debug_dump;
+struct osi_allocator_get_stats osi_allocator_get_stats;
 struct osi_calloc osi_calloc;
 struct osi_free osi_free;
 struct osi_free_and_reset osi_free_and_reset;
@@ -60,6 +62,14 @@ struct osi_strndup osi_strndup;
 }  // namespace test
 
 // Mocked functions, if any
+void osi_allocator_debug_dump(int fd) {
+  inc_func_call_count(__func__);
+  test::mock::osi_allocator::osi_allocator_debug_dump(fd);
+}
+std::vector<osi_alloc_stats_t> osi_allocator_get_stats() {
+  inc_func_call_count(__func__);
+  return test::mock::osi_allocator::osi_allocator_get_stats();
+}
 void* osi_calloc(size_t size) {
   inc_func_call_count(__func__);
   return test::mock::osi_allocator::osi_calloc(size);
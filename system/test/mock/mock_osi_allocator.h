@@ -22,12 +22,15 @@
  */
 
 #include <functional>
+#include <vector>
 
 // Original included files, if any
 #include <base/logging.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "osi/include/allocator.h"
+
 // Mocked compile conditionals, if any
 
 namespace test {
@@ -35,6 +38,26 @@ namespace mock {
 namespace osi_allocator {
 
 // Shared state between mocked functions and tests
+// Name: osi_allocator_debug_dump
+// Params: int fd
+// Return: void
+struct osi_allocator_debug_dump {
+  std::function<void(int fd)> body{[](int /* fd */) {}};
+  void operator()(int fd) { body(fd); };
+};
+extern struct osi_allocator_debug_dump osi_allocator_debug_dump;
+
+// Name: osi_allocator_get_stats
+// Params:
+// Return: std::vector<osi_alloc_stats_t>
+struct osi_allocator_get_stats {
+  std::vector<osi_alloc_stats_t> return_value{};
+  std::function<std::vector<osi_alloc_stats_t>()> body{
+      [this]() { return return_value; }};
+  std::vector<osi_alloc_stats_t> operator()() { return body(); };
+};
+extern struct osi_allocator_get_stats osi_allocator_get_stats;
+
 // Name: osi_calloc
 // Params: size_t size
 // Return: void*
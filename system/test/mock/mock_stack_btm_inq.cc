@@ -65,6 +65,7 @@ struct btm_inq_db_free btm_inq_db_free;
 struct btm_inq_db_init btm_inq_db_init;
 struct btm_inq_db_new btm_inq_db_new;
 struct btm_inq_db_reset btm_inq_db_reset;
+struct btm_inq_db_touch btm_inq_db_touch;
 struct btm_inq_find_bdaddr btm_inq_find_bdaddr;
 struct btm_inq_remote_name_timer_timeout btm_inq_remote_name_timer_timeout;
 struct btm_inq_rmt_name_failed_cancelled btm_inq_rmt_name_failed_cancelled;
@@ -238,6 +239,10 @@ void btm_inq_db_reset(void) {
   inc_func_call_count(__func__);
   test::mock::stack_btm_inq::btm_inq_db_reset();
 }
+void btm_inq_db_touch(tINQ_DB_ENT* p_ent) {
+  inc_func_call_count(__func__);
+  test::mock::stack_btm_inq::btm_inq_db_touch(p_ent);
+}
 bool btm_inq_find_bdaddr(const RawAddress& p_bda) {
   inc_func_call_count(__func__);
   return test::mock::stack_btm_inq::btm_inq_find_bdaddr(p_bda);
@@ -389,6 +389,15 @@ struct btm_inq_db_reset {
 };
 extern struct btm_inq_db_reset btm_inq_db_reset;
 
+// Name: btm_inq_db_touch
+// Params: tINQ_DB_ENT* p_ent
+// Return: void
+struct btm_inq_db_touch {
+  std::function<void(tINQ_DB_ENT* p_ent)> body{[](tINQ_DB_ENT* /* p_ent */) {}};
+  void operator()(tINQ_DB_ENT* p_ent) { body(p_ent); };
+};
+extern struct btm_inq_db_touch btm_inq_db_touch;
+
 // Name: btm_inq_find_bdaddr
 // Params: const RawAddress& p_bda
 // Return: bool
@@ -49,6 +49,11 @@ void IsoManager::ReadIsoLinkQuality(uint16_t /* iso_handle */) {}
 void IsoManager::SendIsoData(uint16_t /* iso_handle */,
                              const uint8_t* /* data */,
                              uint16_t /* data_len */) {}
+BT_HDR* IsoManager::AllocateIsoSdu(uint16_t /* iso_handle */,
+                                   uint16_t /* data_len */) {
+  return nullptr;
+}
+void IsoManager::SendIsoSdu(BT_HDR* /* sdu */) {}
 void IsoManager::CreateBig(
     uint8_t /* big_id */,
     struct iso_manager::big_create_params /* big_params */) {}
@@ -44,6 +44,9 @@ struct GATTC_UpdateUserAttMtuIfNeeded GATTC_UpdateUserAttMtuIfNeeded;
 struct GATTC_ConfigureMTU GATTC_ConfigureMTU;
 struct GATTC_Discover GATTC_Discover;
 struct GATTC_ExecuteWrite GATTC_ExecuteWrite;
+struct GATTC_GetReadMultiVariableMtu GATTC_GetReadMultiVariableMtu;
+struct GATTC_IsEattBearerAvailable GATTC_IsEattBearerAvailable;
+struct GATTC_GetNumEattBearers GATTC_GetNumEattBearers;
 struct GATTC_Read GATTC_Read;
 struct GATTC_SendHandleValueConfirm GATTC_SendHandleValueConfirm;
 struct GATTC_Write GATTC_Write;
@@ -83,6 +86,9 @@ tGATTC_TryMtuRequestResult GATTC_TryMtuRequest::return_value =
 tGATT_STATUS GATTC_ConfigureMTU::return_value = GATT_SUCCESS;
 tGATT_STATUS GATTC_Discover::return_value = GATT_SUCCESS;
 tGATT_STATUS GATTC_ExecuteWrite::return_value = GATT_SUCCESS;
+uint16_t GATTC_GetReadMultiVariableMtu::return_value = 0;
+bool GATTC_IsEattBearerAvailable::return_value = false;
+uint8_t GATTC_GetNumEattBearers::return_value = 0;
 tGATT_STATUS GATTC_Read::return_value = GATT_SUCCESS;
 tGATT_STATUS GATTC_SendHandleValueConfirm::return_value = GATT_SUCCESS;
 tGATT_STATUS GATTC_Write::return_value = GATT_SUCCESS;
@@ -142,6 +148,18 @@ tGATT_STATUS GATTC_ExecuteWrite(uint16_t conn_id, bool is_execute) {
   inc_func_call_count(__func__);
   return test::mock::stack_gatt_api::GATTC_ExecuteWrite(conn_id, is_execute);
 }
+uint16_t GATTC_GetReadMultiVariableMtu(uint16_t conn_id) {
+  inc_func_call_count(__func__);
+  return test::mock::stack_gatt_api::GATTC_GetReadMultiVariableMtu(conn_id);
+}
+bool GATTC_IsEattBearerAvailable(uint16_t conn_id) {
+  inc_func_call_count(__func__);
+  return test::mock::stack_gatt_api::GATTC_IsEattBearerAvailable(conn_id);
+}
+uint8_t GATTC_GetNumEattBearers(uint16_t conn_id) {
+  inc_func_call_count(__func__);
+  return test::mock::stack_gatt_api::GATTC_GetNumEattBearers(conn_id);
+}
 tGATT_STATUS GATTC_Read(uint16_t conn_id, tGATT_READ_TYPE type,
                         tGATT_READ_PARAM* p_read) {
   inc_func_call_count(__func__);
@@ -147,6 +147,39 @@ struct GATTC_ExecuteWrite {
 };
 extern struct GATTC_ExecuteWrite GATTC_ExecuteWrite;
 
+// Name: GATTC_GetReadMultiVariableMtu
+// Params: uint16_t conn_id
+// Return: uint16_t
+struct GATTC_GetReadMultiVariableMtu {
+  static uint16_t return_value;
+  std::function<uint16_t(uint16_t conn_id)> body{
+      [](uint16_t /* conn_id */) { return return_value; }};
+  uint16_t operator()(uint16_t conn_id) { return body(conn_id); };
+};
+extern struct GATTC_GetReadMultiVariableMtu GATTC_GetReadMultiVariableMtu;
+
+// Name: GATTC_IsEattBearerAvailable
+// Params: uint16_t conn_id
+// Return: bool
+struct GATTC_IsEattBearerAvailable {
+  static bool return_value;
+  std::function<bool(uint16_t conn_id)> body{
+      [](uint16_t /* conn_id */) { return return_value; }};
+  bool operator()(uint16_t conn_id) { return body(conn_id); };
+};
+extern struct GATTC_IsEattBearerAvailable GATTC_IsEattBearerAvailable;
+
+// Name: GATTC_GetNumEattBearers
+// Params: uint16_t conn_id
+// Return: uint8_t
+struct GATTC_GetNumEattBearers {
+  static uint8_t return_value;
+  std::function<uint8_t(uint16_t conn_id)> body{
+      [](uint16_t /* conn_id */) { return return_value; }};
+  uint8_t operator()(uint16_t conn_id) { return body(conn_id); };
+};
+extern struct GATTC_GetNumEattBearers GATTC_GetNumEattBearers;
+
 // Name: GATTC_Read
 // Params: uint16_t conn_id, tGATT_READ_TYPE type, tGATT_READ_PARAM* p_read
 // Return: tGATT_STATUS
@@ -16,7 +16,7 @@
 
 /*
  * Generated mock file from original source file
- *   Functions generated:14
+ *   Functions generated:15
  */
 
 #include <stdio.h>
@@ -79,6 +79,7 @@ tSDP_ATTRIBUTE* sdp_db_find_attr_in_rec(tSDP_RECORD* /* p_rec */,
   inc_func_call_count(__func__);
   return nullptr;
 }
+void sdp_db_init(void) { inc_func_call_count(__func__); }
 tSDP_RECORD* sdp_db_find_record(uint32_t /* handle */) {
   inc_func_call_count(__func__);
   return nullptr;
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Generated mock file from original source file
+ *   Functions generated:11
+ */
+
+#include <cstdint>
+#include <memory>
+
+#include "test/common/mock_functions.h"
+#include "udrv/include/audio_fifo.h"
+
+namespace bluetooth {
+namespace udrv {
+
+AudioFifo::~AudioFifo() { inc_func_call_count(__func__); }
+std::unique_ptr<AudioFifo> AudioFifo::Create(size_t capacity) {
+  inc_func_call_count(__func__);
+  return nullptr;
+}
+std::unique_ptr<AudioFifo> AudioFifo::Map(int fd) {
+  inc_func_call_count(__func__);
+  return nullptr;
+}
+size_t AudioFifo::GetReadableSize() const {
+  inc_func_call_count(__func__);
+  return 0;
+}
+size_t AudioFifo::GetWritableSize() const {
+  inc_func_call_count(__func__);
+  return 0;
+}
+size_t AudioFifo::Write(const uint8_t* data, size_t len) {
+  inc_func_call_count(__func__);
+  return 0;
+}
+size_t AudioFifo::Read(uint8_t* data, size_t len) {
+  inc_func_call_count(__func__);
+  return 0;
+}
+uint64_t AudioFifo::GetOverrunCount() const {
+  inc_func_call_count(__func__);
+  return 0;
+}
+uint64_t AudioFifo::GetOverrunBytes() const {
+  inc_func_call_count(__func__);
+  return 0;
+}
+uint64_t AudioFifo::GetUnderrunCount() const {
+  inc_func_call_count(__func__);
+  return 0;
+}
+uint64_t AudioFifo::GetUnderrunBytes() const {
+  inc_func_call_count(__func__);
+  return 0;
+}
+
+}  // namespace udrv
+}  // namespace bluetooth
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "audio_a2dp_hw/include/audio_a2dp_hw.h"
+#include "osi/include/socket_utils/sockets.h"
+#include "udrv/include/audio_fifo.h"
+#include "udrv/include/uipc.h"
+
+using bluetooth::udrv::AudioFifo;
+
+namespace {
+
+/* Same socket namespace as the UIPC server sockets */
+#ifdef __ANDROID__
+constexpr char kAudioPath[] = "/data/misc/bluedroid/.audio_fifo_benchmark";
+constexpr int kAudioPathNamespace = ANDROID_SOCKET_NAMESPACE_ABSTRACT;
+#else   // !__ANDROID__
+constexpr char kAudioPath[] = "/tmp/.audio_fifo_benchmark";
+constexpr int kAudioPathNamespace = ANDROID_SOCKET_NAMESPACE_FILESYSTEM;
+#endif  // __ANDROID__
+
+std::promise<void>* open_promise = nullptr;
+
+void audio_cb(tUIPC_CH_ID /* ch_id */, tUIPC_EVENT event) {
+  if (event == UIPC_OPEN_EVT && open_promise != nullptr) {
+    open_promise->set_value();
+  }
+}
+
+/* Opens the UIPC audio channel the way the A2DP and hearing aid sources do,
+ * and connects the audio HAL side of it.
+ */
+class AudioChannel {
+ public:
+  AudioChannel() : uipc_(UIPC_Init()) {
+    std::promise<void> opened;
+    open_promise = &opened;
+    UIPC_Open(*uipc_, UIPC_CH_ID_AV_AUDIO, audio_cb, kAudioPath);
+
+    hal_fd_ = socket(AF_LOCAL, SOCK_STREAM, 0);
+    if (osi_socket_local_client_connect(hal_fd_, kAudioPath,
+                                        kAudioPathNamespace, SOCK_STREAM) < 0 ||
+        opened.get_future().wait_for(std::chrono::seconds(1)) !=
+            std::future_status::ready) {
+      close(hal_fd_);
+      hal_fd_ = -1;
+    }
+    open_promise = nullptr;
+
+    UIPC_Ioctl(*uipc_, UIPC_CH_ID_AV_AUDIO, UIPC_REG_REMOVE_ACTIVE_READSET,
+               nullptr);
+    UIPC_Ioctl(*uipc_, UIPC_CH_ID_AV_AUDIO, UIPC_SET_READ_POLL_TMO,
+               reinterpret_cast<void*>(0));
+  }
+
+  ~AudioChannel() {
+    UIPC_Close(*uipc_, UIPC_CH_ID_ALL);
+    if (hal_fd_ >= 0) close(hal_fd_);
+  }
+
+  bool IsConnected() const { return hal_fd_ >= 0; }
+  int GetHalFd() const { return hal_fd_; }
+  tUIPC_STATE& GetUipc() { return *uipc_; }
+
+ private:
+  std::unique_ptr<tUIPC_STATE> uipc_;
+  int hal_fd_ = -1;
+};
+
+/* The argument is the size of an audio period: 10 ms of 16 bits stereo PCM
+ * at 44.1 and 48 kHz, and 20 ms at 48 kHz. Each iteration transfers one
+ * period from the audio HAL side to the encoder side of the channel.
+ */
+void BM_UipcSocket(benchmark::State& state) {
+  const size_t period = state.range(0);
+  std::vector<uint8_t> pcm(period, 0x55);
+  std::vector<uint8_t> out(period);
+
+  AudioChannel channel;
+  if (!channel.IsConnected()) {
+    state.SkipWithError("Audio channel setup failed");
+    return;
+  }
+
+  for (auto _ : state) {
+    if (send(channel.GetHalFd(), pcm.data(), period, MSG_NOSIGNAL) !=
+        static_cast<ssize_t>(period)) {
+      state.SkipWithError("Socket write failed");
+      break;
+    }
+    size_t bytes_read = 0;
+    while (bytes_read < period) {
+      bytes_read += UIPC_Read(channel.GetUipc(), UIPC_CH_ID_AV_AUDIO,
+                              out.data() + bytes_read, period - bytes_read);
+    }
+    benchmark::DoNotOptimize(out.data());
+  }
+
+  state.SetBytesProcessed(state.iterations() * period);
+}
+BENCHMARK(BM_UipcSocket)->Arg(1764)->Arg(1920)->Arg(3840);
+
+void BM_UipcAudioFifo(benchmark::State& state) {
+  const size_t period = state.range(0);
+  std::vector<uint8_t> pcm(period, 0x55);
+  std::vector<uint8_t> out(period);
+
+  AudioChannel channel;
+  std::unique_ptr<AudioFifo> fifo =
+      AudioFifo::Create(AUDIO_STREAM_OUTPUT_BUFFER_SZ);
+  if (!channel.IsConnected() || fifo == nullptr) {
+    state.SkipWithError("Audio channel setup failed");
+    return;
+  }
+
+  std::unique_ptr<AudioFifo> hal_fifo =
+      AudioFifo::Map(fcntl(fifo->GetFd(), F_DUPFD_CLOEXEC, 0));
+  if (hal_fifo == nullptr) {
+    state.SkipWithError("Audio FIFO mapping failed");
+    return;
+  }
+  UIPC_Ioctl(channel.GetUipc(), UIPC_CH_ID_AV_AUDIO, UIPC_SET_AUDIO_FIFO,
+             fifo.release());
+
+  for (auto _ : state) {
+    hal_fifo->Write(pcm.data(), period);
+    size_t bytes_read = UIPC_Read(channel.GetUipc(), UIPC_CH_ID_AV_AUDIO,
+                                  out.data(), period);
+    if (bytes_read != period) {
+      state.SkipWithError("Audio FIFO read failed");
+      break;
+    }
+    benchmark::DoNotOptimize(out.data());
+  }
+
+  state.SetBytesProcessed(state.iterations() * period);
+  state.counters["overruns"] = hal_fifo->GetOverrunCount();
+  state.counters["underruns"] = hal_fifo->GetUnderrunCount();
+}
+BENCHMARK(BM_UipcAudioFifo)->Arg(1764)->Arg(1920)->Arg(3840);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace bluetooth {
+namespace udrv {
+
+/**
+ * Single producer, single consumer FIFO carrying the PCM audio data from the
+ * audio HAL to the software encoders, as an alternative to the UIPC audio
+ * socket. The FIFO lives in a sealed memfd which is shared with the peer
+ * process; neither side makes a system call to transfer the audio data.
+ *
+ * Write may only be called from one thread of the producer, and Read from one
+ * thread of the consumer.
+ */
+class AudioFifo {
+ public:
+  ~AudioFifo();
+
+  AudioFifo(const AudioFifo&) = delete;
+  AudioFifo& operator=(const AudioFifo&) = delete;
+
+  /**
+   * Creates an empty FIFO in a new memfd
+   *
+   * @param capacity minimum FIFO size in bytes, rounded up to a power of two
+   * @return the FIFO or nullptr on failure
+   */
+  static std::unique_ptr<AudioFifo> Create(size_t capacity);
+
+  /**
+   * Maps a FIFO created by the peer process
+   *
+   * @param fd memfd received from the peer. The ownership is transferred.
+   * @return the FIFO or nullptr if fd does not hold a valid FIFO
+   */
+  static std::unique_ptr<AudioFifo> Map(int fd);
+
+  /* File descriptor to share with the peer; owned by the FIFO */
+  int GetFd() const { return fd_; }
+  size_t GetCapacity() const { return capacity_; }
+
+  /* Number of bytes which can be read or written right now */
+  size_t GetReadableSize() const;
+  size_t GetWritableSize() const;
+
+  /**
+   * Writes up to len bytes, the bytes which do not fit are dropped and
+   * reported as an overrun
+   *
+   * @return number of bytes written
+   */
+  size_t Write(const uint8_t* data, size_t len);
+
+  /**
+   * Reads up to len bytes, a short read is reported as an underrun
+   *
+   * Every short read is counted, including the ones made before the producer
+   * starts writing and the reads draining the FIFO on suspend. Callers which
+   * only account for the underruns while encoding keep their own statistics.
+   *
+   * @return number of bytes read
+   */
+  size_t Read(uint8_t* data, size_t len);
+
+  /* Overrun and underrun statistics, shared by both sides */
+  uint64_t GetOverrunCount() const;
+  uint64_t GetOverrunBytes() const;
+  uint64_t GetUnderrunCount() const;
+  uint64_t GetUnderrunBytes() const;
+
+ private:
+  struct Header;
+
+  AudioFifo(int fd, void* memory, size_t size, size_t capacity);
+
+  int fd_;
+  void* memory_;
+  size_t size_;
+  size_t capacity_;
+  Header* header_;
+  uint8_t* data_;
+};
+
+}  // namespace udrv
+}  // namespace bluetooth
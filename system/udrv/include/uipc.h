@@ -24,6 +24,7 @@
 #include <mutex>
 
 #include "stack/include/bt_hdr.h"
+#include "udrv/include/audio_fifo.h"
 
 #define UIPC_CH_ID_AV_CTRL 0
 #define UIPC_CH_ID_AV_AUDIO 1
@@ -51,6 +52,7 @@ typedef enum {
 #define UIPC_REQ_RX_FLUSH 1
 #define UIPC_REG_REMOVE_ACTIVE_READSET 3
 #define UIPC_SET_READ_POLL_TMO 4
+#define UIPC_SET_AUDIO_FIFO 5
 
 typedef void(tUIPC_RCV_CBACK)(
     tUIPC_CH_ID ch_id,
@@ -67,6 +69,8 @@ typedef struct {
   int read_poll_tmo_ms;
   int task_evt_flags; /* event flags pending to be processed in read task */
   tUIPC_RCV_CBACK* cback;
+  /* shared memory FIFO replacing the socket for the channel data */
+  bluetooth::udrv::AudioFifo* fifo;
 } tUIPC_CHAN;
 
 struct tUIPC_STATE {
@@ -119,9 +123,25 @@ void UIPC_Close(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id);
 bool UIPC_Send(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id, uint16_t msg_evt,
                const uint8_t* p_buf, uint16_t msglen);
 
+/**
+ * Send a message over UIPC along with a file descriptor
+ *
+ * @param ch_id Channel ID
+ * @param p_buf Buffer for the message
+ * @param msglen Message length, must not be 0
+ * @param fd File descriptor to pass to the peer. The ownership is not being
+ * transferred.
+ * @return true on success, otherwise false
+ */
+bool UIPC_SendFd(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id, const uint8_t* p_buf,
+                 uint16_t msglen, int fd);
+
 /**
  * Read a message from UIPC
  *
+ * When an audio FIFO is attached to the channel, the data is read from the
+ * FIFO without waiting: a short read is an underrun.
+ *
  * @param ch_id Channel ID
  * @param p_msg_evt Message event type
  * @param p_buf Buffer for the message
@@ -136,7 +156,9 @@ uint32_t UIPC_Read(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id, uint8_t* p_buf,
  *
  * @param ch_id Channel ID
  * @param request Request type
- * @param param Optional parameters
+ * @param param Optional parameters. For UIPC_SET_AUDIO_FIFO, the AudioFifo
+ * to read the channel data from, owned by UIPC until the channel is closed;
+ * nullptr to detach the current one.
  * @return true on success, otherwise false
  */
 bool UIPC_Ioctl(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id, uint32_t request,
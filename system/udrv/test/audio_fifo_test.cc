@@ -0,0 +1,214 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "udrv/include/audio_fifo.h"
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using bluetooth::udrv::AudioFifo;
+
+namespace {
+
+/* Shared header layout: magic and capacity, then the write and the read
+ * indices, each on its own cache line.
+ */
+constexpr off_t kMagicOffset = 0;
+constexpr off_t kWriteIndexOffset = 64;
+constexpr off_t kReadIndexOffset = 128;
+
+std::vector<uint8_t> MakePattern(size_t len, uint8_t seed) {
+  std::vector<uint8_t> data(len);
+  for (size_t i = 0; i < len; i++) data[i] = seed + i * 7;
+  return data;
+}
+
+/* Maps a copy of the FIFO file descriptor, as the peer process does */
+std::unique_ptr<AudioFifo> MapPeer(const AudioFifo& fifo) {
+  return AudioFifo::Map(dup(fifo.GetFd()));
+}
+
+size_t GetHeaderSize(const AudioFifo& fifo) {
+  struct stat st;
+  EXPECT_EQ(0, fstat(fifo.GetFd(), &st));
+  return st.st_size - fifo.GetCapacity();
+}
+
+template <typename T>
+void WriteAt(int fd, off_t offset, T value) {
+  ASSERT_EQ((ssize_t)sizeof(value), pwrite(fd, &value, sizeof(value), offset));
+}
+
+}  // namespace
+
+TEST(AudioFifoTest, create_rounds_capacity_up) {
+  auto fifo = AudioFifo::Create(1000);
+  ASSERT_NE(nullptr, fifo);
+  ASSERT_EQ(1024u, fifo->GetCapacity());
+  ASSERT_EQ(0u, fifo->GetReadableSize());
+  ASSERT_EQ(1024u, fifo->GetWritableSize());
+
+  ASSERT_EQ(nullptr, AudioFifo::Create(0));
+  ASSERT_EQ(nullptr, AudioFifo::Create((1 << 24) + 1));
+}
+
+TEST(AudioFifoTest, write_and_read_wrap_around) {
+  auto writer = AudioFifo::Create(64);
+  ASSERT_NE(nullptr, writer);
+  auto reader = MapPeer(*writer);
+  ASSERT_NE(nullptr, reader);
+
+  /* 37 bytes chunks are not aligned on the capacity, so both the writes and
+   * the reads are split at the end of the buffer every other round.
+   */
+  constexpr size_t kChunk = 37;
+  for (int round = 0; round < 20; round++) {
+    auto data = MakePattern(kChunk, round);
+    ASSERT_EQ(kChunk, writer->Write(data.data(), data.size()));
+    ASSERT_EQ(kChunk, reader->GetReadableSize());
+    ASSERT_EQ(64 - kChunk, reader->GetWritableSize());
+
+    std::vector<uint8_t> read(kChunk);
+    ASSERT_EQ(kChunk, reader->Read(read.data(), read.size()));
+    ASSERT_EQ(data, read) << "round " << round;
+  }
+
+  /* Fill the FIFO completely across the end of the buffer */
+  auto data = MakePattern(64, 0x80);
+  ASSERT_EQ(64u, writer->Write(data.data(), data.size()));
+  ASSERT_EQ(0u, writer->GetWritableSize());
+  std::vector<uint8_t> read(64);
+  ASSERT_EQ(64u, reader->Read(read.data(), read.size()));
+  ASSERT_EQ(data, read);
+
+  ASSERT_EQ(0u, writer->GetOverrunCount());
+  ASSERT_EQ(0u, reader->GetUnderrunCount());
+}
+
+TEST(AudioFifoTest, overrun_and_underrun_are_counted) {
+  auto writer = AudioFifo::Create(64);
+  ASSERT_NE(nullptr, writer);
+  auto reader = MapPeer(*writer);
+  ASSERT_NE(nullptr, reader);
+
+  /* The bytes which do not fit are dropped */
+  auto data = MakePattern(100, 1);
+  ASSERT_EQ(64u, writer->Write(data.data(), data.size()));
+  ASSERT_EQ(0u, writer->Write(data.data(), 10));
+  ASSERT_EQ(2u, writer->GetOverrunCount());
+  ASSERT_EQ(46u, writer->GetOverrunBytes());
+
+  std::vector<uint8_t> read(100);
+  ASSERT_EQ(64u, reader->Read(read.data(), read.size()));
+  ASSERT_TRUE(std::equal(data.begin(), data.begin() + 64, read.begin()));
+  ASSERT_EQ(1u, reader->GetUnderrunCount());
+  ASSERT_EQ(36u, reader->GetUnderrunBytes());
+
+  /* Empty reads, e.g. before the producer starts, are underruns too */
+  ASSERT_EQ(0u, reader->Read(read.data(), 16));
+  ASSERT_EQ(2u, reader->GetUnderrunCount());
+  ASSERT_EQ(52u, reader->GetUnderrunBytes());
+
+  /* Full reads and writes are not counted */
+  ASSERT_EQ(16u, writer->Write(data.data(), 16));
+  ASSERT_EQ(16u, reader->Read(read.data(), 16));
+
+  /* The statistics are shared by both sides */
+  ASSERT_EQ(2u, reader->GetOverrunCount());
+  ASSERT_EQ(46u, reader->GetOverrunBytes());
+  ASSERT_EQ(2u, writer->GetUnderrunCount());
+  ASSERT_EQ(52u, writer->GetUnderrunBytes());
+}
+
+TEST(AudioFifoTest, map_rejects_bad_magic) {
+  auto fifo = AudioFifo::Create(64);
+  ASSERT_NE(nullptr, fifo);
+  WriteAt<uint32_t>(fifo->GetFd(), kMagicOffset, 0xdeadbeef);
+  ASSERT_EQ(nullptr, MapPeer(*fifo));
+}
+
+TEST(AudioFifoTest, map_rejects_unsealed_memfd) {
+  auto fifo = AudioFifo::Create(64);
+  ASSERT_NE(nullptr, fifo);
+  size_t size = GetHeaderSize(*fifo) + fifo->GetCapacity();
+
+  /* Same content as a valid FIFO, but the peer could still resize it */
+  std::vector<uint8_t> content(size);
+  ASSERT_EQ((ssize_t)size, pread(fifo->GetFd(), content.data(), size, 0));
+  int fd = memfd_create("unsealed_fifo", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  ASSERT_LE(0, fd);
+  ASSERT_EQ((ssize_t)size, pwrite(fd, content.data(), size, 0));
+  ASSERT_EQ(nullptr, AudioFifo::Map(fd));
+}
+
+TEST(AudioFifoTest, map_rejects_size_and_capacity_mismatch) {
+  auto fifo = AudioFifo::Create(64);
+  ASSERT_NE(nullptr, fifo);
+  size_t header_size = GetHeaderSize(*fifo);
+
+  /* Valid header announcing 64 bytes in a memory of 128 bytes of data */
+  std::vector<uint8_t> header(header_size);
+  ASSERT_EQ((ssize_t)header_size,
+            pread(fifo->GetFd(), header.data(), header_size, 0));
+  int fd = memfd_create("oversized_fifo", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  ASSERT_LE(0, fd);
+  ASSERT_EQ(0, ftruncate(fd, header_size + 128));
+  ASSERT_EQ((ssize_t)header_size, pwrite(fd, header.data(), header_size, 0));
+  ASSERT_EQ(0, fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW));
+  ASSERT_EQ(nullptr, AudioFifo::Map(fd));
+
+  /* Too small to hold the header */
+  fd = memfd_create("truncated_fifo", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  ASSERT_LE(0, fd);
+  ASSERT_EQ(0, ftruncate(fd, header_size / 2));
+  ASSERT_EQ(0, fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW));
+  ASSERT_EQ(nullptr, AudioFifo::Map(fd));
+}
+
+TEST(AudioFifoTest, forged_indices) {
+  auto fifo = AudioFifo::Create(64);
+  ASSERT_NE(nullptr, fifo);
+
+  /* More bytes in use than the capacity */
+  WriteAt<uint64_t>(fifo->GetFd(), kWriteIndexOffset, 65);
+  ASSERT_EQ(nullptr, MapPeer(*fifo));
+
+  /* Read index ahead of the write index */
+  WriteAt<uint64_t>(fifo->GetFd(), kWriteIndexOffset, 0);
+  WriteAt<uint64_t>(fifo->GetFd(), kReadIndexOffset, 1);
+  ASSERT_EQ(nullptr, MapPeer(*fifo));
+
+  /* Indices forged after the mapping never move the accesses out of the
+   * buffer: at most the capacity is readable.
+   */
+  WriteAt<uint64_t>(fifo->GetFd(), kReadIndexOffset, 0);
+  auto reader = MapPeer(*fifo);
+  ASSERT_NE(nullptr, reader);
+  WriteAt<uint64_t>(fifo->GetFd(), kWriteIndexOffset, 1000);
+  ASSERT_EQ(64u, reader->GetReadableSize());
+  ASSERT_EQ(0u, fifo->GetWritableSize());
+
+  std::vector<uint8_t> read(200);
+  ASSERT_EQ(64u, reader->Read(read.data(), read.size()));
+  ASSERT_EQ(0u, fifo->Write(read.data(), 1));
+}
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Define before including log.h
+#define LOG_TAG "audio_fifo"
+
+#include "udrv/include/audio_fifo.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include "os/log.h"
+
+namespace bluetooth {
+namespace udrv {
+
+namespace {
+constexpr uint32_t kAudioFifoMagic = 0x46465442; /* "BTFF" */
+constexpr size_t kMaxCapacity = 1 << 24;
+constexpr size_t kCacheLineSize = 64;
+}  // namespace
+
+/* Shared memory layout. The indices are free running byte counts. Each one is
+ * on its own cache line, along with the statistics of the side updating it,
+ * so that the producer and the consumer never write to the same line.
+ */
+struct AudioFifo::Header {
+  uint32_t magic;
+  uint32_t capacity;
+
+  alignas(kCacheLineSize) std::atomic<uint64_t> write_index;
+  std::atomic<uint64_t> overrun_count;
+  std::atomic<uint64_t> overrun_bytes;
+
+  alignas(kCacheLineSize) std::atomic<uint64_t> read_index;
+  std::atomic<uint64_t> underrun_count;
+  std::atomic<uint64_t> underrun_bytes;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "The FIFO indices must be lock free to be shared across "
+              "processes");
+
+AudioFifo::AudioFifo(int fd, void* memory, size_t size, size_t capacity)
+    : fd_(fd),
+      memory_(memory),
+      size_(size),
+      capacity_(capacity),
+      header_(static_cast<Header*>(memory)),
+      data_(static_cast<uint8_t*>(memory) + sizeof(Header)) {}
+
+AudioFifo::~AudioFifo() {
+  munmap(memory_, size_);
+  close(fd_);
+}
+
+std::unique_ptr<AudioFifo> AudioFifo::Create(size_t capacity) {
+  if (capacity == 0 || capacity > kMaxCapacity) {
+    LOG_ERROR("Invalid FIFO capacity %zu", capacity);
+    return nullptr;
+  }
+
+  size_t fifo_capacity = 1;
+  while (fifo_capacity < capacity) fifo_capacity <<= 1;
+  size_t size = sizeof(Header) + fifo_capacity;
+
+  int fd = memfd_create("bt_audio_fifo", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd < 0) {
+    LOG_ERROR("memfd_create failed (%s)", strerror(errno));
+    return nullptr;
+  }
+
+  /* The peer must not be able to resize the FIFO under our feet */
+  if (ftruncate(fd, size) < 0 ||
+      fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) < 0) {
+    LOG_ERROR("FIFO memory setup failed (%s)", strerror(errno));
+    close(fd);
+    return nullptr;
+  }
+
+  void* memory =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (memory == MAP_FAILED) {
+    LOG_ERROR("mmap failed (%s)", strerror(errno));
+    close(fd);
+    return nullptr;
+  }
+
+  Header* header = new (memory) Header{};
+  header->magic = kAudioFifoMagic;
+  header->capacity = fifo_capacity;
+
+  return std::unique_ptr<AudioFifo>(
+      new AudioFifo(fd, memory, size, fifo_capacity));
+}
+
+std::unique_ptr<AudioFifo> AudioFifo::Map(int fd) {
+  struct stat st;
+  if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(Header) ||
+      st.st_size > (off_t)(sizeof(Header) + kMaxCapacity)) {
+    LOG_ERROR("Invalid FIFO memory");
+    close(fd);
+    return nullptr;
+  }
+
+  int seals = fcntl(fd, F_GET_SEALS);
+  if (seals < 0 || !(seals & F_SEAL_SHRINK)) {
+    LOG_ERROR("FIFO memory is not sealed");
+    close(fd);
+    return nullptr;
+  }
+
+  size_t size = st.st_size;
+  void* memory =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (memory == MAP_FAILED) {
+    LOG_ERROR("mmap failed (%s)", strerror(errno));
+    close(fd);
+    return nullptr;
+  }
+
+  auto header = static_cast<const Header*>(memory);
+  size_t capacity = header->capacity;
+  uint64_t write_index = header->write_index.load(std::memory_order_acquire);
+  uint64_t read_index = header->read_index.load(std::memory_order_acquire);
+  if (header->magic != kAudioFifoMagic || capacity == 0 ||
+      (capacity & (capacity - 1)) != 0 ||
+      sizeof(Header) + capacity != size ||
+      write_index - read_index > capacity) {
+    LOG_ERROR("Invalid FIFO header");
+    munmap(memory, size);
+    close(fd);
+    return nullptr;
+  }
+
+  return std::unique_ptr<AudioFifo>(new AudioFifo(fd, memory, size, capacity));
+}
+
+/* The indices are written by the peer process: never trust them for more
+ * than the FIFO capacity.
+ */
+size_t AudioFifo::GetReadableSize() const {
+  uint64_t read_index = header_->read_index.load(std::memory_order_acquire);
+  uint64_t write_index = header_->write_index.load(std::memory_order_acquire);
+  return std::min<uint64_t>(write_index - read_index, capacity_);
+}
+
+size_t AudioFifo::GetWritableSize() const {
+  return capacity_ - GetReadableSize();
+}
+
+size_t AudioFifo::Write(const uint8_t* data, size_t len) {
+  uint64_t write_index = header_->write_index.load(std::memory_order_relaxed);
+  uint64_t read_index = header_->read_index.load(std::memory_order_acquire);
+  size_t used = std::min<uint64_t>(write_index - read_index, capacity_);
+  size_t count = std::min(len, capacity_ - used);
+
+  size_t offset = write_index & (capacity_ - 1);
+  size_t first = std::min(count, capacity_ - offset);
+  memcpy(data_ + offset, data, first);
+  memcpy(data_, data + first, count - first);
+  header_->write_index.store(write_index + count, std::memory_order_release);
+
+  if (count < len) {
+    header_->overrun_count.fetch_add(1, std::memory_order_relaxed);
+    header_->overrun_bytes.fetch_add(len - count, std::memory_order_relaxed);
+  }
+  return count;
+}
+
+size_t AudioFifo::Read(uint8_t* data, size_t len) {
+  uint64_t read_index = header_->read_index.load(std::memory_order_relaxed);
+  uint64_t write_index = header_->write_index.load(std::memory_order_acquire);
+  size_t available = std::min<uint64_t>(write_index - read_index, capacity_);
+  size_t count = std::min(len, available);
+
+  size_t offset = read_index & (capacity_ - 1);
+  size_t first = std::min(count, capacity_ - offset);
+  memcpy(data, data_ + offset, first);
+  memcpy(data + first, data_, count - first);
+  header_->read_index.store(read_index + count, std::memory_order_release);
+
+  if (count < len) {
+    header_->underrun_count.fetch_add(1, std::memory_order_relaxed);
+    header_->underrun_bytes.fetch_add(len - count, std::memory_order_relaxed);
+  }
+  return count;
+}
+
+uint64_t AudioFifo::GetOverrunCount() const {
+  return header_->overrun_count.load(std::memory_order_relaxed);
+}
+
+uint64_t AudioFifo::GetOverrunBytes() const {
+  return header_->overrun_bytes.load(std::memory_order_relaxed);
+}
+
+uint64_t AudioFifo::GetUnderrunCount() const {
+  return header_->underrun_count.load(std::memory_order_relaxed);
+}
+
+uint64_t AudioFifo::GetUnderrunBytes() const {
+  return header_->underrun_bytes.load(std::memory_order_relaxed);
+}
+
+}  // namespace udrv
+}  // namespace bluetooth
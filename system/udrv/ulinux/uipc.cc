@@ -199,6 +199,7 @@ static int uipc_main_init(tUIPC_STATE& uipc) {
     p->fd = UIPC_DISCONNECTED;
     p->task_evt_flags = 0;
     p->cback = NULL;
+    p->fifo = NULL;
   }
 
   return 0;
@@ -392,6 +393,9 @@ static int uipc_close_ch_locked(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id) {
     wakeup = 1;
   }
 
+  delete uipc.ch[ch_id].fifo;
+  uipc.ch[ch_id].fifo = NULL;
+
   /* notify this connection is closed */
   if (uipc.ch[ch_id].cback) uipc.ch[ch_id].cback(ch_id, UIPC_CLOSE_EVT);
 
@@ -593,6 +597,49 @@ bool UIPC_Send(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id,
   return true;
 }
 
+/*******************************************************************************
+ **
+ ** Function         UIPC_SendFd
+ **
+ ** Description      Called to transmit a message over UIPC along with a file
+ **                  descriptor.
+ **
+ ** Returns          true in case of success, false in case of failure.
+ **
+ ******************************************************************************/
+bool UIPC_SendFd(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id, const uint8_t* p_buf,
+                 uint16_t msglen, int fd) {
+  LOG_DEBUG("UIPC_SendFd : ch_id:%d %d bytes fd:%d", ch_id, msglen, fd);
+
+  std::lock_guard<std::recursive_mutex> lock(uipc.mutex);
+
+  struct iovec iov = {
+      .iov_base = const_cast<uint8_t*>(p_buf),
+      .iov_len = msglen,
+  };
+  char control[CMSG_SPACE(sizeof(int))] = {};
+  struct msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+  ssize_t ret;
+  OSI_NO_INTR(ret = sendmsg(uipc.ch[ch_id].fd, &msg, MSG_NOSIGNAL));
+  if (ret < 0) {
+    LOG_ERROR("failed to write (%s)", strerror(errno));
+    return false;
+  }
+
+  return true;
+}
+
 /*******************************************************************************
  **
  ** Function         UIPC_Read
@@ -610,6 +657,14 @@ uint32_t UIPC_Read(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id, uint8_t* p_buf,
     return 0;
   }
 
+  {
+    /* The FIFO is released when the channel is closed */
+    std::lock_guard<std::recursive_mutex> lock(uipc.mutex);
+    if (uipc.ch[ch_id].fifo != NULL) {
+      return uipc.ch[ch_id].fifo->Read(p_buf, len);
+    }
+  }
+
   int n_read = 0;
   int fd = uipc.ch[ch_id].fd;
   struct pollfd pfd;
@@ -703,6 +758,13 @@ bool UIPC_Ioctl(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id, uint32_t request,
                 uipc.ch[ch_id].read_poll_tmo_ms);
       break;
 
+    case UIPC_SET_AUDIO_FIFO:
+      delete uipc.ch[ch_id].fifo;
+      uipc.ch[ch_id].fifo = static_cast<bluetooth::udrv::AudioFifo*>(param);
+      LOG_DEBUG("UIPC_SET_AUDIO_FIFO : CH %d, %zu bytes", ch_id,
+                param ? uipc.ch[ch_id].fifo->GetCapacity() : 0);
+      break;
+
     default:
       LOG_DEBUG("UIPC_Ioctl : request not handled (%d)", request);
       break;
@@ -50,6 +50,9 @@ DEFINE_bool(enable_baseband_sniffer, false, "enable baseband sniffer");
 DEFINE_bool(enable_pcap_filter, false, "enable PCAP filter");
 DEFINE_bool(disable_address_reuse, false,
             "prevent rootcanal from reusing device addresses");
+DEFINE_bool(enable_virtual_time, false,
+            "run the model in virtual time, skipping idle periods");
+DEFINE_uint32(tick_threads, 1, "number of threads ticking the devices");
 DEFINE_uint32(test_port, 6401, "test tcp port");
 DEFINE_uint32(hci_port, 6402, "hci server tcp port");
 DEFINE_uint32(link_port, 6403, "link server tcp port");
@@ -140,7 +143,8 @@ int main(int argc, char** argv) {
       static_cast<int>(FLAGS_link_port), static_cast<int>(FLAGS_link_ble_port),
       configuration_str, FLAGS_enable_hci_sniffer,
       FLAGS_enable_baseband_sniffer, FLAGS_enable_pcap_filter,
-      FLAGS_disable_address_reuse);
+      FLAGS_disable_address_reuse, FLAGS_enable_virtual_time,
+      static_cast<size_t>(FLAGS_tick_threads));
 
   std::promise<void> barrier;
   std::future<void> barrier_future = barrier.get_future();
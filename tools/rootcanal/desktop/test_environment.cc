@@ -63,7 +63,8 @@ TestEnvironment::TestEnvironment(
     int test_port, int hci_port, int link_port, int link_ble_port,
     const std::string& config_str,
     bool enable_hci_sniffer, bool enable_baseband_sniffer,
-    bool enable_pcap_filter, bool disable_address_reuse)
+    bool enable_pcap_filter, bool disable_address_reuse,
+    bool enable_virtual_time, size_t tick_threads)
     : enable_hci_sniffer_(enable_hci_sniffer),
       enable_baseband_sniffer_(enable_baseband_sniffer),
       enable_pcap_filter_(enable_pcap_filter) {
@@ -72,6 +73,8 @@ TestEnvironment::TestEnvironment(
   link_ble_socket_server_ = open_server(&async_manager_, link_ble_port);
   connector_ = open_connector(&async_manager_);
   test_model_.SetReuseDeviceAddresses(!disable_address_reuse);
+  test_model_.SetVirtualTime(enable_virtual_time);
+  test_model_.SetTickThreads(tick_threads);
 
   // Get a user ID for tasks scheduled within the test environment.
   socket_user_id_ = async_manager_.GetNextUserId();
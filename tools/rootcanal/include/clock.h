@@ -0,0 +1,80 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+namespace rootcanal {
+
+// Time source of the device and controller models.
+//
+// By default the clock follows the steady clock. In virtual time mode
+// the clock is frozen between two ticks of the test model, and advances
+// by exactly one timer period on each tick: the timing of the simulated
+// devices is then independent of the load of the host, and idle periods
+// can be skipped by ticking the model faster than real time.
+class Clock {
+ public:
+  using duration = std::chrono::steady_clock::duration;
+  using time_point = std::chrono::steady_clock::time_point;
+
+  static time_point now() {
+    if (virtual_time_.load(std::memory_order_acquire)) {
+      return time_point(duration(now_.load(std::memory_order_relaxed)));
+    }
+    return std::chrono::steady_clock::now() +
+           duration(offset_.load(std::memory_order_relaxed));
+  }
+
+  static bool IsVirtualTime() {
+    return virtual_time_.load(std::memory_order_acquire);
+  }
+
+  // Enable or disable virtual time. The clock stays monotonic across
+  // the transition: virtual time starts from the current time, and real
+  // time resumes from the last virtual time if it ran ahead.
+  static void SetVirtualTime(bool enable) {
+    if (enable == IsVirtualTime()) {
+      return;
+    }
+    if (enable) {
+      now_.store(now().time_since_epoch().count(), std::memory_order_relaxed);
+    } else {
+      duration ahead = duration(now_.load(std::memory_order_relaxed)) -
+                       std::chrono::steady_clock::now().time_since_epoch();
+      if (ahead > duration(offset_.load(std::memory_order_relaxed))) {
+        offset_.store(ahead.count(), std::memory_order_relaxed);
+      }
+    }
+    virtual_time_.store(enable, std::memory_order_release);
+  }
+
+  // Advance the virtual time. No-op in real time mode.
+  static void Advance(duration delta) {
+    if (IsVirtualTime()) {
+      now_.fetch_add(delta.count(), std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  static inline std::atomic<bool> virtual_time_{false};
+  static inline std::atomic<duration::rep> now_{0};
+  static inline std::atomic<duration::rep> offset_{0};
+};
+
+}  // namespace rootcanal
@@ -25,6 +25,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <mutex>
 #include <optional>
 
 namespace rootcanal::log {
@@ -34,6 +35,9 @@ static bool enable_log_color = true;
 
 void SetLogColorEnable(bool enable) { enable_log_color = enable; }
 
+// Serializes the log lines of the threads ticking the devices.
+static std::mutex log_mutex;
+
 static std::array<char, 5> verbosity_tag = {'D', 'I', 'W', 'E', 'F'};
 
 static std::array<fmt::text_style, 5> text_style = {
@@ -58,6 +62,8 @@ static std::array<fmt::color, 16> text_color = {
 void VLog(Verbosity verb, char const* file, int line,
           std::optional<int> instance, char const* format,
           fmt::format_args args) {
+  std::lock_guard<std::mutex> lock(log_mutex);
+
   // Generate the time label.
   auto now = std::chrono::system_clock::now();
   auto now_ms = std::chrono::time_point_cast<std::chrono::milliseconds>(now);
@@ -76,6 +76,11 @@ void DualModeController::ReceiveLinkLayerPacket(
   link_layer_controller_.IncomingPacket(incoming, rssi);
 }
 
+bool DualModeController::IsInterestedIn(
+    model::packets::PacketType type, Address const& /*destination*/) const {
+  return link_layer_controller_.IsInterestedIn(type);
+}
+
 void DualModeController::Tick() { link_layer_controller_.Tick(); }
 
 void DualModeController::Close() {
@@ -76,6 +76,9 @@ class DualModeController : public Device {
   void ReceiveLinkLayerPacket(model::packets::LinkLayerPacketView incoming,
                               Phy::Type type, int8_t rssi) override;
 
+  bool IsInterestedIn(model::packets::PacketType type,
+                      Address const& destination) const override;
+
   void Tick() override;
   void Close() override;
 
@@ -19,6 +19,7 @@
 #include <android-base/logging.h>
 
 #include <iostream>
+#include <random>
 
 #include "model/controller/dual_mode_controller.h"
 
@@ -136,7 +137,9 @@ __attribute__((visibility("default"))) void ffi_generate_rpa(
     uint8_t const irk_[16], uint8_t rpa[6]) {
   std::array<uint8_t, LinkLayerController::kIrkSize> irk;
   memcpy(irk.data(), irk_, LinkLayerController::kIrkSize);
-  Address address = LinkLayerController::generate_rpa(irk);
+  // Random value generator, always seeded with 0 to be deterministic.
+  static std::mt19937_64 random_generator{};
+  Address address = LinkLayerController::generate_rpa(irk, random_generator);
   memcpy(rpa, address.data(), Address::kLength);
 }
 
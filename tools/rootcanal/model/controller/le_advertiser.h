@@ -22,6 +22,7 @@
 #include <ratio>
 #include <vector>
 
+#include "clock.h"
 #include "hci/address.h"
 #include "hci/address_with_type.h"
 #include "packets/hci_packets.h"
@@ -113,13 +114,13 @@ class ExtendedAdvertiser : public Advertiser {
   void Enable() {
     advertising_enable = true;
     periodic_advertising_enable_latch = periodic_advertising_enable;
-    next_event = std::chrono::steady_clock::now();
+    next_event = Clock::now();
   }
 
   void EnablePeriodic() {
     periodic_advertising_enable = true;
     periodic_advertising_enable_latch = advertising_enable;
-    next_periodic_event = std::chrono::steady_clock::now();
+    next_periodic_event = Clock::now();
   }
 
   void DisablePeriodic() {
@@ -30,6 +30,7 @@
 #include <utility>
 #include <vector>
 
+#include "clock.h"
 #include "crypto/crypto.h"
 #include "hci/address.h"
 #include "hci/address_with_type.h"
@@ -267,7 +268,8 @@ LinkLayerController::GenerateResolvablePrivateAddress(AddressWithType address,
         address.ToPeerAddressType() == entry.peer_identity_address_type) {
       std::array<uint8_t, LinkLayerController::kIrkSize> const& used_irk =
           irk == IrkSelection::Local ? entry.local_irk : entry.peer_irk;
-      Address local_resolvable_address = generate_rpa(used_irk);
+      Address local_resolvable_address =
+          generate_rpa(used_irk, random_generator_);
 
       // Update the local resolvable address used for the peer
       // with the returned identity address.
@@ -1500,7 +1502,7 @@ ErrorCode LinkLayerController::LeSetExtendedScanEnable(
   scanner_.duration = duration_ms;
   scanner_.period = period_ms;
 
-  auto now = std::chrono::steady_clock::now();
+  auto now = Clock::now();
 
   // At the end of a single scan (Duration non-zero but Period zero), an
   // HCI_LE_Scan_Timeout event shall be generated.
@@ -2027,7 +2029,8 @@ LinkLayerController::LinkLayerController(const Address& address,
       address_(address),
       properties_(properties),
       lm_(nullptr, link_manager_destroy),
-      ll_(nullptr, link_layer_destroy) {
+      ll_(nullptr, link_layer_destroy),
+      random_generator_(id) {
   if (properties_.quirks.has_default_random_address) {
     WARNING(id_, "Configuring a default random address for this controller");
     random_address_ = Address { 0xba, 0xdb, 0xad, 0xba, 0xdb, 0xad };
@@ -2271,6 +2274,24 @@ ErrorCode LinkLayerController::SendScoToRemote(
   return ErrorCode::SUCCESS;
 }
 
+bool LinkLayerController::IsInterestedIn(
+    model::packets::PacketType type) const {
+  switch (type) {
+    case model::packets::PacketType::LE_LEGACY_ADVERTISING_PDU:
+    case model::packets::PacketType::LE_EXTENDED_ADVERTISING_PDU:
+      return scanner_.IsEnabled() || initiator_.IsEnabled();
+    case model::packets::PacketType::LE_PERIODIC_ADVERTISING_PDU:
+    case model::packets::PacketType::LE_SCAN_RESPONSE:
+      return scanner_.IsEnabled();
+    case model::packets::PacketType::INQUIRY:
+      return inquiry_scan_enable_;
+    case model::packets::PacketType::PAGE:
+      return page_scan_enable_;
+    default:
+      return true;
+  }
+}
+
 void LinkLayerController::IncomingPacket(
     model::packets::LinkLayerPacketView incoming, int8_t rssi) {
   ASSERT(incoming.IsValid());
@@ -2846,19 +2867,20 @@ void LinkLayerController::IncomingInquiryResponsePacket(
 }
 
 Address LinkLayerController::generate_rpa(
-    std::array<uint8_t, LinkLayerController::kIrkSize> irk) {
+    std::array<uint8_t, LinkLayerController::kIrkSize> irk,
+    std::mt19937_64& random_generator) {
   // most significant bit, bit7, bit6 is 01 to be resolvable random
   // Bits of the random part of prand shall not be all 1 or all 0
   std::array<uint8_t, 3> prand;
-  prand[0] = std::rand();
-  prand[1] = std::rand();
-  prand[2] = std::rand();
+  prand[0] = random_generator();
+  prand[1] = random_generator();
+  prand[2] = random_generator();
 
   constexpr uint8_t BLE_RESOLVE_ADDR_MSB = 0x40;
   prand[2] &= ~0xC0;  // BLE Address mask
   if ((prand[0] == 0x00 && prand[1] == 0x00 && prand[2] == 0x00) ||
       (prand[0] == 0xFF && prand[1] == 0xFF && prand[2] == 0x3F)) {
-    prand[0] = (uint8_t)(std::rand() % 0xFE + 1);
+    prand[0] = (uint8_t)(random_generator() % 0xFE + 1);
   }
   prand[2] |= BLE_RESOLVE_ADDR_MSB;
 
@@ -3167,8 +3189,7 @@ void LinkLayerController::ScanIncomingLeLegacyAdvertisingPdu(
     scanner_.connectable_scan_response = connectable_advertising;
     scanner_.extended_scan_response = false;
     scanner_.pending_scan_request = advertising_address;
-    scanner_.pending_scan_request_timeout =
-        std::chrono::steady_clock::now() + kScanRequestTimeout;
+    scanner_.pending_scan_request_timeout = Clock::now() + kScanRequestTimeout;
 
     INFO(id_,
          "Sending LE Scan request to advertising address {} with scanning "
@@ -3872,8 +3893,7 @@ void LinkLayerController::IncomingLePeriodicAdvertisingPdu(
              .advertising_sid = advertising_sid,
              .sync_handle = sync_handle,
              .sync_timeout = synchronizing_->sync_timeout,
-             .timeout = std::chrono::steady_clock::now() +
-                        synchronizing_->sync_timeout,
+             .timeout = Clock::now() + synchronizing_->sync_timeout,
          }});
 
     // Quit synchronizing state.
@@ -3924,7 +3944,7 @@ void LinkLayerController::IncomingLePeriodicAdvertisingPdu(
     }
 
     // Refresh the timeout for the sync disconnection.
-    sync.timeout = std::chrono::steady_clock::now() + sync.sync_timeout;
+    sync.timeout = Clock::now() + sync.sync_timeout;
   }
 }
 
@@ -5003,7 +5023,7 @@ void LinkLayerController::LeScanning() {
     return;
   }
 
-  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point now = Clock::now();
 
   // Extended Scanning Timeout
 
@@ -5055,7 +5075,7 @@ void LinkLayerController::LeScanning() {
 void LinkLayerController::LeSynchronization() {
   std::vector<uint16_t> removed_sync_handles;
   for (auto& [_, sync] : synchronized_) {
-    if (sync.timeout > std::chrono::steady_clock::now()) {
+    if (sync.timeout > Clock::now()) {
       INFO(id_, "Periodic advertising sync with handle 0x{:x} lost",
            sync.sync_handle);
       removed_sync_handles.push_back(sync.sync_handle);
@@ -5416,7 +5436,7 @@ ErrorCode LinkLayerController::CreateConnection(const Address& bd_addr,
     return ErrorCode::CONNECTION_ALREADY_EXISTS;
   }
 
-  auto now = std::chrono::steady_clock::now();
+  auto now = Clock::now();
   page_ = Page{
       .bd_addr = bd_addr,
       .allow_role_switch = allow_role_switch,
@@ -6074,7 +6094,7 @@ void LinkLayerController::Reset() {
   initiator_ = Initiator{};
   synchronizing_ = {};
   synchronized_ = {};
-  last_inquiry_ = steady_clock::now();
+  last_inquiry_ = Clock::now();
   inquiry_mode_ = InquiryType::STANDARD;
   inquiry_lap_ = 0;
   inquiry_max_responses_ = 0;
@@ -6099,7 +6119,7 @@ void LinkLayerController::Reset() {
 
 /// Drive the logic for the Page controller substate.
 void LinkLayerController::Paging() {
-  auto now = std::chrono::steady_clock::now();
+  auto now = Clock::now();
 
   if (page_.has_value() && now >= page_->page_timeout) {
     INFO("page timeout triggered for connection with {}",
@@ -6158,7 +6178,7 @@ void LinkLayerController::SetInquiryMaxResponses(uint8_t max) {
 }
 
 void LinkLayerController::Inquiry() {
-  steady_clock::time_point now = steady_clock::now();
+  steady_clock::time_point now = Clock::now();
   if (duration_cast<milliseconds>(now - last_inquiry_) < milliseconds(2000)) {
     return;
   }
@@ -6404,8 +6424,7 @@ TaskId LinkLayerController::NextTaskId() {
 TaskId LinkLayerController::ScheduleTask(std::chrono::milliseconds delay,
                                          TaskCallback task_callback) {
   TaskId task_id = NextTaskId();
-  task_queue_.emplace(std::chrono::steady_clock::now() + delay,
-                      std::move(task_callback), task_id);
+  task_queue_.emplace(Clock::now() + delay, std::move(task_callback), task_id);
   return task_id;
 }
 
@@ -6413,7 +6432,7 @@ TaskId LinkLayerController::SchedulePeriodicTask(
     std::chrono::milliseconds delay, std::chrono::milliseconds period,
     TaskCallback task_callback) {
   TaskId task_id = NextTaskId();
-  task_queue_.emplace(std::chrono::steady_clock::now() + delay, period,
+  task_queue_.emplace(Clock::now() + delay, period,
                       std::move(task_callback), task_id);
   return task_id;
 }
@@ -6429,7 +6448,7 @@ void LinkLayerController::CancelScheduledTask(TaskId task_id) {
 }
 
 void LinkLayerController::RunPendingTasks() {
-  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point now = Clock::now();
   while (!task_queue_.empty()) {
     auto it = task_queue_.begin();
     if (it->time > now) {
@@ -26,6 +26,7 @@
 #include <functional>
 #include <memory>
 #include <optional>
+#include <random>
 #include <set>
 #include <unordered_map>
 #include <utility>
@@ -73,8 +74,10 @@ class LinkLayerController {
   const uint32_t id_;
 
   // Generate a resolvable private address using the specified IRK.
+  // The random part of the address is drawn from random_generator.
   static Address generate_rpa(
-      std::array<uint8_t, LinkLayerController::kIrkSize> irk);
+      std::array<uint8_t, LinkLayerController::kIrkSize> irk,
+      std::mt19937_64& random_generator);
 
   // Return true if the input IRK is all 0s.
   static bool irk_is_zero(std::array<uint8_t, LinkLayerController::kIrkSize> irk);
@@ -156,6 +159,10 @@ class LinkLayerController {
   void IncomingPacket(model::packets::LinkLayerPacketView incoming,
                       int8_t rssi);
 
+  // Return false for the broadcast packets that are ignored in the
+  // current scanning, initiating, page scan and inquiry scan states.
+  bool IsInterestedIn(model::packets::PacketType type) const;
+
   void Tick();
 
   void Close();
@@ -991,6 +998,11 @@ class LinkLayerController {
   uint32_t oob_id_{1};
   uint32_t key_id_{1};
 
+  // Random value generator, seeded with the instance identifier to be
+  // deterministic. The controllers can tick on different threads and
+  // must not share a generator.
+  std::mt19937_64 random_generator_;
+
   struct FilterAcceptListEntry {
     FilterAcceptListAddressType address_type;
     Address address;
@@ -22,6 +22,7 @@
 #include <utility>
 #include <vector>
 
+#include "clock.h"
 #include "hci/address.h"
 #include "model/setup/device_boutique.h"
 #include "packets/link_layer_packets.h"
@@ -56,7 +57,7 @@ Beacon::Beacon(const std::vector<std::string>& args) : Beacon() {
 }
 
 void Beacon::Tick() {
-  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point now = Clock::now();
   if ((now - advertising_last_) >= advertising_interval_) {
     advertising_last_ = now;
     SendLinkLayerPacket(
@@ -68,6 +69,11 @@ void Beacon::Tick() {
   }
 }
 
+bool Beacon::IsInterestedIn(PacketType type, Address const& destination) const {
+  // Beacons only respond to scan requests.
+  return type == PacketType::LE_SCAN && destination == address_;
+}
+
 void Beacon::ReceiveLinkLayerPacket(LinkLayerPacketView packet,
                                     Phy::Type /*type*/, int8_t /*rssi*/) {
   if (packet.GetDestinationAddress() == address_ &&
@@ -47,6 +47,8 @@ class Beacon : public Device {
   virtual void ReceiveLinkLayerPacket(
       model::packets::LinkLayerPacketView packet, Phy::Type type,
       int8_t rssi) override;
+  virtual bool IsInterestedIn(model::packets::PacketType type,
+                              Address const& destination) const override;
 
  protected:
   model::packets::LegacyAdvertisingType advertising_type_{};
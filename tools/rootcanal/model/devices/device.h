@@ -55,10 +55,24 @@ class Device {
   virtual void Tick() {}
   virtual void Close();
 
+  // Return false if the device exchanged packets with the outside of the
+  // model since the last call to ResetIdle, e.g. HCI packets with the host
+  // stack.
+  virtual bool IsIdle() const { return true; }
+  virtual void ResetIdle() {}
+
   virtual void ReceiveLinkLayerPacket(
       model::packets::LinkLayerPacketView /*packet*/, Phy::Type /*type*/,
       int8_t /*rssi*/) {}
 
+  // Return false if the device ignores link layer packets of the selected
+  // type sent to the selected destination address. The phy layers skip
+  // the delivery of these packets to the device.
+  virtual bool IsInterestedIn(model::packets::PacketType /*type*/,
+                              Address const& /*destination*/) const {
+    return true;
+  }
+
   void SendLinkLayerPacket(
       std::shared_ptr<model::packets::LinkLayerPacketBuilder> packet,
       Phy::Type type, int8_t tx_power = 0);
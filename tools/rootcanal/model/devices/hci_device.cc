@@ -62,21 +62,26 @@ HciDevice::HciDevice(std::shared_ptr<HciTransport> transport,
   }));
 
   RegisterEventChannel([this](std::shared_ptr<std::vector<uint8_t>> packet) {
+    idle_ = false;
     transport_->Send(PacketType::EVENT, *packet);
   });
   RegisterAclChannel([this](std::shared_ptr<std::vector<uint8_t>> packet) {
+    idle_ = false;
     transport_->Send(PacketType::ACL, *packet);
   });
   RegisterScoChannel([this](std::shared_ptr<std::vector<uint8_t>> packet) {
+    idle_ = false;
     transport_->Send(PacketType::SCO, *packet);
   });
   RegisterIsoChannel([this](std::shared_ptr<std::vector<uint8_t>> packet) {
+    idle_ = false;
     transport_->Send(PacketType::ISO, *packet);
   });
 
   transport_->RegisterCallbacks(
       [this](PacketType packet_type,
              const std::shared_ptr<std::vector<uint8_t>> packet) {
+        idle_ = false;
         switch (packet_type) {
           case PacketType::COMMAND:
             HandleCommand(packet);
@@ -43,8 +43,14 @@ class HciDevice : public DualModeController {
 
   void Close() override;
 
+  bool IsIdle() const override { return idle_; }
+  void ResetIdle() override { idle_ = true; }
+
  private:
   std::shared_ptr<HciTransport> transport_;
+
+  // Cleared when HCI packets are received from or sent to the host.
+  bool idle_{true};
 };
 
 }  // namespace rootcanal
@@ -21,11 +21,17 @@
 #include <condition_variable>
 #include <fcntl.h>
 #include <mutex>
-#include <sys/select.h>
 #include <thread>
 #include <unistd.h>
+#include <unordered_map>
 #include <vector>
 
+#ifdef __linux__
+#include <sys/epoll.h>
+#else
+#include <sys/select.h>
+#endif
+
 #include "log.h"
 
 #ifndef TEMP_FAILURE_RETRY
@@ -49,14 +55,18 @@ namespace rootcanal {
 // After construction of this objects nothing happens beyond some very simple
 // member initialization. When the first FD is set up for watching the object
 // starts a new thread which watches the given (and later provided) FDs using
-// select() inside a loop. A special FD (a pipe) is also watched which is
+// epoll_wait() (select() on platforms other than Linux) inside a loop. The
+// epoll interest list is updated directly when FDs are added or removed, so
+// the cost of a wakeup depends only on the number of ready FDs, and FDs are
+// not limited to FD_SETSIZE. A special FD (a pipe) is also watched which is
 // used to notify the thread of internal changes on the object state (like
-// the addition of new FDs to watch on). Every access to internal state is
-// synchronized using a single internal mutex. The thread is only stopped on
-// destruction of the object, by modifying a flag, which is the only member
-// variable accessed without acquiring the lock (because the notification to
-// the thread is done later by writing to a pipe which means the thread will
-// be notified regardless of what phase of the loop it is in that moment)
+// the addition of new FDs to watch on with select(), or a stop request).
+// Every access to internal state is synchronized using a single internal
+// mutex. The thread is only stopped on destruction of the object, by
+// modifying a flag, which is the only member variable accessed without
+// acquiring the lock (because the notification to the thread is done later
+// by writing to a pipe which means the thread will be notified regardless of
+// what phase of the loop it is in that moment)
 
 // The scheduling of asynchronous tasks, periodic or not, is handled by the
 // AsyncTaskManager class. Like the one for FDs, this class shares no internal
@@ -101,6 +111,12 @@ static inline AsyncTaskId NextAsyncTaskId(const AsyncTaskId id) {
 // no need to treat that case.
 static const int kNotificationBufferSize = 10;
 
+#ifdef __linux__
+// Maximum number of ready FDs returned by a single call to epoll_wait.
+// Remaining ready FDs are returned by the next calls.
+static const int kMaxEpollEvents = 64;
+#endif
+
 // Async File Descriptor Watcher Implementation:
 class AsyncManager::AsyncFdWatcher {
  public:
@@ -119,22 +135,58 @@ class AsyncManager::AsyncFdWatcher {
       return started;
     }
 
+#ifdef __linux__
+    // add the FD to the interest list, the thread does not need to be
+    // notified
+    if (addToEpollSet(file_descriptor) != 0) {
+      ERROR("{}: Unable to watch fd {}: {}", __func__, file_descriptor,
+            strerror(errno));
+      std::unique_lock<std::recursive_mutex> guard(internal_mutex_);
+      watched_shared_fds_.erase(file_descriptor);
+      return -1;
+    }
+#else
     // notify the thread so that it knows of the new FD
     notifyThread();
+#endif
 
     return 0;
   }
 
   void StopWatchingFileDescriptor(int file_descriptor) {
     std::unique_lock<std::recursive_mutex> guard(internal_mutex_);
-    watched_shared_fds_.erase(file_descriptor);
+    if (watched_shared_fds_.erase(file_descriptor) == 0) {
+      return;
+    }
+#ifdef __linux__
+    // Fails if the FD was already closed, which removed it from the
+    // interest list.
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, file_descriptor, nullptr);
+#endif
   }
 
+#ifdef __linux__
+  AsyncFdWatcher() : epoll_fd_(epoll_create1(EPOLL_CLOEXEC)) {
+    if (epoll_fd_ < 0) {
+      ERROR("{}: Unable to create the epoll instance: {}", __func__,
+            strerror(errno));
+    }
+  }
+#else
   AsyncFdWatcher() = default;
+#endif
   AsyncFdWatcher(const AsyncFdWatcher&) = delete;
   AsyncFdWatcher& operator=(const AsyncFdWatcher&) = delete;
 
+#ifdef __linux__
+  ~AsyncFdWatcher() {
+    if (epoll_fd_ >= 0) {
+      close(epoll_fd_);
+    }
+  }
+#else
   ~AsyncFdWatcher() = default;
+#endif
 
   int stopThread() {
     if (!std::atomic_exchange(&running_, false)) {
@@ -152,6 +204,13 @@ class AsyncManager::AsyncFdWatcher {
 
     {
       std::unique_lock<std::recursive_mutex> guard(internal_mutex_);
+#ifdef __linux__
+      // empty the interest list in case the thread is started again
+      for (auto& fdp : watched_shared_fds_) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fdp.first, nullptr);
+      }
+      epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, notification_listen_fd_, nullptr);
+#endif
       watched_shared_fds_.clear();
     }
 
@@ -187,6 +246,16 @@ class AsyncManager::AsyncFdWatcher {
     notification_listen_fd_ = pipe_fds[0];
     notification_write_fd_ = pipe_fds[1];
 
+#ifdef __linux__
+    if (addToEpollSet(notification_listen_fd_) != 0) {
+      ERROR(
+          "{}: Unable to watch the communication channel to the reading "
+          "thread: {}",
+          __func__, strerror(errno));
+      return -1;
+    }
+#endif
+
     thread_ = std::thread([this]() { ThreadRoutine(); });
     if (!thread_.joinable()) {
       ERROR("{}: Unable to start reading thread", __func__);
@@ -204,6 +273,78 @@ class AsyncManager::AsyncFdWatcher {
     return 0;
   }
 
+  // read everything there is on the comm channel
+  void consumeThreadNotifications() const {
+    char buffer[kNotificationBufferSize];
+    while (TEMP_FAILURE_RETRY(read(notification_listen_fd_, buffer,
+                                   kNotificationBufferSize)) ==
+           kNotificationBufferSize) {
+    }
+  }
+
+  // call the callback of a FD ready for reading, if it is still watched
+  void runCallback(int file_descriptor) {
+    auto it = watched_shared_fds_.find(file_descriptor);
+    if (it == watched_shared_fds_.end()) {
+      return;
+    }
+    // the callback is copied as it may stop watching its own FD
+    ReadCallback callback = it->second;
+    callback(file_descriptor);
+  }
+
+#ifdef __linux__
+  int addToEpollSet(int file_descriptor) {
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = file_descriptor;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, file_descriptor, &event) == 0) {
+      return 0;
+    }
+    // The FD was already added, e.g. if it is watched again with a new
+    // callback.
+    if (errno == EEXIST) {
+      return epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, file_descriptor, &event);
+    }
+    return -1;
+  }
+
+  void ThreadRoutine() {
+    struct epoll_event events[kMaxEpollEvents];
+    while (running_) {
+      // wait until there is data available to read on some FD, only the
+      // ready FDs are returned
+      int nevents = epoll_wait(epoll_fd_, events, kMaxEpollEvents, -1);
+      if (nevents < 0) {
+        if (errno != EINTR) {
+          ERROR(
+              "{}: There was an error while waiting for data on the file "
+              "descriptors: {}",
+              __func__, strerror(errno));
+        }
+        continue;
+      }
+
+      for (int i = 0; i < nevents; i++) {
+        if (events[i].data.fd == notification_listen_fd_) {
+          consumeThreadNotifications();
+        }
+      }
+
+      // Do not read if there was a call to stop running
+      if (!running_) {
+        break;
+      }
+
+      std::unique_lock<std::recursive_mutex> guard(internal_mutex_);
+      for (int i = 0; i < nevents; i++) {
+        if (events[i].data.fd != notification_listen_fd_) {
+          runCallback(events[i].data.fd);
+        }
+      }
+    }
+  }
+#else
   int setUpFileDescriptorSet(fd_set& read_fds) {
     // add comm channel to the set
     FD_SET(notification_listen_fd_, &read_fds);
@@ -220,30 +361,17 @@ class AsyncManager::AsyncFdWatcher {
     return nfds;
   }
 
-  // check the comm channel and read everything there
-  bool consumeThreadNotifications(fd_set& read_fds) const {
-    if (FD_ISSET(notification_listen_fd_, &read_fds)) {
-      char buffer[kNotificationBufferSize];
-      while (TEMP_FAILURE_RETRY(read(notification_listen_fd_, buffer,
-                                     kNotificationBufferSize)) ==
-             kNotificationBufferSize) {
-      }
-      return true;
-    }
-    return false;
-  }
-
   // check all file descriptors and call callbacks if necesary
   void runAppropriateCallbacks(fd_set& read_fds) {
-    std::vector<decltype(watched_shared_fds_)::value_type> fds;
+    std::vector<int> fds;
     std::unique_lock<std::recursive_mutex> guard(internal_mutex_);
     for (auto& fdc : watched_shared_fds_) {
       if (FD_ISSET(fdc.first, &read_fds)) {
-        fds.push_back(fdc);
+        fds.push_back(fdc.first);
       }
     }
-    for (auto& p : fds) {
-      p.second(p.first);
+    for (int fd : fds) {
+      runCallback(fd);
     }
   }
 
@@ -263,7 +391,9 @@ class AsyncManager::AsyncFdWatcher {
         continue;
       }
 
-      consumeThreadNotifications(read_fds);
+      if (FD_ISSET(notification_listen_fd_, &read_fds)) {
+        consumeThreadNotifications();
+      }
 
       // Do not read if there was a call to stop running
       if (!running_) {
@@ -273,16 +403,22 @@ class AsyncManager::AsyncFdWatcher {
       runAppropriateCallbacks(read_fds);
     }
   }
+#endif
 
   std::atomic_bool running_{false};
   std::thread thread_;
   std::recursive_mutex internal_mutex_;
 
-  std::map<int, ReadCallback> watched_shared_fds_;
+  std::unordered_map<int, ReadCallback> watched_shared_fds_;
 
   // A pair of FD to send information to the reading thread
   int notification_listen_fd_{};
   int notification_write_fd_{};
+
+#ifdef __linux__
+  // The epoll instance watching the comm channel and the watched FDs
+  int epoll_fd_{-1};
+#endif
 };
 
 // Async task manager implementation
@@ -36,6 +36,10 @@ void PhyDevice::Unregister(PhyLayer* phy) { phy_layers_.erase(phy); }
 
 void PhyDevice::Tick() { device_->Tick(); }
 
+bool PhyDevice::IsIdle() const { return device_->IsIdle(); }
+
+void PhyDevice::ResetIdle() { device_->ResetIdle(); }
+
 bluetooth::hci::Address PhyDevice::GetAddress() const {
   return device_->GetAddress();
 }
@@ -56,14 +60,33 @@ void PhyDevice::Receive(std::vector<uint8_t> const& packet, Phy::Type type,
       model::packets::LinkLayerPacketView::Create(
           pdl::packet::slice(packet_copy));
   if (packet_view.IsValid()) {
-    device_->ReceiveLinkLayerPacket(std::move(packet_view), type, rssi);
+    Receive(packet_view, type, rssi);
   } else {
     WARNING("received invalid LL packet");
   }
 }
 
+void PhyDevice::Receive(model::packets::LinkLayerPacketView const& packet,
+                        Phy::Type type, int8_t rssi) {
+  if (deferred_) {
+    received_packets_.push_back({packet, type, rssi});
+  } else {
+    device_->ReceiveLinkLayerPacket(packet, type, rssi);
+  }
+}
+
+bool PhyDevice::IsInterestedIn(
+    model::packets::PacketType type,
+    bluetooth::hci::Address const& destination) const {
+  return device_->IsInterestedIn(type, destination);
+}
+
 void PhyDevice::Send(std::vector<uint8_t> const& packet, Phy::Type type,
                      int8_t tx_power) {
+  if (deferred_) {
+    sent_packets_.push_back({packet, type, tx_power});
+    return;
+  }
   for (auto const& phy : phy_layers_) {
     if (phy->type == type) {
       phy->Send(packet, tx_power, id);
@@ -71,6 +94,36 @@ void PhyDevice::Send(std::vector<uint8_t> const& packet, Phy::Type type,
   }
 }
 
+void PhyDevice::SetDeferred(bool deferred) {
+  deferred_ = deferred;
+  if (!deferred_) {
+    FlushSentPackets();
+    DeliverReceivedPackets();
+  }
+}
+
+size_t PhyDevice::FlushSentPackets() {
+  std::vector<SentPacket> sent_packets;
+  sent_packets.swap(sent_packets_);
+  for (auto const& sent : sent_packets) {
+    for (auto const& phy : phy_layers_) {
+      if (phy->type == sent.type) {
+        phy->Send(sent.packet, sent.tx_power, id);
+      }
+    }
+  }
+  return sent_packets.size();
+}
+
+void PhyDevice::DeliverReceivedPackets() {
+  std::vector<ReceivedPacket> received_packets;
+  received_packets.swap(received_packets_);
+  for (auto const& received : received_packets) {
+    device_->ReceiveLinkLayerPacket(received.packet, received.type,
+                                    received.rssi);
+  }
+}
+
 std::string PhyDevice::ToString() { return device_->ToString(); }
 
 }  // namespace rootcanal
@@ -18,6 +18,7 @@
 
 #include <cstdint>
 #include <unordered_set>
+#include <vector>
 
 #include "model/devices/device.h"
 #include "phy.h"
@@ -39,10 +40,28 @@ class PhyDevice {
   void Unregister(PhyLayer* phy);
 
   void Tick();
+  bool IsIdle() const;
+  void ResetIdle();
   void Receive(std::vector<uint8_t> const& packet, Phy::Type type, int8_t rssi);
+  void Receive(model::packets::LinkLayerPacketView const& packet,
+               Phy::Type type, int8_t rssi);
+  bool IsInterestedIn(model::packets::PacketType type,
+                      bluetooth::hci::Address const& destination) const;
   void Send(std::vector<uint8_t> const& packet, Phy::Type type,
             int8_t tx_power);
 
+  // In deferred mode the packets sent by the device are queued until
+  // FlushSentPackets(), and the packets sent to the device are queued until
+  // DeliverReceivedPackets(). This lets devices tick concurrently, with the
+  // packets exchanged between the ticks.
+  void SetDeferred(bool deferred);
+  // Forward the queued sent packets to the phy layers, in the order they
+  // were sent. Returns the number of forwarded packets.
+  size_t FlushSentPackets();
+  // Deliver the queued received packets to the device, in the order they
+  // were received.
+  void DeliverReceivedPackets();
+
   bluetooth::hci::Address GetAddress() const;
   std::shared_ptr<Device> GetDevice() const;
   void SetAddress(bluetooth::hci::Address address);
@@ -53,8 +72,24 @@ class PhyDevice {
   const std::string type;
 
  private:
+  struct SentPacket {
+    std::vector<uint8_t> packet;
+    Phy::Type type;
+    int8_t tx_power;
+  };
+
+  struct ReceivedPacket {
+    model::packets::LinkLayerPacketView packet;
+    Phy::Type type;
+    int8_t rssi;
+  };
+
   const std::shared_ptr<Device> device_;
   std::unordered_set<PhyLayer*> phy_layers_;
+
+  bool deferred_{false};
+  std::vector<SentPacket> sent_packets_;
+  std::vector<ReceivedPacket> received_packets_;
 };
 
 }  // namespace rootcanal
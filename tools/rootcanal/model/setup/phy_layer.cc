@@ -16,8 +16,13 @@
 
 #include "phy_layer.h"
 
+#include <packet_runtime.h>
+
+#include <memory>
 #include <sstream>
 
+#include "log.h"
+
 namespace rootcanal {
 
 PhyLayer::PhyLayer(Identifier id, Phy::Type type) : id(id), type(type) {}
@@ -57,10 +62,23 @@ int8_t PhyLayer::ComputeRssi(PhyDevice::Identifier /*sender_id*/,
 
 void PhyLayer::Send(std::vector<uint8_t> const& packet, int8_t tx_power,
                     PhyDevice::Identifier sender_id) {
+  // Parse the packet once, the view is shared by all the receivers.
+  model::packets::LinkLayerPacketView packet_view =
+      model::packets::LinkLayerPacketView::Create(
+          pdl::packet::slice(std::make_shared<std::vector<uint8_t>>(packet)));
+  if (!packet_view.IsValid()) {
+    WARNING("sent invalid LL packet");
+    return;
+  }
+
+  model::packets::PacketType packet_type = packet_view.GetType();
+  bluetooth::hci::Address destination = packet_view.GetDestinationAddress();
   for (const auto& device : phy_devices_) {
-    // Do not send the packet back to the sender.
-    if (sender_id != device->id) {
-      device->Receive(packet, type,
+    // Do not send the packet back to the sender, nor to devices
+    // that would ignore it.
+    if (sender_id != device->id &&
+        device->IsInterestedIn(packet_type, destination)) {
+      device->Receive(packet_view, type,
                       ComputeRssi(sender_id, device->id, tx_power));
     }
   }
@@ -54,6 +54,7 @@ TestCommandHandler::TestCommandHandler(TestModel& test_model)
   SET_HANDLER("set_timer_period", SetTimerPeriod);
   SET_HANDLER("start_timer", StartTimer);
   SET_HANDLER("stop_timer", StopTimer);
+  SET_HANDLER("set_virtual_time", SetVirtualTime);
   SET_HANDLER("reset", Reset);
 #undef SET_HANDLER
   send_response_ = [](std::string const&) {};
@@ -309,6 +310,18 @@ void TestCommandHandler::StopTimer(const vector<std::string>& args) {
   send_response_(response_string_);
 }
 
+void TestCommandHandler::SetVirtualTime(const vector<std::string>& args) {
+  if (args.size() != 1 || (args[0] != "true" && args[0] != "false")) {
+    response_string_ = "set_virtual_time takes 1 argument: true or false";
+    send_response_(response_string_);
+    return;
+  }
+  model_.SetVirtualTime(args[0] == "true");
+  response_string_ = "set virtual time to ";
+  response_string_ += args[0];
+  send_response_(response_string_);
+}
+
 void TestCommandHandler::Reset(const std::vector<std::string>& args) {
   if (!args.empty()) {
     INFO("Unused args: arg[0] = {}", args[0]);
@@ -82,6 +82,9 @@ class TestCommandHandler {
 
   void StopTimer(const std::vector<std::string>& args);
 
+  // Run the model in virtual time, see TestModel::SetVirtualTime
+  void SetVirtualTime(const std::vector<std::string>& args);
+
   void Reset(const std::vector<std::string>& args);
 
   // For manual testing
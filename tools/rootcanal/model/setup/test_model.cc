@@ -18,6 +18,7 @@
 
 #include <stdlib.h>  // for size_t
 
+#include <algorithm>    // for any_of
 #include <iomanip>      // for operator<<, setfill
 #include <iostream>     // for basic_ostream
 #include <memory>       // for shared_ptr, make...
@@ -26,6 +27,7 @@
 #include <utility>      // for move
 #include <optional>
 
+#include "clock.h"
 #include "include/phy.h"  // for Phy, Phy::Type
 #include "log.h"
 #include "phy_layer.h"
@@ -73,8 +75,35 @@ void TestModel::SetTimerPeriod(std::chrono::milliseconds new_period) {
   StartTimer();
 }
 
+void TestModel::SetVirtualTime(bool virtual_time) {
+  INFO("SetVirtualTime({})", virtual_time);
+  virtual_time_ = virtual_time;
+  Clock::SetVirtualTime(virtual_time);
+
+  if (timer_tick_task_ == kInvalidTaskId) {
+    return;
+  }
+
+  // Restart the timer in the new mode
+  StopTimer();
+  StartTimer();
+}
+
+void TestModel::SetTickThreads(size_t num_threads) {
+  INFO("SetTickThreads({})", num_threads);
+  bool parallel = num_threads > 1;
+  worker_pool_ = parallel ? std::make_unique<WorkerPool>(num_threads) : nullptr;
+  for (auto& [_, device] : phy_devices_) {
+    device->SetDeferred(parallel);
+  }
+}
+
 void TestModel::StartTimer() {
   INFO("StartTimer()");
+  if (virtual_time_) {
+    ScheduleVirtualTick(std::chrono::milliseconds(0));
+    return;
+  }
   timer_tick_task_ =
       schedule_periodic_task_(model_user_id_, std::chrono::milliseconds(0),
                               timer_period_, [this]() { TestModel::Tick(); });
@@ -128,6 +157,7 @@ PhyDevice::Identifier TestModel::AddDevice(std::shared_ptr<Device> device) {
   std::string device_type = device->GetTypeString();
   std::shared_ptr<PhyDevice> phy_device =
       CreatePhyDevice(device_type, std::move(device));
+  phy_device->SetDeferred(worker_pool_ != nullptr);
   phy_devices_[phy_device->id] = phy_device;
   return phy_device->id;
 }
@@ -274,11 +304,71 @@ const std::string& TestModel::List() {
 }
 
 void TestModel::Tick() {
+  if (worker_pool_ != nullptr) {
+    ParallelTick();
+    return;
+  }
   for (auto& [_, device] : phy_devices_) {
     device->Tick();
   }
 }
 
+void TestModel::ParallelTick() {
+  std::vector<std::shared_ptr<PhyDevice>> devices;
+  devices.reserve(phy_devices_.size());
+  for (auto& [_, device] : phy_devices_) {
+    devices.push_back(device);
+  }
+
+  size_t num_shards = worker_pool_->NumShards();
+  auto run_sharded = [&](auto const& task) {
+    worker_pool_->Run([&](size_t shard) {
+      for (size_t i = shard; i < devices.size(); i += num_shards) {
+        task(*devices[i]);
+      }
+    });
+  };
+
+  // The devices only touch their own state while ticking, and queue the
+  // packets they send. The packets are then exchanged on this thread, in
+  // device identifier order, and delivered in parallel. Devices replying
+  // to a packet are given more rounds until no packet is left in flight.
+  run_sharded([](PhyDevice& device) { device.Tick(); });
+  for (;;) {
+    size_t sent_packets = 0;
+    for (auto& device : devices) {
+      sent_packets += device->FlushSentPackets();
+    }
+    if (sent_packets == 0) {
+      break;
+    }
+    run_sharded([](PhyDevice& device) { device.DeliverReceivedPackets(); });
+  }
+}
+
+void TestModel::ScheduleVirtualTick(std::chrono::milliseconds delay) {
+  timer_tick_task_ = schedule_task_(model_user_id_, delay, [this]() {
+    Clock::Advance(timer_period_);
+    TestModel::Tick();
+
+    // The timer was stopped by one of the devices.
+    if (timer_tick_task_ == kInvalidTaskId) {
+      return;
+    }
+
+    // Skip ahead to the next tick when the devices are only waiting
+    // for the model time to pass. Otherwise, give the host stacks one
+    // real timer period to send the packets of this tick, or to react
+    // to the packets they received during this tick.
+    bool idle = true;
+    for (auto& [_, device] : phy_devices_) {
+      idle = idle && device->IsIdle();
+      device->ResetIdle();
+    }
+    ScheduleVirtualTick(idle ? std::chrono::milliseconds(0) : timer_period_);
+  });
+}
+
 void TestModel::Reset() {
   StopTimer();
   schedule_task_(model_user_id_, std::chrono::milliseconds(0), [this]() {
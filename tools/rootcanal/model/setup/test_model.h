@@ -28,6 +28,7 @@
 #include "hci/address.h"                       // for Address
 #include "model/devices/hci_device.h"          // for HciDevice
 #include "model/setup/async_manager.h"         // for AsyncUserId, AsyncTaskId
+#include "model/setup/worker_pool.h"
 #include "phy.h"                               // for Phy, Phy::Type
 #include "phy_layer.h"
 #include "rootcanal/configuration.pb.h"
@@ -107,6 +108,16 @@ class TestModel {
   void StopTimer();
   void SetTimerPeriod(std::chrono::milliseconds new_period);
 
+  // Run the model in virtual time: the model clock advances by one timer
+  // period on each tick, and the ticks are run back to back for as long
+  // as no device exchanges packets with the outside of the model.
+  void SetVirtualTime(bool virtual_time);
+
+  // Tick the devices on num_threads threads. The devices are sharded
+  // across the threads, and the link layer packets they exchange are
+  // delivered between the ticks in device identifier order.
+  void SetTickThreads(size_t num_threads);
+
   // List the devices that the test knows about
   const std::string& List();
 
@@ -115,6 +126,8 @@ class TestModel {
 
  private:
   Address GenerateBluetoothAddress(uint32_t device_id) const;
+  void ScheduleVirtualTick(std::chrono::milliseconds delay);
+  void ParallelTick();
 
   std::map<PhyLayer::Identifier, std::shared_ptr<PhyLayer>> phy_layers_;
   std::map<PhyDevice::Identifier, std::shared_ptr<PhyDevice>> phy_devices_;
@@ -143,6 +156,8 @@ class TestModel {
   AsyncUserId model_user_id_;
   AsyncTaskId timer_tick_task_{kInvalidTaskId};
   std::chrono::milliseconds timer_period_{};
+  bool virtual_time_{false};
+  std::unique_ptr<WorkerPool> worker_pool_;
 };
 
 }  // namespace rootcanal
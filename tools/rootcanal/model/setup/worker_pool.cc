@@ -0,0 +1,82 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "model/setup/worker_pool.h"
+
+#include <algorithm>
+
+namespace rootcanal {
+
+WorkerPool::WorkerPool(size_t num_shards)
+    : num_shards_(std::max<size_t>(num_shards, 1)) {
+  for (size_t shard = 1; shard < num_shards_; shard++) {
+    threads_.emplace_back([this, shard]() { WorkerRoutine(shard); });
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  start_cv_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkerPool::Run(std::function<void(size_t)> const& task) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    task_ = &task;
+    pending_shards_ = num_shards_ - 1;
+    generation_++;
+  }
+  start_cv_.notify_all();
+
+  task(0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this]() { return pending_shards_ == 0; });
+  task_ = nullptr;
+}
+
+void WorkerPool::WorkerRoutine(size_t shard) {
+  uint64_t generation = 0;
+  while (true) {
+    std::function<void(size_t)> const* task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_cv_.wait(lock, [this, generation]() {
+        return stopping_ || generation_ != generation;
+      });
+      if (stopping_) {
+        return;
+      }
+      generation = generation_;
+      task = task_;
+    }
+
+    (*task)(shard);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (--pending_shards_ == 0) {
+      done_cv_.notify_one();
+    }
+  }
+}
+
+}  // namespace rootcanal
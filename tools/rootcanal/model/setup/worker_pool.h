@@ -0,0 +1,62 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rootcanal {
+
+// Fixed pool of threads running the same task over a number of shards.
+// The calling thread runs the first shard and the pool threads run the
+// other ones. Run() returns once all the shards are completed, and thus
+// acts as a barrier between consecutive phases.
+class WorkerPool {
+ public:
+  explicit WorkerPool(size_t num_shards);
+  ~WorkerPool();
+
+  WorkerPool(WorkerPool const&) = delete;
+  WorkerPool& operator=(WorkerPool const&) = delete;
+
+  size_t NumShards() const { return num_shards_; }
+
+  // Run task(shard) for each shard in [0, NumShards()), and wait for the
+  // completion of all the shards.
+  void Run(std::function<void(size_t)> const& task);
+
+ private:
+  void WorkerRoutine(size_t shard);
+
+  const size_t num_shards_;
+  std::vector<std::thread> threads_;
+
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  std::function<void(size_t)> const* task_{nullptr};
+  uint64_t generation_{0};
+  size_t pending_shards_{0};
+  bool stopping_{false};
+};
+
+}  // namespace rootcanal
@@ -241,6 +241,12 @@ class TestChannelShell(cmd.Cmd):
     """
         self._test_channel.send_command('stop_timer', args.split())
 
+    def do_set_virtual_time(self, args):
+        """Arguments: true or false. Run the model in virtual time, skipping
+    idle periods.
+    """
+        self._test_channel.send_command('set_virtual_time', args.split())
+
     def do_wait(self, args):
         """Arguments: time in seconds (float).
     """
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <benchmark/benchmark.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "model/setup/async_manager.h"
+
+namespace rootcanal {
+namespace {
+
+// Wake up the fd watcher through one of `num_fds` watched sockets per
+// iteration, and wait for the read callback.
+void BM_WatchedFdWakeup(benchmark::State& state) {
+  size_t num_fds = state.range(0);
+
+  // Each socket pair uses two fds.
+  struct rlimit limit;
+  getrlimit(RLIMIT_NOFILE, &limit);
+  if (limit.rlim_cur < 2 * num_fds + 64) {
+    limit.rlim_cur = std::min<rlim_t>(limit.rlim_max, 2 * num_fds + 64);
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+
+  AsyncManager async_manager;
+  std::vector<std::array<int, 2>> sockets;
+  std::mutex mutex;
+  std::condition_variable cv;
+  size_t num_reads = 0;
+
+  for (size_t index = 0; index < num_fds; index++) {
+    std::array<int, 2> fds;
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds.data()) != 0) {
+      state.SkipWithError("Not enough file descriptors available");
+      break;
+    }
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    sockets.push_back(fds);
+    async_manager.WatchFdForNonBlockingReads(fds[0], [&](int fd) {
+      char byte;
+      (void)read(fd, &byte, 1);
+      std::unique_lock<std::mutex> lock(mutex);
+      num_reads++;
+      cv.notify_one();
+    });
+  }
+
+  size_t index = 0;
+  size_t num_writes = 0;
+  for (auto _ : state) {
+    (void)write(sockets[index][1], "x", 1);
+    index = (index + 1) % sockets.size();
+    num_writes++;
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return num_reads == num_writes; });
+  }
+
+  for (auto& fds : sockets) {
+    async_manager.StopWatchingFileDescriptor(fds[0]);
+    close(fds[0]);
+    close(fds[1]);
+  }
+}
+BENCHMARK(BM_WatchedFdWakeup)->Arg(10)->Arg(1000)->Arg(2000);
+
+}  // namespace
+}  // namespace rootcanal
+
+BENCHMARK_MAIN();
@@ -21,11 +21,14 @@
 #include <netdb.h>        // for gethostbyname, h_addr, hostent
 #include <netinet/in.h>   // for sockaddr_in, in_addr, INADDR_ANY
 #include <stdio.h>        // for printf
+#include <sys/resource.h>  // for getrlimit, setrlimit
 #include <sys/socket.h>   // for socket, AF_INET, accept, bind
 #include <sys/types.h>    // for in_addr_t
 #include <time.h>         // for NULL, size_t
 #include <unistd.h>       // for close, write, read
 
+#include <algorithm>           // for min
+#include <array>               // for array
 #include <condition_variable>  // for condition_variable
 #include <cstdint>             // for uint16_t
 #include <cstring>             // for memset, strcmp, strcpy, strlen
@@ -34,6 +37,7 @@
 #include <string>              // for string
 #include <thread>
 #include <tuple>  // for tuple
+#include <vector>
 
 namespace rootcanal {
 
@@ -490,4 +494,52 @@ TEST_F(AsyncManagerTest, TestCancelAsyncTasksFromUser) {
   ASSERT_FALSE(async_manager_.CancelAsyncTask(task5_id));
 }
 
+#ifdef __linux__
+TEST_F(AsyncManagerTest, TestWatchFdsAboveFdSetSize) {
+  // Each socket pair uses two fds.
+  const size_t kNumSockets = FD_SETSIZE;
+  struct rlimit limit;
+  ASSERT_EQ(0, getrlimit(RLIMIT_NOFILE, &limit));
+  if (limit.rlim_cur < 2 * kNumSockets + 64) {
+    limit.rlim_cur = std::min<rlim_t>(limit.rlim_max, 2 * kNumSockets + 64);
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+  if (limit.rlim_cur < 2 * kNumSockets + 64) {
+    GTEST_SKIP() << "Not enough file descriptors available";
+  }
+
+  std::vector<std::array<int, 2>> sockets(kNumSockets);
+  std::mutex mutex;
+  std::condition_variable cv;
+  int last_read_fd = -1;
+  for (auto& fds : sockets) {
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds.data()));
+    ASSERT_EQ(0, async_manager_.WatchFdForNonBlockingReads(
+                     fds[0], [&](int fd) {
+                       char byte;
+                       ASSERT_EQ(1, read(fd, &byte, 1));
+                       std::unique_lock<std::mutex> lock(mutex);
+                       last_read_fd = fd;
+                       cv.notify_one();
+                     }));
+  }
+
+  // The last socket fds are above FD_SETSIZE.
+  ASSERT_GE(sockets.back()[0], FD_SETSIZE);
+  ASSERT_EQ(1, write(sockets.back()[1], "x", 1));
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(1),
+                            [&] { return last_read_fd != -1; }));
+    ASSERT_EQ(sockets.back()[0], last_read_fd);
+  }
+
+  for (auto& fds : sockets) {
+    async_manager_.StopWatchingFileDescriptor(fds[0]);
+    close(fds[0]);
+    close(fds[1]);
+  }
+}
+#endif  // __linux__
+
 }  // namespace rootcanal
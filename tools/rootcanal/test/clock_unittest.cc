@@ -0,0 +1,61 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "clock.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+namespace rootcanal {
+
+using namespace std::chrono_literals;
+
+class ClockTest : public ::testing::Test {
+ protected:
+  void TearDown() override { Clock::SetVirtualTime(false); }
+};
+
+TEST_F(ClockTest, VirtualTimeOnlyAdvancesOnRequest) {
+  Clock::SetVirtualTime(true);
+  Clock::time_point start = Clock::now();
+  std::this_thread::sleep_for(10ms);
+  ASSERT_EQ(Clock::now(), start);
+
+  Clock::Advance(1h);
+  ASSERT_EQ(Clock::now(), start + 1h);
+}
+
+TEST_F(ClockTest, RealTimeIgnoresAdvance) {
+  Clock::time_point start = Clock::now();
+  Clock::Advance(1h);
+  ASSERT_LT(Clock::now(), start + 1h);
+}
+
+TEST_F(ClockTest, MonotonicAcrossModeChanges) {
+  Clock::time_point start = Clock::now();
+  Clock::SetVirtualTime(true);
+  ASSERT_GE(Clock::now(), start);
+
+  Clock::Advance(1h);
+  Clock::time_point virtual_end = Clock::now();
+  Clock::SetVirtualTime(false);
+  ASSERT_GE(Clock::now(), virtual_end);
+}
+
+}  // namespace rootcanal
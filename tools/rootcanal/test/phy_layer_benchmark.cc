@@ -0,0 +1,102 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "model/devices/beacon.h"
+#include "model/devices/device.h"
+#include "model/setup/phy_device.h"
+#include "model/setup/phy_layer.h"
+#include "packets/link_layer_packets.h"
+#include "phy.h"
+
+namespace rootcanal {
+namespace {
+
+using model::packets::PacketType;
+
+// Passive scanner counting the received advertising packets.
+class Scanner : public Device {
+ public:
+  std::string GetTypeString() const override { return "scanner"; }
+
+  void ReceiveLinkLayerPacket(model::packets::LinkLayerPacketView /*packet*/,
+                              Phy::Type /*type*/, int8_t /*rssi*/) override {
+    received_packets++;
+  }
+
+  bool IsInterestedIn(PacketType type,
+                      Address const& /*destination*/) const override {
+    return type == PacketType::LE_LEGACY_ADVERTISING_PDU;
+  }
+
+  size_t received_packets{0};
+};
+
+// Every beacon advertises once per iteration, the advertising packets
+// are delivered to the scanners only.
+void BM_BeaconSwarm(benchmark::State& state) {
+  size_t num_beacons = state.range(0);
+  size_t num_scanners = state.range(1);
+
+  PhyLayer phy(0, Phy::Type::LOW_ENERGY);
+  std::vector<std::shared_ptr<PhyDevice>> beacons;
+  std::vector<std::shared_ptr<Scanner>> scanners;
+
+  for (size_t index = 0; index < num_beacons; index++) {
+    char address[18];
+    snprintf(address, sizeof(address), "be:ac:00:00:%02zx:%02zx",
+             (index >> 8) & 0xff, index & 0xff);
+    auto beacon = std::make_shared<PhyDevice>(
+        "beacon", std::make_shared<Beacon>(
+                      std::vector<std::string>{"beacon", address, "0"}));
+    phy.Register(beacon);
+    beacons.push_back(beacon);
+  }
+
+  for (size_t index = 0; index < num_scanners; index++) {
+    auto scanner = std::make_shared<Scanner>();
+    phy.Register(std::make_shared<PhyDevice>("scanner", scanner));
+    scanners.push_back(scanner);
+  }
+
+  for (auto _ : state) {
+    for (auto& beacon : beacons) {
+      beacon->Tick();
+    }
+  }
+
+  size_t received_packets = 0;
+  for (auto& scanner : scanners) {
+    received_packets += scanner->received_packets;
+  }
+  state.SetItemsProcessed(state.iterations() * num_beacons);
+  state.counters["received_packets"] = benchmark::Counter(
+      received_packets, benchmark::Counter::kAvgIterations);
+  phy.UnregisterAll();
+}
+BENCHMARK(BM_BeaconSwarm)->Args({100, 10})->Args({1000, 10});
+
+}  // namespace
+}  // namespace rootcanal
+
+BENCHMARK_MAIN();
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "clock.h"
+#include "model/devices/beacon.h"
+#include "model/devices/device.h"
+#include "model/setup/test_model.h"
+#include "packets/link_layer_packets.h"
+#include "phy.h"
+
+namespace rootcanal {
+namespace {
+
+using model::packets::PacketType;
+
+// Passive scanner decoding the received advertising packets.
+class Scanner : public Device {
+ public:
+  std::string GetTypeString() const override { return "scanner"; }
+
+  void ReceiveLinkLayerPacket(model::packets::LinkLayerPacketView packet,
+                              Phy::Type /*type*/, int8_t /*rssi*/) override {
+    auto pdu = model::packets::LeLegacyAdvertisingPduView::Create(packet);
+    if (pdu.IsValid()) {
+      for (uint8_t byte : pdu.GetAdvertisingData()) {
+        checksum += byte;
+      }
+      received_packets++;
+    }
+  }
+
+  bool IsInterestedIn(PacketType type,
+                      Address const& /*destination*/) const override {
+    return type == PacketType::LE_LEGACY_ADVERTISING_PDU;
+  }
+
+  size_t received_packets{0};
+  size_t checksum{0};
+};
+
+TestModel CreateTestModel() {
+  return TestModel(
+      []() { return AsyncUserId(0); },
+      [](AsyncUserId, std::chrono::milliseconds, TaskCallback const&) {
+        return kInvalidTaskId;
+      },
+      [](AsyncUserId, std::chrono::milliseconds, std::chrono::milliseconds,
+         TaskCallback const&) { return kInvalidTaskId; },
+      [](AsyncUserId) {}, [](AsyncTaskId) {},
+      [](std::string const&, int, Phy::Type) {
+        return std::shared_ptr<Device>();
+      });
+}
+
+// Every beacon advertises on every tick, and the advertising packets are
+// decoded by all the scanners. Measures the duration of one model tick
+// depending on the number of threads ticking the devices.
+void BM_ParallelTick(benchmark::State& state) {
+  size_t num_beacons = state.range(0);
+  size_t num_scanners = state.range(1);
+  size_t num_threads = state.range(2);
+
+  Clock::SetVirtualTime(true);
+  TestModel model = CreateTestModel();
+  model.SetTickThreads(num_threads);
+  PhyLayer::Identifier phy_id = model.AddPhy(Phy::Type::LOW_ENERGY);
+  std::vector<std::shared_ptr<Scanner>> scanners;
+
+  for (size_t index = 0; index < num_beacons; index++) {
+    char address[18];
+    snprintf(address, sizeof(address), "be:ac:00:00:%02zx:%02zx",
+             (index >> 8) & 0xff, index & 0xff);
+    model.AddDeviceToPhy(
+        model.AddDevice(std::make_shared<Beacon>(
+            std::vector<std::string>{"beacon", address, "0"})),
+        phy_id);
+  }
+
+  for (size_t index = 0; index < num_scanners; index++) {
+    auto scanner = std::make_shared<Scanner>();
+    model.AddDeviceToPhy(model.AddDevice(scanner), phy_id);
+    scanners.push_back(scanner);
+  }
+
+  for (auto _ : state) {
+    Clock::Advance(std::chrono::milliseconds(10));
+    model.Tick();
+  }
+
+  size_t received_packets = 0;
+  for (auto& scanner : scanners) {
+    received_packets += scanner->received_packets;
+  }
+  state.SetItemsProcessed(received_packets);
+  state.counters["received_packets"] = benchmark::Counter(
+      received_packets, benchmark::Counter::kAvgIterations);
+  Clock::SetVirtualTime(false);
+}
+BENCHMARK(BM_ParallelTick)
+    ->Args({100, 32, 1})
+    ->Args({100, 32, 2})
+    ->Args({100, 32, 4})
+    ->Args({100, 32, 8})
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace rootcanal
+
+BENCHMARK_MAIN();
@@ -0,0 +1,243 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "model/setup/test_model.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "clock.h"
+#include "hci/address.h"
+#include "model/controller/controller_properties.h"
+#include "model/devices/beacon.h"
+#include "model/devices/device.h"
+#include "model/devices/hci_device.h"
+#include "model/hci/hci_transport.h"
+#include "packets/hci_packets.h"
+#include "packets/link_layer_packets.h"
+#include "phy.h"
+
+namespace rootcanal {
+
+using namespace bluetooth::hci;
+using namespace std::chrono_literals;
+
+// HCI transport standing for the host stack. The commands queued by the
+// test are received by the controller on its next tick.
+class FakeHciTransport : public HciTransport {
+ public:
+  void Send(PacketType packet_type,
+            std::vector<uint8_t> const& /*packet*/) override {
+    if (packet_type == PacketType::EVENT) {
+      sent_events++;
+    }
+  }
+
+  void RegisterCallbacks(PacketCallback packet_callback,
+                         CloseCallback /*close_callback*/) override {
+    packet_callback_ = std::move(packet_callback);
+  }
+
+  void Tick() override {
+    for (auto& command : commands_) {
+      packet_callback_(PacketType::COMMAND, command);
+    }
+    commands_.clear();
+  }
+
+  void Close() override {}
+
+  void SendCommand(std::unique_ptr<CommandBuilder> command) {
+    commands_.push_back(
+        std::make_shared<std::vector<uint8_t>>(command->SerializeToBytes()));
+  }
+
+  size_t sent_events{0};
+
+ private:
+  PacketCallback packet_callback_;
+  std::vector<std::shared_ptr<std::vector<uint8_t>>> commands_;
+};
+
+// Passive scanner recording the sequence of the advertising packets
+// received, as a digest of their source addresses and advertising data.
+class Scanner : public Device {
+ public:
+  std::string GetTypeString() const override { return "scanner"; }
+
+  void ReceiveLinkLayerPacket(model::packets::LinkLayerPacketView packet,
+                              Phy::Type /*type*/, int8_t /*rssi*/) override {
+    auto pdu = model::packets::LeLegacyAdvertisingPduView::Create(packet);
+    if (pdu.IsValid()) {
+      for (uint8_t byte : packet.GetSourceAddress().address) {
+        digest = digest * 31 + byte;
+      }
+      for (uint8_t byte : pdu.GetAdvertisingData()) {
+        digest = digest * 31 + byte;
+      }
+      received_packets++;
+    }
+  }
+
+  bool IsInterestedIn(model::packets::PacketType type,
+                      Address const& /*destination*/) const override {
+    return type == model::packets::PacketType::LE_LEGACY_ADVERTISING_PDU;
+  }
+
+  size_t received_packets{0};
+  uint64_t digest{0};
+};
+
+class TestModelTest : public ::testing::Test {
+ protected:
+  void TearDown() override { Clock::SetVirtualTime(false); }
+
+  // Runs the scheduled model tick, and returns the delay of the next one.
+  std::chrono::milliseconds RunTick() {
+    EXPECT_EQ(tasks_.size(), 1u);
+    TaskCallback callback = tasks_.front().second;
+    tasks_.pop_front();
+    callback();
+    EXPECT_EQ(tasks_.size(), 1u);
+    return tasks_.empty() ? 0ms : tasks_.front().first;
+  }
+
+  AsyncUserId next_user_id_{0};
+  AsyncTaskId next_task_id_{kInvalidTaskId};
+  std::deque<std::pair<std::chrono::milliseconds, TaskCallback>> tasks_;
+  TestModel model_{
+      [this]() { return next_user_id_++; },
+      [this](AsyncUserId, std::chrono::milliseconds delay,
+             TaskCallback const& callback) {
+        tasks_.emplace_back(delay, callback);
+        return ++next_task_id_;
+      },
+      [](AsyncUserId, std::chrono::milliseconds, std::chrono::milliseconds,
+         TaskCallback const&) { return kInvalidTaskId; },
+      [](AsyncUserId) {}, [](AsyncTaskId) {},
+      [](std::string const&, int, Phy::Type) {
+        return std::shared_ptr<Device>();
+      }};
+};
+
+TEST_F(TestModelTest, VirtualTickWaitsForHostTraffic) {
+  auto transport = std::make_shared<FakeHciTransport>();
+  PhyLayer::Identifier phy_id = model_.AddPhy(Phy::Type::LOW_ENERGY);
+  model_.AddHciConnection(
+      std::make_shared<HciDevice>(transport, ControllerProperties()));
+  model_.SetTimerPeriod(10ms);
+  model_.SetVirtualTime(true);
+  model_.StartTimer();
+
+  // Without host traffic the ticks are run back to back.
+  ASSERT_EQ(RunTick(), 0ms);
+  ASSERT_EQ(RunTick(), 0ms);
+
+  // The host is given one timer period to react to the command completions.
+  transport->SendCommand(SetEventMaskBuilder::Create(0x3dbff807fffbffff));
+  transport->SendCommand(LeSetScanParametersBuilder::Create(
+      LeScanType::PASSIVE, 0x10, 0x10, OwnAddressType::PUBLIC_DEVICE_ADDRESS,
+      LeScanningFilterPolicy::ACCEPT_ALL));
+  transport->SendCommand(
+      LeSetScanEnableBuilder::Create(Enable::ENABLED, Enable::DISABLED));
+  ASSERT_EQ(RunTick(), 10ms);
+  ASSERT_EQ(transport->sent_events, 3u);
+  ASSERT_EQ(RunTick(), 0ms);
+
+  // And to the events sent without host input, here the advertising reports
+  // of a beacon advertising on every tick.
+  model_.AddDeviceToPhy(
+      model_.AddDevice(std::make_shared<Beacon>(
+          std::vector<std::string>{"beacon", "be:ac:00:00:00:01", "0"})),
+      phy_id);
+  ASSERT_EQ(RunTick(), 10ms);
+  ASSERT_EQ(transport->sent_events, 4u);
+  ASSERT_EQ(RunTick(), 10ms);
+  ASSERT_EQ(transport->sent_events, 5u);
+
+  transport->SendCommand(
+      LeSetScanEnableBuilder::Create(Enable::DISABLED, Enable::DISABLED));
+  ASSERT_EQ(RunTick(), 10ms);
+  ASSERT_EQ(transport->sent_events, 6u);
+  ASSERT_EQ(RunTick(), 0ms);
+}
+
+TEST_F(TestModelTest, ParallelTickMatchesSerialTick) {
+  constexpr size_t kNumBeacons = 40;
+  constexpr size_t kNumScanners = 8;
+  constexpr size_t kNumTicks = 20;
+
+  // Runs the same scenario with the devices ticked by num_threads threads,
+  // and returns the scanners.
+  auto run = [&](size_t num_threads) {
+    Clock::SetVirtualTime(true);
+    TestModel model{
+        []() { return AsyncUserId(0); },
+        [](AsyncUserId, std::chrono::milliseconds, TaskCallback const&) {
+          return kInvalidTaskId;
+        },
+        [](AsyncUserId, std::chrono::milliseconds, std::chrono::milliseconds,
+           TaskCallback const&) { return kInvalidTaskId; },
+        [](AsyncUserId) {}, [](AsyncTaskId) {},
+        [](std::string const&, int, Phy::Type) {
+          return std::shared_ptr<Device>();
+        }};
+    model.SetTickThreads(num_threads);
+    PhyLayer::Identifier phy_id = model.AddPhy(Phy::Type::LOW_ENERGY);
+    std::vector<std::shared_ptr<Scanner>> scanners;
+
+    // Interleave the scanners with the beacons, with advertising intervals
+    // of 0 to 30ms.
+    for (size_t index = 0; index < kNumBeacons + kNumScanners; index++) {
+      if (index % 6 == 5) {
+        auto scanner = std::make_shared<Scanner>();
+        model.AddDeviceToPhy(model.AddDevice(scanner), phy_id);
+        scanners.push_back(scanner);
+        continue;
+      }
+      char address[18];
+      snprintf(address, sizeof(address), "be:ac:00:00:00:%02zx", index);
+      model.AddDeviceToPhy(
+          model.AddDevice(std::make_shared<Beacon>(std::vector<std::string>{
+              "beacon", address, std::to_string((index % 4) * 10)})),
+          phy_id);
+    }
+
+    for (size_t tick = 0; tick < kNumTicks; tick++) {
+      Clock::Advance(10ms);
+      model.Tick();
+    }
+    return scanners;
+  };
+
+  auto serial = run(1);
+  auto parallel = run(4);
+  ASSERT_EQ(serial.size(), kNumScanners);
+  ASSERT_EQ(parallel.size(), kNumScanners);
+  for (size_t i = 0; i < kNumScanners; i++) {
+    ASSERT_GT(serial[i]->received_packets, 0u);
+    ASSERT_EQ(serial[i]->received_packets, parallel[i]->received_packets);
+    ASSERT_EQ(serial[i]->digest, parallel[i]->digest);
+  }
+}
+
+}  // namespace rootcanal